@@ -4,6 +4,7 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <cstdio>
 
 GraphWidget::GraphWidget(int X, int Y, int W, int H, const char* L)
     : Fl_Widget(X, Y, W, H, L) {
@@ -130,6 +131,117 @@ void GraphWidget::draw() {
     if (!curves_.empty() && coordParams_.showAxisLabels) {
         DrawAxisLabels();
     }
+    
+    if (hoverEnabled_ && hoverActive_ && !curves_.empty()) {
+        DrawHoverReadout();
+    }
+}
+
+int GraphWidget::handle(int event) {
+    switch (event) {
+        case FL_ENTER:
+            return 1;  // Required to receive FL_MOVE events
+        case FL_MOVE: {
+            if (!hoverEnabled_) return 1;
+            hoverX_ = Fl::event_x() - x();
+            hoverY_ = Fl::event_y() - y();
+            bool inside = hoverX_ >= coordParams_.drawX && hoverX_ <= coordParams_.drawX + coordParams_.drawWidth &&
+                          hoverY_ >= coordParams_.drawY && hoverY_ <= coordParams_.drawY + coordParams_.drawHeight;
+            if (inside || hoverActive_) {
+                hoverActive_ = inside;
+                redraw();
+            }
+            return 1;
+        }
+        case FL_LEAVE:
+            if (hoverActive_) {
+                hoverActive_ = false;
+                redraw();
+            }
+            return 1;
+        default:
+            return Fl_Widget::handle(event);
+    }
+}
+
+void GraphWidget::DrawHoverReadout() {
+    // Mouse position in world coordinates (inverse of CoordSystemParams::WorldToScreen)
+    double mouseX = coordParams_.xTickInfo.min + (hoverX_ - coordParams_.drawX) / coordParams_.scaleX;
+    double mouseY = coordParams_.yTickInfo.min +
+                    (coordParams_.drawY + coordParams_.drawHeight - hoverY_) / coordParams_.scaleY;
+    
+    // Query each curve's spatial grid and keep the closest hit on screen
+    int hitCurve = -1;
+    long long hitPoint = -1;
+    double bestDist = HOVER_PICK_RADIUS;
+    for (size_t i = 0; i < curves_.size(); ++i) {
+        if (!curves_[i] || !curves_[i]->IsVisible()) continue;
+        
+        double dist = 0.0;
+        long long point = curves_[i]->FindNearestPoint(mouseX, mouseY, coordParams_.scaleX,
+                                                       coordParams_.scaleY, bestDist, &dist);
+        if (point >= 0 && dist <= bestDist) {
+            bestDist = dist;
+            hitCurve = static_cast<int>(i);
+            hitPoint = point;
+        }
+    }
+    if (hitCurve < 0) return;
+    
+    const auto& curve = *curves_[hitCurve];
+    double px = curve.GetXVals()[hitPoint];
+    double py = curve.GetYVals()[hitPoint];
+    double pt = curve.GetTVals()[hitPoint];
+    
+    int screenX, screenY;
+    coordParams_.WorldToScreen(px, py, screenX, screenY);
+    screenX += x();
+    screenY += y();
+    
+    // Crosshair through the picked point, clipped to the plot area
+    int left = x() + coordParams_.drawX;
+    int top = y() + coordParams_.drawY;
+    fl_push_clip(left, top, coordParams_.drawWidth, coordParams_.drawHeight);
+    fl_color(fl_rgb_color(102, 102, 102));
+    fl_line_style(FL_DOT, 1);
+    fl_line(screenX, top, screenX, top + coordParams_.drawHeight);
+    fl_line(left, screenY, left + coordParams_.drawWidth, screenY);
+    fl_line_style(0);
+    
+    CurveColor color = curve.GetColor();
+    fl_color(color.r, color.g, color.b);
+    fl_pie(screenX - 4, screenY - 4, 8, 8, 0, 360);
+    fl_pop_clip();
+    
+    // Readout box next to the cursor
+    char lines[4][128];
+    std::snprintf(lines[0], sizeof(lines[0]), "%s", curve.GetTitle().c_str());
+    std::snprintf(lines[1], sizeof(lines[1]), "t = %.6g", pt);
+    std::snprintf(lines[2], sizeof(lines[2]), "x = %.6g", px);
+    std::snprintf(lines[3], sizeof(lines[3]), "y = %.6g", py);
+    
+    fl_font(FL_HELVETICA, 11);
+    int lineHeight = fl_height();
+    int textWidth = 0;
+    for (const auto& line : lines) {
+        textWidth = std::max(textWidth, static_cast<int>(fl_width(line)));
+    }
+    int boxW = textWidth + 10;
+    int boxH = 4 * lineHeight + 8;
+    int boxX = x() + hoverX_ + 15;
+    int boxY = y() + hoverY_ + 15;
+    if (boxX + boxW > x() + w()) boxX = x() + hoverX_ - 15 - boxW;
+    if (boxY + boxH > y() + h()) boxY = y() + hoverY_ - 15 - boxH;
+    
+    fl_color(FL_WHITE);
+    fl_rectf(boxX, boxY, boxW, boxH);
+    fl_color(color.r, color.g, color.b);
+    fl_rect(boxX, boxY, boxW, boxH);
+    
+    fl_color(FL_BLACK);
+    for (int i = 0; i < 4; ++i) {
+        fl_draw(lines[i], boxX + 5, boxY + 4 + i * lineHeight + fl_height() - fl_descent());
+    }
 }
 
 void GraphWidget::DrawCoordinateSystem() {
@@ -344,6 +456,12 @@ void GraphWidget::SetShowAxisLabels(bool show) {
     redraw();
 }
 
+void GraphWidget::SetHoverReadoutEnabled(bool enabled) {
+    hoverEnabled_ = enabled;
+    if (!enabled) hoverActive_ = false;
+    redraw();
+}
+
 void GraphWidget::SetCurveVisible(int index, bool visible) {
     if (index >= 0 && index < static_cast<int>(curves_.size())) {
         curves_[index]->SetVisible(visible);
@@ -25,6 +25,12 @@ private:
     double animationSpeed_ = 10.0;  // Points per second
     AnimationCallback animationFrameCallback_;
     
+    // Hover crosshair and nearest-point readout
+    bool hoverEnabled_ = true;
+    bool hoverActive_ = false;
+    int hoverX_ = 0, hoverY_ = 0;       // Widget-relative mouse position
+    static constexpr double HOVER_PICK_RADIUS = 20.0;
+    
     // Bounds
     double dataMinX_ = 0, dataMaxX_ = 1;
     double dataMinY_ = 0, dataMaxY_ = 1;
@@ -38,6 +44,7 @@ private:
     void DrawAxisLabels();
     void DrawCurves();
     void DrawAnimationMarkers();
+    void DrawHoverReadout();
     
     // Animation timer callback
     static void AnimationTimerCallback(void* data);
@@ -48,6 +55,7 @@ public:
     ~GraphWidget();
     
     void draw() override;
+    int handle(int event) override;
     void resize(int X, int Y, int W, int H) override;
     
     // Curve management
@@ -69,6 +77,9 @@ public:
     void SetShowAxisLabels(bool show);
     bool GetShowAxisLabels() const { return coordParams_.showAxisLabels; }
     
+    void SetHoverReadoutEnabled(bool enabled);
+    bool IsHoverReadoutEnabled() const { return hoverEnabled_; }
+    
     // Animation controls
     void StartAnimation();
     void PauseAnimation();
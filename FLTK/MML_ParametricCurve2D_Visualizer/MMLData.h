@@ -8,6 +8,7 @@
 #include <cmath>
 #include <limits>
 #include "AxisTickCalculator.h"
+#include "SpatialGrid2D.h"
 
 // Color definition
 struct CurveColor {
@@ -136,6 +137,7 @@ private:
     std::vector<double> yVals_;
     CurveDrawStyle style_;
     CurveColor color_;
+    SpatialGrid2D spatialIndex_;   // Built once after loading, for hover picking
 
 public:
     LoadedParametricCurve2D(const std::string& title, int index) 
@@ -208,6 +210,15 @@ public:
         return xVals_.size();
     }
     
+    // Spatial index for nearest-point queries; call once all points are added
+    void BuildSpatialIndex() { spatialIndex_.Build(xVals_, yVals_); }
+    
+    // Nearest point in screen space (scale = pixels per world unit), -1 if none within maxPixelDist
+    long long FindNearestPoint(double x, double y, double scaleX, double scaleY,
+                               double maxPixelDist, double* outPixelDist = nullptr) const {
+        return spatialIndex_.FindNearest(xVals_, yVals_, x, y, scaleX, scaleY, maxPixelDist, outPixelDist);
+    }
+    
     // Draw the curve
     void Draw(const CoordSystemParams& params);
     
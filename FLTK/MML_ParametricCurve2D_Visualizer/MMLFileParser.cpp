@@ -68,6 +68,9 @@ std::unique_ptr<LoadedParametricCurve2D> MMLFileParser::ParseParametricCurve2D(s
         }
     }
     
+    // Build the hover-picking index once, at load time
+    curve->BuildSpatialIndex();
+    
     return curve;
 }
 
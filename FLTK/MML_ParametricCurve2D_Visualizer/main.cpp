@@ -79,6 +79,7 @@ private:
     Fl_Check_Button* gridCheckbox_;
     Fl_Check_Button* aspectRatioCheckbox_;
     Fl_Check_Button* labelsCheckbox_;
+    Fl_Check_Button* hoverCheckbox_;
     
     // Bounds display
     Fl_Box* boundsLabel_;
@@ -111,6 +112,7 @@ private:
     static void GridCheckboxCallback(Fl_Widget* widget, void* data);
     static void AspectRatioCheckboxCallback(Fl_Widget* widget, void* data);
     static void LabelsCheckboxCallback(Fl_Widget* widget, void* data);
+    static void HoverCheckboxCallback(Fl_Widget* widget, void* data);
     static void StartButtonCallback(Fl_Widget* widget, void* data);
     static void PauseButtonCallback(Fl_Widget* widget, void* data);
     static void ResetButtonCallback(Fl_Widget* widget, void* data);
@@ -262,6 +264,11 @@ MainWindow::MainWindow(int argc, char** argv) : fileIndex_(0), graphTitle_("Para
     aspectRatioCheckbox_ = new Fl_Check_Button(sidebarX + MARGIN, yPos, widgetWidth, 22, "Preserve Aspect Ratio");
     aspectRatioCheckbox_->value(1);  // Default true for parametric curves
     aspectRatioCheckbox_->callback(AspectRatioCheckboxCallback, this);
+    yPos += 24;
+    
+    hoverCheckbox_ = new Fl_Check_Button(sidebarX + MARGIN, yPos, widgetWidth, 22, "Show Hover Readout");
+    hoverCheckbox_->value(1);
+    hoverCheckbox_->callback(HoverCheckboxCallback, this);
     yPos += 30 + sectionSpacing;
     
     // ---------- BOUNDS DISPLAY SECTION ----------
@@ -459,6 +466,12 @@ void MainWindow::LabelsCheckboxCallback(Fl_Widget* widget, void* data) {
     mainWin->graphWidget_->SetShowAxisLabels(checkbox->value() != 0);
 }
 
+void MainWindow::HoverCheckboxCallback(Fl_Widget* widget, void* data) {
+    MainWindow* mainWin = static_cast<MainWindow*>(data);
+    Fl_Check_Button* checkbox = static_cast<Fl_Check_Button*>(widget);
+    mainWin->graphWidget_->SetHoverReadoutEnabled(checkbox->value() != 0);
+}
+
 void MainWindow::StartButtonCallback(Fl_Widget* widget, void* data) {
     MainWindow* mainWin = static_cast<MainWindow*>(data);
     
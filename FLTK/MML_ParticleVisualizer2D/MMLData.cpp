@@ -56,13 +56,28 @@ void ParticleSimulationData::GetBounds(double& xMin, double& xMax, double& yMin,
     yMin = 1e30;
     yMax = -1e30;
     
-    for (const auto& ball : balls_) {
-        for (int step = 0; step < ball.GetNumSteps(); ++step) {
-            auto pos = ball.GetPosition(step);
-            xMin = std::min(xMin, pos.x - ball.GetRadius());
-            xMax = std::max(xMax, pos.x + ball.GetRadius());
-            yMin = std::min(yMin, pos.y - ball.GetRadius());
-            yMax = std::max(yMax, pos.y + ball.GetRadius());
+    for (int step = 0; step < numSteps_; ++step) {
+        const Vector2D* positions = GetStepPositions(step);
+        for (size_t i = 0; i < balls_.size(); ++i) {
+            double radius = balls_[i].GetRadius();
+            xMin = std::min(xMin, positions[i].x - radius);
+            xMax = std::max(xMax, positions[i].x + radius);
+            yMin = std::min(yMin, positions[i].y - radius);
+            yMax = std::max(yMax, positions[i].y + radius);
         }
     }
 }
+
+void ParticleSimulationData::Validate() const {
+    if (numSteps_ < 0) {
+        throw std::runtime_error("Invalid number of steps");
+    }
+    if (static_cast<int>(timeSteps_.size()) != numSteps_) {
+        throw std::runtime_error("Expected " + std::to_string(numSteps_) + " steps, found " +
+                                 std::to_string(timeSteps_.size()));
+    }
+    if (positions_.size() != static_cast<size_t>(numSteps_) * balls_.size()) {
+        throw std::runtime_error("Expected " + std::to_string(balls_.size()) + " positions in each of " +
+                                 std::to_string(numSteps_) + " steps");
+    }
+}
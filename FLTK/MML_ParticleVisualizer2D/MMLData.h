@@ -36,33 +36,21 @@ struct Vector2D {
     Vector2D(double x_ = 0, double y_ = 0) : x(x_), y(y_) {}
 };
 
-// Ball class representing a particle
+// Ball class representing a particle; its positions live in the simulation data,
+// one contiguous block per step
 class Ball {
 private:
     std::string name_;
     Color color_;
     double radius_;
-    std::vector<Vector2D> positions_;  // Position at each time step
 
 public:
     Ball(const std::string& name, const std::string& colorName, double radius)
         : name_(name), color_(Color::FromString(colorName)), radius_(radius) {}
     
-    void AddPosition(const Vector2D& pos) {
-        positions_.push_back(pos);
-    }
-    
-    Vector2D GetPosition(int step) const {
-        if (step < 0 || step >= static_cast<int>(positions_.size())) {
-            throw std::out_of_range("Invalid step index");
-        }
-        return positions_[step];
-    }
-    
     const std::string& GetName() const { return name_; }
     Color GetColor() const { return color_; }
     double GetRadius() const { return radius_; }
-    int GetNumSteps() const { return static_cast<int>(positions_.size()); }
 };
 
 // Particle simulation data
@@ -70,6 +58,7 @@ class ParticleSimulationData {
 private:
     std::vector<Ball> balls_;
     int numSteps_;
+    std::vector<Vector2D> positions_;  // Step-major, GetNumBalls() per step
     std::vector<double> timeSteps_;  // Time value for each step
     double width_;   // Simulation space width
     double height_;  // Simulation space height
@@ -83,6 +72,7 @@ public:
     
     void SetNumSteps(int steps) {
         numSteps_ = steps;
+        if (steps > 0) positions_.reserve(static_cast<size_t>(steps) * balls_.size());
     }
     
     void SetWidth(double width) {
@@ -97,6 +87,15 @@ public:
         timeSteps_.push_back(time);
     }
     
+    // Positions are added step by step, every ball of a step in ball order
+    void AddPosition(const Vector2D& pos) {
+        positions_.push_back(pos);
+    }
+    
+    // Throws unless every step has a time and a position for every ball; once
+    // this passes, GetStepPositions needs no further checks
+    void Validate() const;
+    
     int GetNumBalls() const { return static_cast<int>(balls_.size()); }
     int GetNumSteps() const { return numSteps_; }
     double GetWidth() const { return width_; }
@@ -106,6 +105,11 @@ public:
     double GetTimeStep(int step) const { 
         return step < static_cast<int>(timeSteps_.size()) ? timeSteps_[step] : 0.0; 
     }
+    // GetNumBalls() positions of the given step, nullptr for a step out of range
+    const Vector2D* GetStepPositions(int step) const {
+        if (step < 0 || step >= numSteps_) return nullptr;
+        return positions_.data() + static_cast<size_t>(step) * balls_.size();
+    }
     
     // Get bounds of simulation space
     void GetBounds(double& xMin, double& xMax, double& yMin, double& yMax) const;
@@ -78,6 +78,9 @@ std::unique_ptr<ParticleSimulationData> MMLFileParser::ParseParticleSimulation2D
         throw std::runtime_error("Invalid NumSteps line");
     }
     int numSteps = ParseInt(parts[1]);
+    if (numSteps < 0) {
+        throw std::runtime_error("Invalid NumSteps: " + parts[1]);
+    }
     simData->SetNumSteps(numSteps);
     
     // Parse step data
@@ -103,10 +106,11 @@ std::unique_ptr<ParticleSimulationData> MMLFileParser::ParseParticleSimulation2D
             double x = ParseDouble(parts[1]);
             double y = ParseDouble(parts[2]);
             
-            simData->GetBall(ballIdx).AddPosition(Vector2D(x, y));
+            simData->AddPosition(Vector2D(x, y));
         }
     }
     
+    simData->Validate();
     return simData;
 }
 
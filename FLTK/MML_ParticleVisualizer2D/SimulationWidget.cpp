@@ -58,6 +58,77 @@ void SimulationWidget::InitializeCoordParams() {
     
     coordParams_.centerX = coordParams_.windowWidth / 2 - midPointX * coordParams_.scaleX;
     coordParams_.centerY = coordParams_.windowHeight / 2 + midPointY * coordParams_.scaleY;
+    
+    BuildSprites();
+}
+
+void SimulationWidget::BuildSprites() {
+    sprites_.clear();
+    spriteIndex_.clear();
+    ballSprites_.clear();
+    if (!simData_) return;
+    
+    // Balls sharing a screen radius and color share a sprite
+    ballSprites_.resize(simData_->GetNumBalls());
+    for (int i = 0; i < simData_->GetNumBalls(); ++i) {
+        const Ball& ball = simData_->GetBall(i);
+        int screenRadius = std::max(1, static_cast<int>(ball.GetRadius() * coordParams_.scaleX));
+        ballSprites_[i] = screenRadius <= MAX_SPRITE_RADIUS ? GetSprite(screenRadius, ball.GetColor()) : -1;
+    }
+}
+
+int SimulationWidget::GetSprite(int radius, const Color& color) {
+    long long key = (static_cast<long long>(radius) << 24) | (color.r << 16) | (color.g << 8) | color.b;
+    auto it = spriteIndex_.find(key);
+    if (it != spriteIndex_.end()) {
+        return it->second;
+    }
+    
+    // Disc of radius + 0.5 pixels around the center pixel, a one pixel black
+    // outline inside its edge, coverage of both from the distance to the center
+    int size = 2 * radius + 1;
+    double outer = radius + 0.5;
+    Sprite sprite;
+    sprite.radius = radius;
+    sprite.pixels.resize(static_cast<size_t>(size) * size * 4);
+    unsigned char* pixel = sprite.pixels.data();
+    for (int py = 0; py < size; ++py) {
+        for (int px = 0; px < size; ++px, pixel += 4) {
+            double d = std::sqrt(static_cast<double>((px - radius) * (px - radius) + (py - radius) * (py - radius)));
+            double alpha = std::clamp(outer - d + 0.5, 0.0, 1.0);
+            double fill = 1.0 - std::clamp(d - (outer - 1.0) + 0.5, 0.0, 1.0);
+            pixel[0] = static_cast<unsigned char>(color.r * fill + 0.5);
+            pixel[1] = static_cast<unsigned char>(color.g * fill + 0.5);
+            pixel[2] = static_cast<unsigned char>(color.b * fill + 0.5);
+            pixel[3] = static_cast<unsigned char>(alpha * 255.0 + 0.5);
+        }
+    }
+    sprite.image = std::make_unique<Fl_RGB_Image>(sprite.pixels.data(), size, size, 4);
+    
+    sprites_.push_back(std::move(sprite));
+    int index = static_cast<int>(sprites_.size()) - 1;
+    spriteIndex_[key] = index;
+    return index;
+}
+
+void SimulationWidget::TransformPositions(const Vector2D* positions, int numBalls) {
+    screenX_.resize(numBalls);
+    screenY_.resize(numBalls);
+    
+    // Same transform as WorldToScreen over the whole step, no calls or branches
+    // in the loop so the compiler can vectorize it
+    const double centerX = coordParams_.centerX;
+    const double centerY = coordParams_.centerY;
+    const double scaleX = coordParams_.scaleX;
+    const double scaleY = coordParams_.scaleY;
+    const int offsetX = x();
+    const int offsetY = y();
+    int* screenX = screenX_.data();
+    int* screenY = screenY_.data();
+    for (int i = 0; i < numBalls; ++i) {
+        screenX[i] = static_cast<int>(centerX + positions[i].x * scaleX) + offsetX;
+        screenY[i] = static_cast<int>(centerY - positions[i].y * scaleY) + offsetY;
+    }
 }
 
 void SimulationWidget::WorldToScreen(double worldX, double worldY, int& screenX, int& screenY) const {
@@ -101,30 +172,43 @@ void SimulationWidget::draw() {
     
     DrawBorder();
     
+    // Steps were checked at load, so the step's positions are all there
+    const Vector2D* positions = simData_->GetStepPositions(currentStep_);
+    int numBalls = simData_->GetNumBalls();
+    if (!positions) {
+        return;
+    }
+    TransformPositions(positions, numBalls);
+    
     // Draw all balls at current step
-    for (int i = 0; i < simData_->GetNumBalls(); ++i) {
-        const Ball& ball = simData_->GetBall(i);
+    const int left = x(), top = y(), right = x() + w(), bottom = y() + h();
+    for (int i = 0; i < numBalls; ++i) {
+        int screenX = screenX_[i];
+        int screenY = screenY_[i];
         
-        try {
-            Vector2D pos = ball.GetPosition(currentStep_);
-            int screenX, screenY;
-            WorldToScreen(pos.x, pos.y, screenX, screenY);
-            
-            // Convert radius from world to screen coordinates
-            int screenRadius = static_cast<int>(ball.GetRadius() * coordParams_.scaleX);
+        if (ballSprites_[i] >= 0) {
+            const Sprite& sprite = sprites_[ballSprites_[i]];
+            int size = 2 * sprite.radius + 1;
+            int spriteX = screenX - sprite.radius;
+            int spriteY = screenY - sprite.radius;
             
-            // Draw ball
-            Color color = ball.GetColor();
-            fl_color(color.r, color.g, color.b);
-            fl_pie(screenX - screenRadius, screenY - screenRadius, 
-                   screenRadius * 2, screenRadius * 2, 0, 360);
-            
-            // Draw ball outline
-            fl_color(FL_BLACK);
-            fl_arc(screenX - screenRadius, screenY - screenRadius, 
-                   screenRadius * 2, screenRadius * 2, 0, 360);
-        } catch (const std::exception& e) {
-            // Skip this ball if position data is invalid
+            // Skip balls entirely outside the widget
+            if (spriteX >= right || spriteY >= bottom || spriteX + size <= left || spriteY + size <= top) {
+                continue;
+            }
+            sprite.image->draw(spriteX, spriteY);
+            continue;
         }
+        
+        // Too large for a sprite
+        const Ball& ball = simData_->GetBall(i);
+        int screenRadius = static_cast<int>(ball.GetRadius() * coordParams_.scaleX);
+        Color color = ball.GetColor();
+        fl_color(color.r, color.g, color.b);
+        fl_pie(screenX - screenRadius, screenY - screenRadius, 
+               screenRadius * 2, screenRadius * 2, 0, 360);
+        fl_color(FL_BLACK);
+        fl_arc(screenX - screenRadius, screenY - screenRadius, 
+               screenRadius * 2, screenRadius * 2, 0, 360);
     }
 }
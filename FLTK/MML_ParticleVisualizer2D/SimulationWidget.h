@@ -3,17 +3,40 @@
 
 #include <FL/Fl_Widget.H>
 #include <FL/fl_draw.H>
+#include <FL/Fl_RGB_Image.H>
 #include "MMLData.h"
+#include <map>
 #include <memory>
+#include <vector>
 #include <cmath>
 
 class SimulationWidget : public Fl_Widget {
 private:
+    // Balls larger than this on screen are drawn with fl_pie instead of a sprite
+    static constexpr int MAX_SPRITE_RADIUS = 128;
+    
+    // A ball of one screen radius and color, rendered once with antialiased edges
+    // and outline; the image keeps a pointer into pixels
+    struct Sprite {
+        int radius;
+        std::vector<unsigned char> pixels;  // RGBA, (2 * radius + 1)^2
+        std::unique_ptr<Fl_RGB_Image> image;
+    };
+    
     std::unique_ptr<ParticleSimulationData> simData_;
     CoordSystemParams coordParams_;
     int currentStep_;
     
+    std::vector<Sprite> sprites_;
+    std::map<long long, int> spriteIndex_;  // (radius, rgb) -> sprite
+    std::vector<int> ballSprites_;          // Sprite of each ball, -1 when too large
+    std::vector<int> screenX_;              // Current step's ball centers on screen
+    std::vector<int> screenY_;
+    
     void InitializeCoordParams();
+    void BuildSprites();
+    int GetSprite(int radius, const Color& color);
+    void TransformPositions(const Vector2D* positions, int numBalls);
     void DrawBorder();
     
 public:
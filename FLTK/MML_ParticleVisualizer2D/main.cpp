@@ -1,6 +1,6 @@
 #define NOMINMAX
 #include <FL/Fl.H>
-#include <FL/Fl_Window.H>
+#include <FL/Fl_Double_Window.H>
 #include <FL/Fl_Button.H>
 #include <FL/Fl_File_Chooser.H>
 #include <FL/Fl_Value_Slider.H>
@@ -16,7 +16,7 @@
 
 class MainWindow {
 private:
-    Fl_Window* window_;
+    Fl_Double_Window* window_;
     SimulationWidget* simWidget_;
     LegendWidget* legendWidget_;
     Fl_Button* loadButton_;
@@ -54,7 +54,7 @@ public:
 
 MainWindow::MainWindow(int argc, char** argv) : isPlaying_(false), playbackSpeed_(10.0) {
     // Create main window
-    window_ = new Fl_Window(1200, 750, "MML Particle Visualizer 2D (FLTK)");
+    window_ = new Fl_Double_Window(1200, 750, "MML Particle Visualizer 2D (FLTK)");
     
     // Create simulation widget
     simWidget_ = new SimulationWidget(10, 10, 900, 600);
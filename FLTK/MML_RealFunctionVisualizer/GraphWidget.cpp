@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cstdio>
+#include <FL/Fl.H>
 
 // Define color palette (similar to WPF version)
 const std::vector<Color> GraphWidget::colors_ = {
@@ -324,11 +326,130 @@ void GraphWidget::draw() {
         }
     }
     
+    if (hoverEnabled_ && hoverActive_) {
+        DrawHoverReadout();
+    }
+    
     // Draw border
     fl_color(0, 0, 0);
     fl_rect(x(), y(), w(), h());
 }
 
+int GraphWidget::handle(int event) {
+    switch (event) {
+        case FL_ENTER:
+            return 1;  // Required to receive FL_MOVE events
+        case FL_MOVE:
+            if (hoverEnabled_) {
+                hoverX_ = Fl::event_x();
+                hoverY_ = Fl::event_y();
+                hoverActive_ = true;
+                redraw();
+            }
+            return 1;
+        case FL_LEAVE:
+            if (hoverActive_) {
+                hoverActive_ = false;
+                redraw();
+            }
+            return 1;
+        default:
+            return Fl_Widget::handle(event);
+    }
+}
+
+void GraphWidget::SetHoverReadoutEnabled(bool enabled) {
+    hoverEnabled_ = enabled;
+    if (!enabled) hoverActive_ = false;
+    redraw();
+}
+
+void GraphWidget::DrawHoverReadout() {
+    double mouseX, mouseY;
+    ScreenToWorld(hoverX_, hoverY_, mouseX, mouseY);
+    
+    // Binary search per function; the crosshair snaps to the closest sample found
+    struct HoverLine { std::string text; Color color; double x; double y; };
+    std::vector<HoverLine> lines;
+    double crossX = mouseX;
+    double bestDist = -1.0;
+    char buffer[128];
+    
+    for (const auto& func : functions_) {
+        if (!func->IsVisible()) continue;
+        
+        int sample = func->FindNearestSample(mouseX);
+        if (sample < 0) continue;
+        
+        double sampleX = func->GetSampleX(sample);
+        if (bestDist < 0 || std::abs(sampleX - mouseX) < bestDist) {
+            bestDist = std::abs(sampleX - mouseX);
+            crossX = sampleX;
+        }
+        
+        for (int i = 0; i < func->GetDimension(); ++i) {
+            if (!func->IsFunctionVisible(i)) continue;
+            if (static_cast<int>(lines.size()) >= MAX_HOVER_LINES) break;
+            
+            double sampleY = func->GetSampleY(i, sample);
+            std::snprintf(buffer, sizeof(buffer), "%s: %.6g", func->GetFunctionTitle(i).c_str(), sampleY);
+            lines.push_back({ buffer, GetColor(func->GetFunctionColorIndex(i)), sampleX, sampleY });
+        }
+    }
+    if (bestDist < 0) return;
+    
+    // Crosshair and per-series markers
+    int crossScreenX, unusedY;
+    WorldToScreen(crossX, 0.0, crossScreenX, unusedY);
+    fl_push_clip(x(), y(), w(), h());
+    fl_color(fl_rgb_color(102, 102, 102));
+    fl_line_style(FL_DOT, 1);
+    fl_line(crossScreenX, y(), crossScreenX, y() + h());
+    fl_line_style(FL_SOLID, 1);
+    
+    for (const auto& line : lines) {
+        int sx, sy;
+        WorldToScreen(line.x, line.y, sx, sy);
+        fl_color(line.color.r, line.color.g, line.color.b);
+        fl_pie(sx - 4, sy - 4, 8, 8, 0, 360);
+    }
+    
+    // Readout box next to the cursor: x value, then one swatch + line per series
+    std::snprintf(buffer, sizeof(buffer), "x = %.6g", crossX);
+    std::string header = buffer;
+    
+    fl_font(FL_HELVETICA, style_.labelFontSize);
+    int lineHeight = fl_height();
+    int textWidth = static_cast<int>(fl_width(header.c_str()));
+    for (const auto& line : lines) {
+        textWidth = std::max(textWidth, static_cast<int>(fl_width(line.text.c_str())) + 14);
+    }
+    int boxW = textWidth + 10;
+    int boxH = static_cast<int>(lines.size() + 1) * lineHeight + 8;
+    int boxX = hoverX_ + 15;
+    int boxY = hoverY_ + 15;
+    if (boxX + boxW > x() + w()) boxX = hoverX_ - 15 - boxW;
+    if (boxY + boxH > y() + h()) boxY = hoverY_ - 15 - boxH;
+    
+    fl_color(FL_WHITE);
+    fl_rectf(boxX, boxY, boxW, boxH);
+    fl_color(fl_rgb_color(128, 128, 128));
+    fl_rect(boxX, boxY, boxW, boxH);
+    
+    int baseline = boxY + 4 + fl_height() - fl_descent();
+    fl_color(FL_BLACK);
+    fl_draw(header.c_str(), boxX + 5, baseline);
+    for (const auto& line : lines) {
+        baseline += lineHeight;
+        fl_color(line.color.r, line.color.g, line.color.b);
+        fl_rectf(boxX + 5, baseline - lineHeight / 2 - 3, 8, 8);
+        fl_color(FL_BLACK);
+        fl_draw(line.text.c_str(), boxX + 19, baseline);
+    }
+    
+    fl_pop_clip();
+}
+
 // Implementation of Draw methods for loaded functions
 
 void SingleLoadedFunction::Draw(GraphWidget* widget, const CoordSystemParams& params) {
@@ -60,6 +60,12 @@ private:
     // Callback for requesting main window redraw
     RedrawCallback redrawCallback_;
     
+    // Hover crosshair and nearest-sample readout
+    bool hoverEnabled_ = true;
+    bool hoverActive_ = false;
+    int hoverX_ = 0, hoverY_ = 0;        // Window coordinates of the mouse
+    static constexpr int MAX_HOVER_LINES = 12;
+    
     void InitializeCoordParams();
     void CalculateDataBounds();
     void DrawCoordinateSystem();
@@ -67,11 +73,13 @@ private:
     void DrawAxes();
     void DrawAxisTicks();
     void DrawAxisLabels();
+    void DrawHoverReadout();
     
 public:
     GraphWidget(int X, int Y, int W, int H, const char* L = nullptr);
     
     void draw() override;
+    int handle(int event) override;
     void resize(int X, int Y, int W, int H) override;
     
     void AddFunction(std::unique_ptr<LoadedFunction> func);
@@ -101,6 +109,10 @@ public:
         return coordParams_.preserveAspectRatio; 
     }
     
+    // Hover readout
+    void SetHoverReadoutEnabled(bool enabled);
+    bool IsHoverReadoutEnabled() const { return hoverEnabled_; }
+    
     // Style access
     CoordSystemStyle& GetStyle() { return style_; }
     const CoordSystemStyle& GetStyle() const { return style_; }
@@ -52,6 +52,33 @@ struct FunctionDrawStyle {
         visible(true) {}
 };
 
+// Index of the element nearest to value in an ascending vector (-1 if empty)
+inline int FindNearestSortedIndex(const std::vector<double>& vals, double value) {
+    if (vals.empty()) return -1;
+    
+    auto it = std::lower_bound(vals.begin(), vals.end(), value);
+    if (it == vals.end()) return static_cast<int>(vals.size()) - 1;
+    if (it != vals.begin() && value - *(it - 1) <= *it - value) --it;
+    return static_cast<int>(it - vals.begin());
+}
+
+// Rearranges values into the given order of their indices
+inline void PermuteByOrder(std::vector<double>& values, const std::vector<size_t>& order) {
+    if (values.size() != order.size()) return;
+    std::vector<double> sorted(order.size());
+    for (size_t i = 0; i < order.size(); ++i) sorted[i] = values[order[i]];
+    values.swap(sorted);
+}
+
+// Index order that sorts vals ascending, keeping equal values in file order
+inline std::vector<size_t> AscendingOrder(const std::vector<double>& vals) {
+    std::vector<size_t> order(vals.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&vals](size_t a, size_t b) { return vals[a] < vals[b]; });
+    return order;
+}
+
 // Base class for loaded functions
 class LoadedFunction {
 protected:
@@ -78,6 +105,14 @@ public:
     virtual bool IsFunctionVisible(int index) const { return drawStyle_.visible; }
     virtual void SetFunctionVisible(int index, bool visible) { drawStyle_.visible = visible; }
     
+    // Sample access for hover readout (samples are ordered by increasing x)
+    virtual int FindNearestSample(double x) const = 0;
+    virtual double GetSampleX(int sampleIndex) const = 0;
+    virtual double GetSampleY(int functionIndex, int sampleIndex) const = 0;
+    
+    // Palette index used when drawing a sub-function
+    virtual int GetFunctionColorIndex(int index) const { return index; }
+    
     // Draw style access
     FunctionDrawStyle& GetDrawStyle() { return drawStyle_; }
     const FunctionDrawStyle& GetDrawStyle() const { return drawStyle_; }
@@ -101,6 +136,15 @@ public:
         yVals_.push_back(y);
     }
     
+    // Puts the samples in order of increasing x, as lookups expect; a no-op when
+    // the file listed them in order
+    void SortByX() {
+        if (std::is_sorted(xVals_.begin(), xVals_.end())) return;
+        std::vector<size_t> order = AscendingOrder(xVals_);
+        PermuteByOrder(xVals_, order);
+        PermuteByOrder(yVals_, order);
+    }
+    
     const std::vector<double>& GetXVals() const { return xVals_; }
     const std::vector<double>& GetYVals() const { return yVals_; }
     int GetIndex() const { return index_; }
@@ -133,6 +177,11 @@ public:
         return title_;
     }
     
+    int FindNearestSample(double x) const override { return FindNearestSortedIndex(xVals_, x); }
+    double GetSampleX(int sampleIndex) const override { return xVals_[sampleIndex]; }
+    double GetSampleY(int /*functionIndex*/, int sampleIndex) const override { return yVals_[sampleIndex]; }
+    int GetFunctionColorIndex(int /*index*/) const override { return index_; }
+    
     void Draw(GraphWidget* widget, const CoordSystemParams& params) override;
 };
 
@@ -161,6 +210,15 @@ public:
         }
     }
     
+    // Puts the samples in order of increasing x, as lookups expect; a no-op when
+    // the file listed them in order
+    void SortByX() {
+        if (std::is_sorted(xVals_.begin(), xVals_.end())) return;
+        std::vector<size_t> order = AscendingOrder(xVals_);
+        PermuteByOrder(xVals_, order);
+        for (auto& y : yVals_) PermuteByOrder(y, order);
+    }
+    
     const std::vector<double>& GetXVals() const { return xVals_; }
     const std::vector<std::vector<double>>& GetYVals() const { return yVals_; }
     
@@ -260,6 +318,12 @@ public:
         return title_;
     }
     
+    int FindNearestSample(double x) const override { return FindNearestSortedIndex(xVals_, x); }
+    double GetSampleX(int sampleIndex) const override { return xVals_[sampleIndex]; }
+    double GetSampleY(int functionIndex, int sampleIndex) const override {
+        return yVals_[functionIndex][sampleIndex];
+    }
+    
     void Draw(GraphWidget* widget, const CoordSystemParams& params) override;
 };
 
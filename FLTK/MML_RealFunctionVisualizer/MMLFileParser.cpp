@@ -75,6 +75,7 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseRealFunction(std::ifstream&
         }
     }
     
+    func->SortByX();
     return func;
 }
 
@@ -139,6 +140,7 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseMultiRealFunction(std::ifstr
         }
     }
     
+    func->SortByX();
     return func;
 }
 
@@ -197,6 +199,7 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseMultiRealFunctionVariableSpa
         }
     }
     
+    func->SortByX();
     return func;
 }
 
@@ -64,6 +64,7 @@ private:
     Fl_Check_Button* gridCheckbox_;
     Fl_Check_Button* aspectRatioCheckbox_;
     Fl_Check_Button* labelsCheckbox_;
+    Fl_Check_Button* hoverCheckbox_;
     
     // Buttons section
     Fl_Button* loadButton_;
@@ -86,6 +87,7 @@ private:
     static void GridCheckboxCallback(Fl_Widget* widget, void* data);
     static void AspectRatioCheckboxCallback(Fl_Widget* widget, void* data);
     static void LabelsCheckboxCallback(Fl_Widget* widget, void* data);
+    static void HoverCheckboxCallback(Fl_Widget* widget, void* data);
     
 public:
     MainWindow(int argc, char** argv);
@@ -176,6 +178,11 @@ MainWindow::MainWindow(int argc, char** argv) : fileIndex_(0), graphTitle_("Real
     aspectRatioCheckbox_ = new Fl_Check_Button(sidebarX + MARGIN, yPos, widgetWidth, 25, "Preserve Aspect Ratio");
     aspectRatioCheckbox_->value(0);
     aspectRatioCheckbox_->callback(AspectRatioCheckboxCallback, this);
+    yPos += 28;
+    
+    hoverCheckbox_ = new Fl_Check_Button(sidebarX + MARGIN, yPos, widgetWidth, 25, "Show Hover Readout");
+    hoverCheckbox_->value(1);
+    hoverCheckbox_->callback(HoverCheckboxCallback, this);
     yPos += 35 + sectionSpacing;
     
     // ---------- BUTTONS SECTION ----------
@@ -378,6 +385,12 @@ void MainWindow::LabelsCheckboxCallback(Fl_Widget* widget, void* data) {
     mainWin->graphWidget_->redraw();
 }
 
+void MainWindow::HoverCheckboxCallback(Fl_Widget* widget, void* data) {
+    MainWindow* mainWin = static_cast<MainWindow*>(data);
+    Fl_Check_Button* checkbox = static_cast<Fl_Check_Button*>(widget);
+    mainWin->graphWidget_->SetHoverReadoutEnabled(checkbox->value() != 0);
+}
+
 void MainWindow::Show() {
     window_->show();
 }
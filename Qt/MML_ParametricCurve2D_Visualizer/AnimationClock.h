@@ -0,0 +1,85 @@
+#ifndef ANIMATION_CLOCK_H
+#define ANIMATION_CLOCK_H
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Wall-clock animation position that loops over [begin, end).
+ * The position is origin + rate * elapsed time, so playback speed is exact
+ * regardless of how often it is sampled; the origin is only re-based when the
+ * rate, range or running state changes.
+ */
+class AnimationClock {
+public:
+    // Units per second (points or t, depending on what the owner animates)
+    void SetRate(double unitsPerSecond) {
+        Rebase();
+        rate_ = std::max(0.0, unitsPerSecond);
+    }
+    double GetRate() const { return rate_; }
+
+    void SetRange(double begin, double end) {
+        Rebase();
+        begin_ = begin;
+        end_ = std::max(begin, end);
+        origin_ = Wrap(origin_);
+    }
+    double GetBegin() const { return begin_; }
+    double GetEnd() const { return end_; }
+
+    void Start() {
+        if (running_) return;
+        running_ = true;
+        timer_.start();
+    }
+
+    void Pause() {
+        if (!running_) return;
+        origin_ = GetPosition();
+        running_ = false;
+    }
+
+    void Reset() {
+        origin_ = begin_;
+        if (running_) timer_.start();
+    }
+
+    // Jumps to a position, keeping the running state
+    void Seek(double position) {
+        origin_ = Wrap(position);
+        if (running_) timer_.start();
+    }
+
+    bool IsRunning() const { return running_; }
+
+    double GetPosition() const {
+        if (!running_) return origin_;
+        return Wrap(origin_ + rate_ * static_cast<double>(timer_.nsecsElapsed()) * 1e-9);
+    }
+
+private:
+    void Rebase() {
+        origin_ = GetPosition();
+        if (running_) timer_.start();
+    }
+
+    double Wrap(double position) const {
+        double span = end_ - begin_;
+        if (span <= 0.0) return begin_;
+        if (position >= begin_ && position < end_) return position;
+        double wrapped = std::fmod(position - begin_, span);
+        if (wrapped < 0.0) wrapped += span;
+        return begin_ + wrapped;
+    }
+
+    QElapsedTimer timer_;
+    bool running_ = false;
+    double rate_ = 10.0;
+    double begin_ = 0.0;
+    double end_ = 0.0;
+    double origin_ = 0.0;
+};
+
+#endif // ANIMATION_CLOCK_H
@@ -0,0 +1,93 @@
+#ifndef ARC_LENGTH_TABLE_H
+#define ARC_LENGTH_TABLE_H
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+
+/**
+ * Cumulative arc length of a polyline, for moving along it at constant speed.
+ * length[i] is the distance travelled from point 0 to point i. The table is a
+ * parallel prefix sum: segment lengths and per-chunk totals on worker threads,
+ * a serial scan over the chunk totals, then the chunk offsets added in parallel.
+ */
+template<int Dim>
+class ArcLengthTable {
+public:
+    static constexpr size_t MIN_POINTS_PER_THREAD = size_t(1) << 15;
+
+    // coords[d][i] is coordinate d of point i
+    void Build(const std::array<const double*, Dim>& coords, size_t n) {
+        length_.assign(n, 0.0);
+        if (n < 2) return;
+
+        size_t numChunks = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                            std::max<size_t>(1, n / MIN_POINTS_PER_THREAD));
+        std::vector<double> chunkOffset(numChunks + 1, 0.0);
+        double* length = length_.data();
+
+        // Running sums within each chunk of (1, n]
+        ParallelChunks(numChunks, n, [&](size_t c, size_t begin, size_t end) {
+            double sum = 0.0;
+            for (size_t i = std::max<size_t>(begin, 1); i < end; ++i) {
+                double distSq = 0.0;
+                for (int d = 0; d < Dim; ++d) {
+                    double delta = coords[d][i] - coords[d][i - 1];
+                    distSq += delta * delta;
+                }
+                sum += std::sqrt(distSq);
+                length[i] = sum;
+            }
+            chunkOffset[c + 1] = sum;
+        });
+
+        for (size_t c = 1; c <= numChunks; ++c) {
+            chunkOffset[c] += chunkOffset[c - 1];
+        }
+
+        ParallelChunks(numChunks, n, [&](size_t c, size_t begin, size_t end) {
+            if (c == 0) return;
+            for (size_t i = begin; i < end; ++i) length[i] += chunkOffset[c];
+        });
+    }
+
+    size_t Size() const { return length_.size(); }
+    double GetTotalLength() const { return length_.empty() ? 0.0 : length_.back(); }
+
+    // Arc length at a fractional point index
+    double LengthAtIndex(double index) const {
+        if (length_.empty()) return 0.0;
+        index = std::clamp(index, 0.0, static_cast<double>(length_.size() - 1));
+        size_t i0 = static_cast<size_t>(index);
+        size_t i1 = std::min(i0 + 1, length_.size() - 1);
+        return length_[i0] + (index - static_cast<double>(i0)) * (length_[i1] - length_[i0]);
+    }
+
+    // Fractional point index at arc length s (binary search, then linear within the segment)
+    double IndexAtLength(double s) const {
+        if (length_.size() < 2 || s <= 0.0) return 0.0;
+        size_t j = std::upper_bound(length_.begin(), length_.end(), s) - length_.begin();
+        if (j >= length_.size()) return static_cast<double>(length_.size() - 1);
+        double segment = length_[j] - length_[j - 1];
+        double frac = segment > 0.0 ? (s - length_[j - 1]) / segment : 0.0;
+        return static_cast<double>(j - 1) + frac;
+    }
+
+private:
+    // fn(chunk, begin, end) over a fixed partition of [0, n), one thread per chunk
+    template<typename Fn>
+    static void ParallelChunks(size_t numChunks, size_t n, Fn fn) {
+        std::vector<std::thread> threads;
+        for (size_t c = 1; c < numChunks; ++c) {
+            threads.emplace_back(fn, c, n * c / numChunks, n * (c + 1) / numChunks);
+        }
+        fn(size_t(0), size_t(0), n / numChunks);
+        for (auto& thread : threads) thread.join();
+    }
+
+    std::vector<double> length_;
+};
+
+#endif // ARC_LENGTH_TABLE_H
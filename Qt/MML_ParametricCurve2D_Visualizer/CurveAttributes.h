@@ -0,0 +1,132 @@
+#ifndef CURVE_ATTRIBUTES_H
+#define CURVE_ATTRIBUTES_H
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+
+/**
+ * Per-point scalars for coloring a curve: parameter t, speed |dr/dt| and
+ * curvature. Derivatives use three-point differences on the (possibly uneven)
+ * t spacing; curvature |r' x r''| / |r'|^3 comes from the Lagrange identity, so
+ * the same code serves 2D and 3D. Values are interleaved, NUM_CHANNELS floats
+ * per point, ready to be uploaded next to the positions.
+ */
+template<int Dim>
+class CurveAttributes {
+public:
+    enum Channel { Parameter = 0, Speed = 1, Curvature = 2, NUM_CHANNELS = 3 };
+
+    static constexpr size_t MIN_POINTS_PER_THREAD = size_t(1) << 15;
+    static constexpr size_t MAX_RANGE_SAMPLES = size_t(1) << 16;
+    static constexpr double RANGE_PERCENTILE = 0.01;   // Speed and curvature ranges ignore the extreme 1%
+
+    // coords[d][i] is coordinate d of point i
+    void Build(const double* t, const std::array<const double*, Dim>& coords, size_t n) {
+        values_.assign(n * NUM_CHANNELS, 0.0f);
+        ranges_.fill({0.0f, 1.0f});
+        if (n == 0) return;
+
+        size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                             std::max<size_t>(1, n / MIN_POINTS_PER_THREAD));
+        auto work = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                // End points take the derivatives of their neighbour
+                size_t c = n < 3 ? i : std::clamp<size_t>(i, 1, n - 2);
+                float* v = &values_[i * NUM_CHANNELS];
+                v[Parameter] = static_cast<float>(t[i]);
+                Derivatives(t, coords, n, c, v[Speed], v[Curvature]);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t k = 1; k < numThreads; ++k) {
+            threads.emplace_back(work, n * k / numThreads, n * (k + 1) / numThreads);
+        }
+        work(0, n / numThreads);
+        for (auto& thread : threads) thread.join();
+
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel) {
+            ranges_[channel] = ComputeRange(channel, n, channel == Parameter ? 0.0 : RANGE_PERCENTILE);
+        }
+    }
+
+    // NUM_CHANNELS values per point
+    const std::vector<float>& GetValues() const { return values_; }
+
+    // Value range to map onto a colormap
+    void GetRange(int channel, float& minValue, float& maxValue) const {
+        minValue = ranges_[channel].first;
+        maxValue = ranges_[channel].second;
+    }
+
+private:
+    static void Derivatives(const double* t, const std::array<const double*, Dim>& coords, size_t n, size_t i,
+                            float& speed, float& curvature) {
+        speed = 0.0f;
+        curvature = 0.0f;
+        if (n < 2) return;
+
+        if (n == 2) {
+            double h = t[1] - t[0];
+            if (!(h > 0.0)) return;
+            double sumSq = 0.0;
+            for (int d = 0; d < Dim; ++d) {
+                double d1 = (coords[d][1] - coords[d][0]) / h;
+                sumSq += d1 * d1;
+            }
+            speed = static_cast<float>(std::sqrt(sumSq));
+            return;
+        }
+
+        double h1 = t[i] - t[i - 1];
+        double h2 = t[i + 1] - t[i];
+        if (!(h1 > 0.0) || !(h2 > 0.0)) return;
+
+        double denom = h1 * h2 * (h1 + h2);
+        double d1Sq = 0.0, d2Sq = 0.0, dot = 0.0;
+        for (int d = 0; d < Dim; ++d) {
+            double prev = coords[d][i - 1], cur = coords[d][i], next = coords[d][i + 1];
+            double d1 = (h1 * h1 * next - h2 * h2 * prev + (h2 * h2 - h1 * h1) * cur) / denom;
+            double d2 = 2.0 * (h1 * next - (h1 + h2) * cur + h2 * prev) / denom;
+            d1Sq += d1 * d1;
+            d2Sq += d2 * d2;
+            dot += d1 * d2;
+        }
+
+        double s = std::sqrt(d1Sq);
+        speed = static_cast<float>(s);
+        if (s > 0.0) {
+            double crossSq = std::max(0.0, d1Sq * d2Sq - dot * dot);
+            curvature = static_cast<float>(std::sqrt(crossSq) / (s * s * s));
+        }
+    }
+
+    // [percentile, 1 - percentile] of a strided sample of the channel
+    std::pair<float, float> ComputeRange(int channel, size_t n, double percentile) const {
+        size_t stride = std::max<size_t>(1, n / MAX_RANGE_SAMPLES);
+        std::vector<float> sample;
+        sample.reserve(n / stride + 1);
+        for (size_t i = 0; i < n; i += stride) {
+            float v = values_[i * NUM_CHANNELS + channel];
+            if (std::isfinite(v)) sample.push_back(v);
+        }
+        if (sample.empty()) return {0.0f, 1.0f};
+
+        size_t lo = static_cast<size_t>(percentile * static_cast<double>(sample.size() - 1));
+        size_t hi = sample.size() - 1 - lo;
+        std::nth_element(sample.begin(), sample.begin() + lo, sample.end());
+        float minValue = sample[lo];
+        std::nth_element(sample.begin(), sample.begin() + hi, sample.end());
+        float maxValue = sample[hi];
+        if (!(maxValue > minValue)) maxValue = minValue + 1.0f;
+        return {minValue, maxValue};
+    }
+
+    std::vector<float> values_;
+    std::array<std::pair<float, float>, NUM_CHANNELS> ranges_;
+};
+
+#endif // CURVE_ATTRIBUTES_H
@@ -0,0 +1,201 @@
+#ifndef CURVE_LOD_INDEX_H
+#define CURVE_LOD_INDEX_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+/**
+ * Multi-level Douglas-Peucker simplification of a polyline.
+ * Each point is tagged with the tolerance at which Douglas-Peucker would drop
+ * it (clamped by its parent split, so the levels nest), and level k keeps the
+ * points whose tag exceeds extent * 2^(k - TOLERANCE_LEVELS). The curve is cut
+ * into fixed-size chunks with pinned endpoints that are simplified on worker
+ * threads, which also bounds the worst-case cost of the recursion.
+ */
+template<int Dim>
+class CurveLodIndex {
+public:
+    static constexpr size_t CHUNK_POINTS = size_t(1) << 16;
+    static constexpr size_t MIN_POINTS = 4096;          // Smaller curves are always drawn in full
+    static constexpr int TOLERANCE_LEVELS = 24;         // Finest tolerance is extent / 2^24
+    static constexpr double MAX_LEVEL_FILL = 0.7;       // A level must drop 30% of the previous one
+
+    struct Level {
+        double tolerance;               // Max distance of a dropped point from the simplified curve
+        std::vector<uint32_t> indices;  // Ascending; always contains the first and last point
+    };
+
+    // coords[d][i] is coordinate d of point i; distances are measured after
+    // multiplying coordinate d by scale[d]
+    void Build(const std::array<const double*, Dim>& coords, const std::array<double, Dim>& scale, size_t n) {
+        levels_.clear();
+        if (n < MIN_POINTS || n > std::numeric_limits<uint32_t>::max()) return;
+
+        size_t numChunks = (n - 2) / CHUNK_POINTS + 1;
+        std::vector<float> tolerance(n);
+        std::vector<std::array<double, 2 * Dim>> chunkBounds(numChunks);
+
+        // Chunk endpoints are shared by neighbouring chunks and always kept
+        for (size_t c = 0; c < numChunks; ++c) {
+            tolerance[c * CHUNK_POINTS] = std::numeric_limits<float>::infinity();
+        }
+        tolerance[n - 1] = std::numeric_limits<float>::infinity();
+
+        RunChunks(numChunks, [&](size_t c) {
+            size_t first = c * CHUNK_POINTS;
+            size_t last = std::min(first + CHUNK_POINTS, n - 1);
+            SimplifyChunk(coords, scale, first, last, tolerance.data());
+
+            auto& bounds = chunkBounds[c];
+            for (int d = 0; d < Dim; ++d) {
+                bounds[2 * d] = std::numeric_limits<double>::max();
+                bounds[2 * d + 1] = std::numeric_limits<double>::lowest();
+                for (size_t i = first; i <= last; ++i) {
+                    double v = coords[d][i] * scale[d];
+                    bounds[2 * d] = std::min(bounds[2 * d], v);
+                    bounds[2 * d + 1] = std::max(bounds[2 * d + 1], v);
+                }
+            }
+        });
+
+        double extent = 0.0;
+        for (int d = 0; d < Dim; ++d) {
+            double lo = std::numeric_limits<double>::max();
+            double hi = std::numeric_limits<double>::lowest();
+            for (const auto& bounds : chunkBounds) {
+                lo = std::min(lo, bounds[2 * d]);
+                hi = std::max(hi, bounds[2 * d + 1]);
+            }
+            extent = std::max(extent, hi - lo);
+        }
+        if (!(extent > 0.0)) return;
+
+        // Each level is filtered from the previous one; candidates that don't
+        // thin the curve enough are skipped
+        size_t previousSize = n;
+        for (int k = 0; k <= TOLERANCE_LEVELS; ++k) {
+            double levelTolerance = std::ldexp(extent, k - TOLERANCE_LEVELS);
+            const std::vector<uint32_t>* source = levels_.empty() ? nullptr : &levels_.back().indices;
+            std::vector<uint32_t> indices = Filter(source, n, tolerance.data(), static_cast<float>(levelTolerance));
+            if (static_cast<double>(indices.size()) > MAX_LEVEL_FILL * static_cast<double>(previousSize)) continue;
+
+            previousSize = indices.size();
+            levels_.push_back({levelTolerance, std::move(indices)});
+            if (previousSize <= 2) break;
+        }
+    }
+
+    void Clear() { levels_.clear(); }
+
+    // Coarsest level whose error is within maxError (scaled units); nullptr means every point
+    const Level* SelectLevel(double maxError) const {
+        const Level* best = nullptr;
+        for (const auto& level : levels_) {
+            if (level.tolerance > maxError) break;
+            best = &level;
+        }
+        return best;
+    }
+
+    // Levels from finest to coarsest
+    const std::vector<Level>& GetLevels() const { return levels_; }
+
+private:
+    // Iterative Douglas-Peucker over the interior of [first, last]
+    static void SimplifyChunk(const std::array<const double*, Dim>& coords, const std::array<double, Dim>& scale,
+                              size_t first, size_t last, float* tolerance) {
+        struct Span { size_t first, last; float parent; };
+        std::vector<Span> stack;
+        stack.push_back({first, last, std::numeric_limits<float>::infinity()});
+
+        while (!stack.empty()) {
+            Span span = stack.back();
+            stack.pop_back();
+            if (span.last - span.first < 2) continue;
+
+            std::array<double, Dim> a, ab;
+            double abLengthSq = 0.0;
+            for (int d = 0; d < Dim; ++d) {
+                a[d] = coords[d][span.first] * scale[d];
+                ab[d] = coords[d][span.last] * scale[d] - a[d];
+                abLengthSq += ab[d] * ab[d];
+            }
+
+            // Farthest point from the segment (or from its start when it is degenerate)
+            double maxDistSq = -1.0;
+            size_t split = span.first + 1;
+            for (size_t i = span.first + 1; i < span.last; ++i) {
+                std::array<double, Dim> ap;
+                double dot = 0.0;
+                for (int d = 0; d < Dim; ++d) {
+                    ap[d] = coords[d][i] * scale[d] - a[d];
+                    dot += ap[d] * ab[d];
+                }
+                double u = abLengthSq > 0.0 ? std::clamp(dot / abLengthSq, 0.0, 1.0) : 0.0;
+                double distSq = 0.0;
+                for (int d = 0; d < Dim; ++d) {
+                    double e = ap[d] - u * ab[d];
+                    distSq += e * e;
+                }
+                if (distSq > maxDistSq) {
+                    maxDistSq = distSq;
+                    split = i;
+                }
+            }
+
+            float t = std::min(static_cast<float>(std::sqrt(maxDistSq)), span.parent);
+            tolerance[split] = t;
+            stack.push_back({span.first, split, t});
+            stack.push_back({split, span.last, t});
+        }
+    }
+
+    // Indices (from source, or from all n points) whose drop tolerance exceeds levelTolerance
+    static std::vector<uint32_t> Filter(const std::vector<uint32_t>* source, size_t n,
+                                        const float* tolerance, float levelTolerance) {
+        size_t count = source ? source->size() : n;
+        size_t numChunks = (count + CHUNK_POINTS - 1) / CHUNK_POINTS;
+        std::vector<std::vector<uint32_t>> parts(numChunks);
+
+        RunChunks(numChunks, [&](size_t c) {
+            size_t begin = c * CHUNK_POINTS;
+            size_t end = std::min(begin + CHUNK_POINTS, count);
+            for (size_t j = begin; j < end; ++j) {
+                uint32_t i = source ? (*source)[j] : static_cast<uint32_t>(j);
+                if (tolerance[i] > levelTolerance) parts[c].push_back(i);
+            }
+        });
+
+        std::vector<uint32_t> indices;
+        size_t total = 0;
+        for (const auto& part : parts) total += part.size();
+        indices.reserve(total);
+        for (const auto& part : parts) indices.insert(indices.end(), part.begin(), part.end());
+        return indices;
+    }
+
+    // Runs fn(chunk) for every chunk, handing chunks out to worker threads
+    template<typename Fn>
+    static void RunChunks(size_t numChunks, Fn fn) {
+        size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t c = next++; c < numChunks; c = next++) fn(c);
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads) thread.join();
+    }
+
+    std::vector<Level> levels_;
+};
+
+#endif // CURVE_LOD_INDEX_H
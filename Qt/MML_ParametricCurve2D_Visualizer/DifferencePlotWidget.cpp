@@ -0,0 +1,180 @@
+#include "DifferencePlotWidget.h"
+#include "AxisTickCalculator.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+DifferencePlotWidget::DifferencePlotWidget(QWidget* parent)
+    : QWidget(parent)
+    , tMin_(0.0)
+    , tMax_(1.0)
+    , cursorT_(std::numeric_limits<double>::quiet_NaN())
+{
+    setMinimumHeight(160);
+    setAutoFillBackground(true);
+    QPalette pal = palette();
+    pal.setColor(QPalette::Window, Qt::white);
+    setPalette(pal);
+}
+
+void DifferencePlotWidget::SetTitle(const QString& title) {
+    title_ = title;
+    update();
+}
+
+void DifferencePlotWidget::AddSeries(const QString& name, const QColor& color,
+                                     const std::vector<double>& t, const std::vector<double>& values) {
+    size_t n = std::min(t.size(), values.size());
+    if (n == 0) return;
+
+    // Every series of the pane shares the first one's t range
+    if (series_.empty()) {
+        tMin_ = t.front();
+        tMax_ = t[n - 1];
+        if (!(tMax_ > tMin_)) tMax_ = tMin_ + 1.0;
+    }
+
+    Envelope envelope;
+    envelope.name = name;
+    envelope.color = color;
+    envelope.minValue.assign(NUM_BUCKETS, std::numeric_limits<double>::quiet_NaN());
+    envelope.maxValue.assign(NUM_BUCKETS, std::numeric_limits<double>::quiet_NaN());
+
+    double scale = NUM_BUCKETS / (tMax_ - tMin_);
+    double valueMin = std::numeric_limits<double>::infinity();
+    double valueMax = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; ++i) {
+        double v = values[i];
+        if (!std::isfinite(v)) continue;
+        int bucket = std::clamp(static_cast<int>((t[i] - tMin_) * scale), 0, NUM_BUCKETS - 1);
+        double& lo = envelope.minValue[bucket];
+        double& hi = envelope.maxValue[bucket];
+        if (std::isnan(lo) || v < lo) lo = v;
+        if (std::isnan(hi) || v > hi) hi = v;
+        valueMin = std::min(valueMin, v);
+        valueMax = std::max(valueMax, v);
+    }
+    if (valueMin <= valueMax) {
+        envelope.valueMin = valueMin;
+        envelope.valueMax = valueMax;
+    }
+
+    series_.push_back(std::move(envelope));
+    update();
+}
+
+void DifferencePlotWidget::Clear() {
+    title_.clear();
+    series_.clear();
+    cursorT_ = std::numeric_limits<double>::quiet_NaN();
+    update();
+}
+
+void DifferencePlotWidget::SetCursorT(double t) {
+    if (t == cursorT_) return;
+    cursorT_ = t;
+    update();
+}
+
+void DifferencePlotWidget::paintEvent(QPaintEvent* /*event*/) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    if (!title_.isEmpty()) {
+        painter.save();
+        QFont font = painter.font();
+        font.setBold(true);
+        painter.setFont(font);
+        painter.setPen(Qt::black);
+        painter.drawText(QRect(MARGIN_LEFT, 2, width() - MARGIN_LEFT - MARGIN_RIGHT, MARGIN_TOP - 4),
+                         Qt::AlignLeft | Qt::AlignVCenter, title_);
+        painter.restore();
+    }
+
+    if (series_.empty()) return;
+
+    int numPanels = static_cast<int>(series_.size());
+    int plotHeight = height() - MARGIN_TOP - MARGIN_BOTTOM - PANEL_GAP * (numPanels - 1);
+    int panelHeight = std::max(1, plotHeight / numPanels);
+    int plotWidth = std::max(1, width() - MARGIN_LEFT - MARGIN_RIGHT);
+
+    for (int p = 0; p < numPanels; ++p) {
+        QRect rect(MARGIN_LEFT, MARGIN_TOP + p * (panelHeight + PANEL_GAP), plotWidth, panelHeight);
+        DrawPanel(painter, series_[p], rect, p == numPanels - 1);
+    }
+}
+
+void DifferencePlotWidget::DrawPanel(QPainter& painter, const Envelope& envelope, const QRect& rect, bool tLabels) const {
+    AxisTickInfo tTicks = AxisTickCalculator::CalculateTicks(tMin_, tMax_, 8);
+    AxisTickInfo vTicks = AxisTickCalculator::CalculateTicks(envelope.valueMin, envelope.valueMax, 4);
+    double vMin = vTicks.min, vMax = vTicks.max;
+    if (!(vMax > vMin)) vMax = vMin + 1.0;
+
+    auto toX = [&](double t) { return rect.left() + (t - tMin_) / (tMax_ - tMin_) * rect.width(); };
+    auto toY = [&](double v) { return rect.bottom() - (v - vMin) / (vMax - vMin) * rect.height(); };
+
+    // Grid and tick labels
+    QFontMetrics metrics(painter.font());
+    painter.setPen(QPen(QColor(225, 225, 225), 1));
+    for (const auto& tick : tTicks.ticks) {
+        if (tick.value < tMin_ || tick.value > tMax_) continue;
+        double x = toX(tick.value);
+        painter.drawLine(QPointF(x, rect.top()), QPointF(x, rect.bottom()));
+    }
+    for (const auto& tick : vTicks.ticks) {
+        double y = toY(tick.value);
+        painter.setPen(QPen(QColor(225, 225, 225), 1));
+        painter.drawLine(QPointF(rect.left(), y), QPointF(rect.right(), y));
+        painter.setPen(Qt::black);
+        QString label = QString::fromStdString(tick.label);
+        painter.drawText(QPointF(rect.left() - 6 - metrics.horizontalAdvance(label), y + metrics.ascent() / 2.0), label);
+    }
+    if (tLabels) {
+        painter.setPen(Qt::black);
+        for (const auto& tick : tTicks.ticks) {
+            if (tick.value < tMin_ || tick.value > tMax_) continue;
+            QString label = QString::fromStdString(tick.label);
+            painter.drawText(QPointF(toX(tick.value) - metrics.horizontalAdvance(label) / 2.0,
+                                     rect.bottom() + 4 + metrics.ascent()), label);
+        }
+    }
+
+    painter.setPen(QPen(Qt::black, 1));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(rect);
+
+    // Envelope: down to each bucket's minimum and up to its maximum, left to right
+    QPainterPath path;
+    bool started = false;
+    double bucketWidth = (tMax_ - tMin_) / NUM_BUCKETS;
+    for (int b = 0; b < NUM_BUCKETS; ++b) {
+        if (std::isnan(envelope.minValue[b])) continue;
+        double x = toX(tMin_ + (b + 0.5) * bucketWidth);
+        QPointF lo(x, toY(envelope.minValue[b]));
+        QPointF hi(x, toY(envelope.maxValue[b]));
+        if (!started) {
+            path.moveTo(hi);
+            started = true;
+        } else {
+            path.lineTo(hi);
+        }
+        if (lo != hi) path.lineTo(lo);
+    }
+    painter.save();
+    painter.setClipRect(rect.adjusted(0, -1, 1, 1));
+    painter.setPen(QPen(envelope.color, 1.5));
+    painter.drawPath(path);
+
+    // Animation cursor
+    if (std::isfinite(cursorT_) && cursorT_ >= tMin_ && cursorT_ <= tMax_) {
+        painter.setPen(QPen(QColor(200, 0, 0), 1, Qt::DashLine));
+        double x = toX(cursorT_);
+        painter.drawLine(QPointF(x, rect.top()), QPointF(x, rect.bottom()));
+    }
+    painter.restore();
+
+    painter.setPen(envelope.color.darker(130));
+    painter.drawText(QPointF(rect.left() + 6, rect.top() + metrics.ascent() + 3), envelope.name);
+}
@@ -0,0 +1,59 @@
+#ifndef DIFFERENCE_PLOT_WIDGET_H
+#define DIFFERENCE_PLOT_WIDGET_H
+
+#include <QWidget>
+#include <QString>
+#include <QColor>
+#include <vector>
+
+class QPainter;
+
+// Pane plotting per-sample series against t, one stacked panel per series with
+// a shared t axis. Only a min/max envelope over NUM_BUCKETS equal t intervals is
+// kept, so a series of any length paints in constant time. A vertical cursor
+// marks the animation's current t.
+class DifferencePlotWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr int NUM_BUCKETS = 2048;
+
+    explicit DifferencePlotWidget(QWidget* parent = nullptr);
+
+    void SetTitle(const QString& title);
+    void AddSeries(const QString& name, const QColor& color,
+                   const std::vector<double>& t, const std::vector<double>& values);
+    void Clear();
+    bool IsEmpty() const { return series_.empty(); }
+
+    void SetCursorT(double t);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    struct Envelope {
+        QString name;
+        QColor color;
+        std::vector<double> minValue;    // Per bucket; NaN when no sample fell in it
+        std::vector<double> maxValue;
+        double valueMin = 0.0;
+        double valueMax = 1.0;
+    };
+
+    static constexpr int MARGIN_LEFT = 70;
+    static constexpr int MARGIN_RIGHT = 15;
+    static constexpr int MARGIN_TOP = 22;
+    static constexpr int MARGIN_BOTTOM = 22;
+    static constexpr int PANEL_GAP = 18;
+
+    void DrawPanel(QPainter& painter, const Envelope& envelope, const QRect& rect, bool tLabels) const;
+
+    QString title_;
+    std::vector<Envelope> series_;
+    double tMin_;
+    double tMax_;
+    double cursorT_;
+};
+
+#endif // DIFFERENCE_PLOT_WIDGET_H
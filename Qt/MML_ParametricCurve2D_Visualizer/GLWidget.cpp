@@ -2,9 +2,15 @@
 #include <GL/gl.h>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
 
 GLWidget::GLWidget(QWidget* parent)
     : QOpenGLWidget(parent)
+    , curveColoring_(CurveColoring::Solid)
+    , colormap_(LineRenderer::Colormap::Viridis)
+    , labelsDirty_(true)
+    , labelMinX_(0.0), labelMaxX_(0.0)
+    , labelMinY_(0.0), labelMaxY_(0.0)
     , dataMinX_(-10.0), dataMaxX_(10.0)
     , dataMinY_(-10.0), dataMaxY_(10.0)
     , dataMinT_(0.0), dataMaxT_(1.0)
@@ -17,11 +23,22 @@ GLWidget::GLWidget(QWidget* parent)
     , showGrid_(true)
     , showLabels_(true)
     , preserveAspectRatio_(true)  // Default true for parametric curves
+    , animationMode_(AnimationMode::Points)
+    , animationPosition_(0.0)
     , animationRunning_(false)
     , currentAnimationFrame_(0)
     , maxAnimationFrames_(0)
     , animationSpeed_(10.0)
+    , showTrails_(false)
+    , trailLength_(64)
+    , trailPosition_(0.0)
+    , trailRebuild_(true)
+    , trailColorsDirty_(true)
     , isPanning_(false)
+    , hoverEnabled_(true)
+    , hoverActive_(false)
+    , hoverCurve_(-1)
+    , hoverPoint_(-1)
     , glInitialized_(false)
     , width_(800)
     , height_(600)
@@ -29,19 +46,28 @@ GLWidget::GLWidget(QWidget* parent)
     setFocusPolicy(Qt::StrongFocus);
     setMouseTracking(true);
     
+    curveStyle_.width = CURVE_LINE_WIDTH;
+    curveStyle_.join = LineRenderer::JoinStyle::Round;
+    
     // Initialize tick info for default view
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        viewMinX_, viewMaxX_, viewMinY_, viewMaxY_, 10, 8);
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
     
-    // Create animation timer
-    animationTimer_ = new QTimer(this);
-    connect(animationTimer_, &QTimer::timeout, this, &GLWidget::OnAnimationTimer);
+    // Animation advances once per presented frame
+    animationClock_.SetRate(animationSpeed_);
+    connect(this, &QOpenGLWidget::frameSwapped, this, &GLWidget::OnFrameSwapped);
 }
 
 GLWidget::~GLWidget() {
     StopAnimation();
+    if (glInitialized_) {
+        makeCurrent();
+        textRenderer_.Cleanup();
+        hoverTextRenderer_.Cleanup();
+        ReleaseCurveBuffers();
+        lineRenderer_.ReleaseTrail(trail_);
+        lineRenderer_.Cleanup();
+        doneCurrent();
+    }
 }
 
 void GLWidget::initializeGL() {
@@ -50,11 +76,17 @@ void GLWidget::initializeGL() {
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glEnable(GL_LINE_SMOOTH);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    
+    textRenderer_.Initialize(QFont("Helvetica", 9), devicePixelRatioF());
+    hoverTextRenderer_.Initialize(QFont("Helvetica", 9), devicePixelRatioF());
+    lineRenderer_.Initialize(devicePixelRatioF());
+    labelsDirty_ = true;
 }
 
 void GLWidget::resizeGL(int w, int h) {
     width_ = w;
     height_ = h;
+    labelsDirty_ = true;
 }
 
 void GLWidget::SetupProjection() {
@@ -103,12 +135,17 @@ void GLWidget::SetupProjection() {
     
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
+    
+    QMatrix4x4 projection;
+    projection.ortho(displayMinX_, displayMaxX_, displayMinY_, displayMaxY_, -1.0f, 1.0f);
+    lineRenderer_.SetMatrix(projection);
 }
 
 void GLWidget::paintGL() {
     glClear(GL_COLOR_BUFFER_BIT);
     
     SetupProjection();
+    UploadCurveBuffers();
     
     // Draw OpenGL elements
     if (showGrid_) {
@@ -117,70 +154,100 @@ void GLWidget::paintGL() {
     DrawAxes();
     
     // Draw all visible curves
-    for (const auto& curve : curves_) {
-        if (curve && curve->IsVisible()) {
-            DrawCurve(*curve);
+    for (size_t i = 0; i < curves_.size(); ++i) {
+        if (curves_[i] && curves_[i]->IsVisible()) {
+            DrawCurve(i);
         }
     }
     
-    // Draw labels and animation markers using QPainter overlay
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    // Trails under the markers, while animating
+    bool showMarkers = animationRunning_ || animationPosition_ > animationClock_.GetBegin();
+    if (showMarkers && showTrails_) {
+        DrawTrails();
+    }
     
+    // Hover crosshair in world coordinates, before the viewport is changed for text
+    bool showHover = hoverEnabled_ && hoverActive_;
+    if (showHover) {
+        UpdateHoverPoint();
+        showHover = hoverCurve_ >= 0;
+    }
+    if (showHover) {
+        DrawHoverCrosshair();
+    }
+    
+    // Draw labels from the glyph atlas in a single batch
     if (showLabels_) {
-        DrawAxisLabels(painter);
+        DrawAxisLabels();
     }
     
-    if (animationRunning_ || currentAnimationFrame_ > 0) {
-        DrawAnimationMarkers(painter);
+    if (showHover) {
+        DrawHoverReadout();
     }
     
-    painter.end();
+    // Animation markers still use a QPainter overlay, only while animating
+    if (showMarkers) {
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+        DrawAnimationMarkers(painter);
+        painter.end();
+    }
 }
 
 void GLWidget::DrawGrid() {
-    glLineWidth(1.0f);
-    glColor3f(0.9f, 0.9f, 0.9f);
-    
-    // Draw vertical grid lines at X tick positions
-    glBegin(GL_LINES);
+    // Vertical lines at X tick positions, horizontal lines at Y tick positions
+    lineVertices_.clear();
     for (const auto& tick : xTickInfo_.ticks) {
-        glVertex2d(tick.value, displayMinY_);
-        glVertex2d(tick.value, displayMaxY_);
+        AddSegment(tick.value, displayMinY_, tick.value, displayMaxY_);
     }
-    glEnd();
-    
-    // Draw horizontal grid lines at Y tick positions
-    glBegin(GL_LINES);
     for (const auto& tick : yTickInfo_.ticks) {
-        glVertex2d(displayMinX_, tick.value);
-        glVertex2d(displayMaxX_, tick.value);
+        AddSegment(displayMinX_, tick.value, displayMaxX_, tick.value);
     }
-    glEnd();
+    lineRenderer_.DrawSegments(lineVertices_, { GRID_LINE_WIDTH }, 0.9f, 0.9f, 0.9f);
 }
 
 void GLWidget::DrawAxes() {
-    glLineWidth(2.0f);
-    glColor3f(0.0f, 0.0f, 0.0f);
-    
-    // X-axis (at y=0 if in range, otherwise at bottom)
+    // X-axis at y=0 if in range, otherwise at bottom; Y-axis at x=0 or at left
     double xAxisY = (displayMinY_ <= 0 && displayMaxY_ >= 0) ? 0 : displayMinY_;
-    glBegin(GL_LINES);
-    glVertex2d(displayMinX_, xAxisY);
-    glVertex2d(displayMaxX_, xAxisY);
-    glEnd();
-    
-    // Y-axis (at x=0 if in range, otherwise at left)
     double yAxisX = (displayMinX_ <= 0 && displayMaxX_ >= 0) ? 0 : displayMinX_;
-    glBegin(GL_LINES);
-    glVertex2d(yAxisX, displayMinY_);
-    glVertex2d(yAxisX, displayMaxY_);
-    glEnd();
+    
+    lineVertices_.clear();
+    AddSegment(displayMinX_, xAxisY, displayMaxX_, xAxisY);
+    AddSegment(yAxisX, displayMinY_, yAxisX, displayMaxY_);
+    lineRenderer_.DrawSegments(lineVertices_, { AXIS_LINE_WIDTH }, 0.0f, 0.0f, 0.0f);
 }
 
-void GLWidget::DrawAxisLabels(QPainter& painter) {
-    painter.setFont(QFont("Helvetica", 9));
-    painter.setPen(Qt::black);
+void GLWidget::AddSegment(double x0, double y0, double x1, double y1) {
+    lineVertices_.insert(lineVertices_.end(), { static_cast<float>(x0), static_cast<float>(y0), 0.0f,
+                                                static_cast<float>(x1), static_cast<float>(y1), 0.0f });
+}
+
+void GLWidget::UpdateAxisTicks(double minX, double maxX, double minY, double maxY) {
+    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(minX, maxX, minY, maxY, 10, 8);
+    xTickInfo_ = std::move(xTicks);
+    yTickInfo_ = std::move(yTicks);
+    labelsDirty_ = true;
+}
+
+void GLWidget::DrawAxisLabels() {
+    // Re-scale the atlas if the widget moved to a screen with different pixel density
+    if (textRenderer_.GetDevicePixelRatio() != devicePixelRatioF()) {
+        textRenderer_.Initialize(QFont("Helvetica", 9), devicePixelRatioF());
+        hoverTextRenderer_.Initialize(QFont("Helvetica", 9), devicePixelRatioF());
+        labelsDirty_ = true;
+    }
+    
+    if (labelsDirty_ ||
+        labelMinX_ != displayMinX_ || labelMaxX_ != displayMaxX_ ||
+        labelMinY_ != displayMinY_ || labelMaxY_ != displayMaxY_) {
+        RebuildAxisLabels();
+    }
+    
+    textRenderer_.Draw(width_, height_, 0.0f, 0.0f, 0.0f);
+}
+
+void GLWidget::RebuildAxisLabels() {
+    textRenderer_.ClearBatch();
     
     int drawWidth = width_ - MARGIN_LEFT - MARGIN_RIGHT;
     int drawHeight = height_ - MARGIN_TOP - MARGIN_BOTTOM;
@@ -188,49 +255,132 @@ void GLWidget::DrawAxisLabels(QPainter& painter) {
     double rangeX = displayMaxX_ - displayMinX_;
     double rangeY = displayMaxY_ - displayMinY_;
     
-    // X-axis labels
+    // X-axis labels, centered below the plot area
     for (const auto& tick : xTickInfo_.ticks) {
-        double normX = (tick.value - displayMinX_) / rangeX;
-        int screenX = MARGIN_LEFT + static_cast<int>(normX * drawWidth);
-        int screenY = height_ - MARGIN_BOTTOM + 15;
+        if (tick.value < displayMinX_ || tick.value > displayMaxX_) continue;
         
-        QString label = QString::fromStdString(tick.label);
-        QFontMetrics fm(painter.font());
-        int textWidth = fm.horizontalAdvance(label);
+        double normX = (tick.value - displayMinX_) / rangeX;
+        float screenX = static_cast<float>(MARGIN_LEFT + static_cast<int>(normX * drawWidth));
+        float screenY = static_cast<float>(height_ - MARGIN_BOTTOM + 11);
         
-        painter.drawText(screenX - textWidth / 2, screenY, label);
+        textRenderer_.AddText(tick.label, screenX, screenY, TextAlign::Center);
     }
     
-    // Y-axis labels
+    // Y-axis labels, right-aligned left of the plot area
     for (const auto& tick : yTickInfo_.ticks) {
+        if (tick.value < displayMinY_ || tick.value > displayMaxY_) continue;
+        
         double normY = (tick.value - displayMinY_) / rangeY;
-        int screenX = MARGIN_LEFT - 5;
-        int screenY = height_ - MARGIN_BOTTOM - static_cast<int>(normY * drawHeight);
+        float screenX = static_cast<float>(MARGIN_LEFT - 5);
+        float screenY = static_cast<float>(height_ - MARGIN_BOTTOM - static_cast<int>(normY * drawHeight));
+        
+        textRenderer_.AddText(tick.label, screenX, screenY, TextAlign::Right);
+    }
+    
+    labelMinX_ = displayMinX_;
+    labelMaxX_ = displayMaxX_;
+    labelMinY_ = displayMinY_;
+    labelMaxY_ = displayMaxY_;
+    labelsDirty_ = false;
+}
+
+void GLWidget::UploadCurveBuffers() {
+    // Curves added since the last frame; existing buffers are never re-sent
+    std::vector<float> chunk;
+    for (size_t i = curveBuffers_.size(); i < curves_.size(); ++i) {
+        const auto& curve = *curves_[i];
+        const auto& xVals = curve.GetXVals();
+        const auto& yVals = curve.GetYVals();
+        CurveBuffer buffer;
+        
+        // Convert in chunks so large curves don't need a second full-size copy
+        size_t numPoints = curve.GetNumPoints();
+        buffer.strip = lineRenderer_.CreateStrip(numPoints);
+        for (size_t first = 0; first < numPoints; first += UPLOAD_CHUNK_POINTS) {
+            size_t count = std::min(UPLOAD_CHUNK_POINTS, numPoints - first);
+            chunk.resize(count * 3);
+            for (size_t k = 0; k < count; ++k) {
+                chunk[3 * k] = static_cast<float>(xVals[first + k]);
+                chunk[3 * k + 1] = static_cast<float>(yVals[first + k]);
+                chunk[3 * k + 2] = 0.0f;
+            }
+            lineRenderer_.UploadStripPoints(buffer.strip, first, chunk.data(), count);
+        }
         
-        QString label = QString::fromStdString(tick.label);
-        QFontMetrics fm(painter.font());
-        int textWidth = fm.horizontalAdvance(label);
+        // Coloring attributes go next to the points, so any of them can be shown
+        // without another upload
+        const auto& values = curve.GetAttributes().GetValues();
+        constexpr size_t channels = CurveAttributes<2>::NUM_CHANNELS;
+        lineRenderer_.UploadStripAttributes(buffer.strip, 0, values.data(), numPoints);
         
-        painter.drawText(screenX - textWidth, screenY + 4, label);
+        // Simplified strips hold only the points kept by each level
+        std::vector<float> levelValues;
+        for (const auto& level : curve.GetLodIndex().GetLevels()) {
+            chunk.resize(level.indices.size() * 3);
+            for (size_t k = 0; k < level.indices.size(); ++k) {
+                uint32_t p = level.indices[k];
+                chunk[3 * k] = static_cast<float>(xVals[p]);
+                chunk[3 * k + 1] = static_cast<float>(yVals[p]);
+                chunk[3 * k + 2] = 0.0f;
+            }
+            levelValues.resize(level.indices.size() * channels);
+            for (size_t k = 0; k < level.indices.size(); ++k) {
+                std::copy_n(&values[level.indices[k] * channels], channels, &levelValues[k * channels]);
+            }
+            LineRenderer::Strip strip = lineRenderer_.CreateStrip(level.indices.size());
+            lineRenderer_.UploadStripPoints(strip, 0, chunk.data(), level.indices.size());
+            lineRenderer_.UploadStripAttributes(strip, 0, levelValues.data(), level.indices.size());
+            buffer.lodStrips.push_back(strip);
+        }
+        
+        curveBuffers_.push_back(std::move(buffer));
+    }
+}
+
+void GLWidget::ReleaseCurveBuffers() {
+    for (auto& buffer : curveBuffers_) {
+        lineRenderer_.ReleaseStrip(buffer.strip);
+        for (auto& strip : buffer.lodStrips) {
+            lineRenderer_.ReleaseStrip(strip);
+        }
     }
+    curveBuffers_.clear();
 }
 
-void GLWidget::DrawCurve(const LoadedParamCurve2D& curve) {
-    const auto& xVals = curve.GetXVals();
-    const auto& yVals = curve.GetYVals();
+void GLWidget::DrawCurve(size_t index) {
+    if (index >= curveBuffers_.size()) return;
+    const LoadedParamCurve2D& curve = *curves_[index];
+    const CurveBuffer& buffer = curveBuffers_[index];
     
-    if (xVals.size() < 2) return;
+    // Coarsest simplification level that stays within LOD_PIXEL_TOLERANCE at this zoom
+    int drawWidth = std::max(width_ - MARGIN_LEFT - MARGIN_RIGHT, 1);
+    int drawHeight = std::max(height_ - MARGIN_TOP - MARGIN_BOTTOM, 1);
+    double scaleX = drawWidth / (displayMaxX_ - displayMinX_);
+    double scaleY = drawHeight / (displayMaxY_ - displayMinY_);
+    int level = curve.SelectLodLevel(scaleX, scaleY, LOD_PIXEL_TOLERANCE);
     
-    Color color = curve.GetColor();
-    glColor3f(color.r, color.g, color.b);
-    glLineWidth(2.0f);
+    const LineRenderer::Strip& strip =
+        (level >= 0 && level < static_cast<int>(buffer.lodStrips.size())) ? buffer.lodStrips[level] : buffer.strip;
     
-    // Draw curve as connected line segments
-    glBegin(GL_LINE_STRIP);
-    for (size_t i = 0; i < xVals.size(); ++i) {
-        glVertex2d(xVals[i], yVals[i]);
+    // One instanced draw call per curve
+    if (curveColoring_ != CurveColoring::Solid) {
+        lineRenderer_.DrawStrip(strip, curveStyle_, GetAttributeColoring(curve));
+        return;
     }
-    glEnd();
+    Color color = curve.GetColor();
+    lineRenderer_.DrawStrip(strip, curveStyle_, color.r, color.g, color.b);
+}
+
+LineRenderer::AttributeColoring GLWidget::GetAttributeColoring(const LoadedParamCurve2D& curve) const {
+    LineRenderer::AttributeColoring coloring;
+    switch (curveColoring_) {
+        case CurveColoring::Speed: coloring.channel = CurveAttributes<2>::Speed; break;
+        case CurveColoring::Curvature: coloring.channel = CurveAttributes<2>::Curvature; break;
+        default: coloring.channel = CurveAttributes<2>::Parameter; break;
+    }
+    curve.GetAttributes().GetRange(coloring.channel, coloring.minValue, coloring.maxValue);
+    coloring.colormap = colormap_;
+    return coloring;
 }
 
 void GLWidget::DrawAnimationMarkers(QPainter& painter) {
@@ -242,10 +392,11 @@ void GLWidget::DrawAnimationMarkers(QPainter& painter) {
     
     for (const auto& curve : curves_) {
         if (!curve || !curve->IsVisible()) continue;
-        if (currentAnimationFrame_ >= curve->GetNumPoints()) continue;
+        double index = GetCurveAnimationIndex(*curve);
+        if (index < 0.0 || index >= static_cast<double>(curve->GetNumPoints())) continue;
         
         double x, y;
-        if (!curve->GetPointAt(currentAnimationFrame_, x, y)) continue;
+        if (!GetCurvePointAt(*curve, index, x, y)) continue;
         
         // Convert to screen coordinates
         double normX = (x - displayMinX_) / rangeX;
@@ -265,6 +416,192 @@ void GLWidget::DrawAnimationMarkers(QPainter& painter) {
     }
 }
 
+bool GLWidget::GetCurvePointAt(const LoadedParamCurve2D& curve, double index, double& x, double& y) const {
+    // Interpolate between the two points around the fractional index, clamped to the curve
+    size_t numPoints = curve.GetNumPoints();
+    if (numPoints == 0) return false;
+    index = std::clamp(index, 0.0, static_cast<double>(numPoints - 1));
+    
+    size_t i0 = static_cast<size_t>(index);
+    double x0, y0, x1, y1;
+    if (!curve.GetPointAt(i0, x0, y0)) return false;
+    if (!curve.GetPointAt(i0 + 1, x1, y1)) { x1 = x0; y1 = y0; }
+    double frac = index - static_cast<double>(i0);
+    x = x0 + frac * (x1 - x0);
+    y = y0 + frac * (y1 - y0);
+    return true;
+}
+
+void GLWidget::SyncTrail() {
+    size_t numCurves = curves_.size();
+    if (trailRebuild_) {
+        lineRenderer_.ReleaseTrail(trail_);
+        trail_ = lineRenderer_.CreateTrail(numCurves, trailLength_);
+        trailRow_.assign(numCurves * 3, 0.0f);
+        trailRebuild_ = false;
+        trailColorsDirty_ = true;
+    }
+    
+    if (trailColorsDirty_) {
+        std::vector<float> colors(numCurves * 4);
+        for (size_t i = 0; i < numCurves; ++i) {
+            Color color = curves_[i]->GetColor();
+            colors[4 * i + 0] = color.r;
+            colors[4 * i + 1] = color.g;
+            colors[4 * i + 2] = color.b;
+            colors[4 * i + 3] = curves_[i]->IsVisible() ? 1.0f : 0.0f;
+        }
+        lineRenderer_.SetTrailColors(trail_, colors.data());
+        trailColorsDirty_ = false;
+    }
+    
+    // A frame in which the animation moved adds one row; moving back starts over.
+    // Curves past their end (or not yet started) keep adding their end point, so
+    // their trail shrinks into it.
+    if (trail_.numRows > 0 && animationPosition_ == trailPosition_) return;
+    if (animationPosition_ < trailPosition_) {
+        lineRenderer_.ClearTrail(trail_);
+    }
+    for (size_t i = 0; i < numCurves; ++i) {
+        double x, y;
+        if (!GetCurvePointAt(*curves_[i], GetCurveAnimationIndex(*curves_[i]), x, y)) continue;
+        trailRow_[3 * i + 0] = static_cast<float>(x);
+        trailRow_[3 * i + 1] = static_cast<float>(y);
+    }
+    lineRenderer_.PushTrailRow(trail_, trailRow_.data());
+    trailPosition_ = animationPosition_;
+}
+
+void GLWidget::DrawTrails() {
+    if (curves_.empty()) return;
+    SyncTrail();
+    
+    LineRenderer::Style style;
+    style.width = curveStyle_.width * 2.0f;
+    lineRenderer_.DrawTrail(trail_, style);
+}
+
+void GLWidget::UpdateHoverPoint() {
+    hoverCurve_ = -1;
+    hoverPoint_ = -1;
+    
+    int drawWidth = width_ - MARGIN_LEFT - MARGIN_RIGHT;
+    int drawHeight = height_ - MARGIN_TOP - MARGIN_BOTTOM;
+    if (drawWidth <= 0 || drawHeight <= 0) return;
+    
+    double rangeX = displayMaxX_ - displayMinX_;
+    double rangeY = displayMaxY_ - displayMinY_;
+    double scaleX = drawWidth / rangeX;
+    double scaleY = drawHeight / rangeY;
+    
+    double mouseX = displayMinX_ + (hoverPos_.x() - MARGIN_LEFT) / scaleX;
+    double mouseY = displayMinY_ + (height_ - MARGIN_BOTTOM - hoverPos_.y()) / scaleY;
+    
+    // Query each curve's spatial grid and keep the closest hit on screen
+    double bestDist = HOVER_PICK_RADIUS;
+    for (size_t i = 0; i < curves_.size(); ++i) {
+        if (!curves_[i] || !curves_[i]->IsVisible()) continue;
+        
+        double dist = 0.0;
+        long long point = curves_[i]->FindNearestPoint(mouseX, mouseY, scaleX, scaleY, bestDist, &dist);
+        if (point >= 0 && dist <= bestDist) {
+            bestDist = dist;
+            hoverCurve_ = static_cast<int>(i);
+            hoverPoint_ = point;
+        }
+    }
+}
+
+void GLWidget::DrawHoverCrosshair() {
+    const auto& curve = *curves_[hoverCurve_];
+    double x = curve.GetXVals()[hoverPoint_];
+    double y = curve.GetYVals()[hoverPoint_];
+    
+    glLineWidth(1.0f);
+    glColor3f(0.4f, 0.4f, 0.4f);
+    glBegin(GL_LINES);
+    glVertex2d(x, displayMinY_);
+    glVertex2d(x, displayMaxY_);
+    glVertex2d(displayMinX_, y);
+    glVertex2d(displayMaxX_, y);
+    glEnd();
+    
+    Color color = curve.GetColor();
+    glPointSize(8.0f);
+    glColor3f(color.r, color.g, color.b);
+    glBegin(GL_POINTS);
+    glVertex2d(x, y);
+    glEnd();
+    glPointSize(1.0f);
+}
+
+void GLWidget::DrawHoverReadout() {
+    const auto& curve = *curves_[hoverCurve_];
+    
+    char buffer[128];
+    std::vector<std::string> lines;
+    lines.push_back(curve.GetTitle());
+    std::snprintf(buffer, sizeof(buffer), "t = %.6g", curve.GetTVals()[hoverPoint_]);
+    lines.push_back(buffer);
+    std::snprintf(buffer, sizeof(buffer), "x = %.6g", curve.GetXVals()[hoverPoint_]);
+    lines.push_back(buffer);
+    std::snprintf(buffer, sizeof(buffer), "y = %.6g", curve.GetYVals()[hoverPoint_]);
+    lines.push_back(buffer);
+    
+    const float lineHeight = hoverTextRenderer_.GetLineHeight();
+    const float padding = 5.0f;
+    
+    float textWidth = 0.0f;
+    for (const auto& line : lines) {
+        textWidth = std::max(textWidth, hoverTextRenderer_.GetTextWidth(line));
+    }
+    float boxWidth = textWidth + 2.0f * padding;
+    float boxHeight = lines.size() * lineHeight + 2.0f * padding;
+    
+    // Place the box next to the cursor, flipping sides near the plot edges
+    float boxX = hoverPos_.x() + 15.0f;
+    float boxY = hoverPos_.y() + 15.0f;
+    if (boxX + boxWidth > width_ - MARGIN_RIGHT) boxX = hoverPos_.x() - 15.0f - boxWidth;
+    if (boxY + boxHeight > height_ - MARGIN_BOTTOM) boxY = hoverPos_.y() - 15.0f - boxHeight;
+    
+    hoverTextRenderer_.ClearBatch();
+    for (size_t i = 0; i < lines.size(); ++i) {
+        float centerY = boxY + padding + (i + 0.5f) * lineHeight;
+        hoverTextRenderer_.AddText(lines[i], boxX + padding, centerY, TextAlign::Left);
+    }
+    
+    // Box in widget pixel coordinates
+    glViewport(0, 0, static_cast<int>(width_ * devicePixelRatioF()), static_cast<int>(height_ * devicePixelRatioF()));
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, width_, height_, 0.0, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(1.0f, 1.0f, 1.0f, 0.85f);
+    glBegin(GL_QUADS);
+    glVertex2f(boxX, boxY);
+    glVertex2f(boxX + boxWidth, boxY);
+    glVertex2f(boxX + boxWidth, boxY + boxHeight);
+    glVertex2f(boxX, boxY + boxHeight);
+    glEnd();
+    glDisable(GL_BLEND);
+    
+    Color color = curve.GetColor();
+    glLineWidth(1.0f);
+    glColor3f(color.r, color.g, color.b);
+    glBegin(GL_LINE_LOOP);
+    glVertex2f(boxX, boxY);
+    glVertex2f(boxX + boxWidth, boxY);
+    glVertex2f(boxX + boxWidth, boxY + boxHeight);
+    glVertex2f(boxX, boxY + boxHeight);
+    glEnd();
+    
+    hoverTextRenderer_.Draw(width_, height_, 0.0f, 0.0f, 0.0f);
+}
+
 QColor GLWidget::GetCurveColor(int index) const {
     Color color = GetColorByIndex(index);
     return QColor(static_cast<int>(color.r * 255),
@@ -274,13 +611,16 @@ QColor GLWidget::GetCurveColor(int index) const {
 
 void GLWidget::AddCurve(std::unique_ptr<LoadedParamCurve2D> curve) {
     curves_.push_back(std::move(curve));
-    CalculateBounds();
     
-    // Update max animation frames
-    maxAnimationFrames_ = 0;
-    for (const auto& c : curves_) {
-        maxAnimationFrames_ = std::max(maxAnimationFrames_, c->GetNumPoints());
-    }
+    // Scene bounds grow by the new curve's cached box, so loading many curves
+    // stays linear in their total size
+    const auto& added = *curves_.back();
+    if (added.IsVisible()) sceneBounds_.Add(added.GetBounds());
+    CalculateBounds(true);
+    
+    maxAnimationFrames_ = std::max(maxAnimationFrames_, added.GetNumPoints());
+    UpdateAnimationRange();
+    trailRebuild_ = true;
     
     update();
     emit boundsChanged();
@@ -288,9 +628,19 @@ void GLWidget::AddCurve(std::unique_ptr<LoadedParamCurve2D> curve) {
 
 void GLWidget::ClearCurves() {
     StopAnimation();
+    if (glInitialized_) {
+        makeCurrent();
+        ReleaseCurveBuffers();
+        doneCurrent();
+    }
     curves_.clear();
+    trailRebuild_ = true;
+    sceneBounds_ = Bounds2D();
     currentAnimationFrame_ = 0;
     maxAnimationFrames_ = 0;
+    UpdateAnimationRange();
+    animationClock_.Reset();
+    animationPosition_ = animationClock_.GetPosition();
     
     // Reset to default view
     viewMinX_ = defaultMinX_ = -10.0;
@@ -298,40 +648,38 @@ void GLWidget::ClearCurves() {
     viewMinY_ = defaultMinY_ = -10.0;
     viewMaxY_ = defaultMaxY_ = 10.0;
     
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        viewMinX_, viewMaxX_, viewMinY_, viewMaxY_, 10, 8);
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
     
     update();
     emit boundsChanged();
 }
 
-void GLWidget::CalculateBounds() {
-    if (curves_.empty()) {
+void GLWidget::UpdateSceneBounds() {
+    // Union of the visible curves' cached bounds (every curve when none is
+    // visible); O(number of curves)
+    sceneBounds_ = Bounds2D();
+    for (const auto& curve : curves_) {
+        if (curve->IsVisible()) sceneBounds_.Add(curve->GetBounds());
+    }
+    if (sceneBounds_.IsEmpty()) {
+        for (const auto& curve : curves_) sceneBounds_.Add(curve->GetBounds());
+    }
+}
+
+void GLWidget::CalculateBounds(bool resetView) {
+    if (sceneBounds_.IsEmpty()) {
         dataMinX_ = dataMinY_ = -10.0;
         dataMaxX_ = dataMaxY_ = 10.0;
         dataMinT_ = 0; dataMaxT_ = 1;
         return;
     }
     
-    // Initialize with first curve's bounds
-    dataMinX_ = curves_[0]->GetMinX();
-    dataMaxX_ = curves_[0]->GetMaxX();
-    dataMinY_ = curves_[0]->GetMinY();
-    dataMaxY_ = curves_[0]->GetMaxY();
-    dataMinT_ = curves_[0]->GetMinT();
-    dataMaxT_ = curves_[0]->GetMaxT();
-    
-    // Expand bounds to include all curves
-    for (const auto& curve : curves_) {
-        dataMinX_ = std::min(dataMinX_, curve->GetMinX());
-        dataMaxX_ = std::max(dataMaxX_, curve->GetMaxX());
-        dataMinY_ = std::min(dataMinY_, curve->GetMinY());
-        dataMaxY_ = std::max(dataMaxY_, curve->GetMaxY());
-        dataMinT_ = std::min(dataMinT_, curve->GetMinT());
-        dataMaxT_ = std::max(dataMaxT_, curve->GetMaxT());
-    }
+    dataMinX_ = sceneBounds_.minX;
+    dataMaxX_ = sceneBounds_.maxX;
+    dataMinY_ = sceneBounds_.minY;
+    dataMaxY_ = sceneBounds_.maxY;
+    dataMinT_ = sceneBounds_.minT;
+    dataMaxT_ = sceneBounds_.maxT;
     
     // Handle equal bounds
     if (std::abs(dataMaxX_ - dataMinX_) < 1e-10) {
@@ -345,19 +693,24 @@ void GLWidget::CalculateBounds() {
     double xPadding = (dataMaxX_ - dataMinX_) * 0.05;
     double yPadding = (dataMaxY_ - dataMinY_) * 0.05;
     
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        dataMinX_ - xPadding, dataMaxX_ + xPadding,
-        dataMinY_ - yPadding, dataMaxY_ + yPadding,
-        10, 8);
+    UpdateAxisTicks(dataMinX_ - xPadding, dataMaxX_ + xPadding,
+                    dataMinY_ - yPadding, dataMaxY_ + yPadding);
     
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    // Default bounds come from the nice tick bounds; the view only follows
+    // when asked to, otherwise the ticks go back to the current view
+    defaultMinX_ = xTickInfo_.min;
+    defaultMaxX_ = xTickInfo_.max;
+    defaultMinY_ = yTickInfo_.min;
+    defaultMaxY_ = yTickInfo_.max;
     
-    // Set view and default bounds from nice tick bounds
-    viewMinX_ = defaultMinX_ = xTickInfo_.min;
-    viewMaxX_ = defaultMaxX_ = xTickInfo_.max;
-    viewMinY_ = defaultMinY_ = yTickInfo_.min;
-    viewMaxY_ = defaultMaxY_ = yTickInfo_.max;
+    if (resetView) {
+        viewMinX_ = defaultMinX_;
+        viewMaxX_ = defaultMaxX_;
+        viewMinY_ = defaultMinY_;
+        viewMaxY_ = defaultMaxY_;
+    } else {
+        UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
+    }
 }
 
 void GLWidget::ResetView() {
@@ -365,6 +718,7 @@ void GLWidget::ResetView() {
     viewMaxX_ = defaultMaxX_;
     viewMinY_ = defaultMinY_;
     viewMaxY_ = defaultMaxY_;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
     update();
     emit boundsChanged();
 }
@@ -385,58 +739,199 @@ void GLWidget::SetPreserveAspectRatio(bool preserve) {
     update();
 }
 
+void GLWidget::SetHoverReadoutEnabled(bool enabled) {
+    hoverEnabled_ = enabled;
+    update();
+}
+
+void GLWidget::SetCurveColoring(CurveColoring coloring) {
+    curveColoring_ = coloring;
+    update();
+}
+
+void GLWidget::SetColormap(LineRenderer::Colormap colormap) {
+    colormap_ = colormap;
+    update();
+}
+
 // Animation methods
+void GLWidget::SetShowTrails(bool show) {
+    showTrails_ = show;
+    update();
+}
+
+void GLWidget::SetTrailLength(int length) {
+    if (length < 2 || length == trailLength_) return;
+    trailLength_ = length;
+    trailRebuild_ = true;
+    update();
+}
+
 void GLWidget::StartAnimation() {
     if (maxAnimationFrames_ == 0) return;
     
+    UpdateAnimationRange();
     animationRunning_ = true;
-    int interval = static_cast<int>(1000.0 / animationSpeed_);
-    animationTimer_->start(interval);
+    animationClock_.Start();
     update();
 }
 
 void GLWidget::PauseAnimation() {
     animationRunning_ = false;
-    animationTimer_->stop();
+    animationClock_.Pause();
+    SyncAnimationPosition();
 }
 
 void GLWidget::ResumeAnimation() {
-    if (maxAnimationFrames_ == 0) return;
-    
-    animationRunning_ = true;
-    int interval = static_cast<int>(1000.0 / animationSpeed_);
-    animationTimer_->start(interval);
+    StartAnimation();
 }
 
 void GLWidget::ResetAnimation() {
-    currentAnimationFrame_ = 0;
+    animationClock_.Reset();
+    SyncAnimationPosition();
     update();
 }
 
 void GLWidget::StopAnimation() {
     animationRunning_ = false;
-    animationTimer_->stop();
+    animationClock_.Pause();
 }
 
-void GLWidget::SetAnimationSpeed(double pointsPerSecond) {
-    animationSpeed_ = std::max(0.1, pointsPerSecond);
+void GLWidget::SetAnimationSpeed(double unitsPerSecond) {
+    animationSpeed_ = std::max(1e-6, unitsPerSecond);
+    animationClock_.SetRate(animationSpeed_);
+}
+
+void GLWidget::SetAnimationMode(AnimationMode mode) {
+    if (mode == animationMode_) return;
     
-    if (animationRunning_) {
-        int interval = static_cast<int>(1000.0 / animationSpeed_);
-        animationTimer_->setInterval(interval);
+    // Continue from the same place on the curves
+    double position = GetLongestCurveIndex();
+    if (mode == AnimationMode::Time) position = GetAnimationTime();
+    else if (mode == AnimationMode::ArcLength) position = GetAnimationArcLength();
+    animationMode_ = mode;
+    UpdateAnimationRange();
+    lineRenderer_.ClearTrail(trail_);   // Positions are in other units now
+    animationClock_.Seek(position);
+    SyncAnimationPosition();
+    update();
+}
+
+void GLWidget::UpdateAnimationRange() {
+    if (animationMode_ == AnimationMode::Points) {
+        animationClock_.SetRange(0.0, static_cast<double>(maxAnimationFrames_));
+        return;
+    }
+    
+    if (animationMode_ == AnimationMode::ArcLength) {
+        double maxLength = 0.0;
+        for (const auto& curve : curves_) {
+            maxLength = std::max(maxLength, curve->GetArcLengthTable().GetTotalLength());
+        }
+        animationClock_.SetRange(0.0, maxLength);
+        return;
     }
+    
+    double minT = 0.0, maxT = 0.0;
+    bool first = true;
+    for (const auto& curve : curves_) {
+        const auto& tVals = curve->GetTVals();
+        if (tVals.empty()) continue;
+        minT = first ? tVals.front() : std::min(minT, tVals.front());
+        maxT = first ? tVals.back() : std::max(maxT, tVals.back());
+        first = false;
+    }
+    animationClock_.SetRange(minT, maxT);
 }
 
-void GLWidget::OnAnimationTimer() {
-    if (!animationRunning_) return;
+void GLWidget::SyncAnimationPosition() {
+    animationPosition_ = animationClock_.GetPosition();
+    
+    // Frame counter reported to the UI is the furthest point reached on any curve
+    double frame = 0.0;
+    for (const auto& curve : curves_) {
+        double index = GetCurveAnimationIndex(*curve);
+        if (index >= 0.0) {
+            frame = std::max(frame, std::min(index, static_cast<double>(curve->GetNumPoints()) - 1.0));
+        }
+    }
+    currentAnimationFrame_ = static_cast<size_t>(frame);
+}
+
+double GLWidget::GetCurveAnimationIndex(const LoadedParamCurve2D& curve) const {
+    // Fractional point index on this curve: -1 before the curve starts,
+    // GetNumPoints() once it has been fully traversed
+    size_t numPoints = curve.GetNumPoints();
+    if (numPoints == 0) return -1.0;
+    double last = static_cast<double>(numPoints - 1);
+    
+    if (animationMode_ == AnimationMode::Points) {
+        if (animationPosition_ >= static_cast<double>(numPoints)) return static_cast<double>(numPoints);
+        return std::min(animationPosition_, last);
+    }
     
-    currentAnimationFrame_++;
+    if (animationMode_ == AnimationMode::ArcLength) {
+        // O(log n) lookup in the cumulative length table
+        const auto& arcLength = curve.GetArcLengthTable();
+        if (animationPosition_ > arcLength.GetTotalLength()) return static_cast<double>(numPoints);
+        return arcLength.IndexAtLength(animationPosition_);
+    }
+    
+    const auto& tVals = curve.GetTVals();
+    double t = animationPosition_;
+    if (t < tVals.front()) return -1.0;
+    if (t > tVals.back()) return static_cast<double>(numPoints);
     
-    // Loop animation
-    if (currentAnimationFrame_ >= maxAnimationFrames_) {
-        currentAnimationFrame_ = 0;
+    size_t j = std::upper_bound(tVals.begin(), tVals.end(), t) - tVals.begin();
+    if (j == 0) return 0.0;
+    if (j >= numPoints) return last;
+    double dt = tVals[j] - tVals[j - 1];
+    double frac = dt > 0.0 ? (t - tVals[j - 1]) / dt : 0.0;
+    return static_cast<double>(j - 1) + frac;
+}
+
+const LoadedParamCurve2D* GLWidget::GetLongestCurve() const {
+    const LoadedParamCurve2D* longest = nullptr;
+    for (const auto& curve : curves_) {
+        if (!longest || curve->GetNumPoints() > longest->GetNumPoints()) longest = curve.get();
     }
+    return (longest && longest->GetNumPoints() > 0) ? longest : nullptr;
+}
+
+double GLWidget::GetLongestCurveIndex() const {
+    // Fractional point index of the current position on the longest curve
+    const auto* longest = GetLongestCurve();
+    if (!longest) return 0.0;
+    return std::clamp(GetCurveAnimationIndex(*longest), 0.0, static_cast<double>(longest->GetNumPoints() - 1));
+}
+
+double GLWidget::GetAnimationTime() const {
+    if (animationMode_ == AnimationMode::Time) return animationPosition_;
+    
+    // Interpolated t of the longest curve
+    const auto* longest = GetLongestCurve();
+    if (!longest) return 0.0;
+    
+    const auto& tVals = longest->GetTVals();
+    double index = GetLongestCurveIndex();
+    size_t i0 = static_cast<size_t>(index);
+    size_t i1 = std::min(i0 + 1, tVals.size() - 1);
+    return tVals[i0] + (index - static_cast<double>(i0)) * (tVals[i1] - tVals[i0]);
+}
+
+double GLWidget::GetAnimationArcLength() const {
+    if (animationMode_ == AnimationMode::ArcLength) return animationPosition_;
     
+    const auto* longest = GetLongestCurve();
+    if (!longest) return 0.0;
+    return longest->GetArcLengthTable().LengthAtIndex(GetLongestCurveIndex());
+}
+
+void GLWidget::OnFrameSwapped() {
+    if (!animationRunning_) return;
+    
+    // Sample the clock once per presented frame and schedule the next one
+    SyncAnimationPosition();
     update();
     
     if (animationCallback_) {
@@ -448,7 +943,13 @@ void GLWidget::OnAnimationTimer() {
 void GLWidget::SetCurveVisible(int index, bool visible) {
     if (index >= 0 && index < static_cast<int>(curves_.size())) {
         curves_[index]->SetVisible(visible);
+        trailColorsDirty_ = true;
+        
+        // Reset View goes to the visible curves; the current view stays put
+        UpdateSceneBounds();
+        CalculateBounds(false);
         update();
+        emit boundsChanged();
     }
 }
 
@@ -469,6 +970,16 @@ void GLWidget::mousePressEvent(QMouseEvent* event) {
 }
 
 void GLWidget::mouseMoveEvent(QMouseEvent* event) {
+    // Track hover position; the nearest point is looked up in paintGL
+    QPoint pos = event->pos();
+    bool insidePlot = pos.x() >= MARGIN_LEFT && pos.x() <= width_ - MARGIN_RIGHT &&
+                      pos.y() >= MARGIN_TOP && pos.y() <= height_ - MARGIN_BOTTOM;
+    if (hoverEnabled_ && (insidePlot || hoverActive_)) {
+        hoverActive_ = insidePlot;
+        hoverPos_ = pos;
+        if (!isPanning_) update();
+    }
+    
     if (isPanning_) {
         QPoint delta = event->pos() - lastMousePos_;
         lastMousePos_ = event->pos();
@@ -488,6 +999,7 @@ void GLWidget::mouseMoveEvent(QMouseEvent* event) {
         viewMinY_ += dy;
         viewMaxY_ += dy;
         
+        UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
         update();
     }
 }
@@ -525,5 +1037,16 @@ void GLWidget::wheelEvent(QWheelEvent* event) {
         viewMaxY_ = centerY + rangeY / 2.0;
     }
     
+    // Recalculate ticks for new view
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
+    
     update();
 }
+
+void GLWidget::leaveEvent(QEvent* event) {
+    QOpenGLWidget::leaveEvent(event);
+    if (hoverActive_) {
+        hoverActive_ = false;
+        update();
+    }
+}
@@ -5,14 +5,16 @@
 #include <QOpenGLFunctions>
 #include <QMouseEvent>
 #include <QWheelEvent>
-#include <QTimer>
 #include <QPainter>
 #include <QColor>
 #include <vector>
 #include <memory>
 #include <functional>
 #include "MMLData.h"
+#include "AnimationClock.h"
 #include "AxisTickCalculator.h"
+#include "TextRenderer.h"
+#include "LineRenderer.h"
 
 // Callback for animation frame updates
 using AnimationCallback = std::function<void()>;
@@ -45,6 +47,17 @@ public:
     bool IsAspectRatioPreserved() const { return preserveAspectRatio_; }
     void SetPreserveAspectRatio(bool preserve);
     
+    bool IsHoverReadoutEnabled() const { return hoverEnabled_; }
+    void SetHoverReadoutEnabled(bool enabled);
+    
+    // Curve coloring: each curve's own color, or a colormap over a per-point attribute.
+    // Switching either only changes shader uniforms; nothing is re-uploaded.
+    enum class CurveColoring { Solid, Parameter, Speed, Curvature };
+    void SetCurveColoring(CurveColoring coloring);
+    CurveColoring GetCurveColoring() const { return curveColoring_; }
+    void SetColormap(LineRenderer::Colormap colormap);
+    LineRenderer::Colormap GetColormap() const { return colormap_; }
+    
     // Animation controls
     void StartAnimation();
     void PauseAnimation();
@@ -56,11 +69,29 @@ public:
     size_t GetCurrentAnimationFrame() const { return currentAnimationFrame_; }
     size_t GetMaxAnimationFrames() const { return maxAnimationFrames_; }
     
-    void SetAnimationSpeed(double pointsPerSecond);
+    // Playback follows wall-clock time: the speed is points per second, t units
+    // per second when following the curves' own parameter values, or distance per
+    // second along each curve (constant marker speed however the points are spaced)
+    enum class AnimationMode { Points, Time, ArcLength };
+    void SetAnimationMode(AnimationMode mode);
+    AnimationMode GetAnimationMode() const { return animationMode_; }
+    
+    void SetAnimationSpeed(double unitsPerSecond);
     double GetAnimationSpeed() const { return animationSpeed_; }
     
+    // Parameter value at the current position (of the longest curve)
+    double GetAnimationTime() const;
+    
+    // Distance travelled along the longest curve
+    double GetAnimationArcLength() const;
+    
     void SetAnimationFrameCallback(AnimationCallback callback) { animationCallback_ = callback; }
     
+    // Fading trail behind each marker over its last `length` animation frames
+    void SetShowTrails(bool show);
+    bool IsShowTrails() const { return showTrails_; }
+    void SetTrailLength(int length);
+    
     // Visibility
     void SetCurveVisible(int index, bool visible);
     bool IsCurveVisible(int index) const;
@@ -85,26 +116,68 @@ protected:
     void mouseMoveEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
     void wheelEvent(QWheelEvent* event) override;
+    void leaveEvent(QEvent* event) override;
 
 private slots:
-    void OnAnimationTimer();
+    void OnFrameSwapped();
 
 private:
     void DrawAxes();
     void DrawGrid();
-    void DrawAxisLabels(QPainter& painter);
-    void DrawCurve(const LoadedParamCurve2D& curve);
+    void AddSegment(double x0, double y0, double x1, double y1);
+    void DrawAxisLabels();
+    void RebuildAxisLabels();
+    void UpdateAxisTicks(double minX, double maxX, double minY, double maxY);
+    // Line strips of one curve: every point, plus one strip per simplification level
+    struct CurveBuffer {
+        LineRenderer::Strip strip;
+        std::vector<LineRenderer::Strip> lodStrips;
+    };
+    
+    void UploadCurveBuffers();
+    LineRenderer::AttributeColoring GetAttributeColoring(const LoadedParamCurve2D& curve) const;
+    void ReleaseCurveBuffers();
+    void DrawCurve(size_t index);
     void DrawAnimationMarkers(QPainter& painter);
-    void CalculateBounds();
+    void SyncTrail();
+    void DrawTrails();
+    void UpdateHoverPoint();
+    void DrawHoverCrosshair();
+    void DrawHoverReadout();
+    void UpdateSceneBounds();
+    void CalculateBounds(bool resetView);
     void SetupProjection();
+    void UpdateAnimationRange();
+    void SyncAnimationPosition();
+    double GetCurveAnimationIndex(const LoadedParamCurve2D& curve) const;
+    bool GetCurvePointAt(const LoadedParamCurve2D& curve, double index, double& x, double& y) const;
+    const LoadedParamCurve2D* GetLongestCurve() const;
+    double GetLongestCurveIndex() const;
     
     std::vector<std::unique_ptr<LoadedParamCurve2D>> curves_;
+    std::vector<CurveBuffer> curveBuffers_;     // Parallel to curves_; filled in paintGL
+    
+    // Curves, grid and axes are drawn as instanced wide lines; lineVertices_
+    // is scratch space for the grid and axis segments
+    LineRenderer lineRenderer_;
+    LineRenderer::Style curveStyle_;
+    CurveColoring curveColoring_;
+    LineRenderer::Colormap colormap_;
+    std::vector<float> lineVertices_;
     
     // Tick information
     AxisTickInfo xTickInfo_;
     AxisTickInfo yTickInfo_;
     
+    // Axis labels drawn from a glyph atlas; the batch is rebuilt only when
+    // ticks, display bounds or widget size change
+    TextRenderer textRenderer_;
+    bool labelsDirty_;
+    double labelMinX_, labelMaxX_;
+    double labelMinY_, labelMaxY_;
+    
     // Data bounds
+    Bounds2D sceneBounds_;          // Running union of the curves' cached bounds
     double dataMinX_, dataMaxX_;
     double dataMinY_, dataMaxY_;
     double dataMinT_, dataMaxT_;
@@ -127,17 +200,37 @@ private:
     bool preserveAspectRatio_;
     
     // Animation state
-    QTimer* animationTimer_;
+    AnimationClock animationClock_;
+    AnimationMode animationMode_;
+    double animationPosition_;      // Fractional point index, or t in Time mode
     bool animationRunning_;
     size_t currentAnimationFrame_;
     size_t maxAnimationFrames_;
     double animationSpeed_;  // Points per second
     AnimationCallback animationCallback_;
     
+    // Trails: marker positions of the last trailLength_ animated frames in a GPU
+    // ring, one row per frame in which the animation moved
+    bool showTrails_;
+    int trailLength_;
+    LineRenderer::Trail trail_;
+    double trailPosition_;          // animationPosition_ of the newest row
+    bool trailRebuild_;             // Curves or length changed
+    bool trailColorsDirty_;         // Visibility changed
+    std::vector<float> trailRow_;
+    
     // Mouse interaction
     QPoint lastMousePos_;
     bool isPanning_;
     
+    // Hover crosshair and nearest-point readout
+    TextRenderer hoverTextRenderer_;
+    bool hoverEnabled_;
+    bool hoverActive_;
+    QPoint hoverPos_;
+    int hoverCurve_;          // -1 when no point is within HOVER_PICK_RADIUS
+    long long hoverPoint_;
+    
     // OpenGL initialization flag
     bool glInitialized_;
     
@@ -149,6 +242,19 @@ private:
     static constexpr int MARGIN_BOTTOM = 40;
     static constexpr int MARGIN_TOP = 20;
     static constexpr int MARGIN_RIGHT = 20;
+    
+    // Maximum screen distance (pixels) for hover picking
+    static constexpr double HOVER_PICK_RADIUS = 20.0;
+    
+    // Line widths in logical pixels
+    static constexpr float CURVE_LINE_WIDTH = 2.0f;
+    static constexpr float AXIS_LINE_WIDTH = 2.0f;
+    static constexpr float GRID_LINE_WIDTH = 1.0f;
+    
+    static constexpr size_t UPLOAD_CHUNK_POINTS = 1 << 20;
+    
+    // Maximum screen distance (pixels) between a simplified curve and the full one
+    static constexpr double LOD_PIXEL_TOLERANCE = 0.5;
 };
 
 #endif // GL_WIDGET_H
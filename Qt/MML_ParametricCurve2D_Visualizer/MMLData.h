@@ -6,6 +6,10 @@
 #include <algorithm>
 #include <limits>
 #include <cmath>
+#include "SpatialGrid2D.h"
+#include "CurveLodIndex.h"
+#include "ArcLengthTable.h"
+#include "CurveAttributes.h"
 
 // Color structure for curve colors
 struct Color {
@@ -45,6 +49,30 @@ struct CurveDrawStyle {
     bool visible = true;
 };
 
+// Bounds of a curve's points and parameter range, grown point by point or box by box
+struct Bounds2D {
+    double minX = std::numeric_limits<double>::infinity();
+    double maxX = -std::numeric_limits<double>::infinity();
+    double minY = std::numeric_limits<double>::infinity();
+    double maxY = -std::numeric_limits<double>::infinity();
+    double minT = std::numeric_limits<double>::infinity();
+    double maxT = -std::numeric_limits<double>::infinity();
+    
+    bool IsEmpty() const { return minX > maxX; }
+    
+    void Add(double t, double x, double y) {
+        minX = std::min(minX, x); maxX = std::max(maxX, x);
+        minY = std::min(minY, y); maxY = std::max(maxY, y);
+        minT = std::min(minT, t); maxT = std::max(maxT, t);
+    }
+    
+    void Add(const Bounds2D& other) {
+        if (other.IsEmpty()) return;
+        Add(other.minT, other.minX, other.minY);
+        Add(other.maxT, other.maxX, other.maxY);
+    }
+};
+
 // Class for loaded parametric curve 2D
 class LoadedParamCurve2D {
 private:
@@ -55,6 +83,13 @@ private:
     std::vector<double> yVals_;
     CurveDrawStyle style_;
     Color color_;
+    Bounds2D bounds_;
+    SpatialGrid2D spatialIndex_;   // Built once after loading, for hover picking
+    CurveLodIndex<2> lodIndex_;    // Simplification levels, with x and y measured relative to their extents
+    double lodRangeX_ = 1.0;
+    double lodRangeY_ = 1.0;
+    ArcLengthTable<2> arcLength_;  // Cumulative distance along the curve, in world units
+    CurveAttributes<2> attributes_;
 
 public:
     LoadedParamCurve2D(const std::string& title, int index) 
@@ -64,6 +99,7 @@ public:
         tVals_.push_back(t);
         xVals_.push_back(x);
         yVals_.push_back(y);
+        bounds_.Add(t, x, y);
     }
     
     // Getters
@@ -95,35 +131,49 @@ public:
     
     size_t GetNumPoints() const { return xVals_.size(); }
     
-    double GetMinX() const {
-        if (xVals_.empty()) return 0;
-        return *std::min_element(xVals_.begin(), xVals_.end());
-    }
+    // Spatial index for nearest-point queries; call once all points are added
+    void BuildSpatialIndex() { spatialIndex_.Build(xVals_, yVals_); }
     
-    double GetMaxX() const {
-        if (xVals_.empty()) return 1;
-        return *std::max_element(xVals_.begin(), xVals_.end());
+    // Nearest point in screen space (scale = pixels per world unit), -1 if none within maxPixelDist
+    long long FindNearestPoint(double x, double y, double scaleX, double scaleY,
+                               double maxPixelDist, double* outPixelDist = nullptr) const {
+        return spatialIndex_.FindNearest(xVals_, yVals_, x, y, scaleX, scaleY, maxPixelDist, outPixelDist);
     }
     
-    double GetMinY() const {
-        if (yVals_.empty()) return 0;
-        return *std::min_element(yVals_.begin(), yVals_.end());
+    // Simplification levels; call once all points are added
+    void BuildLodIndex() {
+        lodRangeX_ = std::max(GetMaxX() - GetMinX(), 1e-300);
+        lodRangeY_ = std::max(GetMaxY() - GetMinY(), 1e-300);
+        lodIndex_.Build({xVals_.data(), yVals_.data()}, {1.0 / lodRangeX_, 1.0 / lodRangeY_}, xVals_.size());
     }
     
-    double GetMaxY() const {
-        if (yVals_.empty()) return 1;
-        return *std::max_element(yVals_.begin(), yVals_.end());
-    }
+    const CurveLodIndex<2>& GetLodIndex() const { return lodIndex_; }
     
-    double GetMinT() const {
-        if (tVals_.empty()) return 0;
-        return *std::min_element(tVals_.begin(), tVals_.end());
-    }
+    // Cumulative arc length, for constant-speed animation; call once all points are added
+    void BuildArcLengthTable() { arcLength_.Build({xVals_.data(), yVals_.data()}, xVals_.size()); }
+    const ArcLengthTable<2>& GetArcLengthTable() const { return arcLength_; }
     
-    double GetMaxT() const {
-        if (tVals_.empty()) return 1;
-        return *std::max_element(tVals_.begin(), tVals_.end());
+    // Parameter, speed and curvature per point, for coloring; call once all points are added
+    void BuildAttributes() { attributes_.Build(tVals_.data(), {xVals_.data(), yVals_.data()}, xVals_.size()); }
+    const CurveAttributes<2>& GetAttributes() const { return attributes_; }
+    
+    // Coarsest simplification level whose polyline stays within pixelTolerance of the
+    // full curve at the given scale (pixels per world unit); -1 when every point is needed
+    int SelectLodLevel(double scaleX, double scaleY, double pixelTolerance) const {
+        double pixelsPerUnit = std::max(scaleX * lodRangeX_, scaleY * lodRangeY_);
+        const auto* level = lodIndex_.SelectLevel(pixelTolerance / pixelsPerUnit);
+        return level ? static_cast<int>(level - lodIndex_.GetLevels().data()) : -1;
     }
+    
+    // Bounds are maintained as points are added, so these are O(1)
+    const Bounds2D& GetBounds() const { return bounds_; }
+    
+    double GetMinX() const { return bounds_.IsEmpty() ? 0 : bounds_.minX; }
+    double GetMaxX() const { return bounds_.IsEmpty() ? 1 : bounds_.maxX; }
+    double GetMinY() const { return bounds_.IsEmpty() ? 0 : bounds_.minY; }
+    double GetMaxY() const { return bounds_.IsEmpty() ? 1 : bounds_.maxY; }
+    double GetMinT() const { return bounds_.IsEmpty() ? 0 : bounds_.minT; }
+    double GetMaxT() const { return bounds_.IsEmpty() ? 1 : bounds_.maxT; }
 };
 
 #endif // MML_DATA_H
@@ -69,6 +69,13 @@ std::unique_ptr<LoadedParamCurve2D> MMLFileParser::ParseParametricCurve2D(std::i
         }
     }
     
+    // Build the hover-picking index, simplification levels, arc-length table and
+    // coloring attributes once, at load time
+    curve->BuildSpatialIndex();
+    curve->BuildLodIndex();
+    curve->BuildArcLengthTable();
+    curve->BuildAttributes();
+    
     return curve;
 }
 
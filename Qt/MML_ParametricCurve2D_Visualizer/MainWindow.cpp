@@ -7,9 +7,25 @@
 #include <QMessageBox>
 #include <QLabel>
 #include <QScrollArea>
-#include <QIntValidator>
+#include <QDoubleValidator>
+#include <QElapsedTimer>
+#include <QApplication>
 #include <sstream>
 #include <iomanip>
+#include "TrajectoryDifference.h"
+
+namespace {
+
+// Unit of the animation speed in each mode
+QString SpeedUnit(GLWidget::AnimationMode mode) {
+    switch (mode) {
+        case GLWidget::AnimationMode::Time: return "t/sec";
+        case GLWidget::AnimationMode::ArcLength: return "length/sec";
+        default: return "pts/sec";
+    }
+}
+
+} // namespace
 
 MainWindow::MainWindow(const std::vector<std::string>& filenames, QWidget *parent)
     : QMainWindow(parent)
@@ -25,9 +41,16 @@ MainWindow::MainWindow(const std::vector<std::string>& filenames, QWidget *paren
     mainLayout->setContentsMargins(5, 5, 5, 5);
     mainLayout->setSpacing(5);
 
-    // Create GL widget
-    glWidget_ = new GLWidget(this);
-    mainLayout->addWidget(glWidget_, 1);  // Stretch factor 1
+    // Create GL widget, with the trajectory difference pane below it
+    QSplitter* plotSplitter = new QSplitter(Qt::Vertical, this);
+    glWidget_ = new GLWidget(plotSplitter);
+    diffPlot_ = new DifferencePlotWidget(plotSplitter);
+    diffPlot_->hide();
+    plotSplitter->addWidget(glWidget_);
+    plotSplitter->addWidget(diffPlot_);
+    plotSplitter->setStretchFactor(0, 3);
+    plotSplitter->setStretchFactor(1, 1);
+    mainLayout->addWidget(plotSplitter, 1);  // Stretch factor 1
 
     // Create sidebar
     CreateSidebar();
@@ -87,14 +110,38 @@ void MainWindow::CreateSidebar() {
     showLabelsCheckbox_->setChecked(true);
     aspectRatioCheckbox_ = new QCheckBox("Preserve Aspect Ratio", displayGroup_);
     aspectRatioCheckbox_->setChecked(true);
+    hoverReadoutCheckbox_ = new QCheckBox("Show Hover Readout", displayGroup_);
+    hoverReadoutCheckbox_->setChecked(true);
     
     displayLayout->addWidget(showGridCheckbox_);
     displayLayout->addWidget(showLabelsCheckbox_);
     displayLayout->addWidget(aspectRatioCheckbox_);
+    displayLayout->addWidget(hoverReadoutCheckbox_);
+    
+    // Color by a per-point attribute through a colormap
+    QHBoxLayout* coloringLayout = new QHBoxLayout();
+    coloringLayout->addWidget(new QLabel("Color by:", displayGroup_));
+    coloringCombo_ = new QComboBox(displayGroup_);
+    coloringCombo_->addItems({ "Curve color", "Parameter t", "Speed", "Curvature" });
+    coloringLayout->addWidget(coloringCombo_, 1);
+    displayLayout->addLayout(coloringLayout);
+    
+    QHBoxLayout* colormapLayout = new QHBoxLayout();
+    colormapLayout->addWidget(new QLabel("Colormap:", displayGroup_));
+    colormapCombo_ = new QComboBox(displayGroup_);
+    colormapCombo_->addItems({ "Viridis", "Plasma", "Cool-warm", "Grayscale" });
+    colormapCombo_->setEnabled(false);
+    colormapLayout->addWidget(colormapCombo_, 1);
+    displayLayout->addLayout(colormapLayout);
     
     connect(showGridCheckbox_, &QCheckBox::toggled, this, &MainWindow::OnGridToggled);
     connect(showLabelsCheckbox_, &QCheckBox::toggled, this, &MainWindow::OnLabelsToggled);
     connect(aspectRatioCheckbox_, &QCheckBox::toggled, this, &MainWindow::OnAspectRatioToggled);
+    connect(hoverReadoutCheckbox_, &QCheckBox::toggled, this, &MainWindow::OnHoverReadoutToggled);
+    connect(coloringCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::OnCurveColoringChanged);
+    connect(colormapCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::OnColormapChanged);
     
     sidebarLayout->addWidget(displayGroup_);
 
@@ -114,16 +161,44 @@ void MainWindow::CreateSidebar() {
     animButtonLayout->addWidget(resetAnimButton_);
     animLayout->addLayout(animButtonLayout);
     
-    // Speed input
+    // Advance mode: by point index, by the curves' parameter t, or by arc length
+    QHBoxLayout* modeLayout = new QHBoxLayout();
+    modeLayout->addWidget(new QLabel("Advance by:", animationGroup_));
+    animationModeCombo_ = new QComboBox(animationGroup_);
+    animationModeCombo_->addItem("Points");
+    animationModeCombo_->addItem("Parameter t");
+    animationModeCombo_->addItem("Arc length");
+    modeLayout->addWidget(animationModeCombo_, 1);
+    animLayout->addLayout(modeLayout);
+    
+    // Speed input (no upper limit; playback is driven by wall-clock time)
     QHBoxLayout* speedLayout = new QHBoxLayout();
-    speedLayout->addWidget(new QLabel("Speed (pts/sec):", animationGroup_));
+    speedLabel_ = new QLabel("Speed (pts/sec):", animationGroup_);
+    speedLayout->addWidget(speedLabel_);
     speedInput_ = new QLineEdit("10", animationGroup_);
-    speedInput_->setFixedWidth(60);
-    speedInput_->setValidator(new QIntValidator(1, 1000, this));
+    speedInput_->setFixedWidth(80);
+    QDoubleValidator* speedValidator = new QDoubleValidator(0.0, 1e12, 6, this);
+    speedValidator->setNotation(QDoubleValidator::StandardNotation);
+    speedInput_->setValidator(speedValidator);
     speedLayout->addWidget(speedInput_);
     speedLayout->addStretch();
     animLayout->addLayout(speedLayout);
     
+    // Fading trails behind the markers
+    QHBoxLayout* trailLayout = new QHBoxLayout();
+    showTrailsCheckBox_ = new QCheckBox("Trails", animationGroup_);
+    trailLayout->addWidget(showTrailsCheckBox_);
+    trailLayout->addWidget(new QLabel("Length:", animationGroup_));
+    trailLengthSpinBox_ = new QSpinBox(animationGroup_);
+    trailLengthSpinBox_->setRange(2, 1024);
+    trailLengthSpinBox_->setValue(64);
+    trailLengthSpinBox_->setSuffix(" frames");
+    trailLayout->addWidget(trailLengthSpinBox_);
+    trailLayout->addStretch();
+    animLayout->addLayout(trailLayout);
+    connect(showTrailsCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowTrailsChanged);
+    connect(trailLengthSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::OnTrailLengthChanged);
+    
     // Frame and T value display
     frameLabel_ = new QLabel("Frame: 0 / 0", animationGroup_);
     tValueLabel_ = new QLabel("t = 0.0000", animationGroup_);
@@ -134,6 +209,8 @@ void MainWindow::CreateSidebar() {
     connect(pauseButton_, &QPushButton::clicked, this, &MainWindow::OnPauseAnimation);
     connect(resetAnimButton_, &QPushButton::clicked, this, &MainWindow::OnResetAnimation);
     connect(speedInput_, &QLineEdit::editingFinished, this, &MainWindow::OnAnimationSpeedChanged);
+    connect(animationModeCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::OnAnimationModeChanged);
     
     sidebarLayout->addWidget(animationGroup_);
 
@@ -148,6 +225,37 @@ void MainWindow::CreateSidebar() {
     
     sidebarLayout->addWidget(legendGroup_);
 
+    // === Compare Group ===
+    compareGroup_ = new QGroupBox("Compare", sidebarWidget_);
+    QVBoxLayout* compareLayout = new QVBoxLayout(compareGroup_);
+    
+    // B is interpolated onto A's t grid
+    QHBoxLayout* compareALayout = new QHBoxLayout();
+    compareALayout->addWidget(new QLabel("A:", compareGroup_));
+    compareACombo_ = new QComboBox(compareGroup_);
+    compareALayout->addWidget(compareACombo_, 1);
+    compareLayout->addLayout(compareALayout);
+    
+    QHBoxLayout* compareBLayout = new QHBoxLayout();
+    compareBLayout->addWidget(new QLabel("B:", compareGroup_));
+    compareBCombo_ = new QComboBox(compareGroup_);
+    compareBLayout->addWidget(compareBCombo_, 1);
+    compareLayout->addLayout(compareBLayout);
+    
+    QHBoxLayout* compareButtonLayout = new QHBoxLayout();
+    compareButton_ = new QPushButton("Compare", compareGroup_);
+    clearCompareButton_ = new QPushButton("Close", compareGroup_);
+    compareButton_->setEnabled(false);
+    clearCompareButton_->setEnabled(false);
+    compareButtonLayout->addWidget(compareButton_);
+    compareButtonLayout->addWidget(clearCompareButton_);
+    compareLayout->addLayout(compareButtonLayout);
+    
+    connect(compareButton_, &QPushButton::clicked, this, &MainWindow::OnCompareCurves);
+    connect(clearCompareButton_, &QPushButton::clicked, this, &MainWindow::OnClearComparison);
+    
+    sidebarLayout->addWidget(compareGroup_);
+
     // === Info Group ===
     infoGroup_ = new QGroupBox("Curve Info", sidebarWidget_);
     QVBoxLayout* infoLayout = new QVBoxLayout(infoGroup_);
@@ -228,6 +336,7 @@ void MainWindow::LoadCurveFile(const QString& filename, int index) {
         
         UpdateInfoDisplay();
         UpdateAnimationUI();
+        UpdateCompareCombos();
         statusBar_->showMessage("Loaded: " + filename, 3000);
     }
     catch (const std::exception& e) {
@@ -259,6 +368,8 @@ void MainWindow::ClearAll() {
     }
     legendEntries_.clear();
     
+    OnClearComparison();
+    UpdateCompareCombos();
     UpdateInfoDisplay();
     UpdateAnimationUI();
     statusBar_->showMessage("All curves cleared", 2000);
@@ -310,16 +421,40 @@ void MainWindow::UpdateAnimationUI() {
     
     frameLabel_->setText(QString("Frame: %1 / %2").arg(currentFrame).arg(maxFrames));
     
-    // Calculate t value from current frame
-    const auto& curves = glWidget_->GetCurves();
-    if (!curves.empty() && maxFrames > 0) {
-        double minT = curves[0]->GetMinT();
-        double maxT = curves[0]->GetMaxT();
-        double t = minT + (maxT - minT) * static_cast<double>(currentFrame) / static_cast<double>(maxFrames - 1);
-        tValueLabel_->setText(QString("t = %1").arg(t, 0, 'f', 4));
+    // Parameter value at the (fractional) animation position
+    if (!glWidget_->GetCurves().empty() && maxFrames > 0) {
+        tValueLabel_->setText(QString("t = %1").arg(glWidget_->GetAnimationTime(), 0, 'f', 4));
     } else {
         tValueLabel_->setText("t = 0.0000");
     }
+    
+    // The difference pane's cursor follows the animation
+    if (diffPlot_->isVisible()) {
+        diffPlot_->SetCursorT(glWidget_->GetAnimationTime());
+    }
+}
+
+void MainWindow::UpdateCompareCombos() {
+    int indexA = compareACombo_->currentIndex();
+    int indexB = compareBCombo_->currentIndex();
+    compareACombo_->clear();
+    compareBCombo_->clear();
+    
+    const auto& curves = glWidget_->GetCurves();
+    for (const auto& curve : curves) {
+        QString name = QString::fromStdString(curve->GetTitle());
+        compareACombo_->addItem(name);
+        compareBCombo_->addItem(name);
+    }
+    
+    // Keep the previous choice, but never the same curve twice when there is another
+    int count = static_cast<int>(curves.size());
+    indexA = indexA >= 0 && indexA < count ? indexA : 0;
+    indexB = indexB >= 0 && indexB < count ? indexB : 0;
+    if (indexB == indexA && count >= 2) indexB = indexA == 0 ? 1 : 0;
+    compareACombo_->setCurrentIndex(indexA);
+    compareBCombo_->setCurrentIndex(indexB);
+    compareButton_->setEnabled(count >= 2);
 }
 
 // Animation slots
@@ -354,17 +489,35 @@ void MainWindow::OnResetAnimation() {
 
 void MainWindow::OnAnimationSpeedChanged() {
     bool ok;
-    int speed = speedInput_->text().toInt(&ok);
+    double speed = speedInput_->text().toDouble(&ok);
     if (ok && speed > 0) {
-        glWidget_->SetAnimationSpeed(static_cast<double>(speed));
-        statusBar_->showMessage(QString("Animation speed: %1 pts/sec").arg(speed), 2000);
+        glWidget_->SetAnimationSpeed(speed);
+        QString unit = SpeedUnit(glWidget_->GetAnimationMode());
+        statusBar_->showMessage(QString("Animation speed: %1 %2").arg(speed).arg(unit), 2000);
     }
 }
 
+void MainWindow::OnAnimationModeChanged(int index) {
+    // Combo entries are in AnimationMode order
+    auto mode = static_cast<GLWidget::AnimationMode>(index);
+    glWidget_->SetAnimationMode(mode);
+    speedLabel_->setText(QString("Speed (%1):").arg(SpeedUnit(mode)));
+    UpdateAnimationUI();
+    statusBar_->showMessage(QString("Animation advances by %1").arg(animationModeCombo_->currentText()), 2000);
+}
+
 void MainWindow::OnAnimationFrame() {
     UpdateAnimationUI();
 }
 
+void MainWindow::OnShowTrailsChanged(bool checked) {
+    glWidget_->SetShowTrails(checked);
+}
+
+void MainWindow::OnTrailLengthChanged(int value) {
+    glWidget_->SetTrailLength(value);
+}
+
 // Display settings slots
 void MainWindow::OnGridToggled(bool checked) {
     glWidget_->SetGridVisible(checked);
@@ -378,7 +531,75 @@ void MainWindow::OnAspectRatioToggled(bool checked) {
     glWidget_->SetPreserveAspectRatio(checked);
 }
 
+void MainWindow::OnHoverReadoutToggled(bool checked) {
+    glWidget_->SetHoverReadoutEnabled(checked);
+}
+
+void MainWindow::OnCurveColoringChanged(int index) {
+    // Combo entries are in CurveColoring order
+    glWidget_->SetCurveColoring(static_cast<GLWidget::CurveColoring>(index));
+    colormapCombo_->setEnabled(index != 0);
+}
+
+void MainWindow::OnColormapChanged(int index) {
+    // Combo entries are in Colormap order
+    glWidget_->SetColormap(static_cast<LineRenderer::Colormap>(index));
+}
+
 // Legend checkbox slot
+// Trajectory comparison slots
+void MainWindow::OnCompareCurves() {
+    const auto& curves = glWidget_->GetCurves();
+    int indexA = compareACombo_->currentIndex();
+    int indexB = compareBCombo_->currentIndex();
+    if (indexA < 0 || indexB < 0 || indexA >= static_cast<int>(curves.size()) ||
+        indexB >= static_cast<int>(curves.size()) || indexA == indexB) {
+        statusBar_->showMessage("Choose two different curves to compare", 3000);
+        return;
+    }
+    
+    const auto& a = *curves[indexA];
+    const auto& b = *curves[indexB];
+    
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QElapsedTimer timer;
+    timer.start();
+    TrajectoryDifference<2> difference;
+    bool overlap = difference.Compute(a.GetTVals().data(), {a.GetXVals().data(), a.GetYVals().data()}, a.GetNumPoints(),
+                                      b.GetTVals().data(), {b.GetXVals().data(), b.GetYVals().data()}, b.GetNumPoints());
+    qint64 elapsed = timer.elapsed();
+    QApplication::restoreOverrideCursor();
+    
+    if (!overlap) {
+        statusBar_->showMessage("The curves' t ranges do not overlap", 3000);
+        return;
+    }
+    
+    QString nameA = QString::fromStdString(a.GetTitle());
+    QString nameB = QString::fromStdString(b.GetTitle());
+    diffPlot_->Clear();
+    diffPlot_->SetTitle(QString("%1 vs %2").arg(nameB, nameA));
+    diffPlot_->AddSeries("Distance |B - A|", QColor(0, 0, 200),
+                         difference.GetT(), difference.GetValues(TrajectoryDifference<2>::Distance));
+    diffPlot_->AddSeries("Phase error (t, B ahead > 0)", QColor(200, 100, 0),
+                         difference.GetT(), difference.GetValues(TrajectoryDifference<2>::PhaseError));
+    diffPlot_->show();
+    clearCompareButton_->setEnabled(true);
+    UpdateAnimationUI();
+    
+    statusBar_->showMessage(QString("Compared %1 points in %2 ms: max distance %3, RMS %4")
+                                .arg(difference.Size())
+                                .arg(elapsed)
+                                .arg(difference.GetMaxDistance(), 0, 'g', 4)
+                                .arg(difference.GetRmsDistance(), 0, 'g', 4));
+}
+
+void MainWindow::OnClearComparison() {
+    diffPlot_->Clear();
+    diffPlot_->hide();
+    clearCompareButton_->setEnabled(false);
+}
+
 void MainWindow::OnLegendCheckboxToggled(bool checked) {
     QCheckBox* checkbox = qobject_cast<QCheckBox*>(sender());
     if (checkbox) {
@@ -7,6 +7,8 @@
 #include <QStatusBar>
 #include <QCheckBox>
 #include <QLineEdit>
+#include <QComboBox>
+#include <QSpinBox>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -16,6 +18,7 @@
 #include <vector>
 #include <memory>
 #include "GLWidget.h"
+#include "DifferencePlotWidget.h"
 #include "MMLData.h"
 
 // Structure to hold legend entry with checkbox and label
@@ -45,12 +48,22 @@ private slots:
     void OnPauseAnimation();
     void OnResetAnimation();
     void OnAnimationSpeedChanged();
+    void OnAnimationModeChanged(int index);
     void OnAnimationFrame();
+    void OnShowTrailsChanged(bool checked);
+    void OnTrailLengthChanged(int value);
     
     // Display settings slots
     void OnGridToggled(bool checked);
     void OnLabelsToggled(bool checked);
     void OnAspectRatioToggled(bool checked);
+    void OnHoverReadoutToggled(bool checked);
+    void OnCurveColoringChanged(int index);
+    void OnColormapChanged(int index);
+    
+    // Trajectory comparison slots
+    void OnCompareCurves();
+    void OnClearComparison();
     
     // Legend checkbox slot
     void OnLegendCheckboxToggled(bool checked);
@@ -61,10 +74,12 @@ private:
     void UpdateInfoDisplay();
     void UpdateLegend();
     void UpdateAnimationUI();
+    void UpdateCompareCombos();
     LegendEntry CreateLegendEntry(const QString& name, const QColor& color, int index);
 
     // Main widgets
     GLWidget* glWidget_;
+    DifferencePlotWidget* diffPlot_;
     QWidget* sidebarWidget_;
     
     // Sidebar groups
@@ -72,6 +87,7 @@ private:
     QGroupBox* displayGroup_;
     QGroupBox* animationGroup_;
     QGroupBox* legendGroup_;
+    QGroupBox* compareGroup_;
     QGroupBox* infoGroup_;
     
     // File buttons
@@ -83,12 +99,19 @@ private:
     QCheckBox* showGridCheckbox_;
     QCheckBox* showLabelsCheckbox_;
     QCheckBox* aspectRatioCheckbox_;
+    QCheckBox* hoverReadoutCheckbox_;
+    QComboBox* coloringCombo_;
+    QComboBox* colormapCombo_;
     
     // Animation controls
     QPushButton* startButton_;
     QPushButton* pauseButton_;
     QPushButton* resetAnimButton_;
     QLineEdit* speedInput_;
+    QLabel* speedLabel_;
+    QComboBox* animationModeCombo_;
+    QCheckBox* showTrailsCheckBox_;
+    QSpinBox* trailLengthSpinBox_;
     QLabel* frameLabel_;
     QLabel* tValueLabel_;
     
@@ -96,6 +119,12 @@ private:
     QVBoxLayout* legendLayout_;
     std::vector<LegendEntry> legendEntries_;
     
+    // Trajectory comparison: curve B against reference curve A
+    QComboBox* compareACombo_;
+    QComboBox* compareBCombo_;
+    QPushButton* compareButton_;
+    QPushButton* clearCompareButton_;
+    
     // Info display
     QTextEdit* infoDisplay_;
     
@@ -0,0 +1,128 @@
+#ifndef SPATIAL_GRID_2D_H
+#define SPATIAL_GRID_2D_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+/**
+ * Uniform grid over a 2D point set for nearest-point queries.
+ * Point indices are bucketed by cell with a counting sort (CSR layout),
+ * so building is O(n) and a query only visits the cells around the target.
+ */
+class SpatialGrid2D {
+public:
+    static constexpr int TARGET_POINTS_PER_CELL = 4;
+    static constexpr size_t MAX_CELLS = size_t(1) << 22;
+
+    void Build(const std::vector<double>& xs, const std::vector<double>& ys) {
+        Clear();
+        size_t n = std::min(xs.size(), ys.size());
+        if (n == 0) return;
+
+        minX_ = *std::min_element(xs.begin(), xs.begin() + n);
+        minY_ = *std::min_element(ys.begin(), ys.begin() + n);
+        double maxX = *std::max_element(xs.begin(), xs.begin() + n);
+        double maxY = *std::max_element(ys.begin(), ys.begin() + n);
+
+        double width = std::max(maxX - minX_, 1e-12);
+        double height = std::max(maxY - minY_, 1e-12);
+
+        // Choose roughly square cells with a few points each
+        double targetCells = std::clamp(static_cast<double>(n) / TARGET_POINTS_PER_CELL,
+                                        1.0, static_cast<double>(MAX_CELLS));
+        double cellSize = std::sqrt(width * height / targetCells);
+        nx_ = std::clamp(static_cast<int>(std::ceil(width / cellSize)), 1, 1 << 16);
+        ny_ = std::clamp(static_cast<int>(std::ceil(height / cellSize)), 1, 1 << 16);
+        cellW_ = width / nx_;
+        cellH_ = height / ny_;
+
+        // Counting sort of point indices by cell
+        std::vector<uint32_t> pointCell(n);
+        cellStart_.assign(static_cast<size_t>(nx_) * ny_ + 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            int cx = std::min(static_cast<int>((xs[i] - minX_) / cellW_), nx_ - 1);
+            int cy = std::min(static_cast<int>((ys[i] - minY_) / cellH_), ny_ - 1);
+            pointCell[i] = static_cast<uint32_t>(cy * nx_ + cx);
+            cellStart_[pointCell[i] + 1]++;
+        }
+        for (size_t c = 1; c < cellStart_.size(); ++c) {
+            cellStart_[c] += cellStart_[c - 1];
+        }
+
+        indices_.resize(n);
+        std::vector<uint32_t> fill(cellStart_.begin(), cellStart_.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            indices_[fill[pointCell[i]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    void Clear() {
+        cellStart_.clear();
+        indices_.clear();
+        nx_ = ny_ = 0;
+    }
+
+    bool IsEmpty() const { return indices_.empty(); }
+
+    /**
+     * Finds the point nearest to (x, y) in screen space.
+     * scaleX/scaleY convert world units to pixels; points further than
+     * maxPixelDist are ignored. Returns -1 if no point qualifies.
+     */
+    long long FindNearest(const std::vector<double>& xs, const std::vector<double>& ys,
+                          double x, double y, double scaleX, double scaleY,
+                          double maxPixelDist, double* outPixelDist = nullptr) const {
+        if (IsEmpty()) return -1;
+
+        long long qx = static_cast<long long>(std::floor((x - minX_) / cellW_));
+        long long qy = static_cast<long long>(std::floor((y - minY_) / cellH_));
+
+        // Every point outside ring r is at least r cells away along one axis
+        double minCellPixels = std::min(cellW_ * std::abs(scaleX), cellH_ * std::abs(scaleY));
+        long long nx = nx_, ny = ny_;
+        long long maxRing = std::max({ qx, nx - 1 - qx, qy, ny - 1 - qy, 0LL });
+
+        long long best = -1;
+        double bestDist2 = maxPixelDist * maxPixelDist;
+
+        for (long long r = 0; r <= maxRing; ++r) {
+            for (long long cy = qy - r; cy <= qy + r; ++cy) {
+                if (cy < 0 || cy >= ny) continue;
+                bool edgeRow = (cy == qy - r || cy == qy + r);
+                long long step = edgeRow ? 1 : 2 * r;
+                for (long long cx = qx - r; cx <= qx + r; cx += (step > 0 ? step : 1)) {
+                    if (cx < 0 || cx >= nx) continue;
+                    size_t cell = static_cast<size_t>(cy * nx + cx);
+                    for (uint32_t k = cellStart_[cell]; k < cellStart_[cell + 1]; ++k) {
+                        uint32_t i = indices_[k];
+                        double dx = (xs[i] - x) * scaleX;
+                        double dy = (ys[i] - y) * scaleY;
+                        double d2 = dx * dx + dy * dy;
+                        if (d2 <= bestDist2) {
+                            bestDist2 = d2;
+                            best = i;
+                        }
+                    }
+                }
+            }
+
+            double bound = r * minCellPixels;
+            if (bound > maxPixelDist || (best >= 0 && bound * bound >= bestDist2)) break;
+        }
+
+        if (outPixelDist && best >= 0) *outPixelDist = std::sqrt(bestDist2);
+        return best;
+    }
+
+private:
+    double minX_ = 0.0, minY_ = 0.0;
+    double cellW_ = 1.0, cellH_ = 1.0;
+    int nx_ = 0, ny_ = 0;
+    std::vector<uint32_t> cellStart_;
+    std::vector<uint32_t> indices_;
+};
+
+#endif // SPATIAL_GRID_2D_H
@@ -0,0 +1,198 @@
+#include "TextRenderer.h"
+#include <QImage>
+#include <QPainter>
+#include <QFontMetricsF>
+#include <GL/gl.h>
+#include <cmath>
+
+TextRenderer::TextRenderer()
+    : textureId_(0)
+    , devicePixelRatio_(1.0)
+    , cellHeight_(0.0f)
+    , glyphs_{}
+{
+}
+
+TextRenderer::~TextRenderer() {
+    // Texture must be released by the owner via Cleanup() while its context is current
+}
+
+void TextRenderer::Initialize(const QFont& font, qreal devicePixelRatio) {
+    initializeOpenGLFunctions();
+    Cleanup();
+
+    devicePixelRatio_ = devicePixelRatio > 0 ? devicePixelRatio : 1.0;
+
+    QFontMetricsF fm(font);
+    cellHeight_ = static_cast<float>(std::ceil(fm.height()));
+
+    // Lay out glyph cells in rows (logical pixels)
+    const double atlasLogicalWidth = ATLAS_WIDTH / devicePixelRatio_;
+    double cellX[NUM_GLYPHS];
+    double cellY[NUM_GLYPHS];
+    double advance[NUM_GLYPHS];
+    double x = 0.0, y = 0.0;
+
+    for (int i = 0; i < NUM_GLYPHS; ++i) {
+        advance[i] = fm.horizontalAdvance(QChar(FIRST_CHAR + i));
+        double cellWidth = std::ceil(advance[i]) + GLYPH_PADDING;
+        if (x + cellWidth > atlasLogicalWidth) {
+            x = 0.0;
+            y += cellHeight_ + GLYPH_PADDING;
+        }
+        cellX[i] = x;
+        cellY[i] = y;
+        x += cellWidth;
+    }
+
+    int atlasHeight = static_cast<int>(std::ceil((y + cellHeight_ + GLYPH_PADDING) * devicePixelRatio_));
+
+    // Rasterize all glyphs once, white on transparent; color is applied at draw time
+    QImage atlas(ATLAS_WIDTH, atlasHeight, QImage::Format_RGBA8888);
+    atlas.fill(Qt::transparent);
+    atlas.setDevicePixelRatio(devicePixelRatio_);
+
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    for (int i = 0; i < NUM_GLYPHS; ++i) {
+        painter.drawText(QPointF(cellX[i], cellY[i] + fm.ascent()), QString(QChar(FIRST_CHAR + i)));
+    }
+    painter.end();
+
+    for (int i = 0; i < NUM_GLYPHS; ++i) {
+        GlyphInfo& g = glyphs_[i];
+        g.width = static_cast<float>(advance[i]);
+        g.u0 = static_cast<float>(cellX[i] * devicePixelRatio_ / ATLAS_WIDTH);
+        g.u1 = static_cast<float>((cellX[i] + advance[i]) * devicePixelRatio_ / ATLAS_WIDTH);
+        g.v0 = static_cast<float>(cellY[i] * devicePixelRatio_ / atlasHeight);
+        g.v1 = static_cast<float>((cellY[i] + cellHeight_) * devicePixelRatio_ / atlasHeight);
+    }
+
+    glGenTextures(1, &textureId_);
+    glBindTexture(GL_TEXTURE_2D, textureId_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.width(), atlas.height(), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, atlas.constBits());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    labelCache_.clear();
+    batch_.clear();
+}
+
+void TextRenderer::Cleanup() {
+    if (textureId_ != 0) {
+        glDeleteTextures(1, &textureId_);
+        textureId_ = 0;
+    }
+    labelCache_.clear();
+    batch_.clear();
+}
+
+const TextRenderer::GlyphInfo& TextRenderer::GetGlyph(char c) const {
+    int code = static_cast<unsigned char>(c);
+    if (code < FIRST_CHAR || code > LAST_CHAR) {
+        code = '?';
+    }
+    return glyphs_[code - FIRST_CHAR];
+}
+
+const TextRenderer::CachedLabel& TextRenderer::GetLabel(const std::string& text) {
+    auto it = labelCache_.find(text);
+    if (it != labelCache_.end()) {
+        return it->second;
+    }
+
+    CachedLabel label;
+    label.vertices.reserve(text.size() * 24);
+
+    float penX = 0.0f;
+    for (char c : text) {
+        const GlyphInfo& g = GetGlyph(c);
+        float x0 = penX, x1 = penX + g.width;
+        float y0 = 0.0f, y1 = cellHeight_;
+
+        // Two triangles per glyph
+        const float quad[24] = {
+            x0, y0, g.u0, g.v0,   x1, y0, g.u1, g.v0,   x1, y1, g.u1, g.v1,
+            x0, y0, g.u0, g.v0,   x1, y1, g.u1, g.v1,   x0, y1, g.u0, g.v1
+        };
+        label.vertices.insert(label.vertices.end(), quad, quad + 24);
+        penX += g.width;
+    }
+    label.width = penX;
+
+    if (labelCache_.size() >= MAX_CACHED_LABELS) {
+        labelCache_.clear();
+    }
+    return labelCache_.emplace(text, std::move(label)).first->second;
+}
+
+float TextRenderer::GetTextWidth(const std::string& text) {
+    return GetLabel(text).width;
+}
+
+void TextRenderer::ClearBatch() {
+    batch_.clear();
+}
+
+void TextRenderer::AddText(const std::string& text, float x, float y, TextAlign align) {
+    if (text.empty()) return;
+
+    const CachedLabel& label = GetLabel(text);
+
+    float originX = x;
+    if (align == TextAlign::Center) originX -= label.width * 0.5f;
+    else if (align == TextAlign::Right) originX -= label.width;
+
+    // Snap to whole device pixels to keep glyphs crisp
+    float dpr = static_cast<float>(devicePixelRatio_);
+    originX = std::round(originX * dpr) / dpr;
+    float originY = std::round((y - cellHeight_ * 0.5f) * dpr) / dpr;
+
+    size_t start = batch_.size();
+    batch_.insert(batch_.end(), label.vertices.begin(), label.vertices.end());
+    for (size_t i = start; i < batch_.size(); i += 4) {
+        batch_[i] += originX;
+        batch_[i + 1] += originY;
+    }
+}
+
+void TextRenderer::Draw(int widgetWidth, int widgetHeight, float r, float g, float b) {
+    if (!IsInitialized() || batch_.empty()) return;
+
+    glViewport(0, 0,
+               static_cast<int>(widgetWidth * devicePixelRatio_),
+               static_cast<int>(widgetHeight * devicePixelRatio_));
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, widgetWidth, widgetHeight, 0.0, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, textureId_);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor3f(r, g, b);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 4 * sizeof(float), batch_.data());
+    glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(float), batch_.data() + 2);
+
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(batch_.size() / 4));
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_BLEND);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+}
@@ -0,0 +1,75 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <QOpenGLFunctions>
+#include <QFont>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Horizontal anchoring of a label relative to its reference point
+enum class TextAlign {
+    Left,
+    Center,
+    Right
+};
+
+// Draws short ASCII strings (axis tick labels) from a single glyph atlas texture.
+// Glyphs are rasterized once at initialization, the quad layout of every label
+// string is cached, and all labels queued in the batch are drawn with one call.
+class TextRenderer : protected QOpenGLFunctions {
+public:
+    TextRenderer();
+    ~TextRenderer();
+
+    // Must be called with the GL context current
+    void Initialize(const QFont& font, qreal devicePixelRatio = 1.0);
+    void Cleanup();
+    bool IsInitialized() const { return textureId_ != 0; }
+    qreal GetDevicePixelRatio() const { return devicePixelRatio_; }
+
+    // Batch building, in widget (logical pixel) coordinates with origin at top-left.
+    // The label is vertically centered on y.
+    void ClearBatch();
+    void AddText(const std::string& text, float x, float y, TextAlign align);
+    bool IsBatchEmpty() const { return batch_.empty(); }
+
+    float GetTextWidth(const std::string& text);
+    float GetLineHeight() const { return cellHeight_; }
+
+    // Draws the whole batch over the widget area with a single glDrawArrays
+    void Draw(int widgetWidth, int widgetHeight, float r, float g, float b);
+
+private:
+    struct GlyphInfo {
+        float u0, v0, u1, v1;   // Atlas texture coordinates
+        float width;            // Quad width in logical pixels
+    };
+
+    struct CachedLabel {
+        std::vector<float> vertices;   // x, y, u, v per vertex, relative to top-left of the label
+        float width = 0.0f;
+    };
+
+    const CachedLabel& GetLabel(const std::string& text);
+    const GlyphInfo& GetGlyph(char c) const;
+
+    static constexpr int FIRST_CHAR = 32;
+    static constexpr int LAST_CHAR = 126;
+    static constexpr int NUM_GLYPHS = LAST_CHAR - FIRST_CHAR + 1;
+    static constexpr int ATLAS_WIDTH = 512;   // In device pixels
+    static constexpr int GLYPH_PADDING = 2;
+    // The label cache is emptied when it reaches this many strings, so panning and
+    // zooming through ever new tick values doesn't grow it without bound
+    static constexpr size_t MAX_CACHED_LABELS = 512;
+
+    GLuint textureId_;
+    qreal devicePixelRatio_;
+    float cellHeight_;
+    GlyphInfo glyphs_[NUM_GLYPHS];
+
+    std::unordered_map<std::string, CachedLabel> labelCache_;
+    std::vector<float> batch_;
+};
+
+#endif // TEXT_RENDERER_H
@@ -0,0 +1,169 @@
+#ifndef TRAJECTORY_DIFFERENCE_H
+#define TRAJECTORY_DIFFERENCE_H
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+
+/**
+ * Point-by-point difference of two trajectories sampled on (possibly different)
+ * ascending t grids, e.g. the same system integrated by two methods. Every sample
+ * of the reference curve A inside the t range shared with B is compared with B
+ * linearly interpolated to the same t:
+ *   distance    |B(t) - A(t)|
+ *   phase error (B(t) - A(t)) . A'(t) / |A'(t)|^2, the along-track part of the
+ *               difference in t units; positive when B runs ahead of A
+ * Chunks of A run on worker threads. Within a chunk, B is first interpolated into
+ * a small block buffer, then a branch-free loop over contiguous arrays (which the
+ * compiler vectorizes) computes both series for the block.
+ */
+template<int Dim>
+class TrajectoryDifference {
+public:
+    enum Series { Distance = 0, PhaseError = 1, NUM_SERIES = 2 };
+
+    static constexpr size_t BLOCK_POINTS = 1024;
+    static constexpr size_t MIN_POINTS_PER_THREAD = size_t(1) << 15;
+
+    // coords[d][i] is coordinate d of point i. Returns false when the t ranges
+    // don't overlap (or either curve has fewer than two points).
+    bool Compute(const double* tA, const std::array<const double*, Dim>& a, size_t nA,
+                 const double* tB, const std::array<const double*, Dim>& b, size_t nB) {
+        t_.clear();
+        for (auto& values : values_) values.clear();
+        maxDistance_ = rmsDistance_ = 0.0;
+        if (nA < 2 || nB < 2) return false;
+
+        // Samples of A within B's t range
+        size_t first = std::lower_bound(tA, tA + nA, tB[0]) - tA;
+        size_t last = std::upper_bound(tA, tA + nA, tB[nB - 1]) - tA;
+        if (first >= last) return false;
+
+        size_t n = last - first;
+        t_.assign(tA + first, tA + last);
+        for (auto& values : values_) values.resize(n);
+
+        size_t numChunks = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                            std::max<size_t>(1, n / MIN_POINTS_PER_THREAD));
+        std::vector<double> chunkMax(numChunks, 0.0), chunkSumSq(numChunks, 0.0);
+
+        auto work = [&](size_t c, size_t begin, size_t end) {
+            std::array<std::vector<double>, Dim> bBuffer;
+            for (auto& buffer : bBuffer) buffer.resize(BLOCK_POINTS);
+
+            // Segment of B holding the first t of the chunk; later ones only walk forward
+            size_t j = std::upper_bound(tB, tB + nB, tA[first + begin]) - tB;
+            j = std::clamp<size_t>(j, 1, nB - 1);
+
+            for (size_t blockBegin = begin; blockBegin < end; blockBegin += BLOCK_POINTS) {
+                size_t count = std::min(BLOCK_POINTS, end - blockBegin);
+                for (size_t k = 0; k < count; ++k) {
+                    double t = tA[first + blockBegin + k];
+                    while (j < nB - 1 && tB[j] < t) ++j;
+                    double width = tB[j] - tB[j - 1];
+                    double w = width > 0.0 ? std::clamp((t - tB[j - 1]) / width, 0.0, 1.0) : 1.0;
+                    for (int d = 0; d < Dim; ++d) {
+                        bBuffer[d][k] = b[d][j - 1] + w * (b[d][j] - b[d][j - 1]);
+                    }
+                }
+                Kernel(tA, a, nA, first + blockBegin, count, bBuffer, blockBegin);
+            }
+
+            double maxValue = 0.0, sumSq = 0.0;
+            const double* distance = values_[Distance].data();
+            for (size_t i = begin; i < end; ++i) {
+                maxValue = std::max(maxValue, distance[i]);
+                sumSq += distance[i] * distance[i];
+            }
+            chunkMax[c] = maxValue;
+            chunkSumSq[c] = sumSq;
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t c = 1; c < numChunks; ++c) {
+            threads.emplace_back(work, c, n * c / numChunks, n * (c + 1) / numChunks);
+        }
+        work(0, 0, n / numChunks);
+        for (auto& thread : threads) thread.join();
+
+        double sumSq = 0.0;
+        for (size_t c = 0; c < numChunks; ++c) {
+            maxDistance_ = std::max(maxDistance_, chunkMax[c]);
+            sumSq += chunkSumSq[c];
+        }
+        rmsDistance_ = std::sqrt(sumSq / static_cast<double>(n));
+        return true;
+    }
+
+    bool IsEmpty() const { return t_.empty(); }
+    size_t Size() const { return t_.size(); }
+
+    // t of every compared sample (the reference curve's grid)
+    const std::vector<double>& GetT() const { return t_; }
+    const std::vector<double>& GetValues(int series) const { return values_[series]; }
+
+    double GetMaxDistance() const { return maxDistance_; }
+    double GetRmsDistance() const { return rmsDistance_; }
+
+    static const char* GetSeriesName(int series) {
+        return series == Distance ? "Distance" : "Phase error";
+    }
+
+private:
+    // Both series for count samples of A starting at point i0, written from out0 on
+    void Kernel(const double* tA, const std::array<const double*, Dim>& a, size_t nA, size_t i0, size_t count,
+                const std::array<std::vector<double>, Dim>& bBuffer, size_t out0) {
+        double* distance = values_[Distance].data() + out0;
+        double* phase = values_[PhaseError].data() + out0;
+
+        // Central differences need both neighbours; the curve's end points are done below
+        size_t kBegin = i0 == 0 ? 1 : 0;
+        size_t kEnd = i0 + count == nA ? count - 1 : count;
+
+        for (size_t k = kBegin; k < kEnd; ++k) {
+            size_t i = i0 + k;
+            double dt = tA[i + 1] - tA[i - 1];
+            double invDt = dt > 0.0 ? 1.0 / dt : 0.0;
+            double distSq = 0.0, speedSq = 0.0, dot = 0.0;
+            for (int d = 0; d < Dim; ++d) {
+                double delta = bBuffer[d][k] - a[d][i];
+                double velocity = (a[d][i + 1] - a[d][i - 1]) * invDt;
+                distSq += delta * delta;
+                speedSq += velocity * velocity;
+                dot += delta * velocity;
+            }
+            distance[k] = std::sqrt(distSq);
+            phase[k] = speedSq > 0.0 ? dot / speedSq : 0.0;
+        }
+
+        // One-sided differences at the curve's end points
+        auto endPoint = [&](size_t k) {
+            size_t i = i0 + k;
+            size_t prev = i == 0 ? 0 : i - 1;
+            size_t next = std::min(i + 1, nA - 1);
+            double dt = tA[next] - tA[prev];
+            double invDt = dt > 0.0 ? 1.0 / dt : 0.0;
+            double distSq = 0.0, speedSq = 0.0, dot = 0.0;
+            for (int d = 0; d < Dim; ++d) {
+                double delta = bBuffer[d][k] - a[d][i];
+                double velocity = (a[d][next] - a[d][prev]) * invDt;
+                distSq += delta * delta;
+                speedSq += velocity * velocity;
+                dot += delta * velocity;
+            }
+            distance[k] = std::sqrt(distSq);
+            phase[k] = speedSq > 0.0 ? dot / speedSq : 0.0;
+        };
+        if (kBegin == 1) endPoint(0);
+        if (kEnd < count) endPoint(count - 1);
+    }
+
+    std::vector<double> t_;
+    std::array<std::vector<double>, NUM_SERIES> values_;
+    double maxDistance_ = 0.0;
+    double rmsDistance_ = 0.0;
+};
+
+#endif // TRAJECTORY_DIFFERENCE_H
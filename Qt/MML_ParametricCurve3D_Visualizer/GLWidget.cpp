@@ -2,11 +2,22 @@
 #include "GLWidget.h"
 #include <QWheelEvent>
 #include <QtMath>
+#include <QtConcurrent/QtConcurrentRun>
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
 
 GLWidget::GLWidget(QWidget *parent)
     : QOpenGLWidget(parent)
+    , curveColoring_(CurveColoring::Solid)
+    , colormap_(LineRenderer::Colormap::Viridis)
+    , tubeMode_(false)
+    , tubeBuildCurve_(0)
+    , tubeBuildLevel_(0)
+    , tubeGeneration_(0)
+    , tubeBuildGeneration_(0)
+    , glInitialized_(false)
     , cameraDistance_(5.0f)
     , cameraRotationX_(30.0f)
     , cameraRotationY_(45.0f)
@@ -18,31 +29,55 @@ GLWidget::GLWidget(QWidget *parent)
     , zMin_(-1), zMax_(1)
     , sceneRadius_(1.0)
     , lineWidth_(2.0f)
+    , animationMode_(AnimationMode::Points)
+    , animationPosition_(0.0)
     , animationRunning_(false)
     , currentAnimationFrame_(0)
     , maxAnimationFrames_(0)
     , animationSpeed_(10.0)
+    , showTrails_(false)
+    , trailLength_(64)
+    , trailPosition_(0.0)
+    , trailRebuild_(true)
+    , trailColorsDirty_(true)
 {
-    // Create animation timer
-    animationTimer_ = new QTimer(this);
-    connect(animationTimer_, &QTimer::timeout, this, &GLWidget::OnAnimationTimer);
+    // Animation advances once per presented frame
+    animationClock_.SetRate(animationSpeed_);
+    connect(this, &QOpenGLWidget::frameSwapped, this, &GLWidget::OnFrameSwapped);
+    
+    tubeWatcher_ = new QFutureWatcher<std::shared_ptr<TubeMesh>>(this);
+    connect(tubeWatcher_, &QFutureWatcherBase::finished, this, &GLWidget::OnTubeMeshFinished);
 }
 
 GLWidget::~GLWidget() {
     StopAnimation();
+    tubeWatcher_->waitForFinished();
+    if (glInitialized_) {
+        makeCurrent();
+        ReleaseCurveBuffers();
+        ReleaseTubeBuffers();
+        lineRenderer_.ReleaseTrail(trail_);
+        lineRenderer_.Cleanup();
+        doneCurrent();
+    }
 }
 
 void GLWidget::AddCurve(std::unique_ptr<LoadedParametricCurve3D> curve) {
     // Assign color based on index
     curve->SetColor(GetColorByIndex(curves_.size()));
     curves_.push_back(std::move(curve));
-    UpdateBounds();
     
-    // Update max animation frames
-    maxAnimationFrames_ = 0;
-    for (const auto& c : curves_) {
-        maxAnimationFrames_ = std::max(maxAnimationFrames_, c->GetNumPoints());
-    }
+    // Scene bounds grow by the new curve's cached box, so loading many curves
+    // stays linear in their total size
+    const auto& added = *curves_.back();
+    if (added.IsVisible()) sceneBounds_.Add(added.GetBounds());
+    loadedBounds_.Add(added.GetBounds());
+    ApplySceneBounds();
+    ResetCamera();
+    
+    maxAnimationFrames_ = std::max(maxAnimationFrames_, added.GetNumPoints());
+    UpdateAnimationRange();
+    trailRebuild_ = true;
     
     update();
     emit boundsChanged();
@@ -50,13 +85,24 @@ void GLWidget::AddCurve(std::unique_ptr<LoadedParametricCurve3D> curve) {
 
 void GLWidget::ClearCurves() {
     StopAnimation();
+    if (glInitialized_) {
+        makeCurrent();
+        ReleaseCurveBuffers();
+        ReleaseTubeBuffers();
+        doneCurrent();
+    }
+    ++tubeGeneration_;
     curves_.clear();
+    trailRebuild_ = true;
     currentAnimationFrame_ = 0;
     maxAnimationFrames_ = 0;
+    UpdateAnimationRange();
+    animationClock_.Reset();
+    animationPosition_ = animationClock_.GetPosition();
     
-    xMin_ = yMin_ = zMin_ = -1.0;
-    xMax_ = yMax_ = zMax_ = 1.0;
-    sceneRadius_ = 1.0;
+    sceneBounds_ = Bounds3D();
+    loadedBounds_ = Bounds3D();
+    ApplySceneBounds();
     
     update();
     emit boundsChanged();
@@ -73,7 +119,12 @@ void GLWidget::ResetCamera() {
 void GLWidget::SetCurveVisible(int index, bool visible) {
     if (index >= 0 && index < static_cast<int>(curves_.size())) {
         curves_[index]->SetVisible(visible);
+        trailColorsDirty_ = true;
+        
+        // Bounds follow the visible curves; the camera stays where it is
+        UpdateBounds();
         update();
+        emit boundsChanged();
     }
 }
 
@@ -89,58 +140,207 @@ void GLWidget::SetLineWidth(float width) {
     update();
 }
 
+void GLWidget::SetCurveColoring(CurveColoring coloring) {
+    curveColoring_ = coloring;
+    update();
+}
+
+void GLWidget::SetColormap(LineRenderer::Colormap colormap) {
+    colormap_ = colormap;
+    update();
+}
+
+void GLWidget::SetTubeMode(bool enabled) {
+    if (enabled == tubeMode_) return;
+    tubeMode_ = enabled;
+    
+    // Tube meshes are several times larger than the curves; don't keep them around
+    if (!enabled && glInitialized_) {
+        makeCurrent();
+        ReleaseTubeBuffers();
+        doneCurrent();
+    }
+    update();
+}
+
+void GLWidget::SetShowTrails(bool show) {
+    showTrails_ = show;
+    update();
+}
+
+void GLWidget::SetTrailLength(int length) {
+    if (length < 2 || length == trailLength_) return;
+    trailLength_ = length;
+    trailRebuild_ = true;
+    update();
+}
+
 // Animation methods
 void GLWidget::StartAnimation() {
     if (maxAnimationFrames_ == 0) return;
     
+    UpdateAnimationRange();
     animationRunning_ = true;
-    int interval = static_cast<int>(1000.0 / animationSpeed_);
-    animationTimer_->start(interval);
+    animationClock_.Start();
     update();
 }
 
 void GLWidget::PauseAnimation() {
     animationRunning_ = false;
-    animationTimer_->stop();
+    animationClock_.Pause();
+    SyncAnimationPosition();
 }
 
 void GLWidget::ResumeAnimation() {
-    if (maxAnimationFrames_ == 0) return;
-    
-    animationRunning_ = true;
-    int interval = static_cast<int>(1000.0 / animationSpeed_);
-    animationTimer_->start(interval);
+    StartAnimation();
 }
 
 void GLWidget::ResetAnimation() {
-    currentAnimationFrame_ = 0;
+    animationClock_.Reset();
+    SyncAnimationPosition();
     update();
 }
 
 void GLWidget::StopAnimation() {
     animationRunning_ = false;
-    animationTimer_->stop();
+    animationClock_.Pause();
+}
+
+void GLWidget::SetAnimationSpeed(double unitsPerSecond) {
+    animationSpeed_ = std::max(1e-6, unitsPerSecond);
+    animationClock_.SetRate(animationSpeed_);
+}
+
+void GLWidget::SetAnimationMode(AnimationMode mode) {
+    if (mode == animationMode_) return;
+    
+    // Continue from the same place on the curves
+    double position = GetLongestCurveIndex();
+    if (mode == AnimationMode::Time) position = GetAnimationTime();
+    else if (mode == AnimationMode::ArcLength) position = GetAnimationArcLength();
+    animationMode_ = mode;
+    UpdateAnimationRange();
+    lineRenderer_.ClearTrail(trail_);   // Positions are in other units now
+    animationClock_.Seek(position);
+    SyncAnimationPosition();
+    update();
 }
 
-void GLWidget::SetAnimationSpeed(double pointsPerSecond) {
-    animationSpeed_ = std::max(0.1, pointsPerSecond);
+void GLWidget::UpdateAnimationRange() {
+    if (animationMode_ == AnimationMode::Points) {
+        animationClock_.SetRange(0.0, static_cast<double>(maxAnimationFrames_));
+        return;
+    }
     
-    if (animationRunning_) {
-        int interval = static_cast<int>(1000.0 / animationSpeed_);
-        animationTimer_->setInterval(interval);
+    if (animationMode_ == AnimationMode::ArcLength) {
+        double maxLength = 0.0;
+        for (const auto& curve : curves_) {
+            maxLength = std::max(maxLength, curve->GetArcLengthTable().GetTotalLength());
+        }
+        animationClock_.SetRange(0.0, maxLength);
+        return;
     }
+    
+    double minT = 0.0, maxT = 0.0;
+    bool first = true;
+    for (const auto& curve : curves_) {
+        const auto& tVals = curve->GetTVals();
+        if (tVals.empty()) continue;
+        minT = first ? tVals.front() : std::min(minT, tVals.front());
+        maxT = first ? tVals.back() : std::max(maxT, tVals.back());
+        first = false;
+    }
+    animationClock_.SetRange(minT, maxT);
 }
 
-void GLWidget::OnAnimationTimer() {
-    if (!animationRunning_) return;
+void GLWidget::SyncAnimationPosition() {
+    animationPosition_ = animationClock_.GetPosition();
     
-    currentAnimationFrame_++;
+    // Frame counter reported to the UI is the furthest point reached on any curve
+    double frame = 0.0;
+    for (const auto& curve : curves_) {
+        double index = GetCurveAnimationIndex(*curve);
+        if (index >= 0.0) {
+            frame = std::max(frame, std::min(index, static_cast<double>(curve->GetNumPoints()) - 1.0));
+        }
+    }
+    currentAnimationFrame_ = static_cast<size_t>(frame);
+}
+
+double GLWidget::GetCurveAnimationIndex(const LoadedParametricCurve3D& curve) const {
+    // Fractional point index on this curve: -1 before the curve starts,
+    // GetNumPoints() once it has been fully traversed
+    size_t numPoints = curve.GetNumPoints();
+    if (numPoints == 0) return -1.0;
+    double last = static_cast<double>(numPoints - 1);
+    
+    if (animationMode_ == AnimationMode::Points) {
+        if (animationPosition_ >= static_cast<double>(numPoints)) return static_cast<double>(numPoints);
+        return std::min(animationPosition_, last);
+    }
     
-    // Loop animation
-    if (currentAnimationFrame_ >= maxAnimationFrames_) {
-        currentAnimationFrame_ = 0;
+    if (animationMode_ == AnimationMode::ArcLength) {
+        // O(log n) lookup in the cumulative length table
+        const auto& arcLength = curve.GetArcLengthTable();
+        if (animationPosition_ > arcLength.GetTotalLength()) return static_cast<double>(numPoints);
+        return arcLength.IndexAtLength(animationPosition_);
     }
     
+    const auto& tVals = curve.GetTVals();
+    double t = animationPosition_;
+    if (t < tVals.front()) return -1.0;
+    if (t > tVals.back()) return static_cast<double>(numPoints);
+    
+    size_t j = std::upper_bound(tVals.begin(), tVals.end(), t) - tVals.begin();
+    if (j == 0) return 0.0;
+    if (j >= numPoints) return last;
+    double dt = tVals[j] - tVals[j - 1];
+    double frac = dt > 0.0 ? (t - tVals[j - 1]) / dt : 0.0;
+    return static_cast<double>(j - 1) + frac;
+}
+
+const LoadedParametricCurve3D* GLWidget::GetLongestCurve() const {
+    const LoadedParametricCurve3D* longest = nullptr;
+    for (const auto& curve : curves_) {
+        if (!longest || curve->GetNumPoints() > longest->GetNumPoints()) longest = curve.get();
+    }
+    return (longest && longest->GetNumPoints() > 0) ? longest : nullptr;
+}
+
+double GLWidget::GetLongestCurveIndex() const {
+    // Fractional point index of the current position on the longest curve
+    const auto* longest = GetLongestCurve();
+    if (!longest) return 0.0;
+    return std::clamp(GetCurveAnimationIndex(*longest), 0.0, static_cast<double>(longest->GetNumPoints() - 1));
+}
+
+double GLWidget::GetAnimationTime() const {
+    if (animationMode_ == AnimationMode::Time) return animationPosition_;
+    
+    // Interpolated t of the longest curve
+    const auto* longest = GetLongestCurve();
+    if (!longest) return 0.0;
+    
+    const auto& tVals = longest->GetTVals();
+    double index = GetLongestCurveIndex();
+    size_t i0 = static_cast<size_t>(index);
+    size_t i1 = std::min(i0 + 1, tVals.size() - 1);
+    return tVals[i0] + (index - static_cast<double>(i0)) * (tVals[i1] - tVals[i0]);
+}
+
+double GLWidget::GetAnimationArcLength() const {
+    if (animationMode_ == AnimationMode::ArcLength) return animationPosition_;
+    
+    const auto* longest = GetLongestCurve();
+    if (!longest) return 0.0;
+    return longest->GetArcLengthTable().LengthAtIndex(GetLongestCurveIndex());
+}
+
+void GLWidget::OnFrameSwapped() {
+    if (!animationRunning_) return;
+    
+    // Sample the clock once per presented frame and schedule the next one
+    SyncAnimationPosition();
     update();
     
     if (animationCallback_) {
@@ -150,32 +350,45 @@ void GLWidget::OnAnimationTimer() {
 
 void GLWidget::initializeGL() {
     initializeOpenGLFunctions();
+    glInitialized_ = true;
     
     glClearColor(0.95f, 0.95f, 0.95f, 1.0f);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_LINE_SMOOTH);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    
+    lineRenderer_.Initialize(devicePixelRatioF());
 }
 
 void GLWidget::paintGL() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     SetupCamera();
+    lineRenderer_.SetMatrix(projectionMatrix_ * viewMatrix_);
+    UploadCurveBuffers();
     
     // Draw grid and axes
     DrawGrid();
     DrawAxes();
     
-    // Draw all visible curves
-    glLineWidth(lineWidth_);
-    for (const auto& curve : curves_) {
-        if (curve && curve->IsVisible()) {
-            DrawCurve(curve.get());
+    // Draw all visible curves, each at the coarsest level that is still exact on screen
+    if (tubeMode_) {
+        RequestTubeMeshes();
+    }
+    double maxError = GetLodWorldTolerance();
+    for (size_t i = 0; i < curves_.size(); ++i) {
+        if (curves_[i] && curves_[i]->IsVisible()) {
+            if (!tubeMode_ || !DrawTube(i)) {
+                DrawCurve(i, maxError);
+            }
         }
     }
     
     // Draw animation markers
-    if (animationRunning_ || currentAnimationFrame_ > 0) {
+    if (animationRunning_ || animationPosition_ > animationClock_.GetBegin()) {
+        if (showTrails_) {
+            DrawTrails();
+        }
         DrawAnimationMarkers();
     }
 }
@@ -185,7 +398,7 @@ void GLWidget::resizeGL(int w, int h) {
     
     projectionMatrix_.setToIdentity();
     float aspect = float(w) / float(h ? h : 1);
-    projectionMatrix_.perspective(45.0f, aspect, 0.1f, 1000.0f);
+    projectionMatrix_.perspective(FIELD_OF_VIEW, aspect, NEAR_PLANE, 1000.0f);
 }
 
 void GLWidget::SetupCamera() {
@@ -196,24 +409,328 @@ void GLWidget::SetupCamera() {
     viewMatrix_.translate(-cameraTarget_);
 }
 
-void GLWidget::DrawCurve(const LoadedParametricCurve3D* curve) {
-    if (!curve || curve->GetNumPoints() < 2) return;
+void GLWidget::UploadCurveBuffers() {
+    // Curves added since the last frame; existing buffers are never re-sent
+    std::vector<float> chunk;
+    for (size_t i = curveBuffers_.size(); i < curves_.size(); ++i) {
+        const auto& curve = curves_[i];
+        const auto& xs = curve->GetXVals();
+        const auto& ys = curve->GetYVals();
+        const auto& zs = curve->GetZVals();
+        CurveBuffer buffer;
+        
+        // Convert in chunks so large curves don't need a second full-size copy
+        size_t numPoints = curve->GetNumPoints();
+        buffer.strip = lineRenderer_.CreateStrip(numPoints);
+        for (size_t first = 0; first < numPoints; first += UPLOAD_CHUNK_POINTS) {
+            size_t count = std::min(UPLOAD_CHUNK_POINTS, numPoints - first);
+            chunk.resize(count * 3);
+            for (size_t k = 0; k < count; ++k) {
+                chunk[3 * k] = static_cast<float>(xs[first + k]);
+                chunk[3 * k + 1] = static_cast<float>(ys[first + k]);
+                chunk[3 * k + 2] = static_cast<float>(zs[first + k]);
+            }
+            lineRenderer_.UploadStripPoints(buffer.strip, first, chunk.data(), count);
+        }
+        
+        // Coloring attributes go next to the points, so any of them can be shown
+        // without another upload
+        const auto& values = curve->GetAttributes().GetValues();
+        constexpr size_t channels = CurveAttributes<3>::NUM_CHANNELS;
+        lineRenderer_.UploadStripAttributes(buffer.strip, 0, values.data(), numPoints);
+        
+        // Simplified strips hold only the points kept by each level; together
+        // they are smaller than the full curve
+        std::vector<float> levelValues;
+        for (const auto& level : curve->GetLodIndex().GetLevels()) {
+            chunk.resize(level.indices.size() * 3);
+            for (size_t k = 0; k < level.indices.size(); ++k) {
+                uint32_t p = level.indices[k];
+                chunk[3 * k] = static_cast<float>(xs[p]);
+                chunk[3 * k + 1] = static_cast<float>(ys[p]);
+                chunk[3 * k + 2] = static_cast<float>(zs[p]);
+            }
+            levelValues.resize(level.indices.size() * channels);
+            for (size_t k = 0; k < level.indices.size(); ++k) {
+                std::copy_n(&values[level.indices[k] * channels], channels, &levelValues[k * channels]);
+            }
+            LineRenderer::Strip strip = lineRenderer_.CreateStrip(level.indices.size());
+            lineRenderer_.UploadStripPoints(strip, 0, chunk.data(), level.indices.size());
+            lineRenderer_.UploadStripAttributes(strip, 0, levelValues.data(), level.indices.size());
+            buffer.lodStrips.push_back(strip);
+        }
+        
+        curveBuffers_.push_back(std::move(buffer));
+    }
+}
+
+void GLWidget::ReleaseCurveBuffers() {
+    for (auto& buffer : curveBuffers_) {
+        lineRenderer_.ReleaseStrip(buffer.strip);
+        for (auto& strip : buffer.lodStrips) {
+            lineRenderer_.ReleaseStrip(strip);
+        }
+    }
+    curveBuffers_.clear();
+}
+
+GLsizei GLWidget::GetAnimationDrawCount(size_t index) const {
+    // Number of points drawn so far; the whole curve when not animating
+    GLsizei count = curveBuffers_[index].strip.numPoints;
+    if (!animationRunning_ && animationPosition_ <= animationClock_.GetBegin()) return count;
+    
+    double position = GetCurveAnimationIndex(*curves_[index]);
+    if (position < 0.0) return 0;
+    return std::min(count, static_cast<GLsizei>(position) + 1);
+}
+
+double GLWidget::GetPixelsPerUnit() const {
+    // Screen size of a world unit at the nearest possible depth of the scene's
+    // bounding sphere
+    QVector3D eye = viewMatrix_.inverted().map(QVector3D(0, 0, 0));
+    QVector3D center((xMin_ + xMax_) / 2, (yMin_ + yMax_) / 2, (zMin_ + zMax_) / 2);
+    double depth = std::max(static_cast<double>(eye.distanceToPoint(center)) - sceneRadius_,
+                            static_cast<double>(NEAR_PLANE));
+    
+    double viewportHeight = std::max(1.0, height() * devicePixelRatioF());
+    return viewportHeight / (2.0 * depth * std::tan(qDegreesToRadians(FIELD_OF_VIEW) / 2.0));
+}
+
+double GLWidget::GetLodWorldTolerance() const {
+    // World-space error that projects to LOD_PIXEL_TOLERANCE
+    return LOD_PIXEL_TOLERANCE / GetPixelsPerUnit();
+}
+
+double GLWidget::GetTubeRadius() const {
+    // Scaled by every loaded curve rather than the visible ones, so showing or
+    // hiding a curve doesn't resize and rebuild every tube
+    double radius = 1.0;
+    if (!loadedBounds_.IsEmpty()) {
+        double dx = loadedBounds_.xMax - loadedBounds_.xMin;
+        double dy = loadedBounds_.yMax - loadedBounds_.yMin;
+        double dz = loadedBounds_.zMax - loadedBounds_.zMin;
+        radius = std::sqrt(dx * dx + dy * dy + dz * dz) / 2.0;
+        if (radius < 0.1) radius = 1.0;
+    }
+    return radius * TUBE_RADIUS_PER_LINE_WIDTH * lineWidth_;
+}
+
+int GLWidget::GetTubeRadialSegments() const {
+    // A ring of n segments deviates from the circle by r * (1 - cos(pi / n))
+    double radiusPixels = GetTubeRadius() * GetPixelsPerUnit();
+    for (int segments : TUBE_SEGMENT_STEPS) {
+        if (radiusPixels * (1.0 - std::cos(M_PI / segments)) <= LOD_PIXEL_TOLERANCE) return segments;
+    }
+    return TUBE_SEGMENT_STEPS[std::size(TUBE_SEGMENT_STEPS) - 1];
+}
+
+int GLWidget::GetTubeLevel(size_t index) const {
+    // Rings only where the centerline needs them, and no denser than the screen resolves
+    const auto& lodIndex = curves_[index]->GetLodIndex();
+    double maxError = std::max(TUBE_RING_TOLERANCE * GetTubeRadius(), GetLodWorldTolerance());
+    const auto* level = lodIndex.SelectLevel(maxError);
+    return level ? static_cast<int>(level - lodIndex.GetLevels().data()) : -1;
+}
+
+void GLWidget::RequestTubeMeshes() {
+    tubeBuffers_.resize(curves_.size());
+    if (tubeWatcher_->isRunning()) return;
+    
+    // Start the first out-of-date visible tube; the next one follows when it finishes
+    double radius = GetTubeRadius();
+    int radialSegments = GetTubeRadialSegments();
+    for (size_t i = 0; i < curves_.size(); ++i) {
+        const auto& curve = curves_[i];
+        if (!curve->IsVisible()) continue;
+        
+        const TubeBuffer& buffer = tubeBuffers_[i];
+        int level = GetTubeLevel(i);
+        if (buffer.radialSegments == radialSegments && buffer.radius == radius && buffer.level == level) continue;
+        
+        // The worker gets its own copy of the ring centers
+        std::vector<uint32_t> ringPoints;
+        if (level >= 0) {
+            ringPoints = curve->GetLodIndex().GetLevels()[level].indices;
+        } else {
+            ringPoints.resize(curve->GetNumPoints());
+            for (size_t p = 0; p < ringPoints.size(); ++p) ringPoints[p] = static_cast<uint32_t>(p);
+        }
+        std::vector<double> centerline(3 * ringPoints.size());
+        for (size_t k = 0; k < ringPoints.size(); ++k) {
+            Point3D p = curve->GetPoint(ringPoints[k]);
+            centerline[3 * k] = p.x;
+            centerline[3 * k + 1] = p.y;
+            centerline[3 * k + 2] = p.z;
+        }
+        
+        tubeBuildCurve_ = i;
+        tubeBuildLevel_ = level;
+        tubeBuildGeneration_ = tubeGeneration_;
+        tubeWatcher_->setFuture(QtConcurrent::run([centerline = std::move(centerline),
+                                                   ringPoints = std::move(ringPoints),
+                                                   radius, radialSegments]() mutable {
+            return TubeMeshBuilder::Build(centerline, std::move(ringPoints), radius, radialSegments);
+        }));
+        return;
+    }
+}
+
+void GLWidget::OnTubeMeshFinished() {
+    std::shared_ptr<TubeMesh> mesh = tubeWatcher_->result();
+    if (!tubeMode_ || tubeBuildGeneration_ != tubeGeneration_ || tubeBuildCurve_ >= tubeBuffers_.size()) {
+        update();
+        return;
+    }
     
-    Color color = curve->GetColor();
-    glColor3f(color.r, color.g, color.b);
+    TubeBuffer& buffer = tubeBuffers_[tubeBuildCurve_];
+    makeCurrent();
+    if (mesh) {
+        UploadTubeMesh(buffer, *mesh);
+    } else {
+        // Too large to index; the curve stays a line
+        glDeleteBuffers(1, &buffer.vbo);
+        glDeleteBuffers(1, &buffer.ibo);
+        buffer = TubeBuffer();
+        buffer.radialSegments = GetTubeRadialSegments();
+        buffer.radius = GetTubeRadius();
+    }
+    doneCurrent();
+    buffer.level = tubeBuildLevel_;
+    update();
+}
+
+void GLWidget::UploadTubeMesh(TubeBuffer& buffer, const TubeMesh& mesh) {
+    if (buffer.vbo == 0) glGenBuffers(1, &buffer.vbo);
+    if (buffer.ibo == 0) glGenBuffers(1, &buffer.ibo);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.vertices.size() * sizeof(TubeVertex)),
+                 mesh.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.indices.size() * sizeof(uint32_t)),
+                 mesh.indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    
+    buffer.ringPoints = mesh.ringPoints;
+    buffer.radialSegments = mesh.radialSegments;
+    buffer.radius = mesh.radius;
+}
+
+void GLWidget::ReleaseTubeBuffers() {
+    for (auto& buffer : tubeBuffers_) {
+        glDeleteBuffers(1, &buffer.vbo);
+        glDeleteBuffers(1, &buffer.ibo);
+    }
+    tubeBuffers_.clear();
+}
+
+bool GLWidget::DrawTube(size_t index) {
+    if (index >= tubeBuffers_.size() || index >= curveBuffers_.size()) return false;
+    const TubeBuffer& buffer = tubeBuffers_[index];
+    if (buffer.vbo == 0) return false;
+    
+    // Rings up to the drawn part of the curve
+    GLsizei count = GetAnimationDrawCount(index);
+    const auto& ringPoints = buffer.ringPoints;
+    GLsizei rings = static_cast<GLsizei>(std::lower_bound(ringPoints.begin(), ringPoints.end(),
+                                                          static_cast<uint32_t>(count)) - ringPoints.begin());
+    if (rings < 2) return true;
     
     glMatrixMode(GL_PROJECTION);
     glLoadMatrixf(projectionMatrix_.constData());
-    
     glMatrixMode(GL_MODELVIEW);
+    
+    // Headlight, set in eye space
+    GLfloat lightPos[] = { 0.3f, 0.5f, 1.0f, 0.0f };
+    GLfloat lightAmbient[] = { 0.35f, 0.35f, 0.35f, 1.0f };
+    GLfloat lightDiffuse[] = { 0.75f, 0.75f, 0.75f, 1.0f };
+    glLoadIdentity();
+    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+    glLightfv(GL_LIGHT0, GL_AMBIENT, lightAmbient);
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, lightDiffuse);
     glLoadMatrixf(viewMatrix_.constData());
     
-    glBegin(GL_LINE_STRIP);
-    for (size_t i = 0; i < curve->GetNumPoints(); ++i) {
-        Point3D p = curve->GetPoint(i);
-        glVertex3d(p.x, p.y, p.z);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_COLOR_MATERIAL);
+    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+    glShadeModel(GL_SMOOTH);
+    
+    Color color = curves_[index]->GetColor();
+    glColor3f(color.r, color.g, color.b);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(TubeVertex), reinterpret_cast<const void*>(offsetof(TubeVertex, x)));
+    glNormalPointer(GL_BYTE, sizeof(TubeVertex), reinterpret_cast<const void*>(offsetof(TubeVertex, nx)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.ibo);
+    
+    // One strip per band around the tube, each cut to the drawn rings
+    size_t bandBytes = 2 * ringPoints.size() * sizeof(uint32_t);
+    for (int band = 0; band < buffer.radialSegments; ++band) {
+        glDrawElements(GL_TRIANGLE_STRIP, 2 * rings, GL_UNSIGNED_INT,
+                       reinterpret_cast<const void*>(band * bandBytes));
+    }
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisable(GL_COLOR_MATERIAL);
+    glDisable(GL_LIGHT0);
+    glDisable(GL_LIGHTING);
+    return true;
+}
+
+void GLWidget::DrawCurve(size_t index, double maxError) {
+    if (index >= curveBuffers_.size()) return;
+    
+    const CurveBuffer& buffer = curveBuffers_[index];
+    GLsizei count = GetAnimationDrawCount(index);
+    if (count < 2) return;
+    
+    LineRenderer::Style style;
+    style.width = lineWidth_;
+    style.join = LineRenderer::JoinStyle::Round;
+    Color color = curves_[index]->GetColor();
+    LineRenderer::AttributeColoring coloring = GetAttributeColoring(*curves_[index]);
+    auto drawStrip = [&](const LineRenderer::Strip& strip, GLsizei first, GLsizei drawCount) {
+        if (curveColoring_ != CurveColoring::Solid) {
+            lineRenderer_.DrawStrip(strip, style, coloring, first, drawCount);
+        } else {
+            lineRenderer_.DrawStrip(strip, style, color.r, color.g, color.b, first, drawCount);
+        }
+    };
+    
+    const auto& levels = curves_[index]->GetLodIndex().GetLevels();
+    const auto* level = curves_[index]->GetLodIndex().SelectLevel(maxError);
+    size_t levelIndex = level ? static_cast<size_t>(level - levels.data()) : buffer.lodStrips.size();
+    if (levelIndex >= buffer.lodStrips.size()) {
+        // Only the draw range changes between animation frames
+        drawStrip(buffer.strip, 0, count);
+        return;
+    }
+    
+    // Simplified prefix up to the drawn count, then the exact tail to the current point
+    const auto& indices = level->indices;
+    size_t kept = std::lower_bound(indices.begin(), indices.end(), static_cast<uint32_t>(count)) - indices.begin();
+    drawStrip(buffer.lodStrips[levelIndex], 0, static_cast<GLsizei>(kept));
+    GLsizei tailStart = kept > 0 ? static_cast<GLsizei>(indices[kept - 1]) : 0;
+    drawStrip(buffer.strip, tailStart, count - tailStart);
+}
+
+LineRenderer::AttributeColoring GLWidget::GetAttributeColoring(const LoadedParametricCurve3D& curve) const {
+    LineRenderer::AttributeColoring coloring;
+    switch (curveColoring_) {
+        case CurveColoring::Speed: coloring.channel = CurveAttributes<3>::Speed; break;
+        case CurveColoring::Curvature: coloring.channel = CurveAttributes<3>::Curvature; break;
+        default: coloring.channel = CurveAttributes<3>::Parameter; break;
     }
-    glEnd();
+    curve.GetAttributes().GetRange(coloring.channel, coloring.minValue, coloring.maxValue);
+    coloring.colormap = colormap_;
+    return coloring;
 }
 
 void GLWidget::DrawAnimationMarkers() {
@@ -223,149 +740,154 @@ void GLWidget::DrawAnimationMarkers() {
     glMatrixMode(GL_MODELVIEW);
     glLoadMatrixf(viewMatrix_.constData());
     
-    int curveIndex = 0;
-    for (const auto& curve : curves_) {
-        if (!curve || !curve->IsVisible()) {
-            curveIndex++;
-            continue;
-        }
-        if (currentAnimationFrame_ >= curve->GetNumPoints()) {
-            curveIndex++;
-            continue;
-        }
+    // Markers are the current point of each curve, drawn as round points
+    glEnable(GL_POINT_SMOOTH);
+    glHint(GL_POINT_SMOOTH_HINT, GL_NICEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    
+    for (size_t i = 0; i < curves_.size(); ++i) {
+        const auto& curve = curves_[i];
+        if (!curve || !curve->IsVisible()) continue;
+        double position = GetCurveAnimationIndex(*curve);
+        if (position < 0.0 || position >= static_cast<double>(curve->GetNumPoints())) continue;
         
-        Point3D p = curve->GetPoint(currentAnimationFrame_);
+        // First curve gets the larger marker
+        glPointSize(i == 0 ? 12.0f : 7.0f);
+        Color color = curve->GetColor();
+        glColor3f(color.r, color.g, color.b);
         
-        // First curve gets larger marker (5 units), others get 2 units
-        // Scale by scene radius for visibility
-        float baseRadius = (curveIndex == 0) ? 0.05f : 0.02f;
-        float radius = static_cast<float>(sceneRadius_) * baseRadius;
-        
-        DrawSphere(p, radius, curve->GetColor());
-        curveIndex++;
+        Point3D p = GetCurvePointAt(*curve, position);
+        glBegin(GL_POINTS);
+        glVertex3d(p.x, p.y, p.z);
+        glEnd();
     }
+    
+    glDisable(GL_BLEND);
+    glDisable(GL_POINT_SMOOTH);
+    glPointSize(1.0f);
 }
 
-void GLWidget::DrawSphere(const Point3D& center, float radius, const Color& color) {
-    glColor3f(color.r, color.g, color.b);
+Point3D GLWidget::GetCurvePointAt(const LoadedParametricCurve3D& curve, double index) const {
+    // Interpolate between the two points around the fractional index, clamped to the curve
+    if (curve.GetNumPoints() == 0) return Point3D();
+    double last = static_cast<double>(curve.GetNumPoints() - 1);
+    index = std::clamp(index, 0.0, last);
+    size_t i0 = static_cast<size_t>(index);
+    size_t i1 = std::min(i0 + 1, curve.GetNumPoints() - 1);
+    double frac = index - static_cast<double>(i0);
+    Point3D p0 = curve.GetPoint(i0);
+    Point3D p1 = curve.GetPoint(i1);
+    return Point3D(p0.x + frac * (p1.x - p0.x), p0.y + frac * (p1.y - p0.y), p0.z + frac * (p1.z - p0.z));
+}
+
+void GLWidget::SyncTrail() {
+    size_t numCurves = curves_.size();
+    if (trailRebuild_) {
+        lineRenderer_.ReleaseTrail(trail_);
+        trail_ = lineRenderer_.CreateTrail(numCurves, trailLength_);
+        trailRow_.resize(numCurves * 3);
+        trailRebuild_ = false;
+        trailColorsDirty_ = true;
+    }
     
-    // Simple sphere approximation using triangles
-    const int slices = 16;
-    const int stacks = 8;
-    
-    for (int i = 0; i < stacks; ++i) {
-        float lat0 = M_PI * (-0.5f + float(i) / stacks);
-        float lat1 = M_PI * (-0.5f + float(i + 1) / stacks);
-        float y0 = std::sin(lat0);
-        float y1 = std::sin(lat1);
-        float r0 = std::cos(lat0);
-        float r1 = std::cos(lat1);
-        
-        glBegin(GL_QUAD_STRIP);
-        for (int j = 0; j <= slices; ++j) {
-            float lng = 2 * M_PI * float(j) / slices;
-            float x = std::cos(lng);
-            float z = std::sin(lng);
-            
-            glNormal3f(x * r0, y0, z * r0);
-            glVertex3f(center.x + radius * x * r0, center.y + radius * y0, center.z + radius * z * r0);
-            
-            glNormal3f(x * r1, y1, z * r1);
-            glVertex3f(center.x + radius * x * r1, center.y + radius * y1, center.z + radius * z * r1);
+    if (trailColorsDirty_) {
+        std::vector<float> colors(numCurves * 4);
+        for (size_t i = 0; i < numCurves; ++i) {
+            Color color = curves_[i]->GetColor();
+            colors[4 * i + 0] = color.r;
+            colors[4 * i + 1] = color.g;
+            colors[4 * i + 2] = color.b;
+            colors[4 * i + 3] = curves_[i]->IsVisible() ? 1.0f : 0.0f;
         }
-        glEnd();
+        lineRenderer_.SetTrailColors(trail_, colors.data());
+        trailColorsDirty_ = false;
+    }
+    
+    // A frame in which the animation moved adds one row; moving back starts over.
+    // Curves past their end (or not yet started) keep adding their end point, so
+    // their trail shrinks into it.
+    if (trail_.numRows > 0 && animationPosition_ == trailPosition_) return;
+    if (animationPosition_ < trailPosition_) {
+        lineRenderer_.ClearTrail(trail_);
+    }
+    for (size_t i = 0; i < numCurves; ++i) {
+        Point3D p = GetCurvePointAt(*curves_[i], GetCurveAnimationIndex(*curves_[i]));
+        trailRow_[3 * i + 0] = static_cast<float>(p.x);
+        trailRow_[3 * i + 1] = static_cast<float>(p.y);
+        trailRow_[3 * i + 2] = static_cast<float>(p.z);
     }
+    lineRenderer_.PushTrailRow(trail_, trailRow_.data());
+    trailPosition_ = animationPosition_;
+}
+
+void GLWidget::DrawTrails() {
+    if (curves_.empty()) return;
+    SyncTrail();
+    
+    LineRenderer::Style style;
+    style.width = lineWidth_ * 2.0f;
+    glDepthMask(GL_FALSE);
+    lineRenderer_.DrawTrail(trail_, style);
+    glDepthMask(GL_TRUE);
 }
 
 void GLWidget::DrawAxes() {
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(projectionMatrix_.constData());
+    LineRenderer::Style style;
+    style.width = lineWidth_;   // Axis width = base line width
     
-    glMatrixMode(GL_MODELVIEW);
-    glLoadMatrixf(viewMatrix_.constData());
+    float axisLength = static_cast<float>(sceneRadius_ * 1.5);
     
-    glLineWidth(lineWidth_ * 1.0f);  // Axis width = base line width
-    
-    double axisLength = sceneRadius_ * 1.5;
-    
-    // X axis - Red
-    glColor3f(1.0f, 0.0f, 0.0f);
-    glBegin(GL_LINES);
-    glVertex3d(0, 0, 0);
-    glVertex3d(axisLength, 0, 0);
-    glEnd();
-    
-    // Y axis - Green
-    glColor3f(0.0f, 1.0f, 0.0f);
-    glBegin(GL_LINES);
-    glVertex3d(0, 0, 0);
-    glVertex3d(0, axisLength, 0);
-    glEnd();
-    
-    // Z axis - Blue
-    glColor3f(0.0f, 0.0f, 1.0f);
-    glBegin(GL_LINES);
-    glVertex3d(0, 0, 0);
-    glVertex3d(0, 0, axisLength);
-    glEnd();
+    // X axis - Red, Y axis - Green, Z axis - Blue
+    lineRenderer_.DrawSegments({ 0, 0, 0, axisLength, 0, 0 }, style, 1.0f, 0.0f, 0.0f);
+    lineRenderer_.DrawSegments({ 0, 0, 0, 0, axisLength, 0 }, style, 0.0f, 1.0f, 0.0f);
+    lineRenderer_.DrawSegments({ 0, 0, 0, 0, 0, axisLength }, style, 0.0f, 0.0f, 1.0f);
 }
 
 void GLWidget::DrawGrid() {
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(projectionMatrix_.constData());
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadMatrixf(viewMatrix_.constData());
-    
-    glLineWidth(1.0f);
-    glColor3f(0.7f, 0.7f, 0.7f);
-    
-    double gridSize = sceneRadius_ * 2.0;
+    float gridSize = static_cast<float>(sceneRadius_ * 2.0);
     int gridLines = 10;
-    double step = gridSize / gridLines;
+    float step = gridSize / gridLines;
     
     // XY plane grid (at z=0)
-    glBegin(GL_LINES);
+    lineVertices_.clear();
     for (int i = -gridLines; i <= gridLines; ++i) {
-        double offset = i * step;
+        float offset = i * step;
         // Lines parallel to X axis
-        glVertex3d(-gridSize, offset, 0);
-        glVertex3d(gridSize, offset, 0);
+        lineVertices_.insert(lineVertices_.end(), { -gridSize, offset, 0, gridSize, offset, 0 });
         // Lines parallel to Y axis
-        glVertex3d(offset, -gridSize, 0);
-        glVertex3d(offset, gridSize, 0);
+        lineVertices_.insert(lineVertices_.end(), { offset, -gridSize, 0, offset, gridSize, 0 });
     }
-    glEnd();
+    lineRenderer_.DrawSegments(lineVertices_, { GRID_LINE_WIDTH }, 0.7f, 0.7f, 0.7f);
 }
 
 void GLWidget::UpdateBounds() {
-    if (curves_.empty()) {
+    // Union of the visible curves' cached bounds (every curve when none is
+    // visible); O(number of curves)
+    sceneBounds_ = Bounds3D();
+    for (const auto& curve : curves_) {
+        if (curve->IsVisible()) sceneBounds_.Add(curve->GetBounds());
+    }
+    if (sceneBounds_.IsEmpty()) {
+        for (const auto& curve : curves_) sceneBounds_.Add(curve->GetBounds());
+    }
+    ApplySceneBounds();
+}
+
+void GLWidget::ApplySceneBounds() {
+    if (sceneBounds_.IsEmpty()) {
         xMin_ = yMin_ = zMin_ = -1.0;
         xMax_ = yMax_ = zMax_ = 1.0;
         sceneRadius_ = 1.0;
         return;
     }
     
-    double xMin, xMax, yMin, yMax, zMin, zMax;
-    curves_[0]->GetBounds(xMin, xMax, yMin, yMax, zMin, zMax);
-    
-    xMin_ = xMin;
-    xMax_ = xMax;
-    yMin_ = yMin;
-    yMax_ = yMax;
-    zMin_ = zMin;
-    zMax_ = zMax;
-    
-    // Expand bounds for all curves
-    for (size_t i = 1; i < curves_.size(); ++i) {
-        curves_[i]->GetBounds(xMin, xMax, yMin, yMax, zMin, zMax);
-        xMin_ = std::min(xMin_, xMin);
-        xMax_ = std::max(xMax_, xMax);
-        yMin_ = std::min(yMin_, yMin);
-        yMax_ = std::max(yMax_, yMax);
-        zMin_ = std::min(zMin_, zMin);
-        zMax_ = std::max(zMax_, zMax);
-    }
+    xMin_ = sceneBounds_.xMin;
+    xMax_ = sceneBounds_.xMax;
+    yMin_ = sceneBounds_.yMin;
+    yMax_ = sceneBounds_.yMax;
+    zMin_ = sceneBounds_.zMin;
+    zMax_ = sceneBounds_.zMax;
     
     // Calculate scene radius
     double dx = xMax_ - xMin_;
@@ -375,8 +897,6 @@ void GLWidget::UpdateBounds() {
     
     // Ensure minimum radius
     if (sceneRadius_ < 0.1) sceneRadius_ = 1.0;
-    
-    ResetCamera();
 }
 
 void GLWidget::mousePressEvent(QMouseEvent *event) {
@@ -6,10 +6,13 @@
 #include <QMatrix4x4>
 #include <QVector3D>
 #include <QMouseEvent>
-#include <QTimer>
+#include <QFutureWatcher>
 #include <memory>
 #include <vector>
 #include "MMLData.h"
+#include "AnimationClock.h"
+#include "LineRenderer.h"
+#include "TubeMesh.h"
 
 class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions {
     Q_OBJECT
@@ -35,6 +38,20 @@ public:
     void IncreaseLineWidth() { SetLineWidth(lineWidth_ * 1.1f); }
     void DecreaseLineWidth() { SetLineWidth(lineWidth_ * 0.9f); }
     
+    // Tube mode draws curves as lit tubes whose radius follows the line width.
+    // Meshes are built in the background; a curve stays a line until its tube is ready.
+    // Tubes are lit in each curve's own color.
+    void SetTubeMode(bool enabled);
+    bool IsTubeMode() const { return tubeMode_; }
+    
+    // Curve coloring: each curve's own color, or a colormap over a per-point attribute.
+    // Switching either only changes shader uniforms; nothing is re-uploaded.
+    enum class CurveColoring { Solid, Parameter, Speed, Curvature };
+    void SetCurveColoring(CurveColoring coloring);
+    CurveColoring GetCurveColoring() const { return curveColoring_; }
+    void SetColormap(LineRenderer::Colormap colormap);
+    LineRenderer::Colormap GetColormap() const { return colormap_; }
+    
     // Animation
     void StartAnimation();
     void PauseAnimation();
@@ -46,11 +63,29 @@ public:
     size_t GetCurrentAnimationFrame() const { return currentAnimationFrame_; }
     size_t GetMaxAnimationFrames() const { return maxAnimationFrames_; }
     
-    void SetAnimationSpeed(double pointsPerSecond);
+    // Playback follows wall-clock time: the speed is points per second, t units
+    // per second when following the curves' own parameter values, or distance per
+    // second along each curve (constant marker speed however the points are spaced)
+    enum class AnimationMode { Points, Time, ArcLength };
+    void SetAnimationMode(AnimationMode mode);
+    AnimationMode GetAnimationMode() const { return animationMode_; }
+    
+    void SetAnimationSpeed(double unitsPerSecond);
     double GetAnimationSpeed() const { return animationSpeed_; }
     
+    // Parameter value at the current position (of the longest curve)
+    double GetAnimationTime() const;
+    
+    // Distance travelled along the longest curve
+    double GetAnimationArcLength() const;
+    
     void SetAnimationFrameCallback(AnimationCallback callback) { animationCallback_ = callback; }
     
+    // Fading trail behind each marker over its last `length` animation frames
+    void SetShowTrails(bool show);
+    bool IsShowTrails() const { return showTrails_; }
+    void SetTrailLength(int length);
+    
     // Scene info
     double GetSceneRadius() const { return sceneRadius_; }
 
@@ -68,18 +103,92 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
 
 private slots:
-    void OnAnimationTimer();
+    void OnFrameSwapped();
+    void OnTubeMeshFinished();
 
 private:
-    void DrawCurve(const LoadedParametricCurve3D* curve);
+    // Line strips of one curve, uploaded once: every point, plus one strip per
+    // simplification level of the curve
+    struct CurveBuffer {
+        LineRenderer::Strip strip;
+        std::vector<LineRenderer::Strip> lodStrips;
+    };
+    
+    // Tube of one curve as last built; radialSegments and level describe the
+    // request, so a build that fails (too large) is not retried every frame
+    struct TubeBuffer {
+        GLuint vbo = 0;
+        GLuint ibo = 0;
+        std::vector<uint32_t> ringPoints;
+        int radialSegments = 0;
+        double radius = 0.0;
+        int level = 0;              // Simplification level of the rings; -1 = every point
+    };
+    
+    void DrawCurve(size_t index, double maxError);
+    bool DrawTube(size_t index);
     void DrawAxes();
     void DrawGrid();
     void DrawAnimationMarkers();
-    void DrawSphere(const Point3D& center, float radius, const Color& color);
+    void SyncTrail();
+    void DrawTrails();
+    void UploadCurveBuffers();
+    LineRenderer::AttributeColoring GetAttributeColoring(const LoadedParametricCurve3D& curve) const;
+    void ReleaseCurveBuffers();
+    GLsizei GetAnimationDrawCount(size_t index) const;
+    double GetPixelsPerUnit() const;
+    double GetLodWorldTolerance() const;
+    double GetTubeRadius() const;
+    int GetTubeRadialSegments() const;
+    int GetTubeLevel(size_t index) const;
+    void RequestTubeMeshes();
+    void UploadTubeMesh(TubeBuffer& buffer, const TubeMesh& mesh);
+    void ReleaseTubeBuffers();
     void UpdateBounds();
+    void ApplySceneBounds();
     void SetupCamera();
+    void UpdateAnimationRange();
+    void SyncAnimationPosition();
+    double GetCurveAnimationIndex(const LoadedParametricCurve3D& curve) const;
+    Point3D GetCurvePointAt(const LoadedParametricCurve3D& curve, double index) const;
+    const LoadedParametricCurve3D* GetLongestCurve() const;
+    double GetLongestCurveIndex() const;
 
     std::vector<std::unique_ptr<LoadedParametricCurve3D>> curves_;
+    std::vector<CurveBuffer> curveBuffers_;     // Parallel to curves_; filled in paintGL
+    LineRenderer lineRenderer_;                 // Curves and axes as instanced wide lines
+    CurveColoring curveColoring_;
+    LineRenderer::Colormap colormap_;
+    std::vector<float> lineVertices_;           // Scratch space for axis and grid segments
+    
+    // Tubes are built one curve at a time; the generation discards builds
+    // started before the curves were cleared
+    bool tubeMode_;
+    std::vector<TubeBuffer> tubeBuffers_;       // Parallel to curves_ in tube mode
+    QFutureWatcher<std::shared_ptr<TubeMesh>>* tubeWatcher_;
+    size_t tubeBuildCurve_;
+    int tubeBuildLevel_;
+    unsigned tubeGeneration_;
+    unsigned tubeBuildGeneration_;
+    bool glInitialized_;
+    
+    static constexpr size_t UPLOAD_CHUNK_POINTS = 1 << 20;
+    
+    // Maximum screen distance (pixels) between a simplified curve and the full one
+    static constexpr double LOD_PIXEL_TOLERANCE = 0.5;
+    
+    static constexpr float FIELD_OF_VIEW = 45.0f;
+    static constexpr float NEAR_PLANE = 0.1f;
+    
+    static constexpr float GRID_LINE_WIDTH = 1.0f;
+    
+    // Tube radius per unit of line width, as a fraction of the scene radius
+    static constexpr double TUBE_RADIUS_PER_LINE_WIDTH = 0.0025;
+    // Largest distance between the rings' centerline and the curve, in tube radii
+    static constexpr double TUBE_RING_TOLERANCE = 0.25;
+    // Radial segment counts to choose from; the fewest whose facets stay within
+    // LOD_PIXEL_TOLERANCE of the true circle on screen is used
+    static constexpr int TUBE_SEGMENT_STEPS[] = { 4, 6, 8, 12, 16, 24, 32 };
     
     // Camera parameters
     QMatrix4x4 projectionMatrix_;
@@ -95,6 +204,8 @@ private:
     bool isPanning_;
     
     // Scene bounds
+    Bounds3D sceneBounds_;
+    Bounds3D loadedBounds_;     // Every loaded curve, visible or not; sizes the tubes
     double xMin_, xMax_;
     double yMin_, yMax_;
     double zMin_, zMax_;
@@ -104,12 +215,24 @@ private:
     float lineWidth_;
     
     // Animation
-    QTimer* animationTimer_;
+    AnimationClock animationClock_;
+    AnimationMode animationMode_;
+    double animationPosition_;      // Fractional point index, or t in Time mode
     bool animationRunning_;
     size_t currentAnimationFrame_;
     size_t maxAnimationFrames_;
     double animationSpeed_;
     AnimationCallback animationCallback_;
+    
+    // Trails: marker positions of the last trailLength_ animated frames in a GPU
+    // ring, one row per frame in which the animation moved
+    bool showTrails_;
+    int trailLength_;
+    LineRenderer::Trail trail_;
+    double trailPosition_;          // animationPosition_ of the newest row
+    bool trailRebuild_;             // Curves or length changed
+    bool trailColorsDirty_;         // Visibility changed
+    std::vector<float> trailRow_;
 };
 
 #endif // GL_WIDGET_H
@@ -0,0 +1,615 @@
+#include "LineRenderer.h"
+#include <QOpenGLContext>
+#include <QVector2D>
+#include <QVector3D>
+#include <GL/gl.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Attribute locations shared by the shader and the buffer setup
+constexpr GLuint ATTR_CORNER = 0;
+constexpr GLuint ATTR_PREV = 1;
+constexpr GLuint ATTR_START = 2;
+constexpr GLuint ATTR_END = 3;
+constexpr GLuint ATTR_NEXT = 4;
+constexpr GLuint ATTR_START_VALUES = 5;
+constexpr GLuint ATTR_END_VALUES = 6;
+constexpr GLuint ATTR_SEGMENT_COLOR = 7;
+
+// Colormap control points (RGB, 0-255), evenly spaced; rows of the colormap
+// texture in LineRenderer::Colormap order
+constexpr int COLORMAP_STOPS = 9;
+const unsigned char COLORMAP_DATA[][COLORMAP_STOPS][3] = {
+    // Viridis
+    { {68, 1, 84}, {71, 44, 122}, {59, 81, 139}, {44, 113, 142}, {33, 144, 141},
+      {39, 173, 129}, {92, 200, 99}, {170, 220, 50}, {253, 231, 37} },
+    // Plasma
+    { {13, 8, 135}, {76, 2, 161}, {126, 3, 168}, {169, 35, 149}, {204, 71, 120},
+      {230, 108, 92}, {248, 149, 64}, {253, 197, 39}, {240, 249, 33} },
+    // Cool-warm (diverging)
+    { {59, 76, 192}, {98, 130, 234}, {141, 176, 254}, {184, 208, 249}, {221, 221, 221},
+      {245, 196, 173}, {244, 154, 123}, {222, 96, 77}, {180, 4, 38} },
+    // Grayscale
+    { {0, 0, 0}, {32, 32, 32}, {64, 64, 64}, {96, 96, 96}, {128, 128, 128},
+      {159, 159, 159}, {191, 191, 191}, {223, 223, 223}, {255, 255, 255} },
+};
+static_assert(sizeof(COLORMAP_DATA) / sizeof(COLORMAP_DATA[0]) == static_cast<size_t>(LineRenderer::Colormap::Count),
+              "one row of control points per colormap");
+
+// Expands one segment (an instance) into a quad in screen space. Miter ends are
+// pushed along the bisector with the neighbouring segment; round ends extend the
+// quad by half a width so the fragment shader can cut a capsule out of it.
+const char* VERTEX_SHADER = R"(
+#version 120
+attribute vec2 corner;          // x: 0 at the segment start, 1 at its end; y: side (-1/+1)
+attribute vec3 prevPoint;
+attribute vec3 startPoint;
+attribute vec3 endPoint;
+attribute vec3 nextPoint;
+attribute vec3 startValues;     // Attribute channels at both ends of the segment
+attribute vec3 endValues;
+attribute vec4 segmentColor;    // Per-segment RGBA, when colorPerSegment is set
+uniform mat4 matrix;
+uniform vec2 viewport;          // Device pixels
+uniform float halfWidth;        // Device pixels, including the antialiased fringe
+uniform float miterLimit;
+uniform bool roundJoins;
+uniform vec3 channelMask;       // Selects the coloring channel
+varying vec2 lineCoord;         // Pixels along the segment from its start, and across from its center
+varying float segmentLength;
+varying float startValue;
+varying float endValue;
+varying vec4 segmentRgba;
+
+vec2 ToScreen(vec4 clip) {
+    return (clip.xy / clip.w * 0.5 + 0.5) * viewport;
+}
+
+void main() {
+    startValue = dot(startValues, channelMask);
+    endValue = dot(endValues, channelMask);
+    segmentRgba = segmentColor;
+
+    vec4 clipStart = matrix * vec4(startPoint, 1.0);
+    vec4 clipEnd = matrix * vec4(endPoint, 1.0);
+    vec2 screenStart = ToScreen(clipStart);
+    vec2 screenEnd = ToScreen(clipEnd);
+
+    vec2 dir = screenEnd - screenStart;
+    segmentLength = length(dir);
+    dir = segmentLength > 1e-4 ? dir / segmentLength : vec2(1.0, 0.0);
+    vec2 normal = vec2(-dir.y, dir.x);
+
+    bool atEnd = corner.x > 0.5;
+    vec4 clip = atEnd ? clipEnd : clipStart;
+    vec2 base = atEnd ? screenEnd : screenStart;
+    vec2 offset;
+
+    if (roundJoins) {
+        offset = (atEnd ? dir : -dir) * halfWidth + normal * corner.y * halfWidth;
+    } else {
+        // A missing neighbour (repeated end point) leaves a butt end
+        vec2 neighbour = ToScreen(matrix * vec4(atEnd ? nextPoint : prevPoint, 1.0));
+        vec2 other = atEnd ? neighbour - screenEnd : screenStart - neighbour;
+        vec2 miter = normal;
+        float scale = 1.0;
+        float otherLength = length(other);
+        if (otherLength > 1e-4) {
+            vec2 otherDir = other / otherLength;
+            vec2 bisector = normal + vec2(-otherDir.y, otherDir.x);
+            float bisectorLength = length(bisector);
+            if (bisectorLength > 1e-4) {
+                bisector /= bisectorLength;
+                float cosHalfAngle = dot(bisector, normal);
+                if (cosHalfAngle > 1.0 / miterLimit) {
+                    miter = bisector;
+                    scale = 1.0 / cosHalfAngle;
+                }
+            }
+        }
+        offset = miter * corner.y * halfWidth * scale;
+    }
+
+    vec2 screen = base + offset;
+    lineCoord = vec2(dot(screen - screenStart, dir), dot(screen - screenStart, normal));
+    gl_Position = vec4((screen / viewport * 2.0 - 1.0) * clip.w, clip.z, clip.w);
+}
+)";
+
+const char* FRAGMENT_SHADER = R"(
+#version 120
+uniform vec3 color;
+uniform float halfWidth;
+uniform float fringe;           // Antialiased edge width in device pixels; 0 for hard edges
+uniform bool roundJoins;
+uniform bool colorByAttribute;
+uniform bool colorPerSegment;
+uniform sampler2D colormap;
+uniform float colormapRow;      // Texture coordinate of the colormap's row
+uniform vec2 valueRange;        // Values mapped to the two ends of the colormap
+varying vec2 lineCoord;
+varying float segmentLength;
+varying float startValue;
+varying float endValue;
+varying vec4 segmentRgba;
+
+void main() {
+    float dist = abs(lineCoord.y);
+    if (roundJoins) {
+        float along = max(max(-lineCoord.x, lineCoord.x - segmentLength), 0.0);
+        dist = length(vec2(along, lineCoord.y));
+    }
+    float alpha = fringe > 0.0 ? clamp((halfWidth - dist) / fringe, 0.0, 1.0)
+                               : step(dist, halfWidth);
+    if (alpha <= 0.0) discard;
+
+    vec3 rgb = color;
+    if (colorPerSegment) {
+        rgb = segmentRgba.rgb;
+        alpha *= segmentRgba.a;
+    }
+    if (colorByAttribute) {
+        float value = mix(startValue, endValue, clamp(lineCoord.x / max(segmentLength, 1e-4), 0.0, 1.0));
+        float u = clamp((value - valueRange.x) / max(valueRange.y - valueRange.x, 1e-30), 0.0, 1.0);
+        rgb = texture2D(colormap, vec2((u * 255.0 + 0.5) / 256.0, colormapRow)).rgb;
+    }
+    gl_FragColor = vec4(rgb, alpha);
+}
+)";
+
+} // namespace
+
+LineRenderer::LineRenderer()
+    : initialized_(false)
+    , devicePixelRatio_(1.0)
+    , cornerVbo_(0)
+    , streamVbo_(0)
+    , colormapTexture_(0)
+{
+}
+
+LineRenderer::~LineRenderer() {
+    // Buffers must be released by the owner via Cleanup() while its context is current
+}
+
+void LineRenderer::Initialize(qreal devicePixelRatio) {
+    initializeOpenGLFunctions();
+    Cleanup();
+
+    devicePixelRatio_ = devicePixelRatio > 0 ? devicePixelRatio : 1.0;
+
+    // Instanced attributes need OpenGL 3.3; older contexts keep glLineWidth
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    bool instancing = context && !context->isOpenGLES() &&
+                      context->format().version() >= qMakePair(3, 3);
+    if (instancing) {
+        program_ = std::make_unique<QOpenGLShaderProgram>();
+        program_->addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+        program_->addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+        program_->bindAttributeLocation("corner", ATTR_CORNER);
+        program_->bindAttributeLocation("prevPoint", ATTR_PREV);
+        program_->bindAttributeLocation("startPoint", ATTR_START);
+        program_->bindAttributeLocation("endPoint", ATTR_END);
+        program_->bindAttributeLocation("nextPoint", ATTR_NEXT);
+        program_->bindAttributeLocation("startValues", ATTR_START_VALUES);
+        program_->bindAttributeLocation("endValues", ATTR_END_VALUES);
+        program_->bindAttributeLocation("segmentColor", ATTR_SEGMENT_COLOR);
+        if (!program_->link()) {
+            program_.reset();
+        }
+    }
+
+    if (program_) {
+        const float corners[] = { 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f };
+        glGenBuffers(1, &cornerVbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, cornerVbo_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        CreateColormapTexture();
+    }
+    glGenBuffers(1, &streamVbo_);
+
+    initialized_ = true;
+}
+
+void LineRenderer::Cleanup() {
+    if (cornerVbo_ != 0) {
+        glDeleteBuffers(1, &cornerVbo_);
+        cornerVbo_ = 0;
+    }
+    if (streamVbo_ != 0) {
+        glDeleteBuffers(1, &streamVbo_);
+        streamVbo_ = 0;
+    }
+    if (colormapTexture_ != 0) {
+        glDeleteTextures(1, &colormapTexture_);
+        colormapTexture_ = 0;
+    }
+    program_.reset();
+    initialized_ = false;
+}
+
+LineRenderer::Strip LineRenderer::CreateStrip(size_t numPoints) {
+    Strip strip;
+    strip.numPoints = static_cast<GLsizei>(numPoints);
+    glGenBuffers(1, &strip.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, strip.vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>((numPoints + 2) * POINT_BYTES), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return strip;
+}
+
+void LineRenderer::UploadStripPoints(const Strip& strip, size_t firstPoint, const float* xyz, size_t count) {
+    if (strip.vbo == 0 || count == 0) return;
+    size_t numPoints = static_cast<size_t>(strip.numPoints);
+    count = std::min(count, numPoints - std::min(firstPoint, numPoints));
+    if (count == 0) return;
+
+    // Point k lives in slot k + 1; slots 0 and numPoints + 1 repeat the end points
+    glBindBuffer(GL_ARRAY_BUFFER, strip.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>((firstPoint + 1) * POINT_BYTES),
+                    static_cast<GLsizeiptr>(count * POINT_BYTES), xyz);
+    if (firstPoint == 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, POINT_BYTES, xyz);
+    }
+    if (firstPoint + count == numPoints) {
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>((numPoints + 1) * POINT_BYTES),
+                        POINT_BYTES, xyz + 3 * (count - 1));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LineRenderer::UploadStripAttributes(Strip& strip, size_t firstPoint, const float* values, size_t count) {
+    if (strip.vbo == 0 || count == 0) return;
+    size_t numPoints = static_cast<size_t>(strip.numPoints);
+    count = std::min(count, numPoints - std::min(firstPoint, numPoints));
+    if (count == 0) return;
+
+    if (strip.attributeVbo == 0) {
+        glGenBuffers(1, &strip.attributeVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, strip.attributeVbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>((numPoints + 2) * ATTRIBUTE_BYTES),
+                     nullptr, GL_STATIC_DRAW);
+    }
+
+    // Same slot layout as the points
+    glBindBuffer(GL_ARRAY_BUFFER, strip.attributeVbo);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>((firstPoint + 1) * ATTRIBUTE_BYTES),
+                    static_cast<GLsizeiptr>(count * ATTRIBUTE_BYTES), values);
+    if (firstPoint == 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, ATTRIBUTE_BYTES, values);
+    }
+    if (firstPoint + count == numPoints) {
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>((numPoints + 1) * ATTRIBUTE_BYTES),
+                        ATTRIBUTE_BYTES, values + ATTRIBUTE_CHANNELS * (count - 1));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LineRenderer::ReleaseStrip(Strip& strip) {
+    if (strip.vbo != 0) {
+        glDeleteBuffers(1, &strip.vbo);
+    }
+    if (strip.attributeVbo != 0) {
+        glDeleteBuffers(1, &strip.attributeVbo);
+    }
+    strip = Strip();
+}
+
+LineRenderer::Trail LineRenderer::CreateTrail(size_t numObjects, size_t length) {
+    Trail trail;
+    trail.numObjects = static_cast<GLsizei>(numObjects);
+    trail.length = static_cast<GLsizei>(std::max<size_t>(length, 2));
+    size_t rows = static_cast<size_t>(trail.length);
+
+    glGenBuffers(1, &trail.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, trail.vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(2 * rows * numObjects * POINT_BYTES), nullptr, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &trail.colorVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, trail.colorVbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>((rows - 1) * numObjects * COLOR_BYTES), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return trail;
+}
+
+void LineRenderer::SetTrailColors(const Trail& trail, const float* rgba) {
+    if (trail.colorVbo == 0 || trail.numObjects == 0) return;
+
+    // Segment row s joins positions s and s + 1 of the window, oldest first
+    size_t numObjects = static_cast<size_t>(trail.numObjects);
+    size_t segmentRows = static_cast<size_t>(trail.length - 1);
+    std::vector<unsigned char> colors(segmentRows * numObjects * COLOR_BYTES);
+    for (size_t s = 0; s < segmentRows; ++s) {
+        float fade = static_cast<float>(s + 1) / static_cast<float>(segmentRows);
+        unsigned char* row = &colors[s * numObjects * COLOR_BYTES];
+        for (size_t o = 0; o < numObjects; ++o) {
+            const float* c = rgba + 4 * o;
+            row[4 * o + 0] = static_cast<unsigned char>(std::lround(255.0f * std::clamp(c[0], 0.0f, 1.0f)));
+            row[4 * o + 1] = static_cast<unsigned char>(std::lround(255.0f * std::clamp(c[1], 0.0f, 1.0f)));
+            row[4 * o + 2] = static_cast<unsigned char>(std::lround(255.0f * std::clamp(c[2], 0.0f, 1.0f)));
+            row[4 * o + 3] = static_cast<unsigned char>(std::lround(255.0f * std::clamp(c[3], 0.0f, 1.0f) * fade));
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, trail.colorVbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(colors.size()), colors.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LineRenderer::PushTrailRow(Trail& trail, const float* xyz) {
+    if (trail.vbo == 0 || trail.numObjects == 0) return;
+
+    trail.head = trail.numRows == 0 ? 0 : (trail.head + 1) % trail.length;
+    trail.numRows = std::min(trail.numRows + 1, trail.length);
+
+    // Row r also lives at r + length, so the window ending at head + length never wraps
+    GLsizeiptr rowBytes = static_cast<GLsizeiptr>(trail.numObjects) * POINT_BYTES;
+    glBindBuffer(GL_ARRAY_BUFFER, trail.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, trail.head * rowBytes, rowBytes, xyz);
+    glBufferSubData(GL_ARRAY_BUFFER, (trail.head + trail.length) * rowBytes, rowBytes, xyz);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LineRenderer::ReleaseTrail(Trail& trail) {
+    if (trail.vbo != 0) {
+        glDeleteBuffers(1, &trail.vbo);
+    }
+    if (trail.colorVbo != 0) {
+        glDeleteBuffers(1, &trail.colorVbo);
+    }
+    trail = Trail();
+}
+
+void LineRenderer::DrawTrail(const Trail& trail, const Style& style) {
+    if (!initialized_ || !program_ || trail.vbo == 0 || trail.numRows < 2) return;
+
+    // Window of the newest numRows rows; the segment colors line up with its end
+    GLintptr rowBytes = static_cast<GLintptr>(trail.numObjects) * POINT_BYTES;
+    GLintptr first = (trail.head + trail.length - trail.numRows + 1) * rowBytes;
+    GLintptr colorOffset = static_cast<GLintptr>(trail.length - trail.numRows) * trail.numObjects * COLOR_BYTES;
+    GLsizei numSegments = (trail.numRows - 1) * trail.numObjects;
+
+    // A segment's neighbours are its own end points, which gives butt ends
+    DrawInstanced(trail.vbo, POINT_BYTES, first, first, first + rowBytes, first + rowBytes,
+                  numSegments, style, 0.0f, 0.0f, 0.0f, 0, 0, nullptr, trail.colorVbo, colorOffset);
+}
+
+void LineRenderer::DrawStrip(const Strip& strip, const Style& style, float r, float g, float b,
+                             GLsizei first, GLsizei count) {
+    if (!initialized_ || strip.vbo == 0 || first < 0 || first >= strip.numPoints) return;
+    if (count < 0 || count > strip.numPoints - first) count = strip.numPoints - first;
+    if (count < 2) return;
+
+    if (program_) {
+        GLintptr base = static_cast<GLintptr>(first) * POINT_BYTES;
+        DrawInstanced(strip.vbo, POINT_BYTES, base, base + POINT_BYTES, base + 2 * POINT_BYTES,
+                      base + 3 * POINT_BYTES, count - 1, style, r, g, b);
+    } else {
+        DrawFixedFunction(strip.vbo, static_cast<GLintptr>(first + 1) * POINT_BYTES,
+                          GL_LINE_STRIP, count, style, r, g, b);
+    }
+}
+
+void LineRenderer::DrawStrip(const Strip& strip, const Style& style, const AttributeColoring& coloring,
+                             GLsizei first, GLsizei count) {
+    if (!initialized_ || strip.vbo == 0 || first < 0 || first >= strip.numPoints) return;
+    if (count < 0 || count > strip.numPoints - first) count = strip.numPoints - first;
+    if (count < 2) return;
+
+    const unsigned char* middle = COLORMAP_DATA[static_cast<int>(coloring.colormap)][COLORMAP_STOPS / 2];
+    if (!program_ || strip.attributeVbo == 0) {
+        DrawStrip(strip, style, middle[0] / 255.0f, middle[1] / 255.0f, middle[2] / 255.0f, first, count);
+        return;
+    }
+
+    GLintptr base = static_cast<GLintptr>(first) * POINT_BYTES;
+    DrawInstanced(strip.vbo, POINT_BYTES, base, base + POINT_BYTES, base + 2 * POINT_BYTES,
+                  base + 3 * POINT_BYTES, count - 1, style, 0.0f, 0.0f, 0.0f,
+                  strip.attributeVbo, static_cast<GLintptr>(first + 1) * ATTRIBUTE_BYTES, &coloring);
+}
+
+void LineRenderer::DrawStrip(const std::vector<float>& xyz, const Style& style, float r, float g, float b) {
+    GLsizei numPoints = static_cast<GLsizei>(xyz.size() / 3);
+    if (!initialized_ || numPoints < 2) return;
+
+    FillStreamBuffer(xyz, true);
+    if (program_) {
+        DrawInstanced(streamVbo_, POINT_BYTES, 0, POINT_BYTES, 2 * POINT_BYTES, 3 * POINT_BYTES,
+                      numPoints - 1, style, r, g, b);
+    } else {
+        DrawFixedFunction(streamVbo_, POINT_BYTES, GL_LINE_STRIP, numPoints, style, r, g, b);
+    }
+}
+
+void LineRenderer::DrawSegments(const std::vector<float>& xyz, const Style& style, float r, float g, float b) {
+    GLsizei numSegments = static_cast<GLsizei>(xyz.size() / 6);
+    if (!initialized_ || numSegments < 1) return;
+
+    // Each segment is its own neighbour on both sides, which gives butt ends
+    FillStreamBuffer(xyz, false);
+    if (program_) {
+        DrawInstanced(streamVbo_, 2 * POINT_BYTES, 0, 0, POINT_BYTES, POINT_BYTES,
+                      numSegments, style, r, g, b);
+    } else {
+        DrawFixedFunction(streamVbo_, 0, GL_LINES, 2 * numSegments, style, r, g, b);
+    }
+}
+
+void LineRenderer::FillStreamBuffer(const std::vector<float>& xyz, bool padEnds) {
+    size_t bytes = xyz.size() * sizeof(float);
+    size_t total = padEnds ? bytes + 2 * POINT_BYTES : bytes;
+
+    // Orphan the previous contents so the driver doesn't wait for earlier draws
+    glBindBuffer(GL_ARRAY_BUFFER, streamVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(total), nullptr, GL_STREAM_DRAW);
+    if (padEnds) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, POINT_BYTES, xyz.data());
+        glBufferSubData(GL_ARRAY_BUFFER, POINT_BYTES, static_cast<GLsizeiptr>(bytes), xyz.data());
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(POINT_BYTES + bytes), POINT_BYTES,
+                        xyz.data() + xyz.size() - 3);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), xyz.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LineRenderer::DrawInstanced(GLuint vbo, GLsizei stride, GLintptr prevOffset, GLintptr startOffset,
+                                 GLintptr endOffset, GLintptr nextOffset, GLsizei numSegments,
+                                 const Style& style, float r, float g, float b,
+                                 GLuint attributeVbo, GLintptr attributeOffset,
+                                 const AttributeColoring* coloring,
+                                 GLuint colorVbo, GLintptr colorOffset) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] <= 0 || viewport[3] <= 0) return;
+
+    float fringe = style.antialias ? FRINGE_PIXELS : 0.0f;
+    float halfWidth = 0.5f * style.width * static_cast<float>(devicePixelRatio_) + 0.5f * fringe;
+
+    program_->bind();
+    program_->setUniformValue("matrix", matrix_);
+    program_->setUniformValue("viewport", QVector2D(viewport[2], viewport[3]));
+    program_->setUniformValue("halfWidth", halfWidth);
+    program_->setUniformValue("fringe", fringe);
+    program_->setUniformValue("miterLimit", MITER_LIMIT);
+    program_->setUniformValue("roundJoins", style.join == JoinStyle::Round);
+    program_->setUniformValue("color", QVector3D(r, g, b));
+    program_->setUniformValue("colorByAttribute", coloring != nullptr);
+    program_->setUniformValue("colorPerSegment", colorVbo != 0);
+    if (coloring) {
+        QVector3D mask;
+        mask[std::clamp(coloring->channel, 0, ATTRIBUTE_CHANNELS - 1)] = 1.0f;
+        int numColormaps = static_cast<int>(Colormap::Count);
+        float row = (static_cast<float>(coloring->colormap) + 0.5f) / static_cast<float>(numColormaps);
+        program_->setUniformValue("channelMask", mask);
+        program_->setUniformValue("valueRange", QVector2D(coloring->minValue, coloring->maxValue));
+        program_->setUniformValue("colormapRow", row);
+        program_->setUniformValue("colormap", 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colormapTexture_);
+    }
+
+    GLboolean blendEnabled = glIsEnabled(GL_BLEND);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Per-vertex quad corner
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVbo_);
+    glEnableVertexAttribArray(ATTR_CORNER);
+    glVertexAttribPointer(ATTR_CORNER, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    // Per-instance segment and its neighbours, all read from the same point buffer
+    const GLuint attributes[] = { ATTR_PREV, ATTR_START, ATTR_END, ATTR_NEXT };
+    const GLintptr offsets[] = { prevOffset, startOffset, endOffset, nextOffset };
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    for (int k = 0; k < 4; ++k) {
+        glEnableVertexAttribArray(attributes[k]);
+        glVertexAttribPointer(attributes[k], 3, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<const void*>(offsets[k]));
+        glVertexAttribDivisor(attributes[k], 1);
+    }
+
+    // Attribute channels at the segment's start and end
+    const GLuint valueAttributes[] = { ATTR_START_VALUES, ATTR_END_VALUES };
+    if (coloring) {
+        glBindBuffer(GL_ARRAY_BUFFER, attributeVbo);
+        for (int k = 0; k < 2; ++k) {
+            glEnableVertexAttribArray(valueAttributes[k]);
+            glVertexAttribPointer(valueAttributes[k], ATTRIBUTE_CHANNELS, GL_FLOAT, GL_FALSE, ATTRIBUTE_BYTES,
+                                  reinterpret_cast<const void*>(attributeOffset + k * ATTRIBUTE_BYTES));
+            glVertexAttribDivisor(valueAttributes[k], 1);
+        }
+    }
+
+    // Per-instance RGBA
+    if (colorVbo != 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, colorVbo);
+        glEnableVertexAttribArray(ATTR_SEGMENT_COLOR);
+        glVertexAttribPointer(ATTR_SEGMENT_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, COLOR_BYTES,
+                              reinterpret_cast<const void*>(colorOffset));
+        glVertexAttribDivisor(ATTR_SEGMENT_COLOR, 1);
+    }
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, numSegments);
+
+    for (int k = 0; k < 4; ++k) {
+        glVertexAttribDivisor(attributes[k], 0);
+        glDisableVertexAttribArray(attributes[k]);
+    }
+    if (coloring) {
+        for (int k = 0; k < 2; ++k) {
+            glVertexAttribDivisor(valueAttributes[k], 0);
+            glDisableVertexAttribArray(valueAttributes[k]);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (colorVbo != 0) {
+        glVertexAttribDivisor(ATTR_SEGMENT_COLOR, 0);
+        glDisableVertexAttribArray(ATTR_SEGMENT_COLOR);
+    }
+    glDisableVertexAttribArray(ATTR_CORNER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!blendEnabled) glDisable(GL_BLEND);
+    program_->release();
+}
+
+void LineRenderer::SampleColormap(Colormap colormap, float t, unsigned char rgb[3]) {
+    int map = static_cast<int>(colormap);
+    float x = std::clamp(t, 0.0f, 1.0f) * (COLORMAP_STOPS - 1);
+    int k = std::min(static_cast<int>(x), COLORMAP_STOPS - 2);
+    float frac = x - static_cast<float>(k);
+    for (int c = 0; c < 3; ++c) {
+        float a = COLORMAP_DATA[map][k][c];
+        float b = COLORMAP_DATA[map][k + 1][c];
+        rgb[c] = static_cast<unsigned char>(std::lround(a + frac * (b - a)));
+    }
+}
+
+void LineRenderer::CreateColormapTexture() {
+    // Every colormap is resampled to COLORMAP_SIZE texels and stored as one row
+    const int numColormaps = static_cast<int>(Colormap::Count);
+    std::vector<unsigned char> texels(static_cast<size_t>(numColormaps) * COLORMAP_SIZE * 4);
+    for (int map = 0; map < numColormaps; ++map) {
+        for (int i = 0; i < COLORMAP_SIZE; ++i) {
+            unsigned char* texel = &texels[(static_cast<size_t>(map) * COLORMAP_SIZE + i) * 4];
+            SampleColormap(static_cast<Colormap>(map), static_cast<float>(i) / (COLORMAP_SIZE - 1), texel);
+            texel[3] = 255;
+        }
+    }
+
+    glGenTextures(1, &colormapTexture_);
+    glBindTexture(GL_TEXTURE_2D, colormapTexture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, COLORMAP_SIZE, numColormaps, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void LineRenderer::DrawFixedFunction(GLuint vbo, GLintptr offset, GLenum mode, GLsizei count,
+                                     const Style& style, float r, float g, float b) {
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadMatrixf(matrix_.constData());
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glLineWidth(style.width);
+    glColor3f(r, g, b);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, reinterpret_cast<const void*>(offset));
+    glDrawArrays(mode, 0, count);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+}
@@ -8,6 +8,10 @@
 #include <stdexcept>
 #include <cmath>
 #include <functional>
+#include <limits>
+#include "CurveLodIndex.h"
+#include "ArcLengthTable.h"
+#include "CurveAttributes.h"
 
 // Structure to represent a 3D point
 struct Point3D {
@@ -52,6 +56,30 @@ inline Color GetColorByIndex(int index) {
     return palette[index % palette.size()];
 }
 
+// Axis-aligned bounding box, grown point by point or box by box
+struct Bounds3D {
+    double xMin = std::numeric_limits<double>::infinity();
+    double xMax = -std::numeric_limits<double>::infinity();
+    double yMin = std::numeric_limits<double>::infinity();
+    double yMax = -std::numeric_limits<double>::infinity();
+    double zMin = std::numeric_limits<double>::infinity();
+    double zMax = -std::numeric_limits<double>::infinity();
+    
+    bool IsEmpty() const { return xMin > xMax; }
+    
+    void Add(double x, double y, double z) {
+        xMin = std::min(xMin, x); xMax = std::max(xMax, x);
+        yMin = std::min(yMin, y); yMax = std::max(yMax, y);
+        zMin = std::min(zMin, z); zMax = std::max(zMax, z);
+    }
+    
+    void Add(const Bounds3D& other) {
+        if (other.IsEmpty()) return;
+        Add(other.xMin, other.yMin, other.zMin);
+        Add(other.xMax, other.yMax, other.zMax);
+    }
+};
+
 // Class representing a 3D parametric curve
 class LoadedParametricCurve3D {
 public:
@@ -63,6 +91,7 @@ public:
         xVals_.push_back(x);
         yVals_.push_back(y);
         zVals_.push_back(z);
+        bounds_.Add(x, y, z);
     }
     
     const std::string& GetName() const { return name_; }
@@ -99,22 +128,39 @@ public:
         return tVals_[i];
     }
     
-    // Get bounding box
+    // Simplification levels (world units); call once all points are added
+    void BuildLodIndex() {
+        lodIndex_.Build({xVals_.data(), yVals_.data(), zVals_.data()}, {1.0, 1.0, 1.0}, tVals_.size());
+    }
+    const CurveLodIndex<3>& GetLodIndex() const { return lodIndex_; }
+    
+    // Cumulative arc length, for constant-speed animation; call once all points are added
+    void BuildArcLengthTable() {
+        arcLength_.Build({xVals_.data(), yVals_.data(), zVals_.data()}, tVals_.size());
+    }
+    const ArcLengthTable<3>& GetArcLengthTable() const { return arcLength_; }
+    
+    // Parameter, speed and curvature per point, for coloring; call once all points are added
+    void BuildAttributes() {
+        attributes_.Build(tVals_.data(), {xVals_.data(), yVals_.data(), zVals_.data()}, tVals_.size());
+    }
+    const CurveAttributes<3>& GetAttributes() const { return attributes_; }
+    
+    // Bounding box, maintained as points are added
+    const Bounds3D& GetBounds() const { return bounds_; }
+    
     void GetBounds(double& xMin, double& xMax, 
                    double& yMin, double& yMax,
                    double& zMin, double& zMax) const {
-        if (xVals_.empty()) {
+        if (bounds_.IsEmpty()) {
             xMin = yMin = zMin = -1.0;
             xMax = yMax = zMax = 1.0;
             return;
         }
         
-        xMin = *std::min_element(xVals_.begin(), xVals_.end());
-        xMax = *std::max_element(xVals_.begin(), xVals_.end());
-        yMin = *std::min_element(yVals_.begin(), yVals_.end());
-        yMax = *std::max_element(yVals_.begin(), yVals_.end());
-        zMin = *std::min_element(zVals_.begin(), zVals_.end());
-        zMax = *std::max_element(zVals_.begin(), zVals_.end());
+        xMin = bounds_.xMin; xMax = bounds_.xMax;
+        yMin = bounds_.yMin; yMax = bounds_.yMax;
+        zMin = bounds_.zMin; zMax = bounds_.zMax;
     }
     
 private:
@@ -124,6 +170,10 @@ private:
     std::vector<double> xVals_;
     std::vector<double> yVals_;
     std::vector<double> zVals_;
+    Bounds3D bounds_;
+    CurveLodIndex<3> lodIndex_;
+    ArcLengthTable<3> arcLength_;
+    CurveAttributes<3> attributes_;
     bool visible_;
     Color color_;
 };
@@ -73,5 +73,11 @@ std::unique_ptr<LoadedParametricCurve3D> ParseParametricCurve3D(const std::strin
         throw std::runtime_error("No data points found in file");
     }
     
+    // Simplification levels, the arc-length table and coloring attributes are
+    // built once, at load time
+    curve->BuildLodIndex();
+    curve->BuildArcLengthTable();
+    curve->BuildAttributes();
+    
     return curve;
 }
@@ -9,9 +9,25 @@
 #include <QGroupBox>
 #include <QStatusBar>
 #include <QScrollArea>
-#include <QIntValidator>
+#include <QDoubleValidator>
+#include <QElapsedTimer>
+#include <QApplication>
 #include <sstream>
 #include <iomanip>
+#include "TrajectoryDifference.h"
+
+namespace {
+
+// Unit of the animation speed in each mode
+QString SpeedUnit(GLWidget::AnimationMode mode) {
+    switch (mode) {
+        case GLWidget::AnimationMode::Time: return "t/sec";
+        case GLWidget::AnimationMode::ArcLength: return "length/sec";
+        default: return "pts/sec";
+    }
+}
+
+} // namespace
 
 MainWindow::MainWindow(const std::vector<std::string>& filenames, QWidget *parent)
     : QMainWindow(parent)
@@ -27,10 +43,17 @@ MainWindow::MainWindow(const std::vector<std::string>& filenames, QWidget *paren
     mainLayout->setContentsMargins(5, 5, 5, 5);
     mainLayout->setSpacing(5);
     
-    // Left side: OpenGL widget
-    glWidget_ = new GLWidget(this);
+    // Left side: OpenGL widget, with the trajectory difference pane below it
+    QSplitter* plotSplitter = new QSplitter(Qt::Vertical, this);
+    glWidget_ = new GLWidget(plotSplitter);
     glWidget_->setMinimumSize(640, 480);
-    mainLayout->addWidget(glWidget_, 1);
+    diffPlot_ = new DifferencePlotWidget(plotSplitter);
+    diffPlot_->hide();
+    plotSplitter->addWidget(glWidget_);
+    plotSplitter->addWidget(diffPlot_);
+    plotSplitter->setStretchFactor(0, 3);
+    plotSplitter->setStretchFactor(1, 1);
+    mainLayout->addWidget(plotSplitter, 1);
     
     // Right side: Sidebar
     CreateSidebar();
@@ -102,6 +125,26 @@ void MainWindow::CreateSidebar() {
     lineWidthLayout->addStretch();
     displayLayout->addLayout(lineWidthLayout);
     
+    // Tubes are as thick as the line width setting
+    tubeModeCheckbox_ = new QCheckBox("Draw curves as tubes", displayGroup_);
+    displayLayout->addWidget(tubeModeCheckbox_);
+    
+    // Color by a per-point attribute through a colormap
+    QHBoxLayout* coloringLayout = new QHBoxLayout();
+    coloringLayout->addWidget(new QLabel("Color by:", displayGroup_));
+    coloringCombo_ = new QComboBox(displayGroup_);
+    coloringCombo_->addItems({ "Curve color", "Parameter t", "Speed", "Curvature" });
+    coloringLayout->addWidget(coloringCombo_, 1);
+    displayLayout->addLayout(coloringLayout);
+    
+    QHBoxLayout* colormapLayout = new QHBoxLayout();
+    colormapLayout->addWidget(new QLabel("Colormap:", displayGroup_));
+    colormapCombo_ = new QComboBox(displayGroup_);
+    colormapCombo_->addItems({ "Viridis", "Plasma", "Cool-warm", "Grayscale" });
+    colormapCombo_->setEnabled(false);
+    colormapLayout->addWidget(colormapCombo_, 1);
+    displayLayout->addLayout(colormapLayout);
+    
     // Instructions
     QLabel* instructions = new QLabel(
         "<small><b>Mouse:</b> Left=Rotate, Right=Pan, Wheel=Zoom<br>"
@@ -113,6 +156,11 @@ void MainWindow::CreateSidebar() {
     
     connect(lineWidthIncButton_, &QPushButton::clicked, this, &MainWindow::OnIncreaseLineWidth);
     connect(lineWidthDecButton_, &QPushButton::clicked, this, &MainWindow::OnDecreaseLineWidth);
+    connect(tubeModeCheckbox_, &QCheckBox::toggled, this, &MainWindow::OnTubeModeToggled);
+    connect(coloringCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::OnCurveColoringChanged);
+    connect(colormapCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::OnColormapChanged);
     
     sidebarLayout->addWidget(displayGroup_);
     
@@ -132,16 +180,44 @@ void MainWindow::CreateSidebar() {
     animButtonLayout->addWidget(resetAnimButton_);
     animLayout->addLayout(animButtonLayout);
     
-    // Speed input
+    // Advance mode: by point index, by the curves' parameter t, or by arc length
+    QHBoxLayout* modeLayout = new QHBoxLayout();
+    modeLayout->addWidget(new QLabel("Advance by:", animationGroup_));
+    animationModeCombo_ = new QComboBox(animationGroup_);
+    animationModeCombo_->addItem("Points");
+    animationModeCombo_->addItem("Parameter t");
+    animationModeCombo_->addItem("Arc length");
+    modeLayout->addWidget(animationModeCombo_, 1);
+    animLayout->addLayout(modeLayout);
+    
+    // Speed input (no upper limit; playback is driven by wall-clock time)
     QHBoxLayout* speedLayout = new QHBoxLayout();
-    speedLayout->addWidget(new QLabel("Speed (pts/sec):", animationGroup_));
+    speedLabel_ = new QLabel("Speed (pts/sec):", animationGroup_);
+    speedLayout->addWidget(speedLabel_);
     speedInput_ = new QLineEdit("10", animationGroup_);
-    speedInput_->setFixedWidth(60);
-    speedInput_->setValidator(new QIntValidator(1, 1000, this));
+    speedInput_->setFixedWidth(80);
+    QDoubleValidator* speedValidator = new QDoubleValidator(0.0, 1e12, 6, this);
+    speedValidator->setNotation(QDoubleValidator::StandardNotation);
+    speedInput_->setValidator(speedValidator);
     speedLayout->addWidget(speedInput_);
     speedLayout->addStretch();
     animLayout->addLayout(speedLayout);
     
+    // Fading trails behind the markers
+    QHBoxLayout* trailLayout = new QHBoxLayout();
+    showTrailsCheckBox_ = new QCheckBox("Trails", animationGroup_);
+    trailLayout->addWidget(showTrailsCheckBox_);
+    trailLayout->addWidget(new QLabel("Length:", animationGroup_));
+    trailLengthSpinBox_ = new QSpinBox(animationGroup_);
+    trailLengthSpinBox_->setRange(2, 1024);
+    trailLengthSpinBox_->setValue(64);
+    trailLengthSpinBox_->setSuffix(" frames");
+    trailLayout->addWidget(trailLengthSpinBox_);
+    trailLayout->addStretch();
+    animLayout->addLayout(trailLayout);
+    connect(showTrailsCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowTrailsChanged);
+    connect(trailLengthSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::OnTrailLengthChanged);
+    
     // Frame and T value display
     frameLabel_ = new QLabel("Frame: 0 / 0", animationGroup_);
     tValueLabel_ = new QLabel("t = 0.0000", animationGroup_);
@@ -152,6 +228,8 @@ void MainWindow::CreateSidebar() {
     connect(pauseButton_, &QPushButton::clicked, this, &MainWindow::OnPauseAnimation);
     connect(resetAnimButton_, &QPushButton::clicked, this, &MainWindow::OnResetAnimation);
     connect(speedInput_, &QLineEdit::editingFinished, this, &MainWindow::OnAnimationSpeedChanged);
+    connect(animationModeCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::OnAnimationModeChanged);
     
     sidebarLayout->addWidget(animationGroup_);
     
@@ -166,6 +244,37 @@ void MainWindow::CreateSidebar() {
     
     sidebarLayout->addWidget(legendGroup_);
     
+    // === Compare Group ===
+    compareGroup_ = new QGroupBox("Compare", sidebarWidget_);
+    QVBoxLayout* compareLayout = new QVBoxLayout(compareGroup_);
+    
+    // B is interpolated onto A's t grid
+    QHBoxLayout* compareALayout = new QHBoxLayout();
+    compareALayout->addWidget(new QLabel("A:", compareGroup_));
+    compareACombo_ = new QComboBox(compareGroup_);
+    compareALayout->addWidget(compareACombo_, 1);
+    compareLayout->addLayout(compareALayout);
+    
+    QHBoxLayout* compareBLayout = new QHBoxLayout();
+    compareBLayout->addWidget(new QLabel("B:", compareGroup_));
+    compareBCombo_ = new QComboBox(compareGroup_);
+    compareBLayout->addWidget(compareBCombo_, 1);
+    compareLayout->addLayout(compareBLayout);
+    
+    QHBoxLayout* compareButtonLayout = new QHBoxLayout();
+    compareButton_ = new QPushButton("Compare", compareGroup_);
+    clearCompareButton_ = new QPushButton("Close", compareGroup_);
+    compareButton_->setEnabled(false);
+    clearCompareButton_->setEnabled(false);
+    compareButtonLayout->addWidget(compareButton_);
+    compareButtonLayout->addWidget(clearCompareButton_);
+    compareLayout->addLayout(compareButtonLayout);
+    
+    connect(compareButton_, &QPushButton::clicked, this, &MainWindow::OnCompareCurves);
+    connect(clearCompareButton_, &QPushButton::clicked, this, &MainWindow::OnClearComparison);
+    
+    sidebarLayout->addWidget(compareGroup_);
+    
     // === Info Group ===
     infoGroup_ = new QGroupBox("Curve Info", sidebarWidget_);
     QVBoxLayout* infoLayout = new QVBoxLayout(infoGroup_);
@@ -249,6 +358,7 @@ void MainWindow::LoadCurveFile(const QString& filename) {
         
         UpdateInfoDisplay();
         UpdateAnimationUI();
+        UpdateCompareCombos();
         statusLabel_->setText("Loaded: " + filename);
         
     } catch (const std::exception& e) {
@@ -284,6 +394,8 @@ void MainWindow::ClearAll() {
     }
     legendEntries_.clear();
     
+    OnClearComparison();
+    UpdateCompareCombos();
     UpdateInfoDisplay();
     UpdateAnimationUI();
     statusLabel_->setText("All curves cleared");
@@ -335,16 +447,40 @@ void MainWindow::UpdateAnimationUI() {
     
     frameLabel_->setText(QString("Frame: %1 / %2").arg(currentFrame).arg(maxFrames));
     
-    // Calculate t value from current frame
-    const auto& curves = glWidget_->GetCurves();
-    if (!curves.empty() && maxFrames > 0) {
-        double minT = curves[0]->GetT1();
-        double maxT = curves[0]->GetT2();
-        double t = minT + (maxT - minT) * static_cast<double>(currentFrame) / static_cast<double>(maxFrames - 1);
-        tValueLabel_->setText(QString("t = %1").arg(t, 0, 'f', 4));
+    // Parameter value at the (fractional) animation position
+    if (!glWidget_->GetCurves().empty() && maxFrames > 0) {
+        tValueLabel_->setText(QString("t = %1").arg(glWidget_->GetAnimationTime(), 0, 'f', 4));
     } else {
         tValueLabel_->setText("t = 0.0000");
     }
+    
+    // The difference pane's cursor follows the animation
+    if (diffPlot_->isVisible()) {
+        diffPlot_->SetCursorT(glWidget_->GetAnimationTime());
+    }
+}
+
+void MainWindow::UpdateCompareCombos() {
+    int indexA = compareACombo_->currentIndex();
+    int indexB = compareBCombo_->currentIndex();
+    compareACombo_->clear();
+    compareBCombo_->clear();
+    
+    const auto& curves = glWidget_->GetCurves();
+    for (const auto& curve : curves) {
+        QString name = QString::fromStdString(curve->GetName());
+        compareACombo_->addItem(name);
+        compareBCombo_->addItem(name);
+    }
+    
+    // Keep the previous choice, but never the same curve twice when there is another
+    int count = static_cast<int>(curves.size());
+    indexA = indexA >= 0 && indexA < count ? indexA : 0;
+    indexB = indexB >= 0 && indexB < count ? indexB : 0;
+    if (indexB == indexA && count >= 2) indexB = indexA == 0 ? 1 : 0;
+    compareACombo_->setCurrentIndex(indexA);
+    compareBCombo_->setCurrentIndex(indexB);
+    compareButton_->setEnabled(count >= 2);
 }
 
 // Animation slots
@@ -379,17 +515,35 @@ void MainWindow::OnResetAnimation() {
 
 void MainWindow::OnAnimationSpeedChanged() {
     bool ok;
-    int speed = speedInput_->text().toInt(&ok);
+    double speed = speedInput_->text().toDouble(&ok);
     if (ok && speed > 0) {
-        glWidget_->SetAnimationSpeed(static_cast<double>(speed));
-        statusLabel_->setText(QString("Animation speed: %1 pts/sec").arg(speed));
+        glWidget_->SetAnimationSpeed(speed);
+        QString unit = SpeedUnit(glWidget_->GetAnimationMode());
+        statusLabel_->setText(QString("Animation speed: %1 %2").arg(speed).arg(unit));
     }
 }
 
+void MainWindow::OnAnimationModeChanged(int index) {
+    // Combo entries are in AnimationMode order
+    auto mode = static_cast<GLWidget::AnimationMode>(index);
+    glWidget_->SetAnimationMode(mode);
+    speedLabel_->setText(QString("Speed (%1):").arg(SpeedUnit(mode)));
+    UpdateAnimationUI();
+    statusLabel_->setText(QString("Animation advances by %1").arg(animationModeCombo_->currentText()));
+}
+
 void MainWindow::OnAnimationFrame() {
     UpdateAnimationUI();
 }
 
+void MainWindow::OnShowTrailsChanged(bool checked) {
+    glWidget_->SetShowTrails(checked);
+}
+
+void MainWindow::OnTrailLengthChanged(int value) {
+    glWidget_->SetTrailLength(value);
+}
+
 // Display settings slots
 void MainWindow::OnIncreaseLineWidth() {
     glWidget_->IncreaseLineWidth();
@@ -401,6 +555,74 @@ void MainWindow::OnDecreaseLineWidth() {
     lineWidthLabel_->setText(QString::number(glWidget_->GetLineWidth(), 'f', 1));
 }
 
+void MainWindow::OnTubeModeToggled(bool checked) {
+    glWidget_->SetTubeMode(checked);
+}
+
+void MainWindow::OnCurveColoringChanged(int index) {
+    // Combo entries are in CurveColoring order
+    glWidget_->SetCurveColoring(static_cast<GLWidget::CurveColoring>(index));
+    colormapCombo_->setEnabled(index != 0);
+}
+
+void MainWindow::OnColormapChanged(int index) {
+    // Combo entries are in Colormap order
+    glWidget_->SetColormap(static_cast<LineRenderer::Colormap>(index));
+}
+
+// Trajectory comparison slots
+void MainWindow::OnCompareCurves() {
+    const auto& curves = glWidget_->GetCurves();
+    int indexA = compareACombo_->currentIndex();
+    int indexB = compareBCombo_->currentIndex();
+    if (indexA < 0 || indexB < 0 || indexA >= static_cast<int>(curves.size()) ||
+        indexB >= static_cast<int>(curves.size()) || indexA == indexB) {
+        statusLabel_->setText("Choose two different curves to compare");
+        return;
+    }
+    
+    const auto& a = *curves[indexA];
+    const auto& b = *curves[indexB];
+    
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QElapsedTimer timer;
+    timer.start();
+    TrajectoryDifference<3> difference;
+    bool overlap = difference.Compute(a.GetTVals().data(), {a.GetXVals().data(), a.GetYVals().data(), a.GetZVals().data()}, a.GetNumPoints(),
+                                      b.GetTVals().data(), {b.GetXVals().data(), b.GetYVals().data(), b.GetZVals().data()}, b.GetNumPoints());
+    qint64 elapsed = timer.elapsed();
+    QApplication::restoreOverrideCursor();
+    
+    if (!overlap) {
+        statusLabel_->setText("The curves' t ranges do not overlap");
+        return;
+    }
+    
+    QString nameA = QString::fromStdString(a.GetName());
+    QString nameB = QString::fromStdString(b.GetName());
+    diffPlot_->Clear();
+    diffPlot_->SetTitle(QString("%1 vs %2").arg(nameB, nameA));
+    diffPlot_->AddSeries("Distance |B - A|", QColor(0, 0, 200),
+                         difference.GetT(), difference.GetValues(TrajectoryDifference<3>::Distance));
+    diffPlot_->AddSeries("Phase error (t, B ahead > 0)", QColor(200, 100, 0),
+                         difference.GetT(), difference.GetValues(TrajectoryDifference<3>::PhaseError));
+    diffPlot_->show();
+    clearCompareButton_->setEnabled(true);
+    UpdateAnimationUI();
+    
+    statusLabel_->setText(QString("Compared %1 points in %2 ms: max distance %3, RMS %4")
+                              .arg(difference.Size())
+                              .arg(elapsed)
+                              .arg(difference.GetMaxDistance(), 0, 'g', 4)
+                              .arg(difference.GetRmsDistance(), 0, 'g', 4));
+}
+
+void MainWindow::OnClearComparison() {
+    diffPlot_->Clear();
+    diffPlot_->hide();
+    clearCompareButton_->setEnabled(false);
+}
+
 // Legend checkbox slot
 void MainWindow::OnLegendCheckboxToggled(bool checked) {
     QCheckBox* checkbox = qobject_cast<QCheckBox*>(sender());
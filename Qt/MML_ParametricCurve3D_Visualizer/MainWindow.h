@@ -7,12 +7,15 @@
 #include <QLabel>
 #include <QCheckBox>
 #include <QLineEdit>
+#include <QComboBox>
+#include <QSpinBox>
 #include <QGroupBox>
 #include <QVBoxLayout>
 #include <QFrame>
 #include <vector>
 #include <memory>
 #include "GLWidget.h"
+#include "DifferencePlotWidget.h"
 #include "MMLData.h"
 
 // Structure to hold legend entry with checkbox and label
@@ -42,11 +45,21 @@ private slots:
     void OnPauseAnimation();
     void OnResetAnimation();
     void OnAnimationSpeedChanged();
+    void OnAnimationModeChanged(int index);
     void OnAnimationFrame();
+    void OnShowTrailsChanged(bool checked);
+    void OnTrailLengthChanged(int value);
     
     // Display settings slots
     void OnIncreaseLineWidth();
     void OnDecreaseLineWidth();
+    void OnTubeModeToggled(bool checked);
+    void OnCurveColoringChanged(int index);
+    void OnColormapChanged(int index);
+    
+    // Trajectory comparison slots
+    void OnCompareCurves();
+    void OnClearComparison();
     
     // Legend checkbox slot
     void OnLegendCheckboxToggled(bool checked);
@@ -56,10 +69,12 @@ private:
     void LoadCurveFile(const QString& filename);
     void UpdateInfoDisplay();
     void UpdateAnimationUI();
+    void UpdateCompareCombos();
     LegendEntry CreateLegendEntry(const QString& name, const Color& color, int index);
 
     // Main widgets
     GLWidget* glWidget_;
+    DifferencePlotWidget* diffPlot_;
     QWidget* sidebarWidget_;
     
     // Sidebar groups
@@ -67,6 +82,7 @@ private:
     QGroupBox* displayGroup_;
     QGroupBox* animationGroup_;
     QGroupBox* legendGroup_;
+    QGroupBox* compareGroup_;
     QGroupBox* infoGroup_;
     
     // File buttons
@@ -78,12 +94,19 @@ private:
     QPushButton* lineWidthIncButton_;
     QPushButton* lineWidthDecButton_;
     QLabel* lineWidthLabel_;
+    QCheckBox* tubeModeCheckbox_;
+    QComboBox* coloringCombo_;
+    QComboBox* colormapCombo_;
     
     // Animation controls
     QPushButton* startButton_;
     QPushButton* pauseButton_;
     QPushButton* resetAnimButton_;
     QLineEdit* speedInput_;
+    QLabel* speedLabel_;
+    QComboBox* animationModeCombo_;
+    QCheckBox* showTrailsCheckBox_;
+    QSpinBox* trailLengthSpinBox_;
     QLabel* frameLabel_;
     QLabel* tValueLabel_;
     
@@ -91,6 +114,12 @@ private:
     QVBoxLayout* legendLayout_;
     std::vector<LegendEntry> legendEntries_;
     
+    // Trajectory comparison: curve B against reference curve A
+    QComboBox* compareACombo_;
+    QComboBox* compareBCombo_;
+    QPushButton* compareButton_;
+    QPushButton* clearCompareButton_;
+    
     // Info display
     QTextEdit* infoDisplay_;
     
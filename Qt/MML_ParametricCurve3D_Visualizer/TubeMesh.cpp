@@ -0,0 +1,220 @@
+#include "TubeMesh.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+struct Vec3 {
+    double x, y, z;
+};
+
+Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+Vec3 operator*(double s, const Vec3& a) { return { s * a.x, s * a.y, s * a.z }; }
+double Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec3 Cross(const Vec3& a, const Vec3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+Vec3 Load(const double* v, size_t i) { return { v[3 * i], v[3 * i + 1], v[3 * i + 2] }; }
+void Store(double* v, size_t i, const Vec3& a) {
+    v[3 * i] = a.x;
+    v[3 * i + 1] = a.y;
+    v[3 * i + 2] = a.z;
+}
+
+// Unit vector along a, or false when a is (numerically) zero
+bool Normalize(Vec3& a) {
+    double length = std::sqrt(Dot(a, a));
+    if (!(length > 1e-300)) return false;
+    a = (1.0 / length) * a;
+    return true;
+}
+
+// Any unit vector perpendicular to the unit vector t
+Vec3 Perpendicular(const Vec3& t) {
+    Vec3 axis = { 0.0, 0.0, 0.0 };
+    double ax = std::abs(t.x), ay = std::abs(t.y), az = std::abs(t.z);
+    if (ax <= ay && ax <= az) axis.x = 1.0;
+    else if (ay <= az) axis.y = 1.0;
+    else axis.z = 1.0;
+    Vec3 r = Cross(t, axis);
+    Normalize(r);
+    return r;
+}
+
+// Rotates r (perpendicular to the unit vector t) about t
+Vec3 Rotate(const Vec3& r, const Vec3& t, double angle) {
+    return std::cos(angle) * r + std::sin(angle) * Cross(t, r);
+}
+
+// Double reflection step: carries normal r0 at (x0, t0) to (x1, t1)
+Vec3 Propagate(const Vec3& x0, const Vec3& x1, const Vec3& t0, const Vec3& t1, const Vec3& r0) {
+    Vec3 v1 = x1 - x0;
+    double c1 = Dot(v1, v1);
+    Vec3 rL = r0, tL = t0;
+    if (c1 > 0.0) {
+        rL = r0 - (2.0 / c1) * Dot(v1, r0) * v1;
+        tL = t0 - (2.0 / c1) * Dot(v1, t0) * v1;
+    }
+    Vec3 v2 = t1 - tL;
+    double c2 = Dot(v2, v2);
+    Vec3 r1 = c2 > 0.0 ? rL - (2.0 / c2) * Dot(v2, rL) * v2 : rL;
+
+    // Keep the frame orthonormal over millions of steps
+    r1 = r1 - Dot(r1, t1) * t1;
+    return Normalize(r1) ? r1 : Perpendicular(t1);
+}
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+} // namespace
+
+void TubeMeshBuilder::ComputeFrames(const double* xyz, size_t n, double* tangents, double* normals) {
+    if (n == 0) return;
+    size_t numChunks = (n + CHUNK_POINTS - 1) / CHUNK_POINTS;
+
+    // Central-difference tangents; repeated points are marked with a zero tangent
+    std::vector<unsigned char> degenerate(n, 0);
+    RunChunks(numChunks, [&](size_t c) {
+        size_t end = std::min((c + 1) * CHUNK_POINTS, n);
+        for (size_t i = c * CHUNK_POINTS; i < end; ++i) {
+            Vec3 t = Load(xyz, std::min(i + 1, n - 1)) - Load(xyz, i > 0 ? i - 1 : 0);
+            if (!Normalize(t)) {
+                t = { 0.0, 0.0, 0.0 };
+                degenerate[i] = 1;
+            }
+            Store(tangents, i, t);
+        }
+    });
+
+    // Degenerate points borrow the nearest preceding tangent (following one at the start)
+    size_t firstValid = std::find(degenerate.begin(), degenerate.end(), 0) - degenerate.begin();
+    if (firstValid == n) {
+        for (size_t i = 0; i < n; ++i) Store(tangents, i, { 1.0, 0.0, 0.0 });
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            if (degenerate[i]) {
+                Store(tangents, i, Load(tangents, i < firstValid ? firstValid : i - 1));
+            }
+        }
+    }
+
+    // Pass 1: every chunk propagates its own frame from an arbitrary start normal
+    RunChunks(numChunks, [&](size_t c) {
+        size_t first = c * CHUNK_POINTS;
+        size_t end = std::min(first + CHUNK_POINTS, n);
+        Vec3 r = Perpendicular(Load(tangents, first));
+        Store(normals, first, r);
+        for (size_t i = first + 1; i < end; ++i) {
+            r = Propagate(Load(xyz, i - 1), Load(xyz, i), Load(tangents, i - 1), Load(tangents, i), r);
+            Store(normals, i, r);
+        }
+    });
+
+    // Serial scan over chunk boundaries: the twist of chunk c is the angle between
+    // its start normal and the true normal carried over from chunk c - 1. Double
+    // reflection is a rotation, so the twist is constant along the chunk.
+    std::vector<double> twist(numChunks, 0.0);
+    for (size_t c = 1; c < numChunks; ++c) {
+        size_t first = c * CHUNK_POINTS;
+        Vec3 tPrev = Load(tangents, first - 1);
+        Vec3 rPrev = Rotate(Load(normals, first - 1), tPrev, twist[c - 1]);
+        Vec3 t = Load(tangents, first);
+        Vec3 rTrue = Propagate(Load(xyz, first - 1), Load(xyz, first), tPrev, t, rPrev);
+        Vec3 rLocal = Load(normals, first);
+        twist[c] = std::atan2(Dot(Cross(rLocal, rTrue), t), Dot(rLocal, rTrue));
+    }
+
+    // Pass 2: apply the twists
+    RunChunks(numChunks, [&](size_t c) {
+        if (twist[c] == 0.0) return;
+        size_t end = std::min((c + 1) * CHUNK_POINTS, n);
+        for (size_t i = c * CHUNK_POINTS; i < end; ++i) {
+            Store(normals, i, Rotate(Load(normals, i), Load(tangents, i), twist[c]));
+        }
+    });
+}
+
+std::shared_ptr<TubeMesh> TubeMeshBuilder::Build(const std::vector<double>& centerline, std::vector<uint32_t> ringPoints,
+                                                 double radius, int radialSegments) {
+    auto mesh = std::make_shared<TubeMesh>();
+    mesh->radius = radius;
+    mesh->radialSegments = std::max(radialSegments, MIN_RADIAL_SEGMENTS);
+    mesh->ringPoints = std::move(ringPoints);
+
+    size_t n = mesh->ringPoints.size();
+    size_t segments = static_cast<size_t>(mesh->radialSegments);
+    if (n < 2 || centerline.size() != 3 * n) {
+        mesh->ringPoints.clear();
+        return mesh;
+    }
+    if (n * segments > std::numeric_limits<uint32_t>::max()) return nullptr;
+
+    std::vector<double> tangents(3 * n), normals(3 * n);
+    ComputeFrames(centerline.data(), n, tangents.data(), normals.data());
+
+    std::vector<double> cosines(segments), sines(segments);
+    for (size_t k = 0; k < segments; ++k) {
+        double angle = 2.0 * M_PI * static_cast<double>(k) / static_cast<double>(segments);
+        cosines[k] = std::cos(angle);
+        sines[k] = std::sin(angle);
+    }
+
+    mesh->vertices.resize(n * segments);
+    mesh->indices.resize(2 * n * segments);
+    TubeVertex* vertices = mesh->vertices.data();
+    uint32_t* indices = mesh->indices.data();
+
+    size_t numChunks = (n + CHUNK_POINTS - 1) / CHUNK_POINTS;
+    RunChunks(numChunks, [&](size_t c) {
+        size_t first = c * CHUNK_POINTS;
+        size_t end = std::min(first + CHUNK_POINTS, n);
+        for (size_t i = first; i < end; ++i) {
+            Vec3 center = Load(centerline.data(), i);
+            Vec3 r = Load(normals.data(), i);
+            Vec3 b = Cross(Load(tangents.data(), i), r);
+            for (size_t k = 0; k < segments; ++k) {
+                Vec3 normal = cosines[k] * r + sines[k] * b;
+                Vec3 p = center + radius * normal;
+                TubeVertex& v = vertices[i * segments + k];
+                v.x = static_cast<float>(p.x);
+                v.y = static_cast<float>(p.y);
+                v.z = static_cast<float>(p.z);
+                v.nx = static_cast<int8_t>(std::lround(127.0 * normal.x));
+                v.ny = static_cast<int8_t>(std::lround(127.0 * normal.y));
+                v.nz = static_cast<int8_t>(std::lround(127.0 * normal.z));
+                v.pad = 0;
+            }
+
+            // Strip of band k zig-zags between vertex k and k + 1 of consecutive rings
+            for (size_t k = 0; k < segments; ++k) {
+                uint32_t* strip = indices + 2 * (k * n + i);
+                strip[0] = static_cast<uint32_t>(i * segments + k);
+                strip[1] = static_cast<uint32_t>(i * segments + (k + 1) % segments);
+            }
+        }
+    });
+
+    return mesh;
+}
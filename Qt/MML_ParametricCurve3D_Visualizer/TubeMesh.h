@@ -0,0 +1,49 @@
+#ifndef TUBE_MESH_H
+#define TUBE_MESH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Vertex of a tube surface: position and unit normal scaled to [-127, 127]
+struct TubeVertex {
+    float x, y, z;
+    int8_t nx, ny, nz, pad;
+};
+
+// Tube around a polyline. Ring i sits on curve point ringPoints[i] and holds
+// radialSegments vertices; band k (between ring vertices k and k + 1) is one
+// triangle strip of 2 * NumRings() indices, so a prefix of the tube is drawn by
+// shortening every band's strip.
+struct TubeMesh {
+    int radialSegments = 0;
+    double radius = 0.0;
+    std::vector<uint32_t> ringPoints;
+    std::vector<TubeVertex> vertices;       // Ring-major
+    std::vector<uint32_t> indices;          // Band-major
+
+    size_t NumRings() const { return ringPoints.size(); }
+};
+
+// Builds tube meshes on all cores. Frames along the centerline are rotation
+// minimizing (double reflection), so the tube does not twist the way Frenet
+// frames do around inflection points.
+class TubeMeshBuilder {
+public:
+    static constexpr size_t CHUNK_POINTS = size_t(1) << 14;
+    static constexpr int MIN_RADIAL_SEGMENTS = 3;
+
+    // centerline holds xyz of each ring; ringPoints is the curve point of each ring.
+    // Returns nullptr when the mesh would not fit 32-bit indices.
+    static std::shared_ptr<TubeMesh> Build(const std::vector<double>& centerline, std::vector<uint32_t> ringPoints,
+                                           double radius, int radialSegments);
+
+    // Unit tangents and rotation-minimizing normals (xyz per point) of a polyline.
+    // Chunks are propagated in parallel from an arbitrary start normal; a serial pass
+    // over the chunk boundaries then finds the twist that aligns each chunk with its
+    // predecessor, and a second parallel pass applies it.
+    static void ComputeFrames(const double* xyz, size_t n, double* tangents, double* normals);
+};
+
+#endif // TUBE_MESH_H
@@ -0,0 +1,114 @@
+#include "DensityGrid.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+constexpr size_t MERGE_CHUNK_CELLS = 16384;
+
+} // namespace
+
+void DensityGrid::SetBounds(double minX, double minY, double maxX, double maxY, int resolution) {
+    double width = std::max(maxX - minX, 1e-12);
+    double height = std::max(maxY - minY, 1e-12);
+    cellSize_ = std::max(width, height) / std::max(resolution, 1);
+    minX_ = minX;
+    minY_ = minY;
+    nx_ = std::max(1, static_cast<int>(std::ceil(width / cellSize_)));
+    ny_ = std::max(1, static_cast<int>(std::ceil(height / cellSize_)));
+    Clear();
+}
+
+void DensityGrid::Clear() {
+    counts_.assign(static_cast<size_t>(nx_) * ny_, 0);
+    maxCount_ = 0;
+    first_ = -1;
+    last_ = -1;
+}
+
+int DensityGrid::SetRange(const SimulationData& data, int first, int last) {
+    first = std::max(first, 0);
+    last = std::min(last, data.numSteps - 1);
+    if (counts_.empty() || first > last) {
+        Clear();
+        return 0;
+    }
+    if (first == first_ && last == last_) return 0;
+
+    // Only the timesteps at either end that entered or left the range, unless
+    // that is more work than counting the new range from scratch
+    std::vector<Span> spans;
+    int changed = std::abs(first - first_) + std::abs(last - last_);
+    if (first_ < 0 || first > last_ || last < first_ || changed >= last - first + 1) {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        spans.push_back({ first, last, +1 });
+        changed = last - first + 1;
+    } else {
+        if (first < first_) spans.push_back({ first, first_ - 1, +1 });
+        if (first > first_) spans.push_back({ first_, first - 1, -1 });
+        if (last > last_) spans.push_back({ last_ + 1, last, +1 });
+        if (last < last_) spans.push_back({ last + 1, last_, -1 });
+    }
+    first_ = first;
+    last_ = last;
+    Accumulate(data, spans);
+    return changed;
+}
+
+void DensityGrid::Accumulate(const SimulationData& data, const std::vector<Span>& spans) {
+    const auto& balls = data.balls;
+    size_t numBalls = balls.size();
+    size_t numCells = counts_.size();
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t numSlices = std::max<size_t>(1, std::min(numThreads, numBalls / MIN_SLICE_BALLS));
+    size_t sliceBalls = (numBalls + numSlices - 1) / numSlices;
+
+    // One histogram per slice of balls, each ball's positions read front to back
+    std::vector<std::vector<int64_t>> histograms(numSlices);
+    RunChunks(numSlices, [&](size_t slice) {
+        std::vector<int64_t>& histogram = histograms[slice];
+        histogram.assign(numCells, 0);
+        size_t end = std::min(numBalls, (slice + 1) * sliceBalls);
+        for (size_t i = slice * sliceBalls; i < end; ++i) {
+            const std::vector<Vec2D>& positions = balls[i].GetPositions();
+            for (const Span& span : spans) {
+                int last = std::min(span.last, static_cast<int>(positions.size()) - 1);
+                for (int k = span.first; k <= last; ++k) {
+                    double u = (positions[k].x - minX_) / cellSize_;
+                    double v = (positions[k].y - minY_) / cellSize_;
+                    if (!(u >= 0.0 && v >= 0.0 && u < nx_ && v < ny_)) continue;
+                    histogram[static_cast<size_t>(v) * nx_ + static_cast<size_t>(u)] += span.sign;
+                }
+            }
+        }
+    });
+
+    // Merge, a block of cells per task
+    RunChunks((numCells + MERGE_CHUNK_CELLS - 1) / MERGE_CHUNK_CELLS, [&](size_t c) {
+        size_t end = std::min(numCells, (c + 1) * MERGE_CHUNK_CELLS);
+        for (size_t cell = c * MERGE_CHUNK_CELLS; cell < end; ++cell) {
+            int64_t sum = counts_[cell];
+            for (const auto& histogram : histograms) sum += histogram[cell];
+            counts_[cell] = sum;
+        }
+    });
+    maxCount_ = counts_.empty() ? 0 : *std::max_element(counts_.begin(), counts_.end());
+}
@@ -0,0 +1,57 @@
+#ifndef DENSITY_GRID_H
+#define DENSITY_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MMLData.h"
+
+// How many ball centers fell in each cell of a uniform grid, summed over a range
+// of timesteps. Every thread counts a slice of the balls into its own histogram
+// and the histograms are merged at the end, so no two threads write one cell.
+// Moving the range counts only the timesteps that entered it and subtracts the
+// ones that left it; a jump to a range sharing little with the old one recounts.
+class DensityGrid {
+public:
+    static constexpr size_t MIN_SLICE_BALLS = 1024;
+
+    // Cells over [minX, maxX] x [minY, maxY], resolution along the longer side;
+    // clears the counts. Centers outside the bounds are not counted.
+    void SetBounds(double minX, double minY, double maxX, double maxY, int resolution);
+    // Forgets the counted range
+    void Clear();
+
+    // Brings the counts to timesteps [first, last] of data; returns the number of
+    // timesteps counted or subtracted
+    int SetRange(const SimulationData& data, int first, int last);
+
+    int GetFirst() const { return first_; }
+    int GetLast() const { return last_; }
+    int GetWidth() const { return nx_; }
+    int GetHeight() const { return ny_; }
+    double GetCellSize() const { return cellSize_; }
+    // Row by row from minY, nx_ per row
+    const std::vector<int64_t>& GetCounts() const { return counts_; }
+    int64_t GetMaxCount() const { return maxCount_; }
+
+private:
+    struct Span {
+        int first;
+        int last;
+        int sign;               // +1 counts the timesteps, -1 subtracts them
+    };
+
+    void Accumulate(const SimulationData& data, const std::vector<Span>& spans);
+
+    double minX_ = 0.0;
+    double minY_ = 0.0;
+    double cellSize_ = 1.0;
+    int nx_ = 0;
+    int ny_ = 0;
+    std::vector<int64_t> counts_;
+    int64_t maxCount_ = 0;
+    int first_ = -1;            // Counted range, -1 when nothing is counted
+    int last_ = -1;
+};
+
+#endif // DENSITY_GRID_H
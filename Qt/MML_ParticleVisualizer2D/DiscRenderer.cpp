@@ -0,0 +1,361 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "DiscRenderer.h"
+#include <QOpenGLContext>
+#include <GL/gl.h>
+#include <algorithm>
+#include <cstddef>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+constexpr GLuint ATTR_CORNER = 0;
+constexpr GLuint ATTR_INSTANCE_CENTER = 1;
+constexpr GLuint ATTR_INSTANCE_RADIUS = 2;
+constexpr GLuint ATTR_INSTANCE_COLOR = 3;
+constexpr GLuint ATTR_INSTANCE_PREV = 4;
+constexpr GLuint ATTR_INSTANCE_NEXT = 5;
+constexpr GLuint ATTR_INSTANCE_NEXT2 = 6;
+
+// Square around the disc with room for half the outline and one pixel of
+// antialiasing outside it
+const char* VERTEX_SHADER = R"(
+#version 120
+attribute vec2 corner;          // -1/+1 in both directions
+attribute vec2 instancePrev;    // Centers at steps k-1, k, k+1 and k+2, blended by
+attribute vec2 instanceCenter;  // stepWeights; unused ones have zero weight
+attribute vec2 instanceNext;
+attribute vec2 instanceNext2;
+attribute float instanceRadius;
+attribute vec4 instanceColor;
+uniform vec4 stepWeights;
+uniform mat4 matrix;
+uniform float pixelSize;        // World units
+uniform float outlineWidth;     // Pixels
+varying vec2 offset;            // From the center, world units
+varying float radius;
+varying vec4 color;
+
+void main() {
+    vec2 center = stepWeights.x * instancePrev + stepWeights.y * instanceCenter +
+                  stepWeights.z * instanceNext + stepWeights.w * instanceNext2;
+    radius = instanceRadius;
+    color = instanceColor;
+
+    float extent = radius + (0.5 * outlineWidth + 1.0) * pixelSize;
+    offset = corner * extent;
+    gl_Position = matrix * vec4(center + offset, 0.0, 1.0);
+}
+)";
+
+// Fill inside the outline, outline centered on the circle, both edges blended
+// over one pixel
+const char* FRAGMENT_SHADER = R"(
+#version 120
+uniform float pixelSize;
+uniform float outlineWidth;
+uniform vec4 outlineColor;
+varying vec2 offset;
+varying float radius;
+varying vec4 color;
+
+void main() {
+    float edge = (length(offset) - radius) / pixelSize;    // Pixels outside the circle
+    float halfOutline = 0.5 * outlineWidth;
+    float coverage = clamp(halfOutline + 0.5 - edge, 0.0, 1.0);
+    if (coverage <= 0.0) discard;
+
+    float fill = clamp(-halfOutline + 0.5 - edge, 0.0, 1.0);
+    vec4 shade = mix(outlineColor, color, fill);
+    gl_FragColor = vec4(shade.rgb, shade.a * coverage);
+}
+)";
+
+} // namespace
+
+DiscRenderer::DiscRenderer()
+    : initialized_(false)
+    , cornerVbo_(0)
+    , instanceVbo_(0)
+    , numInstances_(0)
+    , runVbo_(0)
+    , runStyleVbo_(0)
+    , runObjects_(0)
+    , runSteps_(0)
+    , stepWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , pixelSize_(1.0f)
+    , outlineWidth_(1.5f)
+    , outlineColor_(0.0f, 0.0f, 0.0f, 1.0f)
+{
+}
+
+DiscRenderer::~DiscRenderer() {
+    // Buffers must be released by the owner via Cleanup() while its context is current
+}
+
+void DiscRenderer::Initialize() {
+    initializeOpenGLFunctions();
+    Cleanup();
+
+    // Instanced attributes need OpenGL 3.3; older contexts draw one fan per disc
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    bool instancing = context && !context->isOpenGLES() &&
+                      context->format().version() >= qMakePair(3, 3);
+    if (instancing) {
+        program_ = std::make_unique<QOpenGLShaderProgram>();
+        program_->addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+        program_->addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+        program_->bindAttributeLocation("corner", ATTR_CORNER);
+        program_->bindAttributeLocation("instanceCenter", ATTR_INSTANCE_CENTER);
+        program_->bindAttributeLocation("instancePrev", ATTR_INSTANCE_PREV);
+        program_->bindAttributeLocation("instanceNext", ATTR_INSTANCE_NEXT);
+        program_->bindAttributeLocation("instanceNext2", ATTR_INSTANCE_NEXT2);
+        program_->bindAttributeLocation("instanceRadius", ATTR_INSTANCE_RADIUS);
+        program_->bindAttributeLocation("instanceColor", ATTR_INSTANCE_COLOR);
+        if (!program_->link()) {
+            program_.reset();
+        }
+    }
+
+    if (program_) {
+        const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+        glGenBuffers(1, &cornerVbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, cornerVbo_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glGenBuffers(1, &instanceVbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    } else {
+        // Center, then the ring closed on its first point
+        unitCircle_ = { 0.0f, 0.0f };
+        for (int i = 0; i <= CIRCLE_SEGMENTS; ++i) {
+            double angle = 2.0 * M_PI * i / CIRCLE_SEGMENTS;
+            unitCircle_.push_back(static_cast<float>(std::cos(angle)));
+            unitCircle_.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+
+    initialized_ = true;
+}
+
+void DiscRenderer::Cleanup() {
+    if (cornerVbo_ != 0) {
+        glDeleteBuffers(1, &cornerVbo_);
+        cornerVbo_ = 0;
+    }
+    if (instanceVbo_ != 0) {
+        glDeleteBuffers(1, &instanceVbo_);
+        instanceVbo_ = 0;
+    }
+    ReleaseResidentRun();
+    program_.reset();
+    instances_.clear();
+    unitCircle_.clear();
+    numInstances_ = 0;
+    initialized_ = false;
+}
+
+void DiscRenderer::SetMatrix(const QMatrix4x4& matrix, float pixelSize) {
+    matrix_ = matrix;
+    pixelSize_ = pixelSize;
+}
+
+void DiscRenderer::SetOutline(float widthPixels, float r, float g, float b) {
+    outlineWidth_ = widthPixels;
+    outlineColor_ = QVector4D(r, g, b, 1.0f);
+}
+
+void DiscRenderer::SetInstances(const std::vector<Instance>& instances) {
+    if (!initialized_) return;
+    numInstances_ = static_cast<GLsizei>(instances.size());
+
+    if (!program_) {
+        instances_ = instances;
+        return;
+    }
+
+    // Orphan the previous contents so the driver doesn't wait for earlier draws
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instances.size() * INSTANCE_BYTES), nullptr, GL_STREAM_DRAW);
+    if (!instances.empty()) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(instances.size() * INSTANCE_BYTES), instances.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void DiscRenderer::Draw() {
+    if (!initialized_ || numInstances_ == 0) return;
+
+    if (!program_) {
+        DrawFixedFunction();
+        return;
+    }
+
+    InstanceLayout layout;
+    layout.centerVbo = instanceVbo_;
+    layout.centerStride = INSTANCE_BYTES;
+    layout.styleVbo = instanceVbo_;
+    layout.radiusOffset = offsetof(Instance, radius);
+    layout.colorOffset = offsetof(Instance, r);
+    layout.styleStride = INSTANCE_BYTES;
+    DrawInstanced(layout, numInstances_);
+}
+
+bool DiscRenderer::CreateResidentRun(size_t numObjects, size_t numSteps) {
+    ReleaseResidentRun();
+    if (!program_ || numObjects == 0 || numSteps == 0) return false;
+
+    // Drain stale errors so an allocation failure can be told apart
+    while (glGetError() != GL_NO_ERROR) {}
+
+    glGenBuffers(1, &runVbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, runVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(numSteps * numObjects * POINT_BYTES), nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &runStyleVbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, runStyleVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(numObjects * STYLE_BYTES), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        ReleaseResidentRun();
+        return false;
+    }
+    runObjects_ = static_cast<GLsizei>(numObjects);
+    runSteps_ = static_cast<GLsizei>(numSteps);
+    return true;
+}
+
+void DiscRenderer::UploadResidentSteps(size_t firstSlot, const float* xy, size_t numSteps) {
+    if (runVbo_ == 0 || firstSlot >= static_cast<size_t>(runSteps_)) return;
+    numSteps = std::min(numSteps, static_cast<size_t>(runSteps_) - firstSlot);
+
+    size_t stepBytes = static_cast<size_t>(runObjects_) * POINT_BYTES;
+    glBindBuffer(GL_ARRAY_BUFFER, runVbo_);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(firstSlot * stepBytes),
+                    static_cast<GLsizeiptr>(numSteps * stepBytes), xy);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void DiscRenderer::SetResidentStyles(const std::vector<Style>& styles) {
+    if (runStyleVbo_ == 0) return;
+    size_t count = std::min(styles.size(), static_cast<size_t>(runObjects_));
+
+    glBindBuffer(GL_ARRAY_BUFFER, runStyleVbo_);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(count * STYLE_BYTES), styles.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void DiscRenderer::ReleaseResidentRun() {
+    if (runVbo_ != 0) {
+        glDeleteBuffers(1, &runVbo_);
+        runVbo_ = 0;
+    }
+    if (runStyleVbo_ != 0) {
+        glDeleteBuffers(1, &runStyleVbo_);
+        runStyleVbo_ = 0;
+    }
+    runObjects_ = 0;
+    runSteps_ = 0;
+}
+
+void DiscRenderer::DrawResident(size_t slot) {
+    if (!initialized_ || runVbo_ == 0 || slot >= static_cast<size_t>(runSteps_)) return;
+
+    // The step is only where the center attributes start reading; neighbours past
+    // either end of the window repeat the end slot
+    size_t stepBytes = static_cast<size_t>(runObjects_) * POINT_BYTES;
+    size_t lastSlot = static_cast<size_t>(runSteps_) - 1;
+    InstanceLayout layout;
+    layout.centerVbo = runVbo_;
+    layout.centerOffset = static_cast<GLintptr>(slot * stepBytes);
+    layout.centerStride = POINT_BYTES;
+    layout.interpolated = stepWeights_ != QVector4D(0.0f, 1.0f, 0.0f, 0.0f);
+    layout.prevOffset = static_cast<GLintptr>((slot > 0 ? slot - 1 : 0) * stepBytes);
+    layout.nextOffset = static_cast<GLintptr>(std::min(slot + 1, lastSlot) * stepBytes);
+    layout.next2Offset = static_cast<GLintptr>(std::min(slot + 2, lastSlot) * stepBytes);
+    layout.weights = stepWeights_;
+    layout.styleVbo = runStyleVbo_;
+    layout.radiusOffset = offsetof(Style, radius);
+    layout.colorOffset = offsetof(Style, r);
+    layout.styleStride = STYLE_BYTES;
+    DrawInstanced(layout, runObjects_);
+}
+
+void DiscRenderer::DrawInstanced(const InstanceLayout& layout, GLsizei count) {
+    program_->bind();
+    program_->setUniformValue("matrix", matrix_);
+    program_->setUniformValue("pixelSize", pixelSize_);
+    program_->setUniformValue("outlineWidth", outlineWidth_);
+    program_->setUniformValue("outlineColor", outlineColor_);
+    program_->setUniformValue("stepWeights", layout.weights);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVbo_);
+    glEnableVertexAttribArray(ATTR_CORNER);
+    glVertexAttribPointer(ATTR_CORNER, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    // Per-instance center, radius and color, one step per disc
+    glBindBuffer(GL_ARRAY_BUFFER, layout.centerVbo);
+    glEnableVertexAttribArray(ATTR_INSTANCE_CENTER);
+    glVertexAttribPointer(ATTR_INSTANCE_CENTER, 2, GL_FLOAT, GL_FALSE, layout.centerStride,
+                          reinterpret_cast<const void*>(layout.centerOffset));
+    glVertexAttribDivisor(ATTR_INSTANCE_CENTER, 1);
+    if (layout.interpolated) {
+        const GLuint neighbours[] = { ATTR_INSTANCE_PREV, ATTR_INSTANCE_NEXT, ATTR_INSTANCE_NEXT2 };
+        const GLintptr offsets[] = { layout.prevOffset, layout.nextOffset, layout.next2Offset };
+        for (int i = 0; i < 3; ++i) {
+            glEnableVertexAttribArray(neighbours[i]);
+            glVertexAttribPointer(neighbours[i], 2, GL_FLOAT, GL_FALSE, layout.centerStride,
+                                  reinterpret_cast<const void*>(offsets[i]));
+            glVertexAttribDivisor(neighbours[i], 1);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, layout.styleVbo);
+    glEnableVertexAttribArray(ATTR_INSTANCE_RADIUS);
+    glVertexAttribPointer(ATTR_INSTANCE_RADIUS, 1, GL_FLOAT, GL_FALSE, layout.styleStride,
+                          reinterpret_cast<const void*>(layout.radiusOffset));
+    glVertexAttribDivisor(ATTR_INSTANCE_RADIUS, 1);
+    glEnableVertexAttribArray(ATTR_INSTANCE_COLOR);
+    glVertexAttribPointer(ATTR_INSTANCE_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, layout.styleStride,
+                          reinterpret_cast<const void*>(layout.colorOffset));
+    glVertexAttribDivisor(ATTR_INSTANCE_COLOR, 1);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+
+    for (GLuint location : { ATTR_INSTANCE_CENTER, ATTR_INSTANCE_RADIUS, ATTR_INSTANCE_COLOR }) {
+        glVertexAttribDivisor(location, 0);
+        glDisableVertexAttribArray(location);
+    }
+    if (layout.interpolated) {
+        for (GLuint location : { ATTR_INSTANCE_PREV, ATTR_INSTANCE_NEXT, ATTR_INSTANCE_NEXT2 }) {
+            glVertexAttribDivisor(location, 0);
+            glDisableVertexAttribArray(location);
+        }
+    }
+    glDisableVertexAttribArray(ATTR_CORNER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    program_->release();
+}
+
+void DiscRenderer::DrawFixedFunction() {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, unitCircle_.data());
+    glLineWidth(outlineWidth_);
+
+    for (const auto& disc : instances_) {
+        glPushMatrix();
+        glTranslatef(disc.x, disc.y, 0.0f);
+        glScalef(disc.radius, disc.radius, 1.0f);
+
+        glColor4ub(disc.r, disc.g, disc.b, disc.a);
+        glDrawArrays(GL_TRIANGLE_FAN, 0, CIRCLE_SEGMENTS + 2);
+        glColor4f(outlineColor_.x(), outlineColor_.y(), outlineColor_.z(), outlineColor_.w());
+        glDrawArrays(GL_LINE_LOOP, 1, CIRCLE_SEGMENTS);
+
+        glPopMatrix();
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
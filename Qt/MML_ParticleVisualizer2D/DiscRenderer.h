@@ -0,0 +1,108 @@
+#ifndef DISC_RENDERER_H
+#define DISC_RENDERER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <QVector4D>
+#include <memory>
+#include <vector>
+
+// Draws many outlined discs in one call. Every disc is an instanced quad just
+// large enough for the disc and its outline; the fragment shader shades it from
+// the distance to the center (a signed distance field), antialiasing the edge and
+// the outline over one pixel. Without instancing (older than OpenGL 3.3) each disc
+// is a triangle fan and line loop from a unit circle built once.
+//
+// As with the 3D spheres, the positions of a whole run (or a window of its steps)
+// can stay in GPU memory, step-major; a step is drawn by starting the center
+// attribute at that step's row, and between stored steps the shader blends the
+// centers of steps k-1 .. k+2.
+class DiscRenderer : protected QOpenGLExtraFunctions {
+public:
+    // One disc; 16 bytes, uploaded as is
+    struct Instance {
+        float x, y;
+        float radius;
+        unsigned char r, g, b, a;
+    };
+
+    // Radius and fill color of one disc of a resident run; 8 bytes
+    struct Style {
+        float radius;
+        unsigned char r, g, b, a;
+    };
+
+    DiscRenderer();
+    ~DiscRenderer();
+
+    // Must be called with the GL context current
+    void Initialize();
+    void Cleanup();
+    bool IsInitialized() const { return initialized_; }
+    bool IsInstanced() const { return program_ != nullptr; }
+
+    // Orthographic projection, and the size of one pixel in world units
+    void SetMatrix(const QMatrix4x4& matrix, float pixelSize);
+    void SetOutline(float widthPixels, float r, float g, float b);
+
+    // Replaces the discs drawn by Draw(); only needed when they change
+    void SetInstances(const std::vector<Instance>& instances);
+    void Draw();
+
+    // Resident run: numSteps slots of numObjects centers (xy floats). Needs instancing;
+    // returns false when it isn't available or the GPU is out of memory.
+    bool CreateResidentRun(size_t numObjects, size_t numSteps);
+    void UploadResidentSteps(size_t firstSlot, const float* xy, size_t numSteps);
+    void SetResidentStyles(const std::vector<Style>& styles);
+    void ReleaseResidentRun();
+    bool HasResidentRun() const { return runVbo_ != 0; }
+    size_t GetResidentSlots() const { return static_cast<size_t>(runSteps_); }
+    void DrawResident(size_t slot);
+    // Weights of steps slot-1, slot, slot+1 and slot+2 in DrawResident; (0, 1, 0, 0)
+    // draws the stored step
+    void SetStepWeights(const QVector4D& weights) { stepWeights_ = weights; }
+
+private:
+    // Where the per-instance attributes are read from; offsets and strides in bytes
+    struct InstanceLayout {
+        GLuint centerVbo = 0;
+        GLintptr centerOffset = 0;
+        GLsizei centerStride = 0;
+        GLuint styleVbo = 0;
+        GLintptr radiusOffset = 0;
+        GLintptr colorOffset = 0;
+        GLsizei styleStride = 0;
+        bool interpolated = false;  // Neighbouring steps read at these offsets
+        GLintptr prevOffset = 0;
+        GLintptr nextOffset = 0;
+        GLintptr next2Offset = 0;
+        QVector4D weights = QVector4D(0.0f, 1.0f, 0.0f, 0.0f);
+    };
+    void DrawInstanced(const InstanceLayout& layout, GLsizei count);
+    void DrawFixedFunction();
+
+    static constexpr int CIRCLE_SEGMENTS = 32;
+    static constexpr GLsizei INSTANCE_BYTES = sizeof(Instance);
+    static constexpr GLsizei STYLE_BYTES = sizeof(Style);
+    static constexpr GLsizei POINT_BYTES = 2 * sizeof(float);
+
+    bool initialized_;
+    std::unique_ptr<QOpenGLShaderProgram> program_;
+    GLuint cornerVbo_;              // Quad corners
+    GLuint instanceVbo_;
+    GLsizei numInstances_;
+    std::vector<Instance> instances_;   // Kept only for the fixed-function path
+    std::vector<float> unitCircle_;     // Fixed-function path: CIRCLE_SEGMENTS points
+    GLuint runVbo_;                 // Resident centers, runSteps_ rows of runObjects_
+    GLuint runStyleVbo_;
+    GLsizei runObjects_;
+    GLsizei runSteps_;
+    QVector4D stepWeights_;
+    QMatrix4x4 matrix_;
+    float pixelSize_;
+    float outlineWidth_;            // Pixels
+    QVector4D outlineColor_;
+};
+
+#endif // DISC_RENDERER_H
@@ -1,18 +1,65 @@
+#define _USE_MATH_DEFINES
 #include "GLWidget.h"
 #include <QMouseEvent>
 #include <QWheelEvent>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace {
+
+// Weights of timesteps k-1, k, k+1 and k+2 at fraction t of the way from k to k+1
+QVector4D StepWeights(GLWidget::Interpolation interpolation, float t) {
+    if (t <= 0.0f || interpolation == GLWidget::Interpolation::None) {
+        return QVector4D(0.0f, 1.0f, 0.0f, 0.0f);
+    }
+    if (interpolation == GLWidget::Interpolation::Linear) {
+        return QVector4D(0.0f, 1.0f - t, t, 0.0f);
+    }
+    // Catmull-Rom: passes through the stored timesteps with continuous velocity
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return QVector4D(0.5f * (-t + 2.0f * t2 - t3),
+                     0.5f * (2.0f - 5.0f * t2 + 3.0f * t3),
+                     0.5f * (t + 4.0f * t2 - 3.0f * t3),
+                     0.5f * (t3 - t2));
+}
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+constexpr size_t GATHER_CHUNK_BALLS = 4096;
+
+} // namespace
+
 GLWidget::GLWidget(QWidget* parent)
     : QOpenGLWidget(parent)
     , numTimesteps_(0)
     , currentTimestep_(0)
     , isPlaying_(false)
     , animationFPS_(10)
+    , interpolation_(Interpolation::None)
+    , playbackTime_(0.0)
+    , stepFraction_(0.0f)
     , simWidth_(1000)
     , simHeight_(800)
     , scaleX_(1.0)
@@ -20,15 +67,63 @@ GLWidget::GLWidget(QWidget* parent)
     , offsetX_(0)
     , offsetY_(0)
     , zoom_(1.0)
+    , viewLeft_(0.0)
+    , viewBottom_(0.0)
+    , viewWidth_(1000.0)
+    , viewHeight_(800.0)
     , isPanning_(false)
+    , showTrails_(false)
+    , trailLength_(64)
+    , trailTimestep_(-1)
+    , trailRebuild_(true)
+    , discTimestep_(-1)
+    , discWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , gpuResident_(true)
+    , residentRebuild_(true)
+    , residentFirst_(-1)
+    , residentValidFirst_(0)
+    , residentValidLast_(-1)
+    , gridTimestep_(-1)
+    , gridBuildTimestep_(-1)
+    , gridWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , gridBuildWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , gridGeneration_(0)
+    , gridBuildGeneration_(0)
+    , highlightProximity_(false)
+    , proximityGap_(0.0f)
+    , pairsTruncated_(false)
+    , selectedBall_(-1)
+    , pickPending_(false)
+    , pickX_(0.0f)
+    , pickY_(0.0f)
+    , showDensity_(false)
+    , densityFirst_(0)
+    , densityLast_(0)
+    , densityRebuild_(true)
+    , densityTextureDirty_(true)
+    , densityTexture_(0)
 {
     animTimer_ = new QTimer(this);
     connect(animTimer_, &QTimer::timeout, this, &GLWidget::OnAnimationTimer);
     setFocusPolicy(Qt::StrongFocus);
+    
+    gridWatcher_ = new QFutureWatcher<GridResult>(this);
+    connect(gridWatcher_, &QFutureWatcherBase::finished, this, &GLWidget::OnGridFinished);
 }
 
 GLWidget::~GLWidget() {
+    gridWatcher_->waitForFinished();
     delete animTimer_;
+    if (lineRenderer_.IsInitialized()) {
+        makeCurrent();
+        lineRenderer_.ReleaseTrail(trail_);
+        lineRenderer_.Cleanup();
+        discRenderer_.Cleanup();
+        if (densityTexture_ != 0) {
+            glDeleteTextures(1, &densityTexture_);
+        }
+        doneCurrent();
+    }
 }
 
 void GLWidget::LoadSimulation(const SimulationData& data) {
@@ -37,6 +132,12 @@ void GLWidget::LoadSimulation(const SimulationData& data) {
     simHeight_ = data.height;
     numTimesteps_ = data.numSteps;
     currentTimestep_ = 0;
+    stepFraction_ = 0.0f;
+    trailRebuild_ = true;
+    discTimestep_ = -1;
+    residentRebuild_ = true;
+    densityRebuild_ = true;
+    ResetProximity();
     
     // Reset view
     zoom_ = 1.0;
@@ -51,15 +152,34 @@ void GLWidget::ClearSimulation() {
     simData_ = SimulationData();
     numTimesteps_ = 0;
     currentTimestep_ = 0;
+    stepFraction_ = 0.0f;
+    trailRebuild_ = true;
+    discTimestep_ = -1;
+    residentRebuild_ = true;
+    densityRebuild_ = true;
+    ResetProximity();
     isPlaying_ = false;
     animTimer_->stop();
     update();
 }
 
+void GLWidget::ResetProximity() {
+    ++gridGeneration_;
+    grid_.reset();
+    gridTimestep_ = -1;
+    closePairs_.clear();
+    pairsTruncated_ = false;
+    pickPending_ = false;
+    selectedBall_ = -1;
+    emit BallSelected(-1);
+}
+
 void GLWidget::Play() {
     if (numTimesteps_ > 0) {
         isPlaying_ = true;
-        animTimer_->start(1000 / animationFPS_);
+        playbackTime_ = currentTimestep_ + stepFraction_;
+        playbackClock_.start();
+        animTimer_->start(interpolation_ != Interpolation::None ? FRAME_INTERVAL_MS : 1000 / animationFPS_);
     }
 }
 
@@ -72,6 +192,7 @@ void GLWidget::Stop() {
     isPlaying_ = false;
     animTimer_->stop();
     currentTimestep_ = 0;
+    stepFraction_ = 0.0f;
     emit TimestepChanged(currentTimestep_);
     update();
 }
@@ -79,13 +200,17 @@ void GLWidget::Stop() {
 void GLWidget::StepForward() {
     if (currentTimestep_ < numTimesteps_ - 1) {
         currentTimestep_++;
+        stepFraction_ = 0.0f;
         emit TimestepChanged(currentTimestep_);
         update();
     }
 }
 
 void GLWidget::StepBackward() {
-    if (currentTimestep_ > 0) {
+    if (stepFraction_ > 0.0f) {
+        stepFraction_ = 0.0f;
+        update();
+    } else if (currentTimestep_ > 0) {
         currentTimestep_--;
         emit TimestepChanged(currentTimestep_);
         update();
@@ -95,6 +220,8 @@ void GLWidget::StepBackward() {
 void GLWidget::SetTimestep(int timestep) {
     if (timestep >= 0 && timestep < numTimesteps_) {
         currentTimestep_ = timestep;
+        stepFraction_ = 0.0f;
+        playbackTime_ = timestep;
         emit TimestepChanged(currentTimestep_);
         update();
     }
@@ -102,12 +229,101 @@ void GLWidget::SetTimestep(int timestep) {
 
 void GLWidget::SetAnimationSpeed(int fps) {
     animationFPS_ = fps;
-    if (isPlaying_) {
+    if (isPlaying_ && interpolation_ == Interpolation::None) {
         animTimer_->setInterval(1000 / animationFPS_);
     }
 }
 
+void GLWidget::SetInterpolation(Interpolation interpolation) {
+    interpolation_ = interpolation;
+    if (interpolation_ == Interpolation::None) {
+        stepFraction_ = 0.0f;
+    }
+    if (isPlaying_) {
+        playbackTime_ = currentTimestep_ + stepFraction_;
+        playbackClock_.start();
+        animTimer_->setInterval(interpolation_ != Interpolation::None ? FRAME_INTERVAL_MS : 1000 / animationFPS_);
+    }
+    update();
+}
+
+void GLWidget::SetShowTrails(bool show) {
+    showTrails_ = show;
+    update();
+}
+
+void GLWidget::SetTrailLength(int length) {
+    if (length < 2 || length == trailLength_) return;
+    trailLength_ = length;
+    trailRebuild_ = true;
+    update();
+}
+
+void GLWidget::SetGpuResident(bool resident) {
+    if (resident == gpuResident_) return;
+    gpuResident_ = resident;
+    residentRebuild_ = true;
+    discTimestep_ = -1;
+    update();
+}
+
+void GLWidget::SetHighlightProximity(bool highlight) {
+    if (highlight == highlightProximity_) return;
+    highlightProximity_ = highlight;
+    
+    // Pairs are only searched for while highlighting
+    ++gridGeneration_;
+    gridTimestep_ = -1;
+    closePairs_.clear();
+    pairsTruncated_ = false;
+    emit ProximityUpdated();
+    update();
+}
+
+void GLWidget::SetProximityGap(double gap) {
+    proximityGap_ = static_cast<float>(std::max(gap, 0.0));
+    ++gridGeneration_;
+    gridTimestep_ = -1;
+    update();
+}
+
+void GLWidget::SetShowDensity(bool show) {
+    showDensity_ = show;
+    update();
+}
+
+void GLWidget::SetDensityRange(int first, int last) {
+    densityFirst_ = first;
+    densityLast_ = last;
+    if (showDensity_) {
+        update();
+    }
+}
+
+int GLWidget::CountSelectedNeighbours() const {
+    if (!grid_ || gridTimestep_ < 0 || selectedBall_ < 0) return -1;
+    return static_cast<int>(grid_->CountNeighbours(static_cast<size_t>(selectedBall_), proximityGap_));
+}
+
 void GLWidget::OnAnimationTimer() {
+    if (interpolation_ != Interpolation::None) {
+        playbackTime_ += playbackClock_.restart() * animationFPS_ / 1000.0;
+        int last = numTimesteps_ - 1;
+        if (playbackTime_ >= last) {
+            playbackTime_ = last;
+            Pause();
+            emit AnimationFinished();
+        }
+        int timestep = static_cast<int>(playbackTime_);
+        stepFraction_ = static_cast<float>(playbackTime_ - timestep);
+        if (timestep != currentTimestep_) {
+            currentTimestep_ = timestep;
+            emit TimestepChanged(currentTimestep_);
+        }
+        update();
+        return;
+    }
+    
     currentTimestep_++;
     if (currentTimestep_ >= numTimesteps_) {
         currentTimestep_ = numTimesteps_ - 1;  // Stay at last frame
@@ -125,6 +341,10 @@ void GLWidget::initializeGL() {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_LINE_SMOOTH);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    
+    lineRenderer_.Initialize(devicePixelRatioF());
+    discRenderer_.Initialize();
+    discRenderer_.SetOutline(1.5f, 0.0f, 0.0f, 0.0f);
 }
 
 void GLWidget::resizeGL(int w, int h) {
@@ -167,49 +387,62 @@ void GLWidget::paintGL() {
     double centerX = simWidth_ / 2.0 + offsetX_;
     double centerY = simHeight_ / 2.0 + offsetY_;
     
+    viewLeft_ = centerX - viewWidth / 2.0;
+    viewBottom_ = centerY - viewHeight / 2.0;
+    viewWidth_ = viewWidth;
+    viewHeight_ = viewHeight;
+    
     glOrtho(centerX - viewWidth / 2.0, centerX + viewWidth / 2.0,
             centerY - viewHeight / 2.0, centerY + viewHeight / 2.0, -1, 1);
     
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
     
+    QMatrix4x4 projection;
+    projection.ortho(centerX - viewWidth / 2.0, centerX + viewWidth / 2.0,
+                     centerY - viewHeight / 2.0, centerY + viewHeight / 2.0, -1.0f, 1.0f);
+    lineRenderer_.SetMatrix(projection);
+    discRenderer_.SetMatrix(projection, static_cast<float>(viewWidth / (w * devicePixelRatioF())));
+    
     DrawGrid();
     DrawAxes();
+    if (showDensity_) {
+        SyncDensity();
+        DrawDensity();
+    }
+    if (showTrails_) {
+        DrawTrails();
+    }
     DrawBalls();
+    SyncProximity();
+    DrawProximity();
 }
 
 void GLWidget::DrawGrid() {
-    glColor3f(0.9f, 0.9f, 0.9f);
-    glLineWidth(1.0f);
-    
-    double gridSpacing = 100.0;
+    float gridSpacing = 100.0f;
+    float w = static_cast<float>(simWidth_);
+    float h = static_cast<float>(simHeight_);
     
-    glBegin(GL_LINES);
+    lineVertices_.clear();
     // Vertical lines
-    for (double x = 0; x <= simWidth_; x += gridSpacing) {
-        glVertex2d(x, 0);
-        glVertex2d(x, simHeight_);
+    for (float x = 0; x <= w; x += gridSpacing) {
+        lineVertices_.insert(lineVertices_.end(), { x, 0, 0, x, h, 0 });
     }
     // Horizontal lines
-    for (double y = 0; y <= simHeight_; y += gridSpacing) {
-        glVertex2d(0, y);
-        glVertex2d(simWidth_, y);
+    for (float y = 0; y <= h; y += gridSpacing) {
+        lineVertices_.insert(lineVertices_.end(), { 0, y, 0, w, y, 0 });
     }
-    glEnd();
+    lineRenderer_.DrawSegments(lineVertices_, { 1.0f }, 0.9f, 0.9f, 0.9f);
 }
 
 void GLWidget::DrawAxes() {
-    glColor3f(0.5f, 0.5f, 0.5f);
-    glLineWidth(2.0f);
-    
-    glBegin(GL_LINES);
-    // X-axis
-    glVertex2d(0, 0);
-    glVertex2d(simWidth_, 0);
-    // Y-axis
-    glVertex2d(0, 0);
-    glVertex2d(0, simHeight_);
-    glEnd();
+    float w = static_cast<float>(simWidth_);
+    float h = static_cast<float>(simHeight_);
+    
+    // X-axis and Y-axis
+    lineVertices_.assign({ 0, 0, 0, w, 0, 0,
+                           0, 0, 0, 0, h, 0 });
+    lineRenderer_.DrawSegments(lineVertices_, { 2.0f }, 0.5f, 0.5f, 0.5f);
 }
 
 void GLWidget::DrawBalls() {
@@ -217,61 +450,411 @@ void GLWidget::DrawBalls() {
         return;
     }
     
+    QVector4D weights = StepWeights(interpolation_, stepFraction_);
+    if (SyncResidentRun()) {
+        discRenderer_.SetStepWeights(weights);
+        discRenderer_.DrawResident(currentTimestep_ - residentFirst_);
+        return;
+    }
+    
+    if (discTimestep_ != currentTimestep_ || discWeights_ != weights) {
+        UpdateDiscInstances(weights);
+    }
+    discRenderer_.Draw();
+}
+
+void GLWidget::UpdateDiscInstances(const QVector4D& weights) {
+    // Timesteps k-1 .. k+2 for the interpolation, repeating the first and last one
+    int last = numTimesteps_ - 1;
+    int steps[4] = { std::max(currentTimestep_ - 1, 0), currentTimestep_,
+                     std::min(currentTimestep_ + 1, last), std::min(currentTimestep_ + 2, last) };
+    float w[4] = { weights.x(), weights.y(), weights.z(), weights.w() };
+    
+    discInstances_.clear();
     for (const auto& ball : simData_.balls) {
-        Vec2D pos = ball.GetPosition(currentTimestep_);
-        DrawBall(pos.x, pos.y, ball.GetRadius(), ball.GetColor());
+        double x = 0.0, y = 0.0;
+        for (int i = 0; i < 4; ++i) {
+            const Vec2D& pos = ball.GetPosition(steps[i]);
+            x += w[i] * pos.x;
+            y += w[i] * pos.y;
+        }
+        const Rgba8& color = simData_.palette[ball.GetColorIndex()];
+        discInstances_.push_back({ static_cast<float>(x), static_cast<float>(y), static_cast<float>(ball.GetRadius()),
+                                   color.r, color.g, color.b, FILL_ALPHA });
     }
+    discRenderer_.SetInstances(discInstances_);
+    discTimestep_ = currentTimestep_;
+    discWeights_ = weights;
 }
 
-void GLWidget::DrawBall(double centerX, double centerY, double radius, const std::string& colorName) {
-    QColor color = GetColorFromName(colorName);
-    glColor4f(color.redF(), color.greenF(), color.blueF(), 0.8f);
+bool GLWidget::SyncResidentRun() {
+    size_t numBalls = simData_.balls.size();
+    if (residentRebuild_) {
+        discRenderer_.ReleaseResidentRun();
+        residentUpload_.clear();
+        residentUpload_.shrink_to_fit();
+        residentFirst_ = -1;
+        residentValidFirst_ = 0;
+        residentValidLast_ = -1;
+        residentRebuild_ = false;
+        
+        if (gpuResident_ && numBalls > 0 && numTimesteps_ > 0) {
+            size_t stepBytes = numBalls * 2 * sizeof(float);
+            size_t slots = std::clamp<size_t>(RESIDENT_MAX_BYTES / stepBytes, 1, static_cast<size_t>(numTimesteps_));
+            if (!discRenderer_.CreateResidentRun(numBalls, slots)) {
+                if (discRenderer_.IsInstanced()) {
+                    qWarning() << "Ball run doesn't fit in GPU memory, uploading every timestep instead";
+                }
+                discTimestep_ = -1;
+                return false;
+            }
+            
+            // Radius and color never change during a run
+            std::vector<DiscRenderer::Style> styles;
+            styles.reserve(numBalls);
+            for (const auto& ball : simData_.balls) {
+                const Rgba8& color = simData_.palette[ball.GetColorIndex()];
+                styles.push_back({ static_cast<float>(ball.GetRadius()), color.r, color.g, color.b, FILL_ALPHA });
+            }
+            discRenderer_.SetResidentStyles(styles);
+        }
+    }
+    if (!discRenderer_.HasResidentRun()) return false;
     
-    const int segments = 32;
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2d(centerX, centerY);
-    for (int i = 0; i <= segments; i++) {
-        double angle = 2.0 * M_PI * i / segments;
-        double x = centerX + radius * std::cos(angle);
-        double y = centerY + radius * std::sin(angle);
-        glVertex2d(x, y);
+    // Recentre the window when the current timestep or one it's interpolated from has left it
+    int slots = static_cast<int>(discRenderer_.GetResidentSlots());
+    int needFirst = std::max(currentTimestep_ - 1, 0);
+    int needLast = std::min(currentTimestep_ + 2, numTimesteps_ - 1);
+    if (slots < 4) {
+        needFirst = needLast = currentTimestep_;
+    }
+    if (residentFirst_ < 0 || needFirst < residentFirst_ || needLast >= residentFirst_ + slots) {
+        residentFirst_ = std::clamp(currentTimestep_ - slots / 2, 0, numTimesteps_ - slots);
+        residentValidFirst_ = 0;
+        residentValidLast_ = -1;
     }
-    glEnd();
     
-    // Draw outline
-    glColor3f(0.0f, 0.0f, 0.0f);
-    glLineWidth(1.5f);
-    glBegin(GL_LINE_LOOP);
-    for (int i = 0; i < segments; i++) {
-        double angle = 2.0 * M_PI * i / segments;
-        double x = centerX + radius * std::cos(angle);
-        double y = centerY + radius * std::sin(angle);
-        glVertex2d(x, y);
+    // One batch per frame, so creating or recentring a large window never stalls
+    // a paint; keep repainting until the window is full
+    UploadResidentBatch(needFirst, needLast);
+    if (residentValidFirst_ > residentFirst_ || residentValidLast_ < residentFirst_ + slots - 1) {
+        update();
     }
+    return needFirst >= residentValidFirst_ && needLast <= residentValidLast_;
+}
+
+void GLWidget::UploadResidentBatch(int needFirst, int needLast) {
+    size_t stepBytes = simData_.balls.size() * 2 * sizeof(float);
+    int batchSteps = static_cast<int>(std::max<size_t>(1, RESIDENT_UPLOAD_BYTES / stepBytes));
+    int windowLast = residentFirst_ + static_cast<int>(discRenderer_.GetResidentSlots()) - 1;
+    
+    // Start over from the needed timesteps when they are more than a batch away
+    // from the uploaded ones (a seek within the window)
+    bool empty = residentValidFirst_ > residentValidLast_;
+    if (empty || needLast < residentValidFirst_ - batchSteps || needFirst > residentValidLast_ + batchSteps) {
+        int last = std::min(needFirst + batchSteps - 1, windowLast);
+        UploadResidentSteps(needFirst, last - needFirst + 1);
+        residentValidFirst_ = needFirst;
+        residentValidLast_ = last;
+        return;
+    }
+    
+    // Grow towards the needed timesteps first, then forwards (the playback
+    // direction), then backwards
+    bool forward = needLast > residentValidLast_ ||
+                   (needFirst >= residentValidFirst_ && residentValidLast_ < windowLast);
+    if (forward && residentValidLast_ < windowLast) {
+        int last = std::min(residentValidLast_ + batchSteps, windowLast);
+        UploadResidentSteps(residentValidLast_ + 1, last - residentValidLast_);
+        residentValidLast_ = last;
+    } else if (residentValidFirst_ > residentFirst_) {
+        int first = std::max(residentValidFirst_ - batchSteps, residentFirst_);
+        UploadResidentSteps(first, residentValidFirst_ - first);
+        residentValidFirst_ = first;
+    }
+}
+
+void GLWidget::UploadResidentSteps(int firstTimestep, int numTimesteps) {
+    // Converted to floats in parallel; numTimesteps is at most one batch, so the
+    // staging copy stays small
+    size_t numBalls = simData_.balls.size();
+    size_t stepFloats = numBalls * 2;
+    size_t count = static_cast<size_t>(numTimesteps);
+    residentUpload_.resize(count * stepFloats);
+    
+    size_t numChunks = (numBalls + GATHER_CHUNK_BALLS - 1) / GATHER_CHUNK_BALLS;
+    RunChunks(numChunks, [&](size_t c) {
+        size_t end = std::min((c + 1) * GATHER_CHUNK_BALLS, numBalls);
+        for (size_t b = c * GATHER_CHUNK_BALLS; b < end; ++b) {
+            const Ball& ball = simData_.balls[b];
+            for (size_t s = 0; s < count; ++s) {
+                const Vec2D& pos = ball.GetPosition(firstTimestep + static_cast<int>(s));
+                float* out = &residentUpload_[s * stepFloats + b * 2];
+                out[0] = static_cast<float>(pos.x);
+                out[1] = static_cast<float>(pos.y);
+            }
+        }
+    });
+    discRenderer_.UploadResidentSteps(firstTimestep - residentFirst_, residentUpload_.data(), count);
+}
+
+Vec2D GLWidget::GetBallPosition(size_t index) const {
+    // Blended like the discs, so markers stay on them between stored timesteps
+    const Ball& ball = simData_.balls[index];
+    int last = numTimesteps_ - 1;
+    int steps[4] = { std::max(currentTimestep_ - 1, 0), currentTimestep_,
+                     std::min(currentTimestep_ + 1, last), std::min(currentTimestep_ + 2, last) };
+    QVector4D weights = StepWeights(interpolation_, stepFraction_);
+    float w[4] = { weights.x(), weights.y(), weights.z(), weights.w() };
+    
+    Vec2D pos;
+    for (int i = 0; i < 4; ++i) {
+        pos.x += w[i] * ball.GetPosition(steps[i]).x;
+        pos.y += w[i] * ball.GetPosition(steps[i]).y;
+    }
+    return pos;
+}
+
+bool GLWidget::IsGridCurrent() const {
+    return grid_ && gridTimestep_ == currentTimestep_ &&
+           gridWeights_ == StepWeights(interpolation_, stepFraction_);
+}
+
+void GLWidget::SyncProximity() {
+    // Built for the positions on screen when something needs it and no build is
+    // running; frames passed while a build runs are skipped
+    bool needed = highlightProximity_ || pickPending_ || selectedBall_ >= 0;
+    if (!needed || IsGridCurrent() || gridWatcher_->isRunning()) return;
+    if (simData_.balls.empty() || currentTimestep_ >= numTimesteps_) return;
+    
+    size_t numBalls = simData_.balls.size();
+    std::vector<float> xy(numBalls * 2);
+    std::vector<float> radii(numBalls);
+    for (size_t i = 0; i < numBalls; ++i) {
+        Vec2D pos = GetBallPosition(i);
+        xy[2 * i + 0] = static_cast<float>(pos.x);
+        xy[2 * i + 1] = static_cast<float>(pos.y);
+        radii[i] = static_cast<float>(simData_.balls[i].GetRadius());
+    }
+    
+    gridBuildTimestep_ = currentTimestep_;
+    gridBuildWeights_ = StepWeights(interpolation_, stepFraction_);
+    gridBuildGeneration_ = gridGeneration_;
+    float gap = proximityGap_;
+    bool findPairs = highlightProximity_;
+    gridWatcher_->setFuture(QtConcurrent::run([xy = std::move(xy), radii = std::move(radii),
+                                               gap, findPairs]() mutable {
+        GridResult result;
+        result.grid = std::make_shared<SpatialGrid>();
+        result.grid->Build(std::move(xy), std::move(radii));
+        if (findPairs) {
+            // One more than shown, to tell a full list from a cut one
+            result.pairs = result.grid->ClosePairs(gap, MAX_CLOSE_PAIRS + 1);
+        }
+        return result;
+    }));
+}
+
+void GLWidget::OnGridFinished() {
+    GridResult result = gridWatcher_->result();
+    if (gridBuildGeneration_ != gridGeneration_) {
+        update();
+        return;
+    }
+    
+    grid_ = std::move(result.grid);
+    gridTimestep_ = gridBuildTimestep_;
+    gridWeights_ = gridBuildWeights_;
+    closePairs_ = std::move(result.pairs);
+    pairsTruncated_ = closePairs_.size() > 2 * MAX_CLOSE_PAIRS;
+    if (pairsTruncated_) {
+        closePairs_.resize(2 * MAX_CLOSE_PAIRS);
+    }
+    
+    // A click made while the grid was stale picks from the newest one
+    if (pickPending_) {
+        ResolvePick();
+    }
+    emit ProximityUpdated();
+    update();
+}
+
+void GLWidget::ResolvePick() {
+    pickPending_ = false;
+    selectedBall_ = grid_ ? grid_->Pick(pickX_, pickY_) : -1;
+    emit BallSelected(selectedBall_);
+    update();
+}
+
+void GLWidget::DrawProximity() {
+    size_t numBalls = simData_.balls.size();
+    if (numBalls == 0 || currentTimestep_ >= numTimesteps_) return;
+    
+    // Close pairs as lines between the centers
+    if (highlightProximity_ && !closePairs_.empty()) {
+        lineVertices_.clear();
+        for (size_t k = 0; k + 1 < closePairs_.size(); k += 2) {
+            if (closePairs_[k + 1] >= numBalls) continue;
+            Vec2D a = GetBallPosition(closePairs_[k]);
+            Vec2D b = GetBallPosition(closePairs_[k + 1]);
+            lineVertices_.insert(lineVertices_.end(), { static_cast<float>(a.x), static_cast<float>(a.y), 0.0f,
+                                                        static_cast<float>(b.x), static_cast<float>(b.y), 0.0f });
+        }
+        lineRenderer_.DrawSegments(lineVertices_, { 2.0f }, 0.9f, 0.1f, 0.1f);
+    }
+    
+    // Selected ball inside an orange ring
+    if (selectedBall_ >= 0 && static_cast<size_t>(selectedBall_) < numBalls) {
+        Vec2D center = GetBallPosition(selectedBall_);
+        float radius = static_cast<float>(simData_.balls[selectedBall_].GetRadius() * 1.3);
+        lineVertices_.clear();
+        for (int i = 0; i < SELECTION_SEGMENTS; ++i) {
+            float a0 = 2.0f * static_cast<float>(M_PI) * i / SELECTION_SEGMENTS;
+            float a1 = 2.0f * static_cast<float>(M_PI) * (i + 1) / SELECTION_SEGMENTS;
+            lineVertices_.insert(lineVertices_.end(), {
+                static_cast<float>(center.x) + radius * std::cos(a0), static_cast<float>(center.y) + radius * std::sin(a0), 0.0f,
+                static_cast<float>(center.x) + radius * std::cos(a1), static_cast<float>(center.y) + radius * std::sin(a1), 0.0f });
+        }
+        lineRenderer_.DrawSegments(lineVertices_, { 3.0f }, 1.0f, 0.6f, 0.0f);
+    }
+}
+
+void GLWidget::SyncDensity() {
+    if (densityRebuild_) {
+        density_.SetBounds(0.0, 0.0, simWidth_, simHeight_, DENSITY_RESOLUTION);
+        densityRebuild_ = false;
+        densityTextureDirty_ = true;
+    }
+    int first = density_.GetFirst();
+    int last = density_.GetLast();
+    density_.SetRange(simData_, densityFirst_, densityLast_);
+    if (density_.GetFirst() != first || density_.GetLast() != last) {
+        densityTextureDirty_ = true;
+    }
+    if (!densityTextureDirty_) return;
+    
+    // Log scale, so cells visited a few times still show next to the busiest ones
+    const std::vector<int64_t>& counts = density_.GetCounts();
+    double scale = density_.GetMaxCount() > 0 ? 1.0 / std::log1p(static_cast<double>(density_.GetMaxCount())) : 0.0;
+    densityTexels_.assign(counts.size() * 4, 0);
+    for (size_t cell = 0; cell < counts.size(); ++cell) {
+        if (counts[cell] <= 0) continue;
+        unsigned char* texel = &densityTexels_[cell * 4];
+        float t = static_cast<float>(std::log1p(static_cast<double>(counts[cell])) * scale);
+        LineRenderer::SampleColormap(LineRenderer::Colormap::Viridis, t, texel);
+        texel[3] = DENSITY_ALPHA;
+    }
+    
+    if (densityTexture_ == 0) {
+        glGenTextures(1, &densityTexture_);
+        glBindTexture(GL_TEXTURE_2D, densityTexture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, densityTexture_);
+    }
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, density_.GetWidth(), density_.GetHeight(), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, densityTexels_.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    densityTextureDirty_ = false;
+}
+
+void GLWidget::DrawDensity() {
+    if (densityTexture_ == 0 || density_.GetFirst() < 0) return;
+    
+    // Cells are square, so the grid can reach a little past the simulation area
+    float w = static_cast<float>(density_.GetWidth() * density_.GetCellSize());
+    float h = static_cast<float>(density_.GetHeight() * density_.GetCellSize());
+    glActiveTexture(GL_TEXTURE0);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, densityTexture_);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f(w, 0.0f);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f(w, h);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, h);
     glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
 }
 
-QColor GLWidget::GetColorFromName(const std::string& colorName) const {
-    if (colorName == "Black") return QColor(0, 0, 0);
-    if (colorName == "Orange") return QColor(255, 165, 0);
-    if (colorName == "Blue") return QColor(0, 0, 255);
-    if (colorName == "Red") return QColor(255, 0, 0);
-    if (colorName == "Green") return QColor(0, 128, 0);
-    if (colorName == "Purple") return QColor(128, 0, 128);
-    if (colorName == "Cyan") return QColor(0, 255, 255);
-    if (colorName == "Brown") return QColor(165, 42, 42);
-    if (colorName == "Magenta") return QColor(255, 0, 255);
-    if (colorName == "Yellow") return QColor(255, 255, 0);
-    return QColor(128, 128, 128);  // Default gray
+void GLWidget::SyncTrail() {
+    size_t numBalls = simData_.balls.size();
+    if (trailRebuild_) {
+        lineRenderer_.ReleaseTrail(trail_);
+        trail_ = lineRenderer_.CreateTrail(numBalls, trailLength_);
+        trailRow_.resize(numBalls * 3, 0.0f);
+        trailTimestep_ = -1;
+        trailRebuild_ = false;
+        
+        std::vector<float> colors(numBalls * 4);
+        for (size_t i = 0; i < numBalls; ++i) {
+            const Rgba8& color = simData_.palette[simData_.balls[i].GetColorIndex()];
+            colors[4 * i + 0] = color.r / 255.0f;
+            colors[4 * i + 1] = color.g / 255.0f;
+            colors[4 * i + 2] = color.b / 255.0f;
+            colors[4 * i + 3] = 0.8f;
+        }
+        lineRenderer_.SetTrailColors(trail_, colors.data());
+    }
+    
+    if (trailTimestep_ == currentTimestep_) return;
+    
+    // Playing forward only appends the new timesteps; a seek or a step back refills the window
+    int first = trailTimestep_ + 1;
+    if (trailTimestep_ < 0 || currentTimestep_ < trailTimestep_ || currentTimestep_ - trailTimestep_ >= trail_.length) {
+        lineRenderer_.ClearTrail(trail_);
+        first = std::max(0, currentTimestep_ - trail_.length + 1);
+    }
+    for (int timestep = first; timestep <= currentTimestep_; ++timestep) {
+        for (size_t i = 0; i < numBalls; ++i) {
+            const Vec2D& pos = simData_.balls[i].GetPosition(timestep);
+            trailRow_[3 * i + 0] = static_cast<float>(pos.x);
+            trailRow_[3 * i + 1] = static_cast<float>(pos.y);
+        }
+        lineRenderer_.PushTrailRow(trail_, trailRow_.data());
+    }
+    trailTimestep_ = currentTimestep_;
+}
+
+void GLWidget::DrawTrails() {
+    if (simData_.balls.empty() || currentTimestep_ >= numTimesteps_) {
+        return;
+    }
+    
+    SyncTrail();
+    lineRenderer_.DrawTrail(trail_, { 2.0f });
 }
 
 void GLWidget::mousePressEvent(QMouseEvent* event) {
     if (event->button() == Qt::LeftButton) {
         lastMousePos_ = event->pos();
+        pressMousePos_ = event->pos();
         isPanning_ = true;
     }
 }
 
+void GLWidget::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) return;
+    isPanning_ = false;
+    
+    // A click that didn't pan picks, in the bounds of the last paint
+    int w = width();
+    int h = height();
+    if ((event->pos() - pressMousePos_).manhattanLength() > CLICK_MAX_DRAG || w <= 0 || h <= 0) return;
+    pickX_ = static_cast<float>(viewLeft_ + viewWidth_ * event->pos().x() / w);
+    pickY_ = static_cast<float>(viewBottom_ + viewHeight_ * (h - event->pos().y()) / h);
+    pickPending_ = true;
+    if (IsGridCurrent()) {
+        ResolvePick();
+    } else {
+        update();
+    }
+}
+
 void GLWidget::mouseMoveEvent(QMouseEvent* event) {
     if (isPanning_) {
         QPoint delta = event->pos() - lastMousePos_;
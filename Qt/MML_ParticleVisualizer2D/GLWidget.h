@@ -4,7 +4,15 @@
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QVector4D>
+#include <QFutureWatcher>
+#include <memory>
 #include "MMLData.h"
+#include "LineRenderer.h"
+#include "DiscRenderer.h"
+#include "SpatialGrid.h"
+#include "DensityGrid.h"
 
 class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions {
     Q_OBJECT
@@ -25,6 +33,40 @@ public:
     void SetTimestep(int timestep);
     void SetAnimationSpeed(int fps);
     
+    // Between stored timesteps balls are interpolated from the neighbouring ones;
+    // playback then advances a continuous time at display rate
+    enum class Interpolation { None, Linear, CatmullRom };
+    void SetInterpolation(Interpolation interpolation);
+    
+    // Keep the run's positions in GPU memory so changing timesteps uploads nothing;
+    // falls back to per-timestep instances without instancing or GPU memory
+    void SetGpuResident(bool resident);
+    
+    // Fading trails over the last `length` timesteps of every ball
+    void SetShowTrails(bool show);
+    void SetTrailLength(int length);
+    
+    // Proximity: a uniform grid over the balls where they are drawn, between stored
+    // timesteps too, built on a worker thread when needed. A click selects the ball under the cursor; with
+    // highlighting on, pairs whose edges are closer than the gap are joined by red
+    // lines (gap 0 shows the overlapping ones).
+    void SetHighlightProximity(bool highlight);
+    void SetProximityGap(double gap);
+    int GetSelectedBall() const { return selectedBall_; }
+    // Balls within the gap of the selected one, at the timestep the grid was built
+    // for; -1 while there is no grid
+    int CountSelectedNeighbours() const;
+    int GetProximityTimestep() const { return gridTimestep_; }
+    size_t GetNumClosePairs() const { return closePairs_.size() / 2; }
+    bool AreClosePairsTruncated() const { return pairsTruncated_; }
+    
+    // Density: how many ball centers fell in each cell of a grid over the simulation
+    // area during timesteps [first, last], colormapped on a log scale under the
+    // balls (empty cells stay clear). Moving the range recounts only the timesteps
+    // that entered or left it.
+    void SetShowDensity(bool show);
+    void SetDensityRange(int first, int last);
+    
     bool IsPlaying() const { return isPlaying_; }
     int GetCurrentTimestep() const { return currentTimestep_; }
     int GetNumTimesteps() const { return numTimesteps_; }
@@ -32,6 +74,10 @@ public:
 signals:
     void TimestepChanged(int timestep);
     void AnimationFinished();
+    // A click selected a ball, or nothing (-1)
+    void BallSelected(int index);
+    // A grid finished building; close pairs and neighbour counts changed
+    void ProximityUpdated();
 
 protected:
     void initializeGL() override;
@@ -39,19 +85,32 @@ protected:
     void paintGL() override;
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
     void wheelEvent(QWheelEvent* event) override;
 
 private slots:
     void OnAnimationTimer();
+    void OnGridFinished();
 
 private:
     void DrawGrid();
     void DrawAxes();
     void DrawBalls();
-    void DrawBall(double centerX, double centerY, double radius, const std::string& colorName);
+    void UpdateDiscInstances(const QVector4D& weights);
+    bool SyncResidentRun();
+    void UploadResidentBatch(int needFirst, int needLast);
+    void UploadResidentSteps(int firstTimestep, int numTimesteps);
+    void SyncTrail();
+    void DrawTrails();
     void UpdateView();
-    
-    QColor GetColorFromName(const std::string& colorName) const;
+    Vec2D GetBallPosition(size_t index) const;
+    void ResetProximity();
+    bool IsGridCurrent() const;
+    void SyncProximity();
+    void ResolvePick();
+    void DrawProximity();
+    void SyncDensity();
+    void DrawDensity();
 
     // Simulation data
     SimulationData simData_;
@@ -61,7 +120,12 @@ private:
     // Animation
     QTimer* animTimer_;
     bool isPlaying_;
-    int animationFPS_;
+    int animationFPS_;           // Timesteps per second
+    Interpolation interpolation_;
+    double playbackTime_;        // In timesteps, while playing with interpolation
+    QElapsedTimer playbackClock_;
+    float stepFraction_;         // Position between currentTimestep_ and the next one
+    static constexpr int FRAME_INTERVAL_MS = 7;
     
     // View parameters
     double simWidth_;
@@ -71,10 +135,88 @@ private:
     double offsetX_;
     double offsetY_;
     double zoom_;
+    double viewLeft_;            // Bounds drawn by the last paintGL, for clicks
+    double viewBottom_;
+    double viewWidth_;
+    double viewHeight_;
     
     // Mouse interaction
     QPoint lastMousePos_;
+    QPoint pressMousePos_;
     bool isPanning_;
+    
+    // Grid and axes as instanced wide lines
+    LineRenderer lineRenderer_;
+    std::vector<float> lineVertices_;
+    
+    // Trails: a GPU ring of the last trailLength_ ball positions, advanced one row
+    // per timestep; trailTimestep_ is the newest timestep in it (-1 when empty)
+    bool showTrails_;
+    int trailLength_;
+    LineRenderer::Trail trail_;
+    int trailTimestep_;
+    bool trailRebuild_;          // Simulation or length changed
+    std::vector<float> trailRow_;
+    
+    // Balls as instanced outlined discs, filled at FILL_ALPHA over the grid
+    static constexpr unsigned char FILL_ALPHA = 204;
+    DiscRenderer discRenderer_;
+    std::vector<DiscRenderer::Instance> discInstances_;
+    int discTimestep_;           // Timestep in the instance buffer, -1 when stale
+    QVector4D discWeights_;      // Step weights it was interpolated with
+    
+    // Resident run: a window of up to RESIDENT_MAX_BYTES of consecutive timesteps,
+    // the whole run when it fits, recentred on the current timestep when it leaves it.
+    // It is filled RESIDENT_UPLOAD_BYTES per frame outwards from the current timestep;
+    // the discs come from the instance buffer until the timesteps on screen are in
+    bool gpuResident_;
+    bool residentRebuild_;       // Simulation changed or residency toggled
+    int residentFirst_;          // Timestep in the first slot, -1 when there is no window
+    int residentValidFirst_;     // Uploaded timesteps of the window, empty when first > last
+    int residentValidLast_;
+    std::vector<float> residentUpload_;
+    static constexpr size_t RESIDENT_MAX_BYTES = size_t(512) << 20;
+    static constexpr size_t RESIDENT_UPLOAD_BYTES = size_t(16) << 20;
+    
+    // Proximity grid of gridTimestep_ (-1 when none) blended with gridWeights_, as
+    // the discs were drawn, with its close pairs; the generation discards builds
+    // started before the balls or the gap changed
+    struct GridResult {
+        std::shared_ptr<SpatialGrid> grid;
+        std::vector<uint32_t> pairs;
+    };
+    QFutureWatcher<GridResult>* gridWatcher_;
+    std::shared_ptr<SpatialGrid> grid_;
+    int gridTimestep_;
+    int gridBuildTimestep_;
+    QVector4D gridWeights_;
+    QVector4D gridBuildWeights_;
+    unsigned gridGeneration_;
+    unsigned gridBuildGeneration_;
+    bool highlightProximity_;
+    float proximityGap_;
+    std::vector<uint32_t> closePairs_;
+    bool pairsTruncated_;
+    int selectedBall_;
+    bool pickPending_;           // A click waits for the grid of the positions on screen
+    float pickX_;
+    float pickY_;
+    static constexpr size_t MAX_CLOSE_PAIRS = 100000;
+    static constexpr int CLICK_MAX_DRAG = 3;    // Pixels between press and release
+    static constexpr int SELECTION_SEGMENTS = 48;
+    
+    // Density counts of densityFirst_ .. densityLast_ and the texture they were
+    // colormapped into
+    bool showDensity_;
+    int densityFirst_;
+    int densityLast_;
+    DensityGrid density_;
+    bool densityRebuild_;        // Simulation changed
+    bool densityTextureDirty_;
+    GLuint densityTexture_;
+    std::vector<unsigned char> densityTexels_;
+    static constexpr int DENSITY_RESOLUTION = 256;     // Cells along the longer side
+    static constexpr unsigned char DENSITY_ALPHA = 200;
 };
 
 #endif // GLWIDGET_H
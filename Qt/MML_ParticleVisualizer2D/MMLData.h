@@ -12,17 +12,23 @@ struct Vec2D {
     Vec2D(double x_, double y_) : x(x_), y(y_) {}
 };
 
+// Packed 8-bit RGBA color, as uploaded to the GPU
+struct Rgba8 {
+    unsigned char r, g, b, a;
+};
+
 // Class for particle/ball (from WPF Ball class)
 class Ball {
 private:
     std::string name_;
     std::string color_;
     double radius_;
+    int colorIndex_;                // Into SimulationData::palette, resolved at load
     std::vector<Vec2D> positions_;  // Position at each timestep
 
 public:
     Ball(const std::string& name, const std::string& color, double radius) 
-        : name_(name), color_(color), radius_(radius) {}
+        : name_(name), color_(color), radius_(radius), colorIndex_(0) {}
     
     void AddPosition(const Vec2D& pos) {
         positions_.push_back(pos);
@@ -35,10 +41,13 @@ public:
         }
         return positions_[timestep];
     }
+    const std::vector<Vec2D>& GetPositions() const { return positions_; }
     
     std::string GetName() const { return name_; }
     std::string GetColor() const { return color_; }
     double GetRadius() const { return radius_; }
+    int GetColorIndex() const { return colorIndex_; }
+    void SetColorIndex(int index) { colorIndex_ = index; }
     int GetNumTimesteps() const { return static_cast<int>(positions_.size()); }
 };
 
@@ -48,6 +57,8 @@ struct SimulationData {
     double height;
     int numSteps;
     std::vector<Ball> balls;
+    std::vector<Rgba8> palette;     // Distinct ball colors
+    std::vector<double> stepTimes;  // Time of every step, from its Step line
     
     SimulationData() : width(1000), height(800), numSteps(0) {}
 };
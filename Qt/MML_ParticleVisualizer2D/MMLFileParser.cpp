@@ -2,6 +2,7 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <map>
 
 std::string MMLFileParser::Trim(const std::string& str) {
     size_t start = str.find_first_not_of(" \t\r\n");
@@ -10,6 +11,20 @@ std::string MMLFileParser::Trim(const std::string& str) {
     return str.substr(start, end - start + 1);
 }
 
+Rgba8 MMLFileParser::ColorFromName(const std::string& name) {
+    if (name == "Black") return { 0, 0, 0, 255 };
+    if (name == "Orange") return { 255, 165, 0, 255 };
+    if (name == "Blue") return { 0, 0, 255, 255 };
+    if (name == "Red") return { 255, 0, 0, 255 };
+    if (name == "Green") return { 0, 128, 0, 255 };
+    if (name == "Purple") return { 128, 0, 128, 255 };
+    if (name == "Cyan") return { 0, 255, 255, 255 };
+    if (name == "Brown") return { 165, 42, 42, 255 };
+    if (name == "Magenta") return { 255, 0, 255, 255 };
+    if (name == "Yellow") return { 255, 255, 0, 255 };
+    return { 128, 128, 128, 255 };  // Default gray
+}
+
 bool MMLFileParser::ParseFile(const std::string& filename, SimulationData& data, std::string& errorMsg) {
     std::ifstream file(filename);
     if (!file.is_open()) {
@@ -88,7 +103,8 @@ bool MMLFileParser::ParseFile(const std::string& filename, SimulationData& data,
             return false;
         }
 
-        // Parse ball definitions
+        // Parse ball definitions; each distinct color name gets one palette entry
+        std::map<std::string, int> paletteIndex;
         for (int i = 0; i < numBalls; i++) {
             if (!std::getline(file, line)) {
                 errorMsg = "Missing ball definition at line " + std::to_string(lineNum + 1);
@@ -107,7 +123,13 @@ bool MMLFileParser::ParseFile(const std::string& filename, SimulationData& data,
                 return false;
             }
             
+            auto found = paletteIndex.find(color);
+            if (found == paletteIndex.end()) {
+                found = paletteIndex.emplace(color, static_cast<int>(data.palette.size())).first;
+                data.palette.push_back(ColorFromName(color));
+            }
             data.balls.push_back(Ball(name, color, radius));
+            data.balls.back().SetColorIndex(found->second);
         }
 
         // NumSteps (with or without colon)
@@ -146,6 +168,7 @@ bool MMLFileParser::ParseFile(const std::string& filename, SimulationData& data,
                 errorMsg = "Expected 'Step' keyword at line " + std::to_string(lineNum);
                 return false;
             }
+            data.stepTimes.push_back(iss.fail() ? static_cast<double>(step) : time);
 
             // Read positions for each ball
             for (int ballIdx = 0; ballIdx < numBalls; ballIdx++) {
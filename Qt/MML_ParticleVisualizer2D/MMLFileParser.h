@@ -8,6 +8,9 @@ class MMLFileParser {
 public:
     // Parse PARTICLE_SIMULATION_DATA_2D format file
     static bool ParseFile(const std::string& filename, SimulationData& data, std::string& errorMsg);
+    
+    // Supported color names; anything else is gray
+    static Rgba8 ColorFromName(const std::string& name);
 
 private:
     static std::string Trim(const std::string& str);
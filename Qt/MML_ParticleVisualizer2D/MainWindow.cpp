@@ -6,16 +6,23 @@
 #include <QMessageBox>
 #include <QGroupBox>
 #include <QSplitter>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <map>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
+    , statisticsCancel_(false)
 {
     SetupUI();
+    statisticsWatcher_ = new QFutureWatcher<std::shared_ptr<StepStatistics>>(this);
+    connect(statisticsWatcher_, &QFutureWatcherBase::finished, this, &MainWindow::OnStatisticsFinished);
     setWindowTitle("MML Particle Visualizer 2D - Qt");
     resize(1400, 900);
 }
 
 MainWindow::~MainWindow() {
+    CancelStatistics();
 }
 
 void MainWindow::SetupUI() {
@@ -24,9 +31,16 @@ void MainWindow::SetupUI() {
     
     QHBoxLayout* mainLayout = new QHBoxLayout(centralWidget);
     
-    // Left panel - OpenGL widget
-    glWidget_ = new GLWidget(this);
+    // Left panel - OpenGL widget, with the statistics pane below it
+    QSplitter* plotSplitter = new QSplitter(Qt::Vertical, this);
+    glWidget_ = new GLWidget(plotSplitter);
     glWidget_->setMinimumSize(800, 600);
+    statisticsPlot_ = new StatisticsPlotWidget(plotSplitter);
+    statisticsPlot_->hide();
+    plotSplitter->addWidget(glWidget_);
+    plotSplitter->addWidget(statisticsPlot_);
+    plotSplitter->setStretchFactor(0, 3);
+    plotSplitter->setStretchFactor(1, 1);
     
     // Right panel - controls
     QWidget* rightPanel = new QWidget(this);
@@ -82,6 +96,35 @@ void MainWindow::SetupUI() {
     speedLayout->addWidget(speedLabel_);
     animLayout->addLayout(speedLayout);
     
+    // Smooth playback between stored timesteps
+    QHBoxLayout* interpolationLayout = new QHBoxLayout();
+    interpolationLayout->addWidget(new QLabel("Interpolation:", this));
+    interpolationCombo_ = new QComboBox(this);
+    interpolationCombo_->addItem("None");
+    interpolationCombo_->addItem("Linear");
+    interpolationCombo_->addItem("Catmull-Rom");
+    connect(interpolationCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::OnInterpolationChanged);
+    interpolationLayout->addWidget(interpolationCombo_, 1);
+    gpuResidentCheckBox_ = new QCheckBox("Keep run on GPU", this);
+    gpuResidentCheckBox_->setChecked(true);
+    connect(gpuResidentCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnGpuResidentChanged);
+    interpolationLayout->addWidget(gpuResidentCheckBox_);
+    animLayout->addLayout(interpolationLayout);
+    
+    // Trails
+    QHBoxLayout* trailLayout = new QHBoxLayout();
+    showTrailsCheckBox_ = new QCheckBox("Show trails", this);
+    connect(showTrailsCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowTrailsChanged);
+    trailLayout->addWidget(showTrailsCheckBox_);
+    trailLayout->addWidget(new QLabel("Length:", this));
+    trailLengthSpinBox_ = new QSpinBox(this);
+    trailLengthSpinBox_->setRange(2, 1024);
+    trailLengthSpinBox_->setValue(64);
+    trailLengthSpinBox_->setSuffix(" steps");
+    connect(trailLengthSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::OnTrailLengthChanged);
+    trailLayout->addWidget(trailLengthSpinBox_);
+    animLayout->addLayout(trailLayout);
+    
     rightLayout->addWidget(animGroup);
     
     // Legend
@@ -91,6 +134,81 @@ void MainWindow::SetupUI() {
     legendLayout->addWidget(legendList_);
     rightLayout->addWidget(legendGroup);
     
+    // Proximity: selected ball and close pairs
+    QGroupBox* proximityGroup = new QGroupBox("Proximity", this);
+    QVBoxLayout* proximityLayout = new QVBoxLayout(proximityGroup);
+    QHBoxLayout* gapLayout = new QHBoxLayout();
+    highlightProximityCheckBox_ = new QCheckBox("Highlight close pairs", this);
+    connect(highlightProximityCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnHighlightProximityChanged);
+    gapLayout->addWidget(highlightProximityCheckBox_);
+    gapLayout->addWidget(new QLabel("Gap:", this));
+    proximityGapSpinBox_ = new QDoubleSpinBox(this);
+    proximityGapSpinBox_->setRange(0.0, 1.0e6);
+    proximityGapSpinBox_->setDecimals(2);
+    proximityGapSpinBox_->setValue(0.0);
+    proximityGapSpinBox_->setToolTip("Pairs whose edges are closer than this; 0 shows overlaps");
+    connect(proximityGapSpinBox_, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::OnProximityGapChanged);
+    gapLayout->addWidget(proximityGapSpinBox_, 1);
+    proximityLayout->addLayout(gapLayout);
+    closePairsLabel_ = new QLabel(this);
+    proximityLayout->addWidget(closePairsLabel_);
+    selectedBallLabel_ = new QLabel(this);
+    selectedBallLabel_->setWordWrap(true);
+    proximityLayout->addWidget(selectedBallLabel_);
+    rightLayout->addWidget(proximityGroup);
+    
+    // Statistics: per-step speed, energy, centers of mass and extents of the run
+    QGroupBox* statisticsGroup = new QGroupBox("Statistics", this);
+    QVBoxLayout* statisticsLayout = new QVBoxLayout(statisticsGroup);
+    QHBoxLayout* kindLayout = new QHBoxLayout();
+    kindLayout->addWidget(new QLabel("Plot:", this));
+    statisticKindCombo_ = new QComboBox(this);
+    for (StatisticKind kind : { StatisticKind::Speed, StatisticKind::KineticEnergy,
+                                StatisticKind::CenterOfMass, StatisticKind::Extents }) {
+        statisticKindCombo_->addItem(StepStatistics::GetKindName(kind));
+    }
+    connect(statisticKindCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::OnStatisticKindChanged);
+    kindLayout->addWidget(statisticKindCombo_, 1);
+    statisticsLayout->addLayout(kindLayout);
+    QHBoxLayout* statisticsButtonsLayout = new QHBoxLayout();
+    showStatisticsCheckBox_ = new QCheckBox("Show plot", this);
+    connect(showStatisticsCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowStatisticsChanged);
+    statisticsButtonsLayout->addWidget(showStatisticsCheckBox_);
+    statisticsButtonsLayout->addStretch();
+    saveStatisticsButton_ = new QPushButton("Save...", this);
+    saveStatisticsButton_->setToolTip("Save the plotted series as a MULTI_REAL_FUNCTION file");
+    saveStatisticsButton_->setEnabled(false);
+    connect(saveStatisticsButton_, &QPushButton::clicked, this, &MainWindow::OnSaveStatistics);
+    statisticsButtonsLayout->addWidget(saveStatisticsButton_);
+    statisticsLayout->addLayout(statisticsButtonsLayout);
+    statisticsStatusLabel_ = new QLabel("Statistics: -", this);
+    statisticsLayout->addWidget(statisticsStatusLabel_);
+    rightLayout->addWidget(statisticsGroup);
+    
+    // Density: where the balls spent their time over a range of timesteps
+    QGroupBox* densityGroup = new QGroupBox("Density", this);
+    QVBoxLayout* densityLayout = new QVBoxLayout(densityGroup);
+    showDensityCheckBox_ = new QCheckBox("Show density", this);
+    connect(showDensityCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowDensityChanged);
+    densityLayout->addWidget(showDensityCheckBox_);
+    QHBoxLayout* densityFirstLayout = new QHBoxLayout();
+    densityFirstLayout->addWidget(new QLabel("From:", this));
+    densityFirstSlider_ = new QSlider(Qt::Horizontal, this);
+    densityFirstSlider_->setRange(0, 0);
+    connect(densityFirstSlider_, &QSlider::valueChanged, this, &MainWindow::OnDensityRangeChanged);
+    densityFirstLayout->addWidget(densityFirstSlider_);
+    densityLayout->addLayout(densityFirstLayout);
+    QHBoxLayout* densityLastLayout = new QHBoxLayout();
+    densityLastLayout->addWidget(new QLabel("To:", this));
+    densityLastSlider_ = new QSlider(Qt::Horizontal, this);
+    densityLastSlider_->setRange(0, 0);
+    connect(densityLastSlider_, &QSlider::valueChanged, this, &MainWindow::OnDensityRangeChanged);
+    densityLastLayout->addWidget(densityLastSlider_);
+    densityLayout->addLayout(densityLastLayout);
+    densityRangeLabel_ = new QLabel("Timesteps: -", this);
+    densityLayout->addWidget(densityRangeLabel_);
+    rightLayout->addWidget(densityGroup);
+    
     // Info panel
     QGroupBox* infoGroup = new QGroupBox("Information", this);
     QVBoxLayout* infoLayout = new QVBoxLayout(infoGroup);
@@ -115,14 +233,17 @@ void MainWindow::SetupUI() {
     rightPanel->setMaximumWidth(350);
     
     // Add to main layout
-    mainLayout->addWidget(glWidget_, 1);
+    mainLayout->addWidget(plotSplitter, 1);
     mainLayout->addWidget(rightPanel);
     
     // Connect GLWidget signals
     connect(glWidget_, &GLWidget::TimestepChanged, this, &MainWindow::OnTimestepChanged);
+    connect(glWidget_, &GLWidget::BallSelected, this, &MainWindow::OnBallSelected);
+    connect(glWidget_, &GLWidget::ProximityUpdated, this, &MainWindow::OnProximityUpdated);
     
     // Initial state
     UpdatePlayButtonText();
+    UpdateProximityInfo();
 }
 
 void MainWindow::LoadDataFile(const QString& filename) {
@@ -134,6 +255,8 @@ void MainWindow::LoadDataFile(const QString& filename) {
         return;
     }
     
+    // The build of the previous run's statistics reads currentData_
+    CancelStatistics();
     currentData_ = data;
     currentFilename_ = filename;
     
@@ -147,6 +270,8 @@ void MainWindow::LoadDataFile(const QString& filename) {
     UpdateInfo();
     UpdateTimestepLabel();
     UpdatePlayButtonText();
+    ResetDensityRange();
+    StartStatistics();
 }
 
 void MainWindow::OnLoadFile() {
@@ -168,10 +293,13 @@ void MainWindow::OnReset() {
     infoText_->clear();
     timestepSlider_->setMaximum(0);
     timestepSlider_->setValue(0);
+    CancelStatistics();
     currentData_ = SimulationData();
     currentFilename_.clear();
     UpdateTimestepLabel();
     UpdatePlayButtonText();
+    ResetDensityRange();
+    StartStatistics();
 }
 
 void MainWindow::OnPlayPause() {
@@ -205,6 +333,7 @@ void MainWindow::OnTimestepChanged(int timestep) {
     timestepSlider_->setValue(timestep);
     timestepSlider_->blockSignals(false);
     UpdateTimestepLabel();
+    UpdateStatisticsCursor();
 }
 
 void MainWindow::OnSpeedChanged(int value) {
@@ -212,6 +341,203 @@ void MainWindow::OnSpeedChanged(int value) {
     speedLabel_->setText(QString("%1 FPS").arg(value));
 }
 
+void MainWindow::OnInterpolationChanged(int index) {
+    glWidget_->SetInterpolation(static_cast<GLWidget::Interpolation>(index));
+}
+
+void MainWindow::OnGpuResidentChanged(bool checked) {
+    glWidget_->SetGpuResident(checked);
+}
+
+void MainWindow::OnShowTrailsChanged(bool checked) {
+    glWidget_->SetShowTrails(checked);
+}
+
+void MainWindow::OnTrailLengthChanged(int value) {
+    glWidget_->SetTrailLength(value);
+}
+
+void MainWindow::OnHighlightProximityChanged(bool checked) {
+    glWidget_->SetHighlightProximity(checked);
+}
+
+void MainWindow::OnProximityGapChanged(double value) {
+    glWidget_->SetProximityGap(value);
+}
+
+void MainWindow::OnBallSelected(int index) {
+    Q_UNUSED(index);
+    UpdateProximityInfo();
+}
+
+void MainWindow::OnProximityUpdated() {
+    UpdateProximityInfo();
+}
+
+void MainWindow::UpdateProximityInfo() {
+    if (!highlightProximityCheckBox_->isChecked()) {
+        closePairsLabel_->setText("Close pairs: -");
+    } else if (glWidget_->GetProximityTimestep() < 0) {
+        closePairsLabel_->setText("Close pairs: ...");
+    } else {
+        QString pairs = QString::number(glWidget_->GetNumClosePairs());
+        if (glWidget_->AreClosePairsTruncated()) {
+            pairs += "+ (first shown)";
+        }
+        closePairsLabel_->setText(QString("Close pairs: %1").arg(pairs));
+    }
+    
+    int index = glWidget_->GetSelectedBall();
+    if (index < 0 || index >= static_cast<int>(currentData_.balls.size())) {
+        selectedBallLabel_->setText("Click a particle to select it");
+        return;
+    }
+    
+    // Position and neighbours at the timestep the grid was built for
+    const Ball& ball = currentData_.balls[index];
+    QString text = QString("%1 (#%2), r=%3").arg(QString::fromStdString(ball.GetName())).arg(index).arg(ball.GetRadius());
+    int timestep = glWidget_->GetProximityTimestep();
+    int neighbours = glWidget_->CountSelectedNeighbours();
+    if (timestep >= 0 && neighbours >= 0) {
+        const Vec2D& pos = ball.GetPosition(timestep);
+        text += QString("\nPosition: (%1, %2), within gap: %3")
+                    .arg(pos.x, 0, 'g', 5).arg(pos.y, 0, 'g', 5).arg(neighbours);
+    }
+    selectedBallLabel_->setText(text);
+}
+
+void MainWindow::StartStatistics() {
+    statistics_.reset();
+    statisticsPlot_->Clear();
+    saveStatisticsButton_->setEnabled(false);
+    if (currentData_.balls.empty() || currentData_.numSteps <= 0) {
+        statisticsStatusLabel_->setText("Statistics: -");
+        return;
+    }
+    
+    statisticsStatusLabel_->setText("Statistics: computing...");
+    statisticsCancel_ = false;
+    statisticsWatcher_->setFuture(QtConcurrent::run([this]() {
+        return StepStatisticsBuilder::Build(currentData_, &statisticsCancel_);
+    }));
+}
+
+void MainWindow::CancelStatistics() {
+    statisticsCancel_ = true;
+    statisticsWatcher_->waitForFinished();
+}
+
+void MainWindow::OnStatisticsFinished() {
+    // A build cancelled by a later load finishes without a result
+    if (!statisticsWatcher_->isFinished()) return;
+    std::shared_ptr<StepStatistics> statistics = statisticsWatcher_->result();
+    if (!statistics) return;
+    
+    statistics_ = statistics;
+    statisticsStatusLabel_->setText(QString("Statistics: %1 steps in %2 s")
+                                        .arg(statistics_->numSteps)
+                                        .arg(statistics_->seconds, 0, 'f', 2));
+    saveStatisticsButton_->setEnabled(statistics_->numSteps > 0);
+    UpdateStatisticsPlot();
+}
+
+void MainWindow::UpdateStatisticsPlot() {
+    statisticsPlot_->Clear();
+    if (!statistics_ || statistics_->numSteps <= 0) return;
+    
+    auto kind = static_cast<StatisticKind>(statisticKindCombo_->currentIndex());
+    statisticsPlot_->SetTitle(QString("%1 - %2").arg(QFileInfo(currentFilename_).fileName()).arg(StepStatistics::GetKindName(kind)));
+    statisticsPlot_->SetTime(statistics_->time);
+    
+    // Series naming the same panel share its axes
+    std::map<std::string, int> panels;
+    for (const auto& series : statistics_->GetSeries(kind)) {
+        auto found = panels.find(series.panel);
+        if (found == panels.end()) {
+            found = panels.emplace(series.panel, statisticsPlot_->AddPanel(QString::fromStdString(series.panel))).first;
+        }
+        QColor color(series.color.r, series.color.g, series.color.b);
+        statisticsPlot_->AddSeries(found->second, QString::fromStdString(series.name), color, series.values);
+    }
+    if (kind == StatisticKind::Speed && !panels.empty()) {
+        statisticsPlot_->SetDensity(panels.begin()->second, statistics_->speedDistribution,
+                                    StepStatistics::SPEED_BINS, statistics_->speedBinWidth);
+    }
+    UpdateStatisticsCursor();
+}
+
+void MainWindow::UpdateStatisticsCursor() {
+    int timestep = glWidget_->GetCurrentTimestep();
+    if (statistics_ && timestep >= 0 && timestep < statistics_->numSteps) {
+        statisticsPlot_->SetCursorT(statistics_->time[timestep]);
+    }
+}
+
+void MainWindow::OnStatisticKindChanged(int index) {
+    Q_UNUSED(index);
+    UpdateStatisticsPlot();
+}
+
+void MainWindow::OnShowStatisticsChanged(bool checked) {
+    statisticsPlot_->setVisible(checked);
+}
+
+void MainWindow::OnSaveStatistics() {
+    if (!statistics_) return;
+    
+    auto kind = static_cast<StatisticKind>(statisticKindCombo_->currentIndex());
+    QString filename = QFileDialog::getSaveFileName(
+        this,
+        "Save Statistics",
+        QString(),
+        "Text Files (*.txt);;All Files (*.*)"
+    );
+    if (filename.isEmpty()) return;
+    
+    std::string title = QFileInfo(currentFilename_).completeBaseName().toStdString() + " - " + StepStatistics::GetKindName(kind);
+    if (!statistics_->SaveMultiRealFunction(filename.toStdString(), title, statistics_->GetSeries(kind))) {
+        QMessageBox::critical(this, "Error", QString("Failed to save file:\n%1").arg(filename));
+    }
+}
+
+void MainWindow::ResetDensityRange() {
+    // The whole run
+    int last = std::max(currentData_.numSteps - 1, 0);
+    for (QSlider* slider : { densityFirstSlider_, densityLastSlider_ }) {
+        slider->blockSignals(true);
+        slider->setRange(0, last);
+    }
+    densityFirstSlider_->setValue(0);
+    densityLastSlider_->setValue(last);
+    densityFirstSlider_->blockSignals(false);
+    densityLastSlider_->blockSignals(false);
+    OnDensityRangeChanged();
+}
+
+void MainWindow::OnShowDensityChanged(bool checked) {
+    glWidget_->SetShowDensity(checked);
+}
+
+void MainWindow::OnDensityRangeChanged() {
+    // Dragging one end past the other pushes it along
+    int first = densityFirstSlider_->value();
+    int last = densityLastSlider_->value();
+    if (first > last) {
+        QSlider* other = sender() == densityLastSlider_ ? densityFirstSlider_ : densityLastSlider_;
+        other->blockSignals(true);
+        other->setValue(other == densityFirstSlider_ ? last : first);
+        other->blockSignals(false);
+        first = densityFirstSlider_->value();
+        last = densityLastSlider_->value();
+    }
+    glWidget_->SetDensityRange(first, last);
+    if (currentData_.numSteps > 0) {
+        densityRangeLabel_->setText(QString("Timesteps: %1 - %2 (%3)").arg(first).arg(last).arg(last - first + 1));
+    } else {
+        densityRangeLabel_->setText("Timesteps: -");
+    }
+}
+
 void MainWindow::UpdateLegend() {
     legendList_->clear();
     
@@ -220,20 +546,8 @@ void MainWindow::UpdateLegend() {
         QListWidgetItem* item = new QListWidgetItem(text, legendList_);
         
         // Set color
-        QString colorName = QString::fromStdString(ball.GetColor());
-        QColor color;
-        if (colorName == "Black") color = QColor(0, 0, 0);
-        else if (colorName == "Orange") color = QColor(255, 165, 0);
-        else if (colorName == "Blue") color = QColor(0, 0, 255);
-        else if (colorName == "Red") color = QColor(255, 0, 0);
-        else if (colorName == "Green") color = QColor(0, 128, 0);
-        else if (colorName == "Purple") color = QColor(128, 0, 128);
-        else if (colorName == "Cyan") color = QColor(0, 255, 255);
-        else if (colorName == "Brown") color = QColor(165, 42, 42);
-        else if (colorName == "Magenta") color = QColor(255, 0, 255);
-        else if (colorName == "Yellow") color = QColor(255, 255, 0);
-        
-        item->setForeground(QBrush(color));
+        const Rgba8& color = currentData_.palette[ball.GetColorIndex()];
+        item->setForeground(QBrush(QColor(color.r, color.g, color.b)));
     }
 }
 
@@ -247,6 +561,7 @@ void MainWindow::UpdateInfo() {
     info += "Controls:\n";
     info += "- Mouse drag: Pan view\n";
     info += "- Mouse wheel: Zoom\n";
+    info += "- Click: Select particle\n";
     info += "- Slider: Scrub timesteps\n";
     
     infoText_->setPlainText(info);
@@ -7,8 +7,17 @@
 #include <QSlider>
 #include <QLabel>
 #include <QPushButton>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QComboBox>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
 #include "GLWidget.h"
 #include "MMLData.h"
+#include "StepStatistics.h"
+#include "StatisticsPlotWidget.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -29,6 +38,20 @@ private slots:
     void OnTimestepSliderChanged(int value);
     void OnTimestepChanged(int timestep);
     void OnSpeedChanged(int value);
+    void OnShowTrailsChanged(bool checked);
+    void OnTrailLengthChanged(int value);
+    void OnInterpolationChanged(int index);
+    void OnGpuResidentChanged(bool checked);
+    void OnHighlightProximityChanged(bool checked);
+    void OnProximityGapChanged(double value);
+    void OnBallSelected(int index);
+    void OnProximityUpdated();
+    void OnStatisticsFinished();
+    void OnStatisticKindChanged(int index);
+    void OnShowStatisticsChanged(bool checked);
+    void OnSaveStatistics();
+    void OnShowDensityChanged(bool checked);
+    void OnDensityRangeChanged();
 
 private:
     void SetupUI();
@@ -36,6 +59,12 @@ private:
     void UpdateInfo();
     void UpdateTimestepLabel();
     void UpdatePlayButtonText();
+    void UpdateProximityInfo();
+    void StartStatistics();
+    void CancelStatistics();
+    void UpdateStatisticsPlot();
+    void UpdateStatisticsCursor();
+    void ResetDensityRange();
 
     GLWidget* glWidget_;
     QListWidget* legendList_;
@@ -48,9 +77,32 @@ private:
     QPushButton* stepForwardButton_;
     QSlider* speedSlider_;
     QLabel* speedLabel_;
+    QCheckBox* showTrailsCheckBox_;
+    QSpinBox* trailLengthSpinBox_;
+    QComboBox* interpolationCombo_;
+    QCheckBox* gpuResidentCheckBox_;
+    QCheckBox* highlightProximityCheckBox_;
+    QDoubleSpinBox* proximityGapSpinBox_;
+    QLabel* closePairsLabel_;
+    QLabel* selectedBallLabel_;
+    StatisticsPlotWidget* statisticsPlot_;
+    QComboBox* statisticKindCombo_;
+    QCheckBox* showStatisticsCheckBox_;
+    QPushButton* saveStatisticsButton_;
+    QLabel* statisticsStatusLabel_;
+    QCheckBox* showDensityCheckBox_;
+    QSlider* densityFirstSlider_;
+    QSlider* densityLastSlider_;
+    QLabel* densityRangeLabel_;
     
     SimulationData currentData_;
     QString currentFilename_;
+    
+    // Built in the background after every load; the build reads currentData_, so
+    // it is cancelled and waited for before currentData_ changes
+    QFutureWatcher<std::shared_ptr<StepStatistics>>* statisticsWatcher_;
+    std::atomic<bool> statisticsCancel_;
+    std::shared_ptr<StepStatistics> statistics_;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,172 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+float Distance(const float* a, const float* b) {
+    float dx = a[0] - b[0], dy = a[1] - b[1];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+} // namespace
+
+void SpatialGrid::Build(std::vector<float> xy, std::vector<float> radii) {
+    xy_ = std::move(xy);
+    radii_ = std::move(radii);
+    cellStart_.clear();
+    cellObjects_.clear();
+    maxRadius_ = 0.0f;
+    dims_[0] = dims_[1] = 0;
+
+    size_t n = radii_.size();
+    size_t count = 0;
+    float lo[2], hi[2];
+    for (int a = 0; a < 2; ++a) {
+        lo[a] = std::numeric_limits<float>::max();
+        hi[a] = -std::numeric_limits<float>::max();
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (radii_[i] < 0.0f) continue;
+        ++count;
+        maxRadius_ = std::max(maxRadius_, radii_[i]);
+        for (int a = 0; a < 2; ++a) {
+            lo[a] = std::min(lo[a], xy_[2 * i + a]);
+            hi[a] = std::max(hi[a], xy_[2 * i + a]);
+        }
+    }
+    if (count == 0) return;
+
+    // About one disc per cell, never narrower than a disc; lines or clusters of
+    // discs widen the cells until there are at most twice as many cells as discs
+    float extent[2];
+    double area = 1.0;
+    for (int a = 0; a < 2; ++a) {
+        extent[a] = hi[a] - lo[a];
+        area *= std::max(extent[a], 1e-6f);
+    }
+    float size = std::max({ 2.0f * maxRadius_, static_cast<float>(std::sqrt(area / count)), 1e-6f });
+    double maxCells = std::max<double>(2.0 * count, 64.0);
+    auto numCells = [&](float h) {
+        return (std::floor(extent[0] / h) + 1.0) * (std::floor(extent[1] / h) + 1.0);
+    };
+    while (numCells(size) > maxCells) size *= 1.25f;
+
+    cellSize_ = size;
+    for (int a = 0; a < 2; ++a) {
+        origin_[a] = lo[a];
+        dims_[a] = static_cast<int>(extent[a] / size) + 1;
+    }
+
+    // Counting sort of the objects by cell
+    size_t cells = static_cast<size_t>(dims_[0]) * dims_[1];
+    std::vector<uint32_t> objectCell(n);
+    cellStart_.assign(cells + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (radii_[i] < 0.0f) continue;
+        const float* p = &xy_[2 * i];
+        objectCell[i] = static_cast<uint32_t>(CellIndex(CellOf(p[0], 0), CellOf(p[1], 1)));
+        ++cellStart_[objectCell[i] + 1];
+    }
+    for (size_t c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+
+    cellObjects_.resize(count);
+    std::vector<uint32_t> cursor(cellStart_.begin(), cellStart_.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        if (radii_[i] < 0.0f) continue;
+        cellObjects_[cursor[objectCell[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+int SpatialGrid::CellOf(float v, int axis) const {
+    int cell = static_cast<int>(std::floor((v - origin_[axis]) / cellSize_));
+    return std::clamp(cell, 0, dims_[axis] - 1);
+}
+
+template<typename Fn>
+void SpatialGrid::ForEachNear(const float* p, float reach, Fn fn) const {
+    int firstX = CellOf(p[0] - reach, 0), lastX = CellOf(p[0] + reach, 0);
+    int firstY = CellOf(p[1] - reach, 1), lastY = CellOf(p[1] + reach, 1);
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            size_t cell = CellIndex(x, y);
+            for (uint32_t k = cellStart_[cell]; k < cellStart_[cell + 1]; ++k) fn(cellObjects_[k]);
+        }
+    }
+}
+
+int SpatialGrid::Pick(float x, float y) const {
+    if (IsEmpty()) return -1;
+
+    float p[2] = { x, y };
+    int best = -1;
+    ForEachNear(p, maxRadius_, [&](uint32_t j) {
+        if (static_cast<int>(j) > best && Distance(p, &xy_[2 * j]) <= radii_[j]) best = static_cast<int>(j);
+    });
+    return best;
+}
+
+size_t SpatialGrid::CountNeighbours(size_t i, float gap) const {
+    if (i >= radii_.size() || radii_[i] < 0.0f || IsEmpty()) return 0;
+
+    const float* p = &xy_[2 * i];
+    size_t count = 0;
+    ForEachNear(p, radii_[i] + gap + maxRadius_, [&](uint32_t j) {
+        if (j != i && Distance(p, &xy_[2 * j]) - radii_[i] - radii_[j] < gap) ++count;
+    });
+    return count;
+}
+
+std::vector<uint32_t> SpatialGrid::ClosePairs(float gap, size_t maxPairs) const {
+    if (IsEmpty()) return {};
+
+    size_t cells = cellStart_.size() - 1;
+    size_t numChunks = (cells + CHUNK_CELLS - 1) / CHUNK_CELLS;
+    std::vector<std::vector<uint32_t>> chunkPairs(numChunks);
+    std::atomic<size_t> found{0};
+
+    RunChunks(numChunks, [&](size_t c) {
+        auto& pairs = chunkPairs[c];
+        size_t end = std::min((c + 1) * CHUNK_CELLS, cells);
+        for (size_t cell = c * CHUNK_CELLS; cell < end && found < maxPairs; ++cell) {
+            for (uint32_t k = cellStart_[cell]; k < cellStart_[cell + 1]; ++k) {
+                uint32_t i = cellObjects_[k];
+                const float* p = &xy_[2 * i];
+                size_t before = pairs.size();
+                ForEachNear(p, radii_[i] + gap + maxRadius_, [&](uint32_t j) {
+                    if (j > i && Distance(p, &xy_[2 * j]) - radii_[i] - radii_[j] < gap) {
+                        pairs.push_back(i);
+                        pairs.push_back(j);
+                    }
+                });
+                found += (pairs.size() - before) / 2;
+            }
+        }
+    });
+
+    std::vector<uint32_t> result;
+    for (const auto& pairs : chunkPairs) {
+        result.insert(result.end(), pairs.begin(), pairs.end());
+        if (result.size() >= 2 * maxPairs) break;
+    }
+    result.resize(std::min(result.size(), 2 * maxPairs));
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Uniform grid over the discs of one timestep, stored as a cell list: objects sorted
+// by cell, with each cell's first object in cellStart_. Cells are at least as wide
+// as the largest disc, so a disc only reaches into the cells next to its own, and
+// there are about as many cells as discs, so every query below only looks at a few
+// objects per cell. Built once per timestep (off the GUI thread) in O(N); the
+// queries are read-only and thread-safe.
+class SpatialGrid {
+public:
+    static constexpr size_t CHUNK_CELLS = 4096;
+
+    // xy centers and radii of n discs; a negative radius leaves one out
+    void Build(std::vector<float> xy, std::vector<float> radii);
+    size_t GetNumObjects() const { return radii_.size(); }
+    bool IsEmpty() const { return cellObjects_.empty(); }
+
+    // Disc containing point (x, y) that is drawn on top (the highest index); -1 when none
+    int Pick(float x, float y) const;
+
+    // Discs whose edge is closer than gap to disc i's, not counting i
+    size_t CountNeighbours(size_t i, float gap) const;
+
+    // Pairs (i, j), i < j, whose edges are closer than gap, flattened; gap 0 finds the
+    // overlapping ones. Cells are split across worker threads; at most maxPairs pairs
+    // are returned.
+    std::vector<uint32_t> ClosePairs(float gap, size_t maxPairs) const;
+
+private:
+    // Calls fn(j) for every object whose cell is within reach of point p
+    template<typename Fn>
+    void ForEachNear(const float* p, float reach, Fn fn) const;
+    int CellOf(float v, int axis) const;
+    size_t CellIndex(int x, int y) const {
+        return static_cast<size_t>(y) * dims_[0] + x;
+    }
+
+    std::vector<float> xy_;
+    std::vector<float> radii_;
+    float origin_[2] = { 0.0f, 0.0f };
+    float cellSize_ = 1.0f;
+    int dims_[2] = { 0, 0 };
+    float maxRadius_ = 0.0f;
+    std::vector<uint32_t> cellStart_;       // Cells + 1 entries
+    std::vector<uint32_t> cellObjects_;     // Object indices, cell-major
+};
+
+#endif // SPATIAL_GRID_H
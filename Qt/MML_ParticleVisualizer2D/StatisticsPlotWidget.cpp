@@ -0,0 +1,273 @@
+#include "StatisticsPlotWidget.h"
+#include "AxisTickCalculator.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+StatisticsPlotWidget::StatisticsPlotWidget(QWidget* parent)
+    : QWidget(parent)
+    , numBuckets_(1)
+    , tMin_(0.0)
+    , tMax_(1.0)
+    , cursorT_(std::numeric_limits<double>::quiet_NaN())
+{
+    setMinimumHeight(160);
+    setAutoFillBackground(true);
+    QPalette pal = palette();
+    pal.setColor(QPalette::Window, Qt::white);
+    setPalette(pal);
+}
+
+void StatisticsPlotWidget::SetTitle(const QString& title) {
+    title_ = title;
+    update();
+}
+
+void StatisticsPlotWidget::SetTime(const std::vector<double>& t) {
+    t_ = t;
+    panels_.clear();
+    tMin_ = t.empty() ? 0.0 : t.front();
+    tMax_ = t.empty() ? 1.0 : t.back();
+    if (!(tMax_ > tMin_)) tMax_ = tMin_ + 1.0;
+    numBuckets_ = static_cast<int>(std::clamp<size_t>(t.size(), 1, NUM_BUCKETS));
+    update();
+}
+
+int StatisticsPlotWidget::AddPanel(const QString& name) {
+    Panel panel;
+    panel.name = name;
+    panels_.push_back(std::move(panel));
+    update();
+    return static_cast<int>(panels_.size()) - 1;
+}
+
+int StatisticsPlotWidget::BucketOf(size_t sample) const {
+    return std::clamp(static_cast<int>((t_[sample] - tMin_) / (tMax_ - tMin_) * numBuckets_), 0, numBuckets_ - 1);
+}
+
+void StatisticsPlotWidget::IncludeRange(Panel& panel, double lo, double hi) {
+    if (!panel.hasValues) {
+        panel.valueMin = lo;
+        panel.valueMax = hi;
+        panel.hasValues = true;
+    } else {
+        panel.valueMin = std::min(panel.valueMin, lo);
+        panel.valueMax = std::max(panel.valueMax, hi);
+    }
+}
+
+void StatisticsPlotWidget::AddSeries(int panel, const QString& name, const QColor& color, const std::vector<double>& values) {
+    if (panel < 0 || panel >= static_cast<int>(panels_.size())) return;
+    size_t n = std::min(t_.size(), values.size());
+    if (n == 0) return;
+
+    // Near-white particle colors would vanish on the white background
+    Envelope envelope;
+    envelope.name = name;
+    envelope.color = color.lightnessF() > 0.85 ? color.darker(180) : color;
+    envelope.minValue.assign(numBuckets_, std::numeric_limits<double>::quiet_NaN());
+    envelope.maxValue.assign(numBuckets_, std::numeric_limits<double>::quiet_NaN());
+
+    double valueMin = std::numeric_limits<double>::infinity();
+    double valueMax = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; ++i) {
+        double v = values[i];
+        if (!std::isfinite(v)) continue;
+        int bucket = BucketOf(i);
+        double& lo = envelope.minValue[bucket];
+        double& hi = envelope.maxValue[bucket];
+        if (std::isnan(lo) || v < lo) lo = v;
+        if (std::isnan(hi) || v > hi) hi = v;
+        valueMin = std::min(valueMin, v);
+        valueMax = std::max(valueMax, v);
+    }
+    if (valueMin <= valueMax) {
+        IncludeRange(panels_[panel], valueMin, valueMax);
+    }
+
+    panels_[panel].series.push_back(std::move(envelope));
+    update();
+}
+
+void StatisticsPlotWidget::SetDensity(int panel, const std::vector<float>& values, int numBins, double binWidth) {
+    if (panel < 0 || panel >= static_cast<int>(panels_.size()) || numBins <= 0) return;
+    size_t n = std::min(t_.size(), values.size() / numBins);
+    if (n == 0) return;
+
+    // Mean of each bin over the steps in a bucket
+    std::vector<double> sums(static_cast<size_t>(numBuckets_) * numBins, 0.0);
+    std::vector<int> counts(numBuckets_, 0);
+    for (size_t i = 0; i < n; ++i) {
+        int bucket = BucketOf(i);
+        ++counts[bucket];
+        for (int b = 0; b < numBins; ++b) sums[static_cast<size_t>(bucket) * numBins + b] += values[i * numBins + b];
+    }
+    double largest = 0.0;
+    for (int bucket = 0; bucket < numBuckets_; ++bucket) {
+        if (counts[bucket] == 0) continue;
+        for (int b = 0; b < numBins; ++b) {
+            double& v = sums[static_cast<size_t>(bucket) * numBins + b];
+            v /= counts[bucket];
+            largest = std::max(largest, v);
+        }
+    }
+
+    // White to dark blue; the square root keeps sparse tails visible
+    QImage image(numBuckets_, numBins, QImage::Format_RGB32);
+    image.fill(Qt::white);
+    for (int bucket = 0; bucket < numBuckets_; ++bucket) {
+        if (counts[bucket] == 0) continue;
+        for (int b = 0; b < numBins; ++b) {
+            double v = sums[static_cast<size_t>(bucket) * numBins + b];
+            double level = largest > 0.0 ? std::sqrt(v / largest) : 0.0;
+            image.setPixel(bucket, numBins - 1 - b, qRgb(static_cast<int>(255 - level * 215),
+                                                         static_cast<int>(255 - level * 185),
+                                                         static_cast<int>(255 - level * 95)));
+        }
+    }
+
+    Panel& target = panels_[panel];
+    target.density = image;
+    target.densityMax = binWidth * numBins;
+    IncludeRange(target, 0.0, target.densityMax);
+    update();
+}
+
+void StatisticsPlotWidget::Clear() {
+    title_.clear();
+    t_.clear();
+    panels_.clear();
+    cursorT_ = std::numeric_limits<double>::quiet_NaN();
+    update();
+}
+
+void StatisticsPlotWidget::SetCursorT(double t) {
+    if (t == cursorT_) return;
+    cursorT_ = t;
+    update();
+}
+
+void StatisticsPlotWidget::paintEvent(QPaintEvent* /*event*/) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    if (!title_.isEmpty()) {
+        painter.save();
+        QFont font = painter.font();
+        font.setBold(true);
+        painter.setFont(font);
+        painter.setPen(Qt::black);
+        painter.drawText(QRect(MARGIN_LEFT, 2, width() - MARGIN_LEFT - MARGIN_RIGHT, MARGIN_TOP - 4),
+                         Qt::AlignLeft | Qt::AlignVCenter, title_);
+        painter.restore();
+    }
+
+    if (panels_.empty()) return;
+
+    int numPanels = static_cast<int>(panels_.size());
+    int plotHeight = height() - MARGIN_TOP - MARGIN_BOTTOM - PANEL_GAP * (numPanels - 1);
+    int panelHeight = std::max(1, plotHeight / numPanels);
+    int plotWidth = std::max(1, width() - MARGIN_LEFT - MARGIN_RIGHT);
+
+    for (int p = 0; p < numPanels; ++p) {
+        QRect rect(MARGIN_LEFT, MARGIN_TOP + p * (panelHeight + PANEL_GAP), plotWidth, panelHeight);
+        DrawPanel(painter, panels_[p], rect, p == numPanels - 1);
+    }
+}
+
+void StatisticsPlotWidget::DrawPanel(QPainter& painter, const Panel& panel, const QRect& rect, bool tLabels) const {
+    AxisTickInfo tTicks = AxisTickCalculator::CalculateTicks(tMin_, tMax_, 8);
+    AxisTickInfo vTicks = AxisTickCalculator::CalculateTicks(panel.valueMin, panel.valueMax, 4);
+    double vMin = vTicks.min, vMax = vTicks.max;
+    if (!(vMax > vMin)) vMax = vMin + 1.0;
+
+    auto toX = [&](double t) { return rect.left() + (t - tMin_) / (tMax_ - tMin_) * rect.width(); };
+    auto toY = [&](double v) { return rect.bottom() - (v - vMin) / (vMax - vMin) * rect.height(); };
+
+    painter.save();
+    painter.setClipRect(rect.adjusted(0, -1, 1, 1));
+    if (!panel.density.isNull()) {
+        QRectF target(QPointF(toX(tMin_), toY(panel.densityMax)), QPointF(toX(tMax_), toY(0.0)));
+        painter.drawImage(target, panel.density);
+    }
+    painter.restore();
+
+    // Grid and tick labels
+    QFontMetrics metrics(painter.font());
+    painter.setPen(QPen(QColor(225, 225, 225), 1));
+    for (const auto& tick : tTicks.ticks) {
+        if (tick.value < tMin_ || tick.value > tMax_) continue;
+        double x = toX(tick.value);
+        painter.drawLine(QPointF(x, rect.top()), QPointF(x, rect.bottom()));
+    }
+    for (const auto& tick : vTicks.ticks) {
+        double y = toY(tick.value);
+        painter.setPen(QPen(QColor(225, 225, 225), 1));
+        painter.drawLine(QPointF(rect.left(), y), QPointF(rect.right(), y));
+        painter.setPen(Qt::black);
+        QString label = QString::fromStdString(tick.label);
+        painter.drawText(QPointF(rect.left() - 6 - metrics.horizontalAdvance(label), y + metrics.ascent() / 2.0), label);
+    }
+    if (tLabels) {
+        painter.setPen(Qt::black);
+        for (const auto& tick : tTicks.ticks) {
+            if (tick.value < tMin_ || tick.value > tMax_) continue;
+            QString label = QString::fromStdString(tick.label);
+            painter.drawText(QPointF(toX(tick.value) - metrics.horizontalAdvance(label) / 2.0,
+                                     rect.bottom() + 4 + metrics.ascent()), label);
+        }
+    }
+
+    painter.setPen(QPen(Qt::black, 1));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(rect);
+
+    painter.save();
+    painter.setClipRect(rect.adjusted(0, -1, 1, 1));
+
+    // Envelopes: down to each bucket's minimum and up to its maximum, left to right
+    double bucketWidth = (tMax_ - tMin_) / numBuckets_;
+    for (const auto& envelope : panel.series) {
+        QPainterPath path;
+        bool started = false;
+        for (int b = 0; b < numBuckets_; ++b) {
+            if (std::isnan(envelope.minValue[b])) continue;
+            double x = toX(tMin_ + (b + 0.5) * bucketWidth);
+            QPointF lo(x, toY(envelope.minValue[b]));
+            QPointF hi(x, toY(envelope.maxValue[b]));
+            if (!started) {
+                path.moveTo(hi);
+                started = true;
+            } else {
+                path.lineTo(hi);
+            }
+            if (lo != hi) path.lineTo(lo);
+        }
+        painter.setPen(QPen(envelope.color, 1.5));
+        painter.drawPath(path);
+    }
+
+    // Playback cursor
+    if (std::isfinite(cursorT_) && cursorT_ >= tMin_ && cursorT_ <= tMax_) {
+        painter.setPen(QPen(QColor(200, 0, 0), 1, Qt::DashLine));
+        double x = toX(cursorT_);
+        painter.drawLine(QPointF(x, rect.top()), QPointF(x, rect.bottom()));
+    }
+
+    // Panel name, then a legend entry per series
+    double x = rect.left() + 6;
+    double y = rect.top() + metrics.ascent() + 3;
+    painter.setPen(Qt::black);
+    painter.drawText(QPointF(x, y), panel.name);
+    x += metrics.horizontalAdvance(panel.name) + 12;
+    if (panel.series.size() > 1) {
+        for (const auto& envelope : panel.series) {
+            painter.setPen(envelope.color.darker(130));
+            painter.drawText(QPointF(x, y), envelope.name);
+            x += metrics.horizontalAdvance(envelope.name) + 10;
+        }
+    }
+    painter.restore();
+}
@@ -0,0 +1,77 @@
+#ifndef STATISTICS_PLOT_WIDGET_H
+#define STATISTICS_PLOT_WIDGET_H
+
+#include <QWidget>
+#include <QString>
+#include <QColor>
+#include <QImage>
+#include <vector>
+
+class QPainter;
+
+// Pane plotting per-step statistics against time, in stacked panels with a shared
+// time axis; a panel holds any number of series and optionally a density image
+// behind them (one column of bins per step). Only a min/max envelope over
+// NUM_BUCKETS equal time intervals is kept, so a run of any length paints in
+// constant time. A vertical cursor marks the step on screen.
+class StatisticsPlotWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr int NUM_BUCKETS = 2048;
+
+    explicit StatisticsPlotWidget(QWidget* parent = nullptr);
+
+    void SetTitle(const QString& title);
+    // Sets the time axis; clears the panels
+    void SetTime(const std::vector<double>& t);
+    int AddPanel(const QString& name);
+    void AddSeries(int panel, const QString& name, const QColor& color, const std::vector<double>& values);
+    // numBins values per step from 0 to binWidth * numBins, drawn darker the larger
+    void SetDensity(int panel, const std::vector<float>& values, int numBins, double binWidth);
+    void Clear();
+    bool IsEmpty() const { return panels_.empty(); }
+
+    void SetCursorT(double t);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    struct Envelope {
+        QString name;
+        QColor color;
+        std::vector<double> minValue;    // Per bucket; NaN when no sample fell in it
+        std::vector<double> maxValue;
+    };
+
+    struct Panel {
+        QString name;
+        std::vector<Envelope> series;
+        QImage density;                  // Buckets wide, bins high, bin 0 at the bottom
+        double densityMax = 0.0;         // Value at the top of the image
+        double valueMin = 0.0;
+        double valueMax = 1.0;
+        bool hasValues = false;
+    };
+
+    static constexpr int MARGIN_LEFT = 70;
+    static constexpr int MARGIN_RIGHT = 15;
+    static constexpr int MARGIN_TOP = 22;
+    static constexpr int MARGIN_BOTTOM = 22;
+    static constexpr int PANEL_GAP = 18;
+
+    int BucketOf(size_t sample) const;
+    void IncludeRange(Panel& panel, double lo, double hi);
+    void DrawPanel(QPainter& painter, const Panel& panel, const QRect& rect, bool tLabels) const;
+
+    QString title_;
+    std::vector<double> t_;
+    std::vector<Panel> panels_;
+    int numBuckets_;                    // NUM_BUCKETS, or fewer for short runs
+    double tMin_;
+    double tMax_;
+    double cursorT_;
+};
+
+#endif // STATISTICS_PLOT_WIDGET_H
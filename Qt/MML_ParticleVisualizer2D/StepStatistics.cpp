@@ -0,0 +1,228 @@
+#include "StepStatistics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+// Speed at step k from the neighbouring steps; steps without a time difference
+// count as one time unit apart
+double Speed(const Vec2D* p, const double* time, int k, int numSteps) {
+    if (numSteps < 2) return 0.0;
+    int a = k > 0 ? k - 1 : 0;
+    int b = k < numSteps - 1 ? k + 1 : numSteps - 1;
+    double dt = time[b] - time[a];
+    if (!(dt > 0.0)) dt = b - a;
+    double dx = p[b].x - p[a].x, dy = p[b].y - p[a].y;
+    return std::sqrt(dx * dx + dy * dy) / dt;
+}
+
+const char* AXIS_NAMES[2] = { "x", "y" };
+
+const Rgba8 BLUE = { 26, 51, 179, 255 };
+const Rgba8 RED = { 204, 51, 26, 255 };
+const Rgba8 GREEN = { 26, 128, 26, 255 };
+
+} // namespace
+
+std::shared_ptr<StepStatistics> StepStatisticsBuilder::Build(const SimulationData& data,
+                                                             const std::atomic<bool>* cancel) {
+    auto start = std::chrono::steady_clock::now();
+    auto stats = std::make_shared<StepStatistics>();
+    const auto& balls = data.balls;
+    size_t n = balls.size();
+    int numSteps = data.numSteps;
+    for (const auto& ball : balls) {
+        numSteps = std::min(numSteps, ball.GetNumTimesteps());
+    }
+    if (n == 0 || numSteps <= 0) return stats;
+
+    stats->numSteps = numSteps;
+    if (data.stepTimes.size() >= static_cast<size_t>(numSteps)) {
+        stats->time.assign(data.stepTimes.begin(), data.stepTimes.begin() + numSteps);
+    } else {
+        stats->time.resize(numSteps);
+        for (int k = 0; k < numSteps; ++k) stats->time[k] = k;
+    }
+
+    // Groups by palette color, weighted by mass; a group of radius-0 balls by count
+    stats->groups.resize(data.palette.size());
+    for (size_t g = 0; g < data.palette.size(); ++g) {
+        stats->groups[g].name = "Group " + std::to_string(g + 1);
+        stats->groups[g].color = data.palette[g];
+    }
+    std::vector<double> mass(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto& group = stats->groups[balls[i].GetColorIndex()];
+        if (group.numBalls++ == 0 && !balls[i].GetColor().empty()) group.name = balls[i].GetColor();
+        double r = std::max(balls[i].GetRadius(), 0.0);
+        mass[i] = r * r;
+    }
+    size_t numGroups = stats->groups.size();
+    std::vector<double> groupMass(numGroups, 0.0);
+    for (size_t i = 0; i < n; ++i) groupMass[balls[i].GetColorIndex()] += mass[i];
+    std::vector<double> weight(mass);
+    for (size_t i = 0; i < n; ++i) {
+        if (groupMass[balls[i].GetColorIndex()] <= 0.0) weight[i] = 1.0;
+    }
+    std::vector<double> groupWeight(numGroups, 0.0);
+    for (size_t i = 0; i < n; ++i) groupWeight[balls[i].GetColorIndex()] += weight[i];
+
+    size_t steps = static_cast<size_t>(numSteps);
+    stats->meanSpeed.assign(steps, 0.0);
+    stats->maxSpeed.assign(steps, 0.0);
+    stats->kineticEnergy.assign(steps, 0.0);
+    stats->extentMin.assign(2 * steps, std::numeric_limits<double>::max());
+    stats->extentMax.assign(2 * steps, -std::numeric_limits<double>::max());
+    for (auto& group : stats->groups) group.center.assign(2 * steps, 0.0);
+
+    size_t numChunks = (steps + CHUNK_STEPS - 1) / CHUNK_STEPS;
+    const double* time = stats->time.data();
+    auto cancelled = [cancel]() { return cancel && cancel->load(); };
+
+    // Pass 1: every chunk owns its steps' entries, so no two tasks write the same one
+    RunChunks(numChunks, [&](size_t c) {
+        if (cancelled()) return;
+        int first = static_cast<int>(c * CHUNK_STEPS);
+        int last = static_cast<int>(std::min((c + 1) * CHUNK_STEPS, steps));
+        for (size_t i = 0; i < n; ++i) {
+            const Vec2D* p = balls[i].GetPositions().data();
+            double* center = stats->groups[balls[i].GetColorIndex()].center.data();
+            double m = mass[i];
+            double w = weight[i];
+            for (int k = first; k < last; ++k) {
+                double speed = Speed(p, time, k, numSteps);
+                stats->meanSpeed[k] += speed;
+                stats->maxSpeed[k] = std::max(stats->maxSpeed[k], speed);
+                stats->kineticEnergy[k] += 0.5 * m * speed * speed;
+
+                const double xy[2] = { p[k].x, p[k].y };
+                for (int a = 0; a < 2; ++a) {
+                    center[2 * k + a] += w * xy[a];
+                    stats->extentMin[2 * k + a] = std::min(stats->extentMin[2 * k + a], xy[a]);
+                    stats->extentMax[2 * k + a] = std::max(stats->extentMax[2 * k + a], xy[a]);
+                }
+            }
+        }
+        for (int k = first; k < last; ++k) {
+            stats->meanSpeed[k] /= static_cast<double>(n);
+            for (size_t g = 0; g < numGroups; ++g) {
+                if (groupWeight[g] <= 0.0) continue;
+                for (int a = 0; a < 2; ++a) stats->groups[g].center[2 * k + a] /= groupWeight[g];
+            }
+        }
+    });
+    if (cancelled()) return nullptr;
+
+    // Pass 2: speed histograms over [0, fastest speed of the run]
+    double fastest = *std::max_element(stats->maxSpeed.begin(), stats->maxSpeed.end());
+    stats->speedBinWidth = fastest > 0.0 ? fastest / StepStatistics::SPEED_BINS : 1.0;
+    stats->speedDistribution.assign(steps * StepStatistics::SPEED_BINS, 0.0f);
+    RunChunks(numChunks, [&](size_t c) {
+        if (cancelled()) return;
+        int first = static_cast<int>(c * CHUNK_STEPS);
+        int last = static_cast<int>(std::min((c + 1) * CHUNK_STEPS, steps));
+        std::vector<uint32_t> counts(static_cast<size_t>(last - first) * StepStatistics::SPEED_BINS, 0);
+        for (size_t i = 0; i < n; ++i) {
+            const Vec2D* p = balls[i].GetPositions().data();
+            for (int k = first; k < last; ++k) {
+                int bin = static_cast<int>(Speed(p, time, k, numSteps) / stats->speedBinWidth);
+                ++counts[(k - first) * StepStatistics::SPEED_BINS + std::min(bin, StepStatistics::SPEED_BINS - 1)];
+            }
+        }
+        float scale = 1.0f / static_cast<float>(n);
+        for (size_t j = 0; j < counts.size(); ++j) {
+            stats->speedDistribution[first * StepStatistics::SPEED_BINS + j] = counts[j] * scale;
+        }
+    });
+    if (cancelled()) return nullptr;
+
+    stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+std::vector<StatisticSeries> StepStatistics::GetSeries(StatisticKind kind) const {
+    std::vector<StatisticSeries> series;
+    auto perStep = [this](const std::vector<double>& rows, int column, int stride) {
+        std::vector<double> values(numSteps);
+        for (int k = 0; k < numSteps; ++k) values[k] = rows[static_cast<size_t>(k) * stride + column];
+        return values;
+    };
+
+    switch (kind) {
+        case StatisticKind::Speed:
+            series.push_back({ "Mean speed", "Speed", BLUE, meanSpeed });
+            series.push_back({ "Max speed", "Speed", RED, maxSpeed });
+            break;
+        case StatisticKind::KineticEnergy:
+            series.push_back({ "Kinetic energy", "Kinetic energy (m ~ r^2)", GREEN, kineticEnergy });
+            break;
+        case StatisticKind::CenterOfMass:
+            for (int a = 0; a < 2; ++a) {
+                for (const auto& group : groups) {
+                    if (group.numBalls == 0) continue;
+                    series.push_back({ group.name + " " + AXIS_NAMES[a], std::string("Center of mass ") + AXIS_NAMES[a],
+                                       group.color, perStep(group.center, a, 2) });
+                }
+            }
+            break;
+        case StatisticKind::Extents:
+            for (int a = 0; a < 2; ++a) {
+                std::string axis = AXIS_NAMES[a];
+                series.push_back({ axis + " min", "Extent " + axis, BLUE, perStep(extentMin, a, 2) });
+                series.push_back({ axis + " max", "Extent " + axis, RED, perStep(extentMax, a, 2) });
+            }
+            break;
+    }
+    return series;
+}
+
+const char* StepStatistics::GetKindName(StatisticKind kind) {
+    switch (kind) {
+        case StatisticKind::Speed: return "Speed";
+        case StatisticKind::KineticEnergy: return "Kinetic energy";
+        case StatisticKind::CenterOfMass: return "Center of mass";
+        case StatisticKind::Extents: return "Extents";
+    }
+    return "";
+}
+
+bool StepStatistics::SaveMultiRealFunction(const std::string& filename, const std::string& title,
+                                           const std::vector<StatisticSeries>& series) const {
+    if (numSteps <= 0 || series.empty()) return false;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    file << "MULTI_REAL_FUNCTION\n" << title << "\n" << series.size() << "\n";
+    for (const auto& s : series) file << s.name << "\n";
+    file << std::setprecision(10);
+    file << "x1: " << time.front() << "\n";
+    file << "x2: " << time.back() << "\n";
+    file << "NumPoints: " << numSteps << "\n";
+    for (int k = 0; k < numSteps; ++k) {
+        file << time[k];
+        for (const auto& s : series) file << " " << s.values[k];
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
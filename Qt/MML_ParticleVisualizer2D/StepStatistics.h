@@ -0,0 +1,71 @@
+#ifndef STEP_STATISTICS_H
+#define STEP_STATISTICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MMLData.h"
+
+// Quantities derived from a run, one value (or row) per step
+enum class StatisticKind {
+    Speed,              // Mean and maximum speed over the speed distribution
+    KineticEnergy,      // Sum of m v^2 / 2 with m proportional to r^2
+    CenterOfMass,       // Per color, mass weighted
+    Extents             // Bounding rectangle of all balls
+};
+
+// One plotted or exported series; series with the same panel share axes
+struct StatisticSeries {
+    std::string name;
+    std::string panel;
+    Rgba8 color;
+    std::vector<double> values;     // One per step
+};
+
+// Per-step statistics of a whole run. Velocities are central differences of the
+// positions over the step times (one-sided at the ends).
+struct StepStatistics {
+    static constexpr int SPEED_BINS = 48;
+
+    struct Group {
+        std::string name;
+        Rgba8 color;
+        size_t numBalls = 0;
+        std::vector<double> center;         // xy per step
+    };
+
+    int numSteps = 0;
+    std::vector<double> time;
+    std::vector<double> meanSpeed;
+    std::vector<double> maxSpeed;
+    std::vector<double> kineticEnergy;
+    double speedBinWidth = 1.0;
+    std::vector<float> speedDistribution;   // SPEED_BINS fractions per step, from speed 0 up
+    std::vector<Group> groups;              // One per palette color, in palette order
+    std::vector<double> extentMin;          // xy per step
+    std::vector<double> extentMax;
+    double seconds = 0.0;                   // Time the build took
+
+    std::vector<StatisticSeries> GetSeries(StatisticKind kind) const;
+    static const char* GetKindName(StatisticKind kind);
+
+    // Writes the series as a MULTI_REAL_FUNCTION file over the step times
+    bool SaveMultiRealFunction(const std::string& filename, const std::string& title,
+                               const std::vector<StatisticSeries>& series) const;
+};
+
+// Builds the statistics on all cores, a chunk of consecutive steps per task, each
+// reading every ball's positions over its steps front to back. Two passes:
+// the first finds the speeds, energies, centers and extents, the second bins the
+// speeds once the largest one is known. Returns nullptr when cancel is set.
+class StepStatisticsBuilder {
+public:
+    static constexpr size_t CHUNK_STEPS = 64;
+
+    static std::shared_ptr<StepStatistics> Build(const SimulationData& data,
+                                                 const std::atomic<bool>* cancel = nullptr);
+};
+
+#endif // STEP_STATISTICS_H
@@ -0,0 +1,121 @@
+#include "DensityGrid.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+constexpr size_t MERGE_CHUNK_CELLS = 16384;
+
+double Coordinate(const Point3D& p, int axis) {
+    return axis == 0 ? p.x : (axis == 1 ? p.y : p.z);
+}
+
+} // namespace
+
+void DensityGrid::SetBounds(int axisU, int axisV, double minU, double minV, double maxU, double maxV, int resolution) {
+    double width = std::max(maxU - minU, 1e-12);
+    double height = std::max(maxV - minV, 1e-12);
+    cellSize_ = std::max(width, height) / std::max(resolution, 1);
+    axisU_ = axisU;
+    axisV_ = axisV;
+    minU_ = minU;
+    minV_ = minV;
+    nx_ = std::max(1, static_cast<int>(std::ceil(width / cellSize_)));
+    ny_ = std::max(1, static_cast<int>(std::ceil(height / cellSize_)));
+    Clear();
+}
+
+void DensityGrid::Clear() {
+    counts_.assign(static_cast<size_t>(nx_) * ny_, 0);
+    maxCount_ = 0;
+    first_ = -1;
+    last_ = -1;
+}
+
+int DensityGrid::SetRange(const LoadedParticleSimulation3D& simulation, int first, int last) {
+    first = std::max(first, 0);
+    last = std::min(last, simulation.numSteps - 1);
+    if (counts_.empty() || first > last) {
+        Clear();
+        return 0;
+    }
+    if (first == first_ && last == last_) return 0;
+
+    // Only the steps at either end that entered or left the range, unless
+    // that is more work than counting the new range from scratch
+    std::vector<Span> spans;
+    int changed = std::abs(first - first_) + std::abs(last - last_);
+    if (first_ < 0 || first > last_ || last < first_ || changed >= last - first + 1) {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        spans.push_back({ first, last, +1 });
+        changed = last - first + 1;
+    } else {
+        if (first < first_) spans.push_back({ first, first_ - 1, +1 });
+        if (first > first_) spans.push_back({ first_, first - 1, -1 });
+        if (last > last_) spans.push_back({ last_ + 1, last, +1 });
+        if (last < last_) spans.push_back({ last + 1, last_, -1 });
+    }
+    first_ = first;
+    last_ = last;
+    Accumulate(simulation, spans);
+    return changed;
+}
+
+void DensityGrid::Accumulate(const LoadedParticleSimulation3D& simulation, const std::vector<Span>& spans) {
+    const auto& particles = simulation.particles;
+    size_t numParticles = particles.size();
+    size_t numCells = counts_.size();
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t numSlices = std::max<size_t>(1, std::min(numThreads, numParticles / MIN_SLICE_PARTICLES));
+    size_t sliceParticles = (numParticles + numSlices - 1) / numSlices;
+
+    // One histogram per slice of particles, each trajectory read front to back
+    std::vector<std::vector<int64_t>> histograms(numSlices);
+    RunChunks(numSlices, [&](size_t slice) {
+        std::vector<int64_t>& histogram = histograms[slice];
+        histogram.assign(numCells, 0);
+        size_t end = std::min(numParticles, (slice + 1) * sliceParticles);
+        for (size_t i = slice * sliceParticles; i < end; ++i) {
+            if (!particles[i].visible) continue;
+            const std::vector<Point3D>& positions = particles[i].trajectory;
+            for (const Span& span : spans) {
+                int last = std::min(span.last, static_cast<int>(positions.size()) - 1);
+                for (int k = span.first; k <= last; ++k) {
+                    double u = (Coordinate(positions[k], axisU_) - minU_) / cellSize_;
+                    double v = (Coordinate(positions[k], axisV_) - minV_) / cellSize_;
+                    if (!(u >= 0.0 && v >= 0.0 && u < nx_ && v < ny_)) continue;
+                    histogram[static_cast<size_t>(v) * nx_ + static_cast<size_t>(u)] += span.sign;
+                }
+            }
+        }
+    });
+
+    // Merge, a block of cells per task
+    RunChunks((numCells + MERGE_CHUNK_CELLS - 1) / MERGE_CHUNK_CELLS, [&](size_t c) {
+        size_t end = std::min(numCells, (c + 1) * MERGE_CHUNK_CELLS);
+        for (size_t cell = c * MERGE_CHUNK_CELLS; cell < end; ++cell) {
+            int64_t sum = counts_[cell];
+            for (const auto& histogram : histograms) sum += histogram[cell];
+            counts_[cell] = sum;
+        }
+    });
+    maxCount_ = counts_.empty() ? 0 : *std::max_element(counts_.begin(), counts_.end());
+}
@@ -0,0 +1,61 @@
+#ifndef DENSITY_GRID_H
+#define DENSITY_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MMLData.h"
+
+// How many particle centers, projected onto a coordinate plane, fell in each cell
+// of a uniform grid, summed over a range of steps. Every thread counts a slice of
+// the particles into its own histogram and the histograms are merged at the end,
+// so no two threads write one cell. Moving the range counts only the steps that
+// entered it and subtracts the ones that left it; a jump to a range sharing little
+// with the old one recounts. Hidden particles are not counted.
+class DensityGrid {
+public:
+    static constexpr size_t MIN_SLICE_PARTICLES = 1024;
+
+    // Cells over [minU, maxU] x [minV, maxV] of coordinates axisU and axisV (0 = x,
+    // 1 = y, 2 = z), resolution along the longer side; clears the counts. Centers
+    // outside the bounds are not counted.
+    void SetBounds(int axisU, int axisV, double minU, double minV, double maxU, double maxV, int resolution);
+    // Forgets the counted range
+    void Clear();
+
+    // Brings the counts to steps [first, last] of simulation; returns the number of
+    // steps counted or subtracted
+    int SetRange(const LoadedParticleSimulation3D& simulation, int first, int last);
+
+    int GetFirst() const { return first_; }
+    int GetLast() const { return last_; }
+    int GetWidth() const { return nx_; }
+    int GetHeight() const { return ny_; }
+    double GetCellSize() const { return cellSize_; }
+    // Row by row from minV, nx_ per row
+    const std::vector<int64_t>& GetCounts() const { return counts_; }
+    int64_t GetMaxCount() const { return maxCount_; }
+
+private:
+    struct Span {
+        int first;
+        int last;
+        int sign;               // +1 counts the steps, -1 subtracts them
+    };
+
+    void Accumulate(const LoadedParticleSimulation3D& simulation, const std::vector<Span>& spans);
+
+    int axisU_ = 0;
+    int axisV_ = 1;
+    double minU_ = 0.0;
+    double minV_ = 0.0;
+    double cellSize_ = 1.0;
+    int nx_ = 0;
+    int ny_ = 0;
+    std::vector<int64_t> counts_;
+    int64_t maxCount_ = 0;
+    int first_ = -1;            // Counted range, -1 when nothing is counted
+    int last_ = -1;
+};
+
+#endif // DENSITY_GRID_H
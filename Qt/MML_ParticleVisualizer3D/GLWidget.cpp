@@ -1,16 +1,61 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "GLWidget.h"
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace {
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+constexpr size_t GATHER_CHUNK_PARTICLES = 4096;
+
+// Weights of steps k-1, k, k+1 and k+2 at fraction t of the way from k to k+1
+QVector4D StepWeights(GLWidget::Interpolation interpolation, float t)
+{
+    if (t <= 0.0f || interpolation == GLWidget::Interpolation::None) {
+        return QVector4D(0.0f, 1.0f, 0.0f, 0.0f);
+    }
+    if (interpolation == GLWidget::Interpolation::Linear) {
+        return QVector4D(0.0f, 1.0f - t, t, 0.0f);
+    }
+    // Catmull-Rom: passes through the stored steps with continuous velocity
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return QVector4D(0.5f * (-t + 2.0f * t2 - t3),
+                     0.5f * (2.0f - 5.0f * t2 + 3.0f * t3),
+                     0.5f * (t + 4.0f * t2 - 3.0f * t3),
+                     0.5f * (t3 - t2));
+}
+
+} // namespace
+
 GLWidget::GLWidget(QWidget *parent)
     : QOpenGLWidget(parent)
     , currentStep_(0)
+    , stepFraction_(0.0f)
+    , interpolation_(Interpolation::None)
     , displayMode_(DisplayMode::None)
     , cameraDistance_(15.0f)
     , cameraRotationX_(25.0f)
@@ -20,20 +65,83 @@ GLWidget::GLWidget(QWidget *parent)
     , initialCameraRotationY_(-45.0f)
     , isRotating_(false)
     , isPanning_(false)
+    , showTrails_(false)
+    , trailLength_(64)
+    , trailStep_(-1)
+    , trailRebuild_(true)
+    , trailColorsDirty_(true)
+    , sphereStep_(-1)
+    , sphereWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , sphereMaxRadius_(0.0f)
+    , sphereCount_(0)
+    , sphereMode_(SphereMode::Auto)
+    , gpuResident_(true)
+    , residentRebuild_(true)
+    , residentFailed_(false)
+    , residentStylesDirty_(true)
+    , residentFirst_(-1)
+    , residentValidFirst_(0)
+    , residentValidLast_(-1)
+    , gridStep_(-1)
+    , gridBuildStep_(-1)
+    , gridWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , gridBuildWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , gridGeneration_(0)
+    , gridBuildGeneration_(0)
+    , highlightProximity_(false)
+    , proximityGap_(0.0f)
+    , pairsTruncated_(false)
+    , selectedParticle_(-1)
+    , pickPending_(false)
+    , showDensity_(false)
+    , densityFirst_(0)
+    , densityLast_(0)
+    , densityPlane_(DensityPlane::XY)
+    , densityRebuild_(true)
+    , densityTextureDirty_(true)
+    , densityTexture_(0)
 {
     lookAtPoint_ = QVector3D(0, 0, 0);
     initialLookAtPoint_ = QVector3D(0, 0, 0);
     setFocusPolicy(Qt::StrongFocus);
+    
+    gridWatcher_ = new QFutureWatcher<GridResult>(this);
+    connect(gridWatcher_, &QFutureWatcherBase::finished, this, &GLWidget::OnGridFinished);
 }
 
 GLWidget::~GLWidget()
 {
+    gridWatcher_->waitForFinished();
+    if (lineRenderer_.IsInitialized()) {
+        makeCurrent();
+        lineRenderer_.ReleaseTrail(trail_);
+        lineRenderer_.Cleanup();
+        sphereRenderer_.Cleanup();
+        if (densityTexture_ != 0) {
+            glDeleteTextures(1, &densityTexture_);
+        }
+        doneCurrent();
+    }
 }
 
 void GLWidget::SetSimulation(const LoadedParticleSimulation3D& sim)
 {
     simulation_ = sim;
     currentStep_ = 0;
+    stepFraction_ = 0.0f;
+    trailRebuild_ = true;
+    sphereStep_ = -1;
+    residentRebuild_ = true;
+    densityRebuild_ = true;
+    
+    ++gridGeneration_;
+    grid_.reset();
+    gridStep_ = -1;
+    closePairs_.clear();
+    pairsTruncated_ = false;
+    pickPending_ = false;
+    selectedParticle_ = -1;
+    emit ParticleSelected(-1);
     
     // Set initial camera based on container size
     auto center = simulation_.GetCenter();
@@ -51,10 +159,26 @@ void GLWidget::SetCurrentStep(int step)
 {
     if (step >= 0 && step < simulation_.numSteps) {
         currentStep_ = step;
+        stepFraction_ = 0.0f;
         update();
     }
 }
 
+void GLWidget::SetPlaybackTime(double time)
+{
+    if (simulation_.numSteps <= 0) return;
+    time = std::clamp(time, 0.0, static_cast<double>(simulation_.numSteps - 1));
+    currentStep_ = static_cast<int>(time);
+    stepFraction_ = static_cast<float>(time - currentStep_);
+    update();
+}
+
+void GLWidget::SetInterpolation(Interpolation interpolation)
+{
+    interpolation_ = interpolation;
+    update();
+}
+
 void GLWidget::SetDisplayMode(DisplayMode mode)
 {
     displayMode_ = mode;
@@ -65,10 +189,96 @@ void GLWidget::SetParticleVisible(int index, bool visible)
 {
     if (index >= 0 && index < static_cast<int>(simulation_.particles.size())) {
         simulation_.particles[index].visible = visible;
+        trailColorsDirty_ = true;
+        sphereStep_ = -1;
+        residentStylesDirty_ = true;
+        densityRebuild_ = true;
+        ++gridGeneration_;
+        gridStep_ = -1;
         update();
     }
 }
 
+void GLWidget::SetShowDensity(bool show)
+{
+    showDensity_ = show;
+    update();
+}
+
+void GLWidget::SetDensityRange(int first, int last)
+{
+    densityFirst_ = first;
+    densityLast_ = last;
+    if (showDensity_) {
+        update();
+    }
+}
+
+void GLWidget::SetDensityPlane(DensityPlane plane)
+{
+    if (plane == densityPlane_) return;
+    densityPlane_ = plane;
+    densityRebuild_ = true;
+    update();
+}
+
+void GLWidget::SetShowTrails(bool show)
+{
+    showTrails_ = show;
+    update();
+}
+
+void GLWidget::SetTrailLength(int length)
+{
+    if (length < 2 || length == trailLength_) return;
+    trailLength_ = length;
+    trailRebuild_ = true;
+    update();
+}
+
+void GLWidget::SetSphereMode(SphereMode mode)
+{
+    sphereMode_ = mode;
+    update();
+}
+
+void GLWidget::SetGpuResident(bool resident)
+{
+    if (resident == gpuResident_) return;
+    gpuResident_ = resident;
+    residentRebuild_ = true;
+    sphereStep_ = -1;
+    update();
+}
+
+void GLWidget::SetHighlightProximity(bool highlight)
+{
+    if (highlight == highlightProximity_) return;
+    highlightProximity_ = highlight;
+    
+    // Pairs are only searched for while highlighting
+    ++gridGeneration_;
+    gridStep_ = -1;
+    closePairs_.clear();
+    pairsTruncated_ = false;
+    emit ProximityUpdated();
+    update();
+}
+
+void GLWidget::SetProximityGap(double gap)
+{
+    proximityGap_ = static_cast<float>(std::max(gap, 0.0));
+    ++gridGeneration_;
+    gridStep_ = -1;
+    update();
+}
+
+int GLWidget::CountSelectedNeighbours() const
+{
+    if (!grid_ || gridStep_ < 0 || selectedParticle_ < 0) return -1;
+    return static_cast<int>(grid_->CountNeighbours(static_cast<size_t>(selectedParticle_), proximityGap_));
+}
+
 void GLWidget::ResetCamera()
 {
     lookAtPoint_ = initialLookAtPoint_;
@@ -107,6 +317,9 @@ void GLWidget::initializeGL()
     glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
     glLightfv(GL_LIGHT0, GL_AMBIENT, lightAmbient);
     glLightfv(GL_LIGHT0, GL_DIFFUSE, lightDiffuse);
+    
+    lineRenderer_.Initialize(devicePixelRatioF());
+    sphereRenderer_.Initialize(SPHERE_SLICES, SPHERE_STACKS);
 }
 
 void GLWidget::UpdateProjectionMatrix()
@@ -116,11 +329,14 @@ void GLWidget::UpdateProjectionMatrix()
     projectionMatrix_.setToIdentity();
     // Far plane scales with camera distance to support unlimited zoom out
     float farPlane = qMax(10000.0f, cameraDistance_ * 10.0f);
-    projectionMatrix_.perspective(45.0f, aspectRatio, 0.1f, farPlane);
+    projectionMatrix_.perspective(FIELD_OF_VIEW, aspectRatio, 0.1f, farPlane);
 }
 
 void GLWidget::paintGL()
 {
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     UpdateProjectionMatrix();
@@ -147,10 +363,13 @@ void GLWidget::paintGL()
     
     glMatrixMode(GL_MODELVIEW);
     glLoadMatrixf(viewMatrix_.constData());
+    lineRenderer_.SetMatrix(projectionMatrix_ * viewMatrix_);
+    sphereRenderer_.SetMatrices(projectionMatrix_, viewMatrix_);
     
     // Update light position relative to camera
     GLfloat lightPos[] = { cameraPosition_.x(), cameraPosition_.y() + 5.0f, cameraPosition_.z(), 0.0f };
     glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+    sphereRenderer_.SetLightDirection(QVector3D(lightPos[0], lightPos[1], lightPos[2]));
     
     // Draw based on display mode
     switch (displayMode_) {
@@ -167,55 +386,527 @@ void GLWidget::paintGL()
             break;
     }
     
+    if (showDensity_) {
+        SyncDensity();
+        DrawDensity();
+    }
+    
     // Draw particles
     if (currentStep_ < simulation_.numSteps) {
         glEnable(GL_LIGHTING);
-        for (size_t i = 0; i < simulation_.particles.size(); ++i) {
+        QVector4D weights = StepWeights(interpolation_, stepFraction_);
+        if (SyncResidentRun()) {
+            sphereRenderer_.SetStepWeights(weights);
+            sphereRenderer_.DrawResident(currentStep_ - residentFirst_, ChooseSphereMode());
+        } else {
+            if (sphereStep_ != currentStep_ || sphereWeights_ != weights) {
+                sphereWeights_ = weights;
+                UpdateSphereInstances();
+            }
+            sphereRenderer_.Draw(ChooseSphereMode());
+        }
+        
+        if (showTrails_) {
+            DrawTrails();
+        }
+        
+        SyncProximity();
+        DrawProximity();
+    }
+    
+    emit FrameDrawn(frameTimer.nsecsElapsed() / 1.0e6);
+}
+
+void GLWidget::SyncTrail()
+{
+    size_t numParticles = simulation_.particles.size();
+    if (trailRebuild_) {
+        lineRenderer_.ReleaseTrail(trail_);
+        trail_ = lineRenderer_.CreateTrail(numParticles, trailLength_);
+        trailRow_.resize(numParticles * 3);
+        trailStep_ = -1;
+        trailRebuild_ = false;
+        trailColorsDirty_ = true;
+    }
+    
+    if (trailColorsDirty_) {
+        std::vector<float> colors(numParticles * 4);
+        for (size_t i = 0; i < numParticles; ++i) {
             const auto& particle = simulation_.particles[i];
-            if (!particle.visible) continue;
-            
-            const auto& pos = particle.trajectory[currentStep_];
-            DrawSphere(pos, particle.size, particle.color);
+            colors[4 * i + 0] = particle.color.r;
+            colors[4 * i + 1] = particle.color.g;
+            colors[4 * i + 2] = particle.color.b;
+            colors[4 * i + 3] = particle.visible ? particle.color.a : 0.0f;
         }
+        lineRenderer_.SetTrailColors(trail_, colors.data());
+        trailColorsDirty_ = false;
     }
+    
+    if (trailStep_ == currentStep_) return;
+    
+    // Playing forward only appends the new steps; a seek or a step back refills the window
+    int first = trailStep_ + 1;
+    if (trailStep_ < 0 || currentStep_ < trailStep_ || currentStep_ - trailStep_ >= trail_.length) {
+        lineRenderer_.ClearTrail(trail_);
+        first = std::max(0, currentStep_ - trail_.length + 1);
+    }
+    for (int step = first; step <= currentStep_; ++step) {
+        for (size_t i = 0; i < numParticles; ++i) {
+            const auto& pos = simulation_.particles[i].trajectory[step];
+            trailRow_[3 * i + 0] = static_cast<float>(pos.x);
+            trailRow_[3 * i + 1] = static_cast<float>(pos.y);
+            trailRow_[3 * i + 2] = static_cast<float>(pos.z);
+        }
+        lineRenderer_.PushTrailRow(trail_, trailRow_.data());
+    }
+    trailStep_ = currentStep_;
 }
 
-void GLWidget::resizeGL(int w, int h)
+void GLWidget::DrawTrails()
 {
-    glViewport(0, 0, w, h);
+    SyncTrail();
+    
+    // Blended over the spheres without hiding each other
+    glDisable(GL_LIGHTING);
+    glDepthMask(GL_FALSE);
+    LineRenderer::Style style;
+    style.width = 2.0f;
+    lineRenderer_.DrawTrail(trail_, style);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_LIGHTING);
 }
 
-void GLWidget::DrawSphere(const Point3D& center, double radius, const Color& color)
+void GLWidget::UpdateSphereInstances()
 {
-    glPushMatrix();
-    glTranslatef(center.x, center.y, center.z);
-    glColor4f(color.r, color.g, color.b, color.a);
+    auto toByte = [](float c) {
+        return static_cast<unsigned char>(std::lround(255.0f * std::clamp(c, 0.0f, 1.0f)));
+    };
     
-    for (int i = 0; i < SPHERE_STACKS; ++i) {
-        float lat0 = M_PI * (-0.5f + static_cast<float>(i) / SPHERE_STACKS);
-        float z0 = sin(lat0) * radius;
-        float zr0 = cos(lat0) * radius;
-        
-        float lat1 = M_PI * (-0.5f + static_cast<float>(i + 1) / SPHERE_STACKS);
-        float z1 = sin(lat1) * radius;
-        float zr1 = cos(lat1) * radius;
+    // Steps k-1 .. k+2 for the interpolation, repeating the first and last step
+    int last = simulation_.numSteps - 1;
+    int steps[4] = { std::max(currentStep_ - 1, 0), currentStep_,
+                     std::min(currentStep_ + 1, last), std::min(currentStep_ + 2, last) };
+    float w[4] = { sphereWeights_.x(), sphereWeights_.y(), sphereWeights_.z(), sphereWeights_.w() };
+    
+    sphereInstances_.clear();
+    sphereMaxRadius_ = 0.0f;
+    for (const auto& particle : simulation_.particles) {
+        if (!particle.visible) continue;
         
-        glBegin(GL_QUAD_STRIP);
-        for (int j = 0; j <= SPHERE_SLICES; ++j) {
-            float lng = 2 * M_PI * static_cast<float>(j) / SPHERE_SLICES;
-            float x = cos(lng);
-            float y = sin(lng);
-            
-            glNormal3f(x * zr0 / radius, y * zr0 / radius, z0 / radius);
-            glVertex3f(x * zr0, y * zr0, z0);
-            
-            glNormal3f(x * zr1 / radius, y * zr1 / radius, z1 / radius);
-            glVertex3f(x * zr1, y * zr1, z1);
+        double x = 0.0, y = 0.0, z = 0.0;
+        for (int i = 0; i < 4; ++i) {
+            const auto& pos = particle.trajectory[steps[i]];
+            x += w[i] * pos.x;
+            y += w[i] * pos.y;
+            z += w[i] * pos.z;
         }
-        glEnd();
+        sphereInstances_.push_back({ static_cast<float>(x), static_cast<float>(y), static_cast<float>(z),
+                                     static_cast<float>(particle.size),
+                                     toByte(particle.color.r), toByte(particle.color.g),
+                                     toByte(particle.color.b), toByte(particle.color.a) });
+        sphereMaxRadius_ = std::max(sphereMaxRadius_, static_cast<float>(particle.size));
+    }
+    sphereCount_ = sphereInstances_.size();
+    sphereRenderer_.SetInstances(sphereInstances_);
+    sphereStep_ = currentStep_;
+}
+
+bool GLWidget::SyncResidentRun()
+{
+    if (residentRebuild_) {
+        sphereRenderer_.ReleaseResidentRun();
+        residentUpload_.clear();
+        residentUpload_.shrink_to_fit();
+        residentFirst_ = -1;
+        residentValidFirst_ = 0;
+        residentValidLast_ = -1;
+        residentFailed_ = false;
+        residentStylesDirty_ = true;
+        residentRebuild_ = false;
     }
     
-    glPopMatrix();
+    size_t numParticles = simulation_.particles.size();
+    if (!gpuResident_ || residentFailed_ || numParticles == 0 || simulation_.numSteps <= 0) return false;
+    
+    if (!sphereRenderer_.HasResidentRun()) {
+        size_t stepBytes = numParticles * 3 * sizeof(float);
+        size_t slots = std::clamp<size_t>(RESIDENT_MAX_BYTES / stepBytes, 1, static_cast<size_t>(simulation_.numSteps));
+        if (!sphereRenderer_.CreateResidentRun(numParticles, slots)) {
+            qWarning() << "Particle run doesn't fit in GPU memory, uploading every step instead";
+            residentFailed_ = true;
+            sphereStep_ = -1;
+            return false;
+        }
+    }
+    
+    // Recentre the window when the current step or a step it's interpolated from has left it
+    int slots = static_cast<int>(sphereRenderer_.GetResidentSlots());
+    int needFirst = std::max(currentStep_ - 1, 0);
+    int needLast = std::min(currentStep_ + 2, simulation_.numSteps - 1);
+    if (slots < 4) {
+        needFirst = needLast = currentStep_;
+    }
+    if (residentFirst_ < 0 || needFirst < residentFirst_ || needLast >= residentFirst_ + slots) {
+        residentFirst_ = std::clamp(currentStep_ - slots / 2, 0, simulation_.numSteps - slots);
+        residentValidFirst_ = 0;
+        residentValidLast_ = -1;
+    }
+    
+    // One batch per frame, so creating or recentring a large window never stalls
+    // a paint; keep repainting until the window is full
+    UploadResidentBatch(needFirst, needLast);
+    if (residentValidFirst_ > residentFirst_ || residentValidLast_ < residentFirst_ + slots - 1) {
+        update();
+    }
+    
+    if (residentStylesDirty_) {
+        UpdateResidentStyles();
+    }
+    return needFirst >= residentValidFirst_ && needLast <= residentValidLast_;
+}
+
+void GLWidget::UploadResidentBatch(int needFirst, int needLast)
+{
+    size_t stepBytes = simulation_.particles.size() * 3 * sizeof(float);
+    int batchSteps = static_cast<int>(std::max<size_t>(1, RESIDENT_UPLOAD_BYTES / stepBytes));
+    int windowLast = residentFirst_ + static_cast<int>(sphereRenderer_.GetResidentSlots()) - 1;
+    
+    // Start over from the needed steps when they are more than a batch away from
+    // the uploaded ones (a seek within the window)
+    bool empty = residentValidFirst_ > residentValidLast_;
+    if (empty || needLast < residentValidFirst_ - batchSteps || needFirst > residentValidLast_ + batchSteps) {
+        int last = std::min(needFirst + batchSteps - 1, windowLast);
+        UploadResidentSteps(needFirst, last - needFirst + 1);
+        residentValidFirst_ = needFirst;
+        residentValidLast_ = last;
+        return;
+    }
+    
+    // Grow towards the needed steps first, then forwards (the playback direction),
+    // then backwards
+    bool forward = needLast > residentValidLast_ ||
+                   (needFirst >= residentValidFirst_ && residentValidLast_ < windowLast);
+    if (forward && residentValidLast_ < windowLast) {
+        int last = std::min(residentValidLast_ + batchSteps, windowLast);
+        UploadResidentSteps(residentValidLast_ + 1, last - residentValidLast_);
+        residentValidLast_ = last;
+    } else if (residentValidFirst_ > residentFirst_) {
+        int first = std::max(residentValidFirst_ - batchSteps, residentFirst_);
+        UploadResidentSteps(first, residentValidFirst_ - first);
+        residentValidFirst_ = first;
+    }
+}
+
+void GLWidget::UploadResidentSteps(int firstStep, int numSteps)
+{
+    // Converted to floats in parallel; numSteps is at most one batch, so the
+    // staging copy stays small
+    size_t numParticles = simulation_.particles.size();
+    size_t stepFloats = numParticles * 3;
+    size_t count = static_cast<size_t>(numSteps);
+    residentUpload_.resize(count * stepFloats);
+    
+    size_t numChunks = (numParticles + GATHER_CHUNK_PARTICLES - 1) / GATHER_CHUNK_PARTICLES;
+    RunChunks(numChunks, [&](size_t c) {
+        size_t end = std::min((c + 1) * GATHER_CHUNK_PARTICLES, numParticles);
+        for (size_t p = c * GATHER_CHUNK_PARTICLES; p < end; ++p) {
+            const auto& trajectory = simulation_.particles[p].trajectory;
+            for (size_t s = 0; s < count; ++s) {
+                const auto& pos = trajectory[firstStep + s];
+                float* out = &residentUpload_[s * stepFloats + p * 3];
+                out[0] = static_cast<float>(pos.x);
+                out[1] = static_cast<float>(pos.y);
+                out[2] = static_cast<float>(pos.z);
+            }
+        }
+    });
+    sphereRenderer_.UploadResidentSteps(firstStep - residentFirst_, residentUpload_.data(), count);
+}
+
+void GLWidget::UpdateResidentStyles()
+{
+    auto toByte = [](float c) {
+        return static_cast<unsigned char>(std::lround(255.0f * std::clamp(c, 0.0f, 1.0f)));
+    };
+    
+    // Hidden particles keep their slot with a zero radius
+    residentStyles_.clear();
+    sphereMaxRadius_ = 0.0f;
+    sphereCount_ = 0;
+    for (const auto& particle : simulation_.particles) {
+        float radius = particle.visible ? static_cast<float>(particle.size) : 0.0f;
+        residentStyles_.push_back({ radius, toByte(particle.color.r), toByte(particle.color.g),
+                                    toByte(particle.color.b), toByte(particle.color.a) });
+        if (particle.visible) {
+            sphereMaxRadius_ = std::max(sphereMaxRadius_, radius);
+            ++sphereCount_;
+        }
+    }
+    sphereRenderer_.SetResidentStyles(residentStyles_);
+    residentStylesDirty_ = false;
+}
+
+Point3D GLWidget::GetParticlePosition(size_t index) const
+{
+    // Blended like the spheres, so markers stay on them between stored steps
+    const auto& trajectory = simulation_.particles[index].trajectory;
+    int last = simulation_.numSteps - 1;
+    int steps[4] = { std::max(currentStep_ - 1, 0), currentStep_,
+                     std::min(currentStep_ + 1, last), std::min(currentStep_ + 2, last) };
+    QVector4D weights = StepWeights(interpolation_, stepFraction_);
+    float w[4] = { weights.x(), weights.y(), weights.z(), weights.w() };
+    
+    Point3D pos{ 0.0, 0.0, 0.0 };
+    for (int i = 0; i < 4; ++i) {
+        pos.x += w[i] * trajectory[steps[i]].x;
+        pos.y += w[i] * trajectory[steps[i]].y;
+        pos.z += w[i] * trajectory[steps[i]].z;
+    }
+    return pos;
+}
+
+bool GLWidget::IsGridCurrent() const
+{
+    return grid_ && gridStep_ == currentStep_ &&
+           gridWeights_ == StepWeights(interpolation_, stepFraction_);
+}
+
+void GLWidget::SyncProximity()
+{
+    // Built for the positions on screen when something needs it and no build is
+    // running; frames passed while a build runs are skipped
+    bool needed = highlightProximity_ || pickPending_ || selectedParticle_ >= 0;
+    if (!needed || IsGridCurrent() || gridWatcher_->isRunning()) return;
+    
+    size_t numParticles = simulation_.particles.size();
+    std::vector<float> xyz(numParticles * 3);
+    std::vector<float> radii(numParticles);
+    for (size_t i = 0; i < numParticles; ++i) {
+        const auto& particle = simulation_.particles[i];
+        Point3D pos = GetParticlePosition(i);
+        xyz[3 * i + 0] = static_cast<float>(pos.x);
+        xyz[3 * i + 1] = static_cast<float>(pos.y);
+        xyz[3 * i + 2] = static_cast<float>(pos.z);
+        radii[i] = particle.visible ? static_cast<float>(particle.size) : -1.0f;
+    }
+    
+    gridBuildStep_ = currentStep_;
+    gridBuildWeights_ = StepWeights(interpolation_, stepFraction_);
+    gridBuildGeneration_ = gridGeneration_;
+    float gap = proximityGap_;
+    bool findPairs = highlightProximity_;
+    gridWatcher_->setFuture(QtConcurrent::run([xyz = std::move(xyz), radii = std::move(radii),
+                                               gap, findPairs]() mutable {
+        GridResult result;
+        result.grid = std::make_shared<SpatialGrid>();
+        result.grid->Build(std::move(xyz), std::move(radii));
+        if (findPairs) {
+            // One more than shown, to tell a full list from a cut one
+            result.pairs = result.grid->ClosePairs(gap, MAX_CLOSE_PAIRS + 1);
+        }
+        return result;
+    }));
+}
+
+void GLWidget::OnGridFinished()
+{
+    GridResult result = gridWatcher_->result();
+    if (gridBuildGeneration_ != gridGeneration_) {
+        update();
+        return;
+    }
+    
+    grid_ = std::move(result.grid);
+    gridStep_ = gridBuildStep_;
+    gridWeights_ = gridBuildWeights_;
+    closePairs_ = std::move(result.pairs);
+    pairsTruncated_ = closePairs_.size() > 2 * MAX_CLOSE_PAIRS;
+    if (pairsTruncated_) {
+        closePairs_.resize(2 * MAX_CLOSE_PAIRS);
+    }
+    
+    // A click made while the grid was stale picks from the newest one
+    if (pickPending_) {
+        ResolvePick();
+    }
+    emit ProximityUpdated();
+    update();
+}
+
+void GLWidget::PickAt(const QPoint& pos)
+{
+    if (width() <= 0 || height() <= 0) return;
+    
+    // Ray from the near to the far plane through the pixel
+    float x = 2.0f * pos.x() / width() - 1.0f;
+    float y = 1.0f - 2.0f * pos.y() / height();
+    QMatrix4x4 inverse = (projectionMatrix_ * viewMatrix_).inverted();
+    QVector3D nearPoint = (inverse * QVector4D(x, y, -1.0f, 1.0f)).toVector3DAffine();
+    QVector3D farPoint = (inverse * QVector4D(x, y, 1.0f, 1.0f)).toVector3DAffine();
+    pickOrigin_ = nearPoint;
+    pickDirection_ = farPoint - nearPoint;
+    pickPending_ = true;
+    
+    if (IsGridCurrent()) {
+        ResolvePick();
+    } else {
+        update();
+    }
+}
+
+void GLWidget::ResolvePick()
+{
+    pickPending_ = false;
+    float origin[3] = { pickOrigin_.x(), pickOrigin_.y(), pickOrigin_.z() };
+    float direction[3] = { pickDirection_.x(), pickDirection_.y(), pickDirection_.z() };
+    selectedParticle_ = grid_ ? grid_->Pick(origin, direction) : -1;
+    emit ParticleSelected(selectedParticle_);
+    update();
+}
+
+void GLWidget::DrawProximity()
+{
+    size_t numParticles = simulation_.particles.size();
+    
+    // Selected particle inside a translucent yellow shell
+    if (selectedParticle_ >= 0 && static_cast<size_t>(selectedParticle_) < numParticles &&
+        simulation_.particles[selectedParticle_].visible) {
+        glDepthMask(GL_FALSE);
+        DrawSphere(GetParticlePosition(selectedParticle_), simulation_.particles[selectedParticle_].size * 1.4,
+                   { 1.0f, 0.8f, 0.0f, 0.35f });
+        glDepthMask(GL_TRUE);
+    }
+    
+    if (!highlightProximity_ || closePairs_.empty()) return;
+    
+    // Close pairs as lines between the centers, drawn over the spheres they join
+    std::vector<float> segments;
+    segments.reserve(3 * closePairs_.size());
+    for (size_t k = 0; k + 1 < closePairs_.size(); k += 2) {
+        if (closePairs_[k + 1] >= numParticles) continue;
+        Point3D a = GetParticlePosition(closePairs_[k]);
+        Point3D b = GetParticlePosition(closePairs_[k + 1]);
+        segments.insert(segments.end(), { static_cast<float>(a.x), static_cast<float>(a.y), static_cast<float>(a.z),
+                                          static_cast<float>(b.x), static_cast<float>(b.y), static_cast<float>(b.z) });
+    }
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    lineRenderer_.DrawSegments(segments, { 2.0f }, 0.9f, 0.1f, 0.1f);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHTING);
+}
+
+SphereRenderer::Mode GLWidget::ChooseSphereMode() const
+{
+    if (sphereMode_ == SphereMode::Mesh) return SphereRenderer::Mode::Mesh;
+    if (sphereMode_ == SphereMode::Impostor) return SphereRenderer::Mode::Impostor;
+    
+    if (sphereCount_ >= IMPOSTOR_MIN_PARTICLES) return SphereRenderer::Mode::Impostor;
+    
+    // Radius in pixels of the largest sphere at the distance of the look-at point
+    float pixelsPerUnit = 0.5f * height() / (std::tan(0.5f * FIELD_OF_VIEW * static_cast<float>(M_PI) / 180.0f) *
+                                             std::max(cameraDistance_, 1e-6f));
+    float pixelRadius = sphereMaxRadius_ * pixelsPerUnit;
+    bool meshFits = pixelRadius >= MESH_MIN_PIXEL_RADIUS && pixelRadius <= MESH_MAX_PIXEL_RADIUS;
+    return meshFits ? SphereRenderer::Mode::Mesh : SphereRenderer::Mode::Impostor;
+}
+
+void GLWidget::SyncDensity()
+{
+    if (densityRebuild_) {
+        double w = simulation_.containerWidth;
+        double h = simulation_.containerHeight;
+        double d = simulation_.containerDepth;
+        switch (densityPlane_) {
+            case DensityPlane::XY: density_.SetBounds(0, 1, 0.0, 0.0, w, h, DENSITY_RESOLUTION); break;
+            case DensityPlane::XZ: density_.SetBounds(0, 2, 0.0, 0.0, w, d, DENSITY_RESOLUTION); break;
+            case DensityPlane::YZ: density_.SetBounds(1, 2, 0.0, 0.0, h, d, DENSITY_RESOLUTION); break;
+        }
+        densityRebuild_ = false;
+        densityTextureDirty_ = true;
+    }
+    int first = density_.GetFirst();
+    int last = density_.GetLast();
+    density_.SetRange(simulation_, densityFirst_, densityLast_);
+    if (density_.GetFirst() != first || density_.GetLast() != last) {
+        densityTextureDirty_ = true;
+    }
+    if (!densityTextureDirty_) return;
+    
+    // Log scale, so cells visited a few times still show next to the busiest ones
+    const std::vector<int64_t>& counts = density_.GetCounts();
+    double scale = density_.GetMaxCount() > 0 ? 1.0 / std::log1p(static_cast<double>(density_.GetMaxCount())) : 0.0;
+    densityTexels_.assign(counts.size() * 4, 0);
+    for (size_t cell = 0; cell < counts.size(); ++cell) {
+        if (counts[cell] <= 0) continue;
+        unsigned char* texel = &densityTexels_[cell * 4];
+        float t = static_cast<float>(std::log1p(static_cast<double>(counts[cell])) * scale);
+        LineRenderer::SampleColormap(LineRenderer::Colormap::Viridis, t, texel);
+        texel[3] = DENSITY_ALPHA;
+    }
+    
+    if (densityTexture_ == 0) {
+        glGenTextures(1, &densityTexture_);
+        glBindTexture(GL_TEXTURE_2D, densityTexture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, densityTexture_);
+    }
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, density_.GetWidth(), density_.GetHeight(), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, densityTexels_.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    densityTextureDirty_ = false;
+}
+
+void GLWidget::DrawDensity()
+{
+    if (densityTexture_ == 0 || density_.GetFirst() < 0) return;
+    
+    // Corners of the grid on its face; cells are square, so it can reach a little
+    // past the container
+    float u = static_cast<float>(density_.GetWidth() * density_.GetCellSize());
+    float v = static_cast<float>(density_.GetHeight() * density_.GetCellSize());
+    QVector3D corners[4];
+    switch (densityPlane_) {
+        case DensityPlane::XY: corners[1] = QVector3D(u, 0, 0); corners[3] = QVector3D(0, v, 0); break;
+        case DensityPlane::XZ: corners[1] = QVector3D(u, 0, 0); corners[3] = QVector3D(0, 0, v); break;
+        case DensityPlane::YZ: corners[1] = QVector3D(0, u, 0); corners[3] = QVector3D(0, 0, v); break;
+    }
+    corners[2] = corners[1] + corners[3];
+    const float texCoords[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+    
+    // Drawn over the coplanar face of the bounding box
+    glDisable(GL_LIGHTING);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(-1.0f, -1.0f);
+    glActiveTexture(GL_TEXTURE0);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, densityTexture_);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    for (int i = 0; i < 4; ++i) {
+        glTexCoord2f(texCoords[i][0], texCoords[i][1]);
+        glVertex3f(corners[i].x(), corners[i].y(), corners[i].z());
+    }
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glEnable(GL_LIGHTING);
+}
+
+void GLWidget::resizeGL(int w, int h)
+{
+    glViewport(0, 0, w, h);
+}
+
+void GLWidget::DrawSphere(const Point3D& center, double radius, const Color& color)
+{
+    sphereRenderer_.DrawSingle(static_cast<float>(center.x), static_cast<float>(center.y), static_cast<float>(center.z),
+                               static_cast<float>(radius), color.r, color.g, color.b, color.a);
 }
 
 void GLWidget::DrawAxes(bool extendBothDirections)
@@ -229,32 +920,16 @@ void GLWidget::DrawAxes(bool extendBothDirections)
     float sphereRadius = maxDim * 0.03f;
     
     glDisable(GL_LIGHTING);
-    glLineWidth(2.0f);
     
     float start = extendBothDirections ? -axisLength : 0.0f;
+    LineRenderer::Style style;
+    style.width = 2.0f;
     
-    // X axis - Red
-    glBegin(GL_LINES);
-    glColor3f(0.8f, 0.0f, 0.0f);
-    glVertex3f(start, 0, 0);
-    glVertex3f(axisLength, 0, 0);
-    glEnd();
-    
-    // Y axis - Green
-    glBegin(GL_LINES);
-    glColor3f(0.0f, 0.6f, 0.0f);
-    glVertex3f(0, start, 0);
-    glVertex3f(0, axisLength, 0);
-    glEnd();
-    
-    // Z axis - Blue
-    glBegin(GL_LINES);
-    glColor3f(0.0f, 0.0f, 0.8f);
-    glVertex3f(0, 0, start);
-    glVertex3f(0, 0, axisLength);
-    glEnd();
+    // X axis - Red, Y axis - Green, Z axis - Blue
+    lineRenderer_.DrawSegments({ start, 0, 0, axisLength, 0, 0 }, style, 0.8f, 0.0f, 0.0f);
+    lineRenderer_.DrawSegments({ 0, start, 0, 0, axisLength, 0 }, style, 0.0f, 0.6f, 0.0f);
+    lineRenderer_.DrawSegments({ 0, 0, start, 0, 0, axisLength }, style, 0.0f, 0.0f, 0.8f);
     
-    glLineWidth(1.0f);
     glEnable(GL_LIGHTING);
     
     // Draw sphere tips on axes
@@ -316,31 +991,15 @@ void GLWidget::DrawBoundingBox()
     Color yzColor = {0.94f, 0.50f, 0.50f, 0.2f};
     DrawSemiTransparentPlane(0, 0, 0,  0, h, 0,  0, h, d,  0, 0, d, yzColor);
     
-    // Draw wireframe edges
-    glColor4f(0.5f, 0.5f, 0.5f, 0.6f);
-    glLineWidth(1.5f);
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(0, 0, 0);
-    glVertex3f(w, 0, 0);
-    glVertex3f(w, h, 0);
-    glVertex3f(0, h, 0);
-    glEnd();
-    
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(0, 0, d);
-    glVertex3f(w, 0, d);
-    glVertex3f(w, h, d);
-    glVertex3f(0, h, d);
-    glEnd();
+    // Wireframe edges: front and back rectangles plus the four connecting edges,
+    // in the gray that 60% opaque mid-gray gave over the white background
+    std::vector<float> edges = {
+        0, 0, 0, w, 0, 0,   w, 0, 0, w, h, 0,   w, h, 0, 0, h, 0,   0, h, 0, 0, 0, 0,
+        0, 0, d, w, 0, d,   w, 0, d, w, h, d,   w, h, d, 0, h, d,   0, h, d, 0, 0, d,
+        0, 0, 0, 0, 0, d,   w, 0, 0, w, 0, d,   w, h, 0, w, h, d,   0, h, 0, 0, h, d
+    };
+    lineRenderer_.DrawSegments(edges, { 1.5f }, 0.7f, 0.7f, 0.7f);
     
-    glBegin(GL_LINES);
-    glVertex3f(0, 0, 0); glVertex3f(0, 0, d);
-    glVertex3f(w, 0, 0); glVertex3f(w, 0, d);
-    glVertex3f(w, h, 0); glVertex3f(w, h, d);
-    glVertex3f(0, h, 0); glVertex3f(0, h, d);
-    glEnd();
-    
-    glLineWidth(1.0f);
     glEnable(GL_LIGHTING);
 }
 
@@ -377,6 +1036,7 @@ void GLWidget::DrawCoordinatePlanes()
 void GLWidget::mousePressEvent(QMouseEvent *event)
 {
     lastMousePos_ = event->pos();
+    pressMousePos_ = event->pos();
     
     if (event->button() == Qt::LeftButton) {
         isRotating_ = true;
@@ -417,7 +1077,11 @@ void GLWidget::mouseMoveEvent(QMouseEvent *event)
 
 void GLWidget::mouseReleaseEvent(QMouseEvent *event)
 {
-    Q_UNUSED(event);
+    // A left click that didn't rotate the view picks
+    if (event->button() == Qt::LeftButton &&
+        (event->pos() - pressMousePos_).manhattanLength() <= CLICK_MAX_DRAG) {
+        PickAt(event->pos());
+    }
     isRotating_ = false;
     isPanning_ = false;
 }
@@ -5,9 +5,17 @@
 #include <QOpenGLFunctions>
 #include <QMatrix4x4>
 #include <QVector3D>
+#include <QVector4D>
 #include <QMouseEvent>
 #include <QWheelEvent>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <memory>
 #include "MMLData.h"
+#include "LineRenderer.h"
+#include "SphereRenderer.h"
+#include "SpatialGrid.h"
+#include "DensityGrid.h"
 
 class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions
 {
@@ -19,8 +27,51 @@ public:
 
     void SetSimulation(const LoadedParticleSimulation3D& sim);
     void SetCurrentStep(int step);
+    
+    // Continuous playback position in steps; between stored steps the particles
+    // are interpolated from the neighbouring ones
+    enum class Interpolation { None, Linear, CatmullRom };
+    void SetPlaybackTime(double time);
+    void SetInterpolation(Interpolation interpolation);
+    Interpolation GetInterpolation() const { return interpolation_; }
     void SetDisplayMode(DisplayMode mode);
     void SetParticleVisible(int index, bool visible);
+    void SetShowTrails(bool show);
+    void SetTrailLength(int length);
+    
+    // Particle spheres as meshes or ray-cast impostors; Auto picks per frame from
+    // the particle count and their size on screen
+    enum class SphereMode { Auto, Mesh, Impostor };
+    void SetSphereMode(SphereMode mode);
+    SphereMode GetSphereMode() const { return sphereMode_; }
+    
+    // Keep the run's positions in GPU memory so changing steps uploads nothing;
+    // falls back to per-step instances without instancing or GPU memory
+    void SetGpuResident(bool resident);
+    bool IsGpuResident() const { return gpuResident_; }
+    
+    // Proximity: a uniform grid over the visible particles where they are drawn,
+    // between stored steps too, built on a worker thread when needed. A click selects the particle under the cursor;
+    // with highlighting on, pairs whose surfaces are closer than the gap are joined
+    // by red lines (gap 0 shows the overlapping ones).
+    void SetHighlightProximity(bool highlight);
+    void SetProximityGap(double gap);
+    int GetSelectedParticle() const { return selectedParticle_; }
+    // Particles within the gap of the selected one, at the step the grid was built
+    // for; -1 while there is no grid
+    int CountSelectedNeighbours() const;
+    int GetProximityStep() const { return gridStep_; }
+    size_t GetNumClosePairs() const { return closePairs_.size() / 2; }
+    bool AreClosePairsTruncated() const { return pairsTruncated_; }
+    
+    // Density: the visible particles' centers projected onto one of the container's
+    // faces at the origin and counted per cell over steps [first, last], drawn on
+    // that face colormapped on a log scale (empty cells stay clear). Moving the
+    // range recounts only the steps that entered or left it.
+    enum class DensityPlane { XY, XZ, YZ };
+    void SetShowDensity(bool show);
+    void SetDensityRange(int first, int last);
+    void SetDensityPlane(DensityPlane plane);
     
     void ResetCamera();
     void LookAtCenter();
@@ -28,6 +79,14 @@ public:
     LoadedParticleSimulation3D& GetSimulation() { return simulation_; }
     const LoadedParticleSimulation3D& GetSimulation() const { return simulation_; }
 
+signals:
+    // After every paint, with the CPU time it took
+    void FrameDrawn(double milliseconds);
+    // A click selected a particle, or nothing (-1)
+    void ParticleSelected(int index);
+    // A grid finished building; close pairs and neighbour counts changed
+    void ProximityUpdated();
+
 protected:
     void initializeGL() override;
     void paintGL() override;
@@ -49,9 +108,28 @@ private:
                                    float x4, float y4, float z4,
                                    const Color& color);
     void UpdateProjectionMatrix();
+    void UpdateSphereInstances();
+    SphereRenderer::Mode ChooseSphereMode() const;
+    bool SyncResidentRun();
+    void UploadResidentBatch(int needFirst, int needLast);
+    void UploadResidentSteps(int firstStep, int numSteps);
+    void UpdateResidentStyles();
+    void SyncTrail();
+    void DrawTrails();
+    Point3D GetParticlePosition(size_t index) const;
+    bool IsGridCurrent() const;
+    void SyncProximity();
+    void OnGridFinished();
+    void PickAt(const QPoint& pos);
+    void ResolvePick();
+    void DrawProximity();
+    void SyncDensity();
+    void DrawDensity();
     
     LoadedParticleSimulation3D simulation_;
     int currentStep_;
+    float stepFraction_;         // Position between currentStep_ and the next step
+    Interpolation interpolation_;
     DisplayMode displayMode_;
     
     // Camera parameters
@@ -69,6 +147,7 @@ private:
     
     // Mouse interaction
     QPoint lastMousePos_;
+    QPoint pressMousePos_;
     bool isRotating_;
     bool isPanning_;
     
@@ -76,6 +155,93 @@ private:
     QMatrix4x4 projectionMatrix_;
     QMatrix4x4 viewMatrix_;
     
+    // Axes and box edges as instanced wide lines
+    LineRenderer lineRenderer_;
+    
+    // Fading trails: the last trailLength_ positions of every particle in a GPU ring,
+    // advanced one row per step; trailStep_ is the newest step in it (-1 when empty)
+    bool showTrails_;
+    int trailLength_;
+    LineRenderer::Trail trail_;
+    int trailStep_;
+    bool trailRebuild_;          // Simulation or length changed
+    bool trailColorsDirty_;      // Visibility changed
+    std::vector<float> trailRow_;
+    
+    // Particles as instances of one sphere mesh; the instance buffer is rebuilt
+    // only when the step or the visible set changes
+    SphereRenderer sphereRenderer_;
+    std::vector<SphereRenderer::Instance> sphereInstances_;
+    int sphereStep_;            // Step in the instance buffer, -1 when stale
+    QVector4D sphereWeights_;   // Step weights it was interpolated with
+    float sphereMaxRadius_;     // Largest radius drawn
+    size_t sphereCount_;        // Visible spheres drawn
+    SphereMode sphereMode_;
+    
+    // Resident run: a window of up to RESIDENT_MAX_BYTES of consecutive steps, the
+    // whole run when it fits, recentred on the current step when it leaves it. The
+    // window is filled RESIDENT_UPLOAD_BYTES per frame outwards from the current step,
+    // drawing through the per-step instances until the steps on screen are in
+    bool gpuResident_;
+    bool residentRebuild_;       // Simulation changed or residency toggled
+    bool residentFailed_;        // No instancing or out of GPU memory; use instances
+    bool residentStylesDirty_;   // Visibility changed
+    int residentFirst_;          // Step in the first slot, -1 when there is no window
+    int residentValidFirst_;     // Uploaded steps of the window, empty when first > last
+    int residentValidLast_;
+    std::vector<float> residentUpload_;
+    std::vector<SphereRenderer::Style> residentStyles_;
+    static constexpr size_t RESIDENT_MAX_BYTES = size_t(512) << 20;
+    static constexpr size_t RESIDENT_UPLOAD_BYTES = size_t(16) << 20;
+    
+    // Proximity grid of gridStep_ (-1 when none) blended with gridWeights_, as the
+    // spheres were drawn, with its close pairs; the generation discards builds
+    // started before the particles, visibility or gap changed
+    struct GridResult {
+        std::shared_ptr<SpatialGrid> grid;
+        std::vector<uint32_t> pairs;
+    };
+    QFutureWatcher<GridResult>* gridWatcher_;
+    std::shared_ptr<SpatialGrid> grid_;
+    int gridStep_;
+    int gridBuildStep_;
+    QVector4D gridWeights_;
+    QVector4D gridBuildWeights_;
+    unsigned gridGeneration_;
+    unsigned gridBuildGeneration_;
+    bool highlightProximity_;
+    float proximityGap_;
+    std::vector<uint32_t> closePairs_;
+    bool pairsTruncated_;
+    int selectedParticle_;
+    bool pickPending_;           // A click waits for the grid of the positions on screen
+    QVector3D pickOrigin_;
+    QVector3D pickDirection_;
+    static constexpr size_t MAX_CLOSE_PAIRS = 100000;
+    static constexpr int CLICK_MAX_DRAG = 3;    // Pixels between press and release
+    
+    // Density counts of densityFirst_ .. densityLast_ and the texture they were
+    // colormapped into
+    bool showDensity_;
+    int densityFirst_;
+    int densityLast_;
+    DensityPlane densityPlane_;
+    DensityGrid density_;
+    bool densityRebuild_;        // Simulation, visibility or plane changed
+    bool densityTextureDirty_;
+    GLuint densityTexture_;
+    std::vector<unsigned char> densityTexels_;
+    static constexpr int DENSITY_RESOLUTION = 256;     // Cells along the longer side
+    static constexpr unsigned char DENSITY_ALPHA = 200;
+    
+    // Auto mode uses meshes only for fewer particles than this whose largest
+    // on-screen radius lies between the two limits (pixels): smaller spheres are
+    // all sub-pixel triangles, larger ones show the mesh's facets
+    static constexpr size_t IMPOSTOR_MIN_PARTICLES = 10000;
+    static constexpr float MESH_MIN_PIXEL_RADIUS = 3.0f;
+    static constexpr float MESH_MAX_PIXEL_RADIUS = 150.0f;
+    static constexpr float FIELD_OF_VIEW = 45.0f;
+    
     // Sphere rendering parameters
     static const int SPHERE_SLICES = 20;
     static const int SPHERE_STACKS = 20;
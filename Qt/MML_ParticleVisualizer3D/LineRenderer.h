@@ -0,0 +1,144 @@
+#ifndef LINE_RENDERER_H
+#define LINE_RENDERER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <memory>
+#include <vector>
+
+// Draws wide lines as screen-space quads. Every segment of a strip is one instance
+// of a 4-vertex quad that the vertex shader expands from the raw point buffer, so
+// a series of any length and width costs a single draw call, with miter or round
+// joins and an antialiased edge. Strips can also be colored per point from a
+// colormap texture, and fading trails of many moving objects are drawn the same
+// way from a ring buffer. Falls back to glLineWidth line strips when the context has
+// no instancing (older than OpenGL 3.3).
+class LineRenderer : protected QOpenGLExtraFunctions {
+public:
+    enum class JoinStyle {
+        Miter,      // Sharp corners; squared off beyond MITER_LIMIT
+        Round       // Each segment is a capsule; overlapping caps form the joins
+    };
+
+    struct Style {
+        float width = 1.0f;             // Logical pixels
+        JoinStyle join = JoinStyle::Miter;
+        bool antialias = true;
+    };
+
+    // Colormaps for attribute-colored strips; all of them live in one texture
+    enum class Colormap { Viridis, Plasma, CoolWarm, Grayscale, Count };
+    
+    // Per-point scalars of a strip, stored next to its points
+    static constexpr int ATTRIBUTE_CHANNELS = 3;
+    
+    // Color from one attribute channel; [minValue, maxValue] spans the colormap.
+    // Everything here is a uniform, so changing it never touches the buffers.
+    struct AttributeColoring {
+        int channel = 0;
+        float minValue = 0.0f;
+        float maxValue = 1.0f;
+        Colormap colormap = Colormap::Viridis;
+    };
+    
+    // Color at t in [0, 1] along a colormap, as the colormap texture stores it
+    static void SampleColormap(Colormap colormap, float t, unsigned char rgb[3]);
+    
+    // Points uploaded once (xyz floats). The first and last point are stored twice,
+    // so every segment can read both of its neighbours from the same buffer.
+    struct Strip {
+        GLuint vbo = 0;
+        GLsizei numPoints = 0;
+        GLuint attributeVbo = 0;    // ATTRIBUTE_CHANNELS floats per point, padded like the points
+    };
+    
+    // Trails of the last `length` positions of numObjects objects. The positions of
+    // one step form a row of a ring; every row is stored twice, so the newest rows
+    // are always contiguous and every trail is drawn by one instanced call.
+    struct Trail {
+        GLuint vbo = 0;             // 2 * length rows of numObjects points
+        GLuint colorVbo = 0;        // RGBA8 per segment; alpha fades from the newest segment to the oldest
+        GLsizei numObjects = 0;
+        GLsizei length = 0;         // Positions kept per object
+        GLsizei head = 0;           // Ring row of the newest positions
+        GLsizei numRows = 0;        // Rows pushed since the last clear, up to length
+    };
+
+    LineRenderer();
+    ~LineRenderer();
+
+    // Must be called with the GL context current
+    void Initialize(qreal devicePixelRatio = 1.0);
+    void Cleanup();
+    bool IsInitialized() const { return initialized_; }
+    bool IsInstanced() const { return program_ != nullptr; }
+
+    // Strip buffers; points may be uploaded in several chunks
+    Strip CreateStrip(size_t numPoints);
+    void UploadStripPoints(const Strip& strip, size_t firstPoint, const float* xyz, size_t count);
+    // ATTRIBUTE_CHANNELS values per point; the attribute buffer is created on first upload
+    void UploadStripAttributes(Strip& strip, size_t firstPoint, const float* values, size_t count);
+    void ReleaseStrip(Strip& strip);
+    
+    // Trail buffers; colors must be set before the first draw
+    Trail CreateTrail(size_t numObjects, size_t length);
+    // RGBA floats per object; an alpha of 0 hides that object's trail
+    void SetTrailColors(const Trail& trail, const float* rgba);
+    // Newest position of every object (xyz floats, numObjects points): one row, written twice
+    void PushTrailRow(Trail& trail, const float* xyz);
+    void ClearTrail(Trail& trail) { trail.numRows = 0; }
+    void ReleaseTrail(Trail& trail);
+
+    // World to clip space transform used by the following draws
+    void SetMatrix(const QMatrix4x4& matrix) { matrix_ = matrix; }
+
+    // Points [first, first + count) of an uploaded strip; count < 0 draws to the end
+    void DrawStrip(const Strip& strip, const Style& style, float r, float g, float b,
+                   GLsizei first = 0, GLsizei count = -1);
+    
+    // Same, colored from the strip's attributes. Without instancing (or attributes)
+    // the strip is drawn in the middle color of the colormap.
+    void DrawStrip(const Strip& strip, const Style& style, const AttributeColoring& coloring,
+                   GLsizei first = 0, GLsizei count = -1);
+
+    // Strip or independent segments (point pairs) streamed from client memory
+    void DrawStrip(const std::vector<float>& xyz, const Style& style, float r, float g, float b);
+    void DrawSegments(const std::vector<float>& xyz, const Style& style, float r, float g, float b);
+    
+    // Every trail segment as one instance; needs instancing, nothing is drawn otherwise
+    void DrawTrail(const Trail& trail, const Style& style);
+
+private:
+    // Draws numSegments quads; attribute offsets are in bytes into vbo
+    void DrawInstanced(GLuint vbo, GLsizei stride, GLintptr prevOffset, GLintptr startOffset,
+                       GLintptr endOffset, GLintptr nextOffset, GLsizei numSegments,
+                       const Style& style, float r, float g, float b,
+                       GLuint attributeVbo = 0, GLintptr attributeOffset = 0,
+                       const AttributeColoring* coloring = nullptr,
+                       GLuint colorVbo = 0, GLintptr colorOffset = 0);
+
+    // glLineWidth path for contexts without instancing
+    void DrawFixedFunction(GLuint vbo, GLintptr offset, GLenum mode, GLsizei count,
+                           const Style& style, float r, float g, float b);
+
+    void FillStreamBuffer(const std::vector<float>& xyz, bool padEnds);
+    void CreateColormapTexture();
+
+    static constexpr float MITER_LIMIT = 4.0f;      // Max miter length, in line widths
+    static constexpr float FRINGE_PIXELS = 1.0f;    // Antialiased edge width
+    static constexpr GLsizei POINT_BYTES = 3 * sizeof(float);
+    static constexpr GLsizei ATTRIBUTE_BYTES = ATTRIBUTE_CHANNELS * sizeof(float);
+    static constexpr GLsizei COLOR_BYTES = 4;
+    static constexpr int COLORMAP_SIZE = 256;       // Texels per colormap
+
+    bool initialized_;
+    qreal devicePixelRatio_;
+    std::unique_ptr<QOpenGLShaderProgram> program_;
+    GLuint cornerVbo_;
+    GLuint streamVbo_;
+    GLuint colormapTexture_;        // One row per Colormap
+    QMatrix4x4 matrix_;
+};
+
+#endif // LINE_RENDERER_H
@@ -34,6 +34,7 @@ class ParticleData3D
 public:
     std::string name;
     Color color;
+    std::string colorName;  // As written in the file
     double size;  // particle size/radius
     std::vector<Point3D> trajectory;  // positions over time
     bool visible;
@@ -61,6 +62,7 @@ struct LoadedParticleSimulation3D
     std::string title;
     std::vector<ParticleData3D> particles;
     int numSteps;
+    std::vector<double> stepTimes;  // Time of every step, from its Step line
     double containerWidth, containerHeight, containerDepth;
     
     LoadedParticleSimulation3D() 
@@ -125,6 +125,7 @@ LoadedParticleSimulation3D MMLFileParser::LoadParticleSimulation3D(const std::st
         double radius = ParseDouble(parts[2]);
         
         simulation.particles.emplace_back(name, color, radius);
+        simulation.particles.back().colorName = parts[1];
     }
     
     // Read NumSteps line
@@ -156,6 +157,7 @@ LoadedParticleSimulation3D MMLFileParser::LoadParticleSimulation3D(const std::st
         if (stepNum != step) {
             throw std::runtime_error("Step number mismatch at line " + std::to_string(lineNumber));
         }
+        simulation.stepTimes.push_back(parts.size() >= 3 ? ParseDouble(parts[2]) : static_cast<double>(step));
         
         // Read ball positions for this step
         for (int i = 0; i < numBalls; i++) {
@@ -8,18 +8,28 @@
 #include <QButtonGroup>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QStatusBar>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <cmath>
+#include <map>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , glWidget_(nullptr)
+    , statisticsPlot_(nullptr)
     , animationTimer_(nullptr)
     , isPlaying_(false)
     , currentStep_(0)
-    , refreshCounter_(0)
-    , refreshEvery_(1)
+    , playbackStatusLabel_(nullptr)
+    , statisticsWatcher_(nullptr)
+    , statisticsCancel_(false)
 {
     SetupUI();
     
+    statisticsWatcher_ = new QFutureWatcher<std::shared_ptr<StepStatistics>>(this);
+    connect(statisticsWatcher_, &QFutureWatcherBase::finished, this, &MainWindow::OnStatisticsFinished);
+    
     animationTimer_ = new QTimer(this);
     connect(animationTimer_, &QTimer::timeout, this, &MainWindow::OnTimerTick);
     
@@ -29,6 +39,7 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    CancelStatistics();
 }
 
 void MainWindow::SetupUI()
@@ -94,19 +105,39 @@ void MainWindow::SetupUI()
     totalStepsLabel_ = new QLabel("0");
     animationLayout->addRow("Total Steps:", totalStepsLabel_);
     
-    delaySpinBox_ = new QSpinBox();
-    delaySpinBox_->setRange(1, 1000);
-    delaySpinBox_->setValue(50);
-    delaySpinBox_->setSuffix(" ms");
-    connect(delaySpinBox_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::OnDelayChanged);
-    animationLayout->addRow("Step Delay:", delaySpinBox_);
-    
-    refreshEverySpinBox_ = new QSpinBox();
-    refreshEverySpinBox_->setRange(1, 100);
-    refreshEverySpinBox_->setValue(1);
-    refreshEverySpinBox_->setSuffix(" steps");
-    connect(refreshEverySpinBox_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::OnRefreshEveryChanged);
-    animationLayout->addRow("Refresh Every:", refreshEverySpinBox_);
+    // Simulation steps per second of wall time, held by skipping or repeating steps
+    rateSpinBox_ = new QDoubleSpinBox();
+    rateSpinBox_->setRange(0.1, 10000.0);
+    rateSpinBox_->setDecimals(1);
+    rateSpinBox_->setValue(20.0);
+    rateSpinBox_->setSuffix(" steps/s");
+    connect(rateSpinBox_, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::OnRateChanged);
+    animationLayout->addRow("Playback Rate:", rateSpinBox_);
+    
+    // Smooth playback between stored steps
+    interpolationCombo_ = new QComboBox();
+    interpolationCombo_->addItem("None");
+    interpolationCombo_->addItem("Linear");
+    interpolationCombo_->addItem("Catmull-Rom");
+    connect(interpolationCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::OnInterpolationChanged);
+    animationLayout->addRow("Interpolation:", interpolationCombo_);
+    
+    showTrailsCheckBox_ = new QCheckBox("Show trails");
+    connect(showTrailsCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowTrailsChanged);
+    animationLayout->addRow(showTrailsCheckBox_);
+    
+    trailLengthSpinBox_ = new QSpinBox();
+    trailLengthSpinBox_->setRange(2, 1024);
+    trailLengthSpinBox_->setValue(64);
+    trailLengthSpinBox_->setSuffix(" steps");
+    connect(trailLengthSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::OnTrailLengthChanged);
+    animationLayout->addRow("Trail Length:", trailLengthSpinBox_);
+    
+    gpuResidentCheckBox_ = new QCheckBox("Keep run on GPU");
+    gpuResidentCheckBox_->setChecked(true);
+    gpuResidentCheckBox_->setToolTip("Upload all steps once so scrubbing and playback upload nothing per step");
+    connect(gpuResidentCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnGpuResidentChanged);
+    animationLayout->addRow(gpuResidentCheckBox_);
     
     sidebarLayout->addWidget(animationGroup);
     
@@ -121,7 +152,7 @@ void MainWindow::SetupUI()
     cameraLayout->addWidget(lookAtCenterButton_);
     cameraLayout->addWidget(resetCameraButton_);
     
-    QLabel* cameraHelpLabel = new QLabel("Mouse: Left=Rotate, Right=Pan\nWheel=Zoom");
+    QLabel* cameraHelpLabel = new QLabel("Mouse: Left=Rotate, Right=Pan\nWheel=Zoom, Click=Select particle");
     cameraHelpLabel->setStyleSheet("color: gray; font-size: 10px;");
     cameraLayout->addWidget(cameraHelpLabel);
     
@@ -149,8 +180,105 @@ void MainWindow::SetupUI()
     displayLayout->addWidget(displayBoundingBoxRadio_);
     displayLayout->addWidget(displayCoordinatePlanesRadio_);
     
+    // Spheres: Auto switches to impostors for many or very small/large particles
+    QHBoxLayout* sphereModeLayout = new QHBoxLayout();
+    sphereModeLayout->addWidget(new QLabel("Spheres:"));
+    sphereModeCombo_ = new QComboBox();
+    sphereModeCombo_->addItem("Auto");
+    sphereModeCombo_->addItem("Mesh");
+    sphereModeCombo_->addItem("Impostor");
+    connect(sphereModeCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::OnSphereModeChanged);
+    sphereModeLayout->addWidget(sphereModeCombo_, 1);
+    displayLayout->addLayout(sphereModeLayout);
+    
     sidebarLayout->addWidget(displayGroup);
     
+    // === Proximity Panel ===
+    QGroupBox* proximityGroup = new QGroupBox("Proximity");
+    QFormLayout* proximityLayout = new QFormLayout(proximityGroup);
+    
+    highlightProximityCheckBox_ = new QCheckBox("Highlight close pairs");
+    connect(highlightProximityCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnHighlightProximityChanged);
+    proximityLayout->addRow(highlightProximityCheckBox_);
+    
+    // Distance between surfaces; 0 finds overlapping particles
+    proximityGapSpinBox_ = new QDoubleSpinBox();
+    proximityGapSpinBox_->setRange(0.0, 1.0e6);
+    proximityGapSpinBox_->setDecimals(3);
+    proximityGapSpinBox_->setSingleStep(0.1);
+    proximityGapSpinBox_->setValue(0.0);
+    proximityGapSpinBox_->setToolTip("Pairs whose surfaces are closer than this; 0 shows overlaps");
+    connect(proximityGapSpinBox_, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::OnProximityGapChanged);
+    proximityLayout->addRow("Gap:", proximityGapSpinBox_);
+    
+    closePairsLabel_ = new QLabel("-");
+    proximityLayout->addRow("Close Pairs:", closePairsLabel_);
+    
+    selectedParticleLabel_ = new QLabel("Click a particle to select it");
+    selectedParticleLabel_->setWordWrap(true);
+    proximityLayout->addRow(selectedParticleLabel_);
+    
+    sidebarLayout->addWidget(proximityGroup);
+    
+    // === Statistics Panel ===
+    QGroupBox* statisticsGroup = new QGroupBox("Statistics");
+    QFormLayout* statisticsLayout = new QFormLayout(statisticsGroup);
+    
+    statisticKindCombo_ = new QComboBox();
+    for (StatisticKind kind : { StatisticKind::Speed, StatisticKind::KineticEnergy,
+                                StatisticKind::CenterOfMass, StatisticKind::Extents }) {
+        statisticKindCombo_->addItem(StepStatistics::GetKindName(kind));
+    }
+    connect(statisticKindCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::OnStatisticKindChanged);
+    statisticsLayout->addRow("Plot:", statisticKindCombo_);
+    
+    QHBoxLayout* statisticsButtonsLayout = new QHBoxLayout();
+    showStatisticsCheckBox_ = new QCheckBox("Show plot");
+    connect(showStatisticsCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowStatisticsChanged);
+    saveStatisticsButton_ = new QPushButton("Save...");
+    saveStatisticsButton_->setToolTip("Save the plotted series as a MULTI_REAL_FUNCTION file");
+    saveStatisticsButton_->setEnabled(false);
+    connect(saveStatisticsButton_, &QPushButton::clicked, this, &MainWindow::OnSaveStatistics);
+    statisticsButtonsLayout->addWidget(showStatisticsCheckBox_);
+    statisticsButtonsLayout->addStretch();
+    statisticsButtonsLayout->addWidget(saveStatisticsButton_);
+    statisticsLayout->addRow(statisticsButtonsLayout);
+    
+    statisticsStatusLabel_ = new QLabel("-");
+    statisticsLayout->addRow("Status:", statisticsStatusLabel_);
+    
+    sidebarLayout->addWidget(statisticsGroup);
+    
+    // === Density Panel ===
+    QGroupBox* densityGroup = new QGroupBox("Density");
+    QFormLayout* densityLayout = new QFormLayout(densityGroup);
+    
+    showDensityCheckBox_ = new QCheckBox("Show density");
+    connect(showDensityCheckBox_, &QCheckBox::toggled, this, &MainWindow::OnShowDensityChanged);
+    densityLayout->addRow(showDensityCheckBox_);
+    
+    densityPlaneCombo_ = new QComboBox();
+    densityPlaneCombo_->addItem("XY (z = 0)");
+    densityPlaneCombo_->addItem("XZ (y = 0)");
+    densityPlaneCombo_->addItem("YZ (x = 0)");
+    connect(densityPlaneCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::OnDensityPlaneChanged);
+    densityLayout->addRow("Plane:", densityPlaneCombo_);
+    
+    densityFirstSlider_ = new QSlider(Qt::Horizontal);
+    densityFirstSlider_->setRange(0, 0);
+    connect(densityFirstSlider_, &QSlider::valueChanged, this, &MainWindow::OnDensityRangeChanged);
+    densityLayout->addRow("From:", densityFirstSlider_);
+    
+    densityLastSlider_ = new QSlider(Qt::Horizontal);
+    densityLastSlider_->setRange(0, 0);
+    connect(densityLastSlider_, &QSlider::valueChanged, this, &MainWindow::OnDensityRangeChanged);
+    densityLayout->addRow("To:", densityLastSlider_);
+    
+    densityRangeLabel_ = new QLabel("-");
+    densityLayout->addRow("Steps:", densityRangeLabel_);
+    
+    sidebarLayout->addWidget(densityGroup);
+    
     // === Particles Panel ===
     particlesGroupBox_ = new QGroupBox("Particles");
     QVBoxLayout* particlesLayout = new QVBoxLayout(particlesGroupBox_);
@@ -184,21 +312,41 @@ void MainWindow::SetupUI()
     // Add stretch to push everything up
     sidebarLayout->addStretch();
     
-    // Create OpenGL widget
-    glWidget_ = new GLWidget();
+    // Create OpenGL widget, with the statistics pane below it
+    QSplitter* plotSplitter = new QSplitter(Qt::Vertical, this);
+    glWidget_ = new GLWidget(plotSplitter);
     glWidget_->setMinimumSize(800, 600);
+    connect(glWidget_, &GLWidget::FrameDrawn, this, &MainWindow::OnFrameDrawn);
+    connect(glWidget_, &GLWidget::ParticleSelected, this, &MainWindow::OnParticleSelected);
+    connect(glWidget_, &GLWidget::ProximityUpdated, this, &MainWindow::OnProximityUpdated);
+    
+    statisticsPlot_ = new StatisticsPlotWidget(plotSplitter);
+    statisticsPlot_->hide();
+    plotSplitter->addWidget(glWidget_);
+    plotSplitter->addWidget(statisticsPlot_);
+    plotSplitter->setStretchFactor(0, 3);
+    plotSplitter->setStretchFactor(1, 1);
     
     // Add to main layout
     mainLayout->addWidget(sidebar);
-    mainLayout->addWidget(glWidget_, 1);
+    mainLayout->addWidget(plotSplitter, 1);
     
     setCentralWidget(centralWidget);
+    
+    // Status bar: requested and achieved playback rate
+    playbackStatusLabel_ = new QLabel(this);
+    statusBar()->addWidget(playbackStatusLabel_);
+    UpdatePlaybackStatus();
 }
 
 void MainWindow::LoadSimulation(const QString& filePath)
 {
+    // The parser writes into simulation_, which a statistics build may be reading
+    CancelStatistics();
+    
     MMLFileParser parser;
     if (!parser.ParseFile(filePath.toStdString(), simulation_)) {
+        if (!statistics_) StartStatistics();
         QMessageBox::critical(this, "Error", "Failed to load simulation file:\n" + filePath);
         return;
     }
@@ -212,8 +360,10 @@ void MainWindow::LoadSimulation(const QString& filePath)
     
     // Reset animation state
     currentStep_ = 0;
-    refreshCounter_ = 0;
     isPlaying_ = false;
+    animationTimer_->stop();
+    scheduler_.SetNumSteps(simulation_.numSteps);
+    scheduler_.SetTime(0.0);
     startPauseButton_->setText("Start");
     
     // Update UI
@@ -221,6 +371,8 @@ void MainWindow::LoadSimulation(const QString& filePath)
     UpdateParticleCheckboxes();
     UpdateContainerInfo();
     UpdateControls();
+    ResetDensityRange();
+    StartStatistics();
 }
 
 void MainWindow::UpdateControls()
@@ -232,6 +384,10 @@ void MainWindow::UpdateControls()
     progressBar_->setValue(currentStep_);
     
     currentStepLabel_->setText(QString("Step: %1 / %2").arg(currentStep_ + 1).arg(totalSteps));
+    
+    if (statistics_ && currentStep_ < statistics_->numSteps) {
+        statisticsPlot_->SetCursorT(statistics_->time[currentStep_]);
+    }
 }
 
 void MainWindow::UpdateParticleCheckboxes()
@@ -323,48 +479,118 @@ void MainWindow::OnStartPause()
         startPauseButton_->setText("Start");
         isPlaying_ = false;
     } else {
-        animationTimer_->start(delaySpinBox_->value());
+        bool smooth = glWidget_->GetInterpolation() != GLWidget::Interpolation::None;
+        scheduler_.SetTime(currentStep_);
+        scheduler_.Reset();
+        playbackClock_.start();
+        animationTimer_->start(scheduler_.GetTimerInterval(smooth));
         startPauseButton_->setText("Pause");
         isPlaying_ = true;
     }
+    UpdatePlaybackStatus();
 }
 
 void MainWindow::OnRestart()
 {
     currentStep_ = 0;
-    refreshCounter_ = 0;
+    scheduler_.SetTime(0.0);
     glWidget_->SetCurrentStep(currentStep_);
     UpdateControls();
 }
 
 void MainWindow::OnTimerTick()
 {
-    refreshCounter_++;
+    if (simulation_.numSteps <= 1) return;
     
-    if (refreshCounter_ >= refreshEvery_) {
-        refreshCounter_ = 0;
-        currentStep_++;
-        
-        if (currentStep_ >= simulation_.numSteps) {
-            currentStep_ = 0;  // Loop
-        }
-        
-        glWidget_->SetCurrentStep(currentStep_);
+    bool smooth = glWidget_->GetInterpolation() != GLWidget::Interpolation::None;
+    double time = scheduler_.Advance(playbackClock_.restart());
+    int step = scheduler_.GetStep();
+    
+    // Without interpolation a tick inside the step on screen repeats it without a repaint
+    if (smooth) {
+        glWidget_->SetPlaybackTime(time);
+    } else if (step != currentStep_) {
+        glWidget_->SetCurrentStep(step);
+    }
+    if (step != currentStep_) {
+        currentStep_ = step;
         UpdateControls();
     }
+    
+    // Follow the frame cost so ticks don't pile up behind slow frames
+    int interval = scheduler_.GetTimerInterval(smooth);
+    if (interval != animationTimer_->interval()) {
+        animationTimer_->setInterval(interval);
+    }
+    if (scheduler_.UpdateStatistics()) {
+        UpdatePlaybackStatus();
+    }
+}
+
+void MainWindow::OnRateChanged(double value)
+{
+    scheduler_.SetRate(value);
+    if (isPlaying_) {
+        animationTimer_->setInterval(scheduler_.GetTimerInterval(glWidget_->GetInterpolation() != GLWidget::Interpolation::None));
+    }
+    UpdatePlaybackStatus();
 }
 
-void MainWindow::OnDelayChanged(int value)
+void MainWindow::OnFrameDrawn(double milliseconds)
 {
     if (isPlaying_) {
-        animationTimer_->setInterval(value);
+        scheduler_.RecordFrame(milliseconds);
+    }
+}
+
+void MainWindow::OnInterpolationChanged(int index)
+{
+    auto interpolation = static_cast<GLWidget::Interpolation>(index);
+    glWidget_->SetInterpolation(interpolation);
+    
+    // Continue from the step on screen, on the timer the new mode needs
+    scheduler_.SetTime(currentStep_);
+    glWidget_->SetCurrentStep(currentStep_);
+    if (isPlaying_) {
+        playbackClock_.start();
+        animationTimer_->setInterval(scheduler_.GetTimerInterval(interpolation != GLWidget::Interpolation::None));
     }
 }
 
-void MainWindow::OnRefreshEveryChanged(int value)
+void MainWindow::UpdatePlaybackStatus()
 {
-    refreshEvery_ = value;
-    refreshCounter_ = 0;
+    QString requested = QString::number(scheduler_.GetRate(), 'f', 1);
+    if (!isPlaying_ || scheduler_.GetFrameRate() <= 0.0) {
+        playbackStatusLabel_->setText(QString("Playback: %1 steps/s requested").arg(requested));
+        return;
+    }
+    
+    // More than one step per frame means steps are being skipped
+    double stepsPerFrame = scheduler_.GetAchievedRate() / scheduler_.GetFrameRate();
+    QString text = QString("Playback: %1 / %2 steps/s, %3 fps, %4 ms/frame")
+                       .arg(scheduler_.GetAchievedRate(), 0, 'f', 1)
+                       .arg(requested)
+                       .arg(scheduler_.GetFrameRate(), 0, 'f', 0)
+                       .arg(scheduler_.GetFrameCost(), 0, 'f', 1);
+    if (stepsPerFrame > 1.05) {
+        text += QString(" (skipping, %1 steps/frame)").arg(stepsPerFrame, 0, 'f', 1);
+    }
+    playbackStatusLabel_->setText(text);
+}
+
+void MainWindow::OnShowTrailsChanged(bool checked)
+{
+    glWidget_->SetShowTrails(checked);
+}
+
+void MainWindow::OnTrailLengthChanged(int value)
+{
+    glWidget_->SetTrailLength(value);
+}
+
+void MainWindow::OnGpuResidentChanged(bool checked)
+{
+    glWidget_->SetGpuResident(checked);
 }
 
 void MainWindow::OnDisplayModeChanged()
@@ -378,6 +604,209 @@ void MainWindow::OnDisplayModeChanged()
     }
 }
 
+void MainWindow::OnSphereModeChanged(int index)
+{
+    glWidget_->SetSphereMode(static_cast<GLWidget::SphereMode>(index));
+}
+
+void MainWindow::OnHighlightProximityChanged(bool checked)
+{
+    glWidget_->SetHighlightProximity(checked);
+}
+
+void MainWindow::OnProximityGapChanged(double value)
+{
+    glWidget_->SetProximityGap(value);
+}
+
+void MainWindow::OnParticleSelected(int index)
+{
+    Q_UNUSED(index);
+    UpdateProximityInfo();
+}
+
+void MainWindow::OnProximityUpdated()
+{
+    UpdateProximityInfo();
+}
+
+void MainWindow::UpdateProximityInfo()
+{
+    if (!highlightProximityCheckBox_->isChecked()) {
+        closePairsLabel_->setText("-");
+    } else if (glWidget_->GetProximityStep() < 0) {
+        closePairsLabel_->setText("...");
+    } else {
+        QString pairs = QString::number(glWidget_->GetNumClosePairs());
+        closePairsLabel_->setText(glWidget_->AreClosePairsTruncated() ? pairs + "+ (first shown)" : pairs);
+    }
+    
+    int index = glWidget_->GetSelectedParticle();
+    const auto& particles = glWidget_->GetSimulation().particles;
+    if (index < 0 || index >= static_cast<int>(particles.size())) {
+        selectedParticleLabel_->setText("Click a particle to select it");
+        return;
+    }
+    
+    // Position and neighbours at the step the grid was built for
+    const auto& particle = particles[index];
+    QString name = particle.name.empty() ? QString("Particle %1").arg(index + 1) : QString::fromStdString(particle.name);
+    QString text = QString("%1 (#%2)\nRadius: %3").arg(name).arg(index).arg(particle.size, 0, 'g', 4);
+    int step = glWidget_->GetProximityStep();
+    int neighbours = glWidget_->CountSelectedNeighbours();
+    if (step >= 0 && neighbours >= 0) {
+        const auto& pos = particle.trajectory[step];
+        text += QString("\nPosition: (%1, %2, %3)\nWithin gap: %4")
+                    .arg(pos.x, 0, 'g', 5).arg(pos.y, 0, 'g', 5).arg(pos.z, 0, 'g', 5)
+                    .arg(neighbours);
+    }
+    selectedParticleLabel_->setText(text);
+}
+
+void MainWindow::StartStatistics()
+{
+    statistics_.reset();
+    statisticsPlot_->Clear();
+    saveStatisticsButton_->setEnabled(false);
+    if (simulation_.particles.empty() || simulation_.numSteps <= 0) {
+        statisticsStatusLabel_->setText("-");
+        return;
+    }
+    
+    statisticsStatusLabel_->setText("Computing...");
+    statisticsCancel_ = false;
+    statisticsWatcher_->setFuture(QtConcurrent::run([this]() {
+        return StepStatisticsBuilder::Build(simulation_, &statisticsCancel_);
+    }));
+}
+
+void MainWindow::CancelStatistics()
+{
+    statisticsCancel_ = true;
+    statisticsWatcher_->waitForFinished();
+}
+
+void MainWindow::OnStatisticsFinished()
+{
+    // A build cancelled by a later load finishes without a result
+    if (!statisticsWatcher_->isFinished()) return;
+    std::shared_ptr<StepStatistics> statistics = statisticsWatcher_->result();
+    if (!statistics) return;
+    
+    statistics_ = statistics;
+    statisticsStatusLabel_->setText(QString("%1 steps in %2 s")
+                                        .arg(statistics_->numSteps)
+                                        .arg(statistics_->seconds, 0, 'f', 2));
+    saveStatisticsButton_->setEnabled(statistics_->numSteps > 0);
+    UpdateStatisticsPlot();
+    UpdateControls();
+}
+
+void MainWindow::UpdateStatisticsPlot()
+{
+    statisticsPlot_->Clear();
+    if (!statistics_ || statistics_->numSteps <= 0) return;
+    
+    auto kind = static_cast<StatisticKind>(statisticKindCombo_->currentIndex());
+    statisticsPlot_->SetTitle(QString::fromStdString(simulation_.title.empty() ? "" : simulation_.title + " - ")
+                              + StepStatistics::GetKindName(kind));
+    statisticsPlot_->SetTime(statistics_->time);
+    
+    // Series naming the same panel share its axes
+    std::map<std::string, int> panels;
+    for (const auto& series : statistics_->GetSeries(kind)) {
+        auto found = panels.find(series.panel);
+        if (found == panels.end()) {
+            found = panels.emplace(series.panel, statisticsPlot_->AddPanel(QString::fromStdString(series.panel))).first;
+        }
+        QColor color = QColor::fromRgbF(series.color.r, series.color.g, series.color.b);
+        statisticsPlot_->AddSeries(found->second, QString::fromStdString(series.name), color, series.values);
+    }
+    if (kind == StatisticKind::Speed && !panels.empty()) {
+        statisticsPlot_->SetDensity(panels.begin()->second, statistics_->speedDistribution,
+                                    StepStatistics::SPEED_BINS, statistics_->speedBinWidth);
+    }
+    if (currentStep_ < statistics_->numSteps) {
+        statisticsPlot_->SetCursorT(statistics_->time[currentStep_]);
+    }
+}
+
+void MainWindow::OnStatisticKindChanged(int index)
+{
+    Q_UNUSED(index);
+    UpdateStatisticsPlot();
+}
+
+void MainWindow::OnShowStatisticsChanged(bool checked)
+{
+    statisticsPlot_->setVisible(checked);
+}
+
+void MainWindow::OnSaveStatistics()
+{
+    if (!statistics_) return;
+    
+    auto kind = static_cast<StatisticKind>(statisticKindCombo_->currentIndex());
+    QString filePath = QFileDialog::getSaveFileName(
+        this,
+        "Save Statistics",
+        QString(),
+        "Data Files (*.txt);;All Files (*)");
+    if (filePath.isEmpty()) return;
+    
+    std::string title = (simulation_.title.empty() ? std::string("Simulation") : simulation_.title)
+                        + " - " + StepStatistics::GetKindName(kind);
+    if (!statistics_->SaveMultiRealFunction(filePath.toStdString(), title, statistics_->GetSeries(kind))) {
+        QMessageBox::critical(this, "Error", "Failed to save statistics file:\n" + filePath);
+    }
+}
+
+void MainWindow::ResetDensityRange()
+{
+    // The whole run
+    int last = std::max(simulation_.numSteps - 1, 0);
+    for (QSlider* slider : { densityFirstSlider_, densityLastSlider_ }) {
+        slider->blockSignals(true);
+        slider->setRange(0, last);
+    }
+    densityFirstSlider_->setValue(0);
+    densityLastSlider_->setValue(last);
+    densityFirstSlider_->blockSignals(false);
+    densityLastSlider_->blockSignals(false);
+    OnDensityRangeChanged();
+}
+
+void MainWindow::OnShowDensityChanged(bool checked)
+{
+    glWidget_->SetShowDensity(checked);
+}
+
+void MainWindow::OnDensityPlaneChanged(int index)
+{
+    glWidget_->SetDensityPlane(static_cast<GLWidget::DensityPlane>(index));
+}
+
+void MainWindow::OnDensityRangeChanged()
+{
+    // Dragging one end past the other pushes it along
+    int first = densityFirstSlider_->value();
+    int last = densityLastSlider_->value();
+    if (first > last) {
+        QSlider* other = sender() == densityLastSlider_ ? densityFirstSlider_ : densityLastSlider_;
+        other->blockSignals(true);
+        other->setValue(other == densityFirstSlider_ ? last : first);
+        other->blockSignals(false);
+        first = densityFirstSlider_->value();
+        last = densityLastSlider_->value();
+    }
+    glWidget_->SetDensityRange(first, last);
+    if (simulation_.numSteps > 0) {
+        densityRangeLabel_->setText(QString("%1 - %2 (%3)").arg(first + 1).arg(last + 1).arg(last - first + 1));
+    } else {
+        densityRangeLabel_->setText("-");
+    }
+}
+
 void MainWindow::OnLookAtCenter()
 {
     glWidget_->LookAtCenter();
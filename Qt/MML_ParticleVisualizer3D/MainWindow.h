@@ -3,20 +3,29 @@
 
 #include <QMainWindow>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QPushButton>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QLabel>
 #include <QSlider>
 #include <QProgressBar>
 #include <QRadioButton>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QLineEdit>
 #include <QGroupBox>
 #include <QScrollArea>
 #include <QFileDialog>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include "GLWidget.h"
 #include "MMLData.h"
+#include "PlaybackScheduler.h"
+#include "StepStatistics.h"
+#include "StatisticsPlotWidget.h"
 
 class MainWindow : public QMainWindow
 {
@@ -33,9 +42,25 @@ private slots:
     void OnStartPause();
     void OnRestart();
     void OnTimerTick();
-    void OnDelayChanged(int value);
-    void OnRefreshEveryChanged(int value);
+    void OnRateChanged(double value);
+    void OnFrameDrawn(double milliseconds);
+    void OnInterpolationChanged(int index);
+    void OnShowTrailsChanged(bool checked);
+    void OnTrailLengthChanged(int value);
+    void OnGpuResidentChanged(bool checked);
     void OnDisplayModeChanged();
+    void OnSphereModeChanged(int index);
+    void OnHighlightProximityChanged(bool checked);
+    void OnProximityGapChanged(double value);
+    void OnParticleSelected(int index);
+    void OnProximityUpdated();
+    void OnStatisticsFinished();
+    void OnStatisticKindChanged(int index);
+    void OnShowStatisticsChanged(bool checked);
+    void OnSaveStatistics();
+    void OnShowDensityChanged(bool checked);
+    void OnDensityPlaneChanged(int index);
+    void OnDensityRangeChanged();
     void OnLookAtCenter();
     void OnResetCamera();
     void OnTitleChanged();
@@ -46,9 +71,16 @@ private:
     void UpdateControls();
     void UpdateParticleCheckboxes();
     void UpdateContainerInfo();
+    void UpdatePlaybackStatus();
+    void UpdateProximityInfo();
+    void StartStatistics();
+    void CancelStatistics();
+    void UpdateStatisticsPlot();
+    void ResetDensityRange();
     
-    // Central widget
+    // Central widget, with the statistics pane below it
     GLWidget* glWidget_;
+    StatisticsPlotWidget* statisticsPlot_;
     
     // Sidebar panels
     QLineEdit* titleEdit_;
@@ -64,8 +96,11 @@ private:
     
     // Animation settings
     QLabel* totalStepsLabel_;
-    QSpinBox* delaySpinBox_;
-    QSpinBox* refreshEverySpinBox_;
+    QDoubleSpinBox* rateSpinBox_;
+    QComboBox* interpolationCombo_;
+    QCheckBox* showTrailsCheckBox_;
+    QSpinBox* trailLengthSpinBox_;
+    QCheckBox* gpuResidentCheckBox_;
     
     // Camera controls
     QPushButton* lookAtCenterButton_;
@@ -75,6 +110,26 @@ private:
     QRadioButton* displayNoneRadio_;
     QRadioButton* displayBoundingBoxRadio_;
     QRadioButton* displayCoordinatePlanesRadio_;
+    QComboBox* sphereModeCombo_;
+    
+    // Proximity: selected particle and close pairs
+    QCheckBox* highlightProximityCheckBox_;
+    QDoubleSpinBox* proximityGapSpinBox_;
+    QLabel* selectedParticleLabel_;
+    QLabel* closePairsLabel_;
+    
+    // Per-step statistics of the whole run
+    QComboBox* statisticKindCombo_;
+    QCheckBox* showStatisticsCheckBox_;
+    QPushButton* saveStatisticsButton_;
+    QLabel* statisticsStatusLabel_;
+    
+    // Density of particle centers over a range of steps
+    QCheckBox* showDensityCheckBox_;
+    QComboBox* densityPlaneCombo_;
+    QSlider* densityFirstSlider_;
+    QSlider* densityLastSlider_;
+    QLabel* densityRangeLabel_;
     
     // Particles panel
     QGroupBox* particlesGroupBox_;
@@ -91,10 +146,20 @@ private:
     QTimer* animationTimer_;
     bool isPlaying_;
     int currentStep_;
-    int refreshCounter_;
-    int refreshEvery_;
+    
+    // Playback advances a continuous time (in steps) by the wall-clock time since
+    // the last tick, skipping or repeating steps to hold the requested rate
+    PlaybackScheduler scheduler_;
+    QElapsedTimer playbackClock_;
+    QLabel* playbackStatusLabel_;
     
     LoadedParticleSimulation3D simulation_;
+    
+    // Built in the background after every load; the build reads simulation_, so it
+    // is cancelled and waited for before simulation_ changes
+    QFutureWatcher<std::shared_ptr<StepStatistics>>* statisticsWatcher_;
+    std::atomic<bool> statisticsCancel_;
+    std::shared_ptr<StepStatistics> statistics_;
 };
 
 #endif // MAINWINDOW_H
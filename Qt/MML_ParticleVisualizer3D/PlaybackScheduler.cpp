@@ -0,0 +1,64 @@
+#include "PlaybackScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+PlaybackScheduler::PlaybackScheduler()
+    : rate_(20.0)
+    , numSteps_(0)
+    , time_(0.0)
+    , frameCost_(0.0)
+    , windowMs_(0.0)
+    , windowSteps_(0.0)
+    , windowFrames_(0)
+    , achievedRate_(0.0)
+    , frameRate_(0.0)
+{
+}
+
+void PlaybackScheduler::SetRate(double stepsPerSecond) {
+    if (stepsPerSecond > 0.0) rate_ = stepsPerSecond;
+}
+
+void PlaybackScheduler::Reset() {
+    frameCost_ = 0.0;
+    windowMs_ = 0.0;
+    windowSteps_ = 0.0;
+    windowFrames_ = 0;
+    achievedRate_ = 0.0;
+    frameRate_ = 0.0;
+}
+
+double PlaybackScheduler::Advance(double elapsedMs) {
+    // A stall (dragging the window, a modal dialog) resumes instead of jumping ahead
+    elapsedMs = std::clamp(elapsedMs, 0.0, MAX_TICK_MS);
+    double steps = elapsedMs * rate_ / 1000.0;
+
+    windowMs_ += elapsedMs;
+    windowSteps_ += steps;
+    time_ += steps;
+    if (numSteps_ > 0 && time_ >= numSteps_) {
+        time_ = std::fmod(time_, static_cast<double>(numSteps_));
+    }
+    return time_;
+}
+
+void PlaybackScheduler::RecordFrame(double frameMs) {
+    frameCost_ = frameCost_ == 0.0 ? frameMs : 0.8 * frameCost_ + 0.2 * frameMs;
+    ++windowFrames_;
+}
+
+int PlaybackScheduler::GetTimerInterval(bool interpolated) const {
+    double interval = interpolated ? MIN_INTERVAL_MS : std::max<double>(MIN_INTERVAL_MS, 1000.0 / rate_);
+    return static_cast<int>(std::ceil(std::max(interval, frameCost_)));
+}
+
+bool PlaybackScheduler::UpdateStatistics() {
+    if (windowMs_ < STATS_WINDOW_MS) return false;
+
+    achievedRate_ = windowSteps_ * 1000.0 / windowMs_;
+    frameRate_ = windowFrames_ * 1000.0 / windowMs_;
+    windowMs_ = 0.0;
+    windowSteps_ = 0.0;
+    windowFrames_ = 0;
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef PLAYBACK_SCHEDULER_H
+#define PLAYBACK_SCHEDULER_H
+
+// Keeps playback at a requested rate in steps per second of wall time, however
+// long frames take. Every tick advances a continuous playback time by the wall
+// time since the previous one, so when rendering can't keep up whole steps are
+// skipped, and when it is faster than the rate the same step is shown again
+// (or interpolated). The timer interval follows the measured frame cost so ticks
+// don't queue up behind slow frames. Times are in milliseconds.
+class PlaybackScheduler {
+public:
+    PlaybackScheduler();
+
+    void SetRate(double stepsPerSecond);
+    double GetRate() const { return rate_; }
+
+    // Steps played before looping back to step 0
+    void SetNumSteps(int numSteps) { numSteps_ = numSteps; }
+    void SetTime(double time) { time_ = time; }
+    double GetTime() const { return time_; }
+    int GetStep() const { return static_cast<int>(time_); }
+
+    // Restarts the rate and frame statistics, e.g. when playback starts
+    void Reset();
+
+    // Advances by the wall time since the previous tick; returns the new time
+    double Advance(double elapsedMs);
+    // CPU cost of the frame last drawn
+    void RecordFrame(double frameMs);
+
+    // Timer interval that holds the rate: one tick per step when steps are slower
+    // than the display, else one per frame (interpolated playback always ticks per frame)
+    int GetTimerInterval(bool interpolated) const;
+
+    // Measured over the last STATS_WINDOW_MS; true when new values are available
+    bool UpdateStatistics();
+    double GetAchievedRate() const { return achievedRate_; }
+    double GetFrameRate() const { return frameRate_; }
+    double GetFrameCost() const { return frameCost_; }
+
+    static constexpr int MIN_INTERVAL_MS = 7;           // About 144 Hz
+    static constexpr double MAX_TICK_MS = 250.0;        // Longer stalls aren't caught up
+    static constexpr double STATS_WINDOW_MS = 500.0;
+
+private:
+    double rate_;
+    int numSteps_;
+    double time_;
+    double frameCost_;          // Exponential moving average
+
+    // Statistics window
+    double windowMs_;
+    double windowSteps_;
+    int windowFrames_;
+    double achievedRate_;
+    double frameRate_;
+};
+
+#endif // PLAYBACK_SCHEDULER_H
@@ -0,0 +1,257 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// Runs fn(chunk) for every chunk, handing chunks out to worker threads
+template<typename Fn>
+void RunChunks(size_t numChunks, Fn fn) {
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t c = next++; c < numChunks; c = next++) fn(c);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+// Nearest t >= 0 where the ray (unit direction) meets the sphere; -1 for a miss
+float RayHit(const float* origin, const float* direction, const float* center, float radius) {
+    float oc[3] = { center[0] - origin[0], center[1] - origin[1], center[2] - origin[2] };
+    float along = oc[0] * direction[0] + oc[1] * direction[1] + oc[2] * direction[2];
+    float disc = radius * radius - (oc[0] * oc[0] + oc[1] * oc[1] + oc[2] * oc[2] - along * along);
+    if (disc < 0.0f) return -1.0f;
+    float root = std::sqrt(disc);
+    if (along - root >= 0.0f) return along - root;
+    return along + root >= 0.0f ? 0.0f : -1.0f;    // Origin inside the sphere
+}
+
+float Distance(const float* a, const float* b) {
+    float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace
+
+void SpatialGrid::Build(std::vector<float> xyz, std::vector<float> radii) {
+    xyz_ = std::move(xyz);
+    radii_ = std::move(radii);
+    cellStart_.clear();
+    cellObjects_.clear();
+    maxRadius_ = 0.0f;
+    dims_[0] = dims_[1] = dims_[2] = 0;
+
+    size_t n = radii_.size();
+    size_t count = 0;
+    float lo[3], hi[3];
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = std::numeric_limits<float>::max();
+        hi[a] = -std::numeric_limits<float>::max();
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (radii_[i] < 0.0f) continue;
+        ++count;
+        maxRadius_ = std::max(maxRadius_, radii_[i]);
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], xyz_[3 * i + a]);
+            hi[a] = std::max(hi[a], xyz_[3 * i + a]);
+        }
+    }
+    if (count == 0) return;
+
+    // About one sphere per cell, never narrower than a sphere; flat or clustered
+    // runs widen the cells until there are at most twice as many cells as spheres
+    float extent[3];
+    double volume = 1.0;
+    for (int a = 0; a < 3; ++a) {
+        extent[a] = hi[a] - lo[a];
+        volume *= std::max(extent[a], 1e-6f);
+    }
+    float size = std::max({ 2.0f * maxRadius_, static_cast<float>(std::cbrt(volume / count)), 1e-6f });
+    double maxCells = std::max<double>(2.0 * count, 64.0);
+    auto numCells = [&](float h) {
+        double cells = 1.0;
+        for (int a = 0; a < 3; ++a) cells *= std::floor(extent[a] / h) + 1.0;
+        return cells;
+    };
+    while (numCells(size) > maxCells) size *= 1.25f;
+
+    cellSize_ = size;
+    for (int a = 0; a < 3; ++a) {
+        origin_[a] = lo[a];
+        dims_[a] = static_cast<int>(extent[a] / size) + 1;
+    }
+
+    // Counting sort of the objects by cell
+    size_t cells = static_cast<size_t>(dims_[0]) * dims_[1] * dims_[2];
+    std::vector<uint32_t> objectCell(n);
+    cellStart_.assign(cells + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (radii_[i] < 0.0f) continue;
+        const float* p = &xyz_[3 * i];
+        objectCell[i] = static_cast<uint32_t>(CellIndex(CellOf(p[0], 0), CellOf(p[1], 1), CellOf(p[2], 2)));
+        ++cellStart_[objectCell[i] + 1];
+    }
+    for (size_t c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+
+    cellObjects_.resize(count);
+    std::vector<uint32_t> cursor(cellStart_.begin(), cellStart_.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        if (radii_[i] < 0.0f) continue;
+        cellObjects_[cursor[objectCell[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+int SpatialGrid::CellOf(float v, int axis) const {
+    int cell = static_cast<int>(std::floor((v - origin_[axis]) / cellSize_));
+    return std::clamp(cell, 0, dims_[axis] - 1);
+}
+
+template<typename Fn>
+void SpatialGrid::ForEachNear(const float* p, float reach, Fn fn) const {
+    int first[3], last[3];
+    for (int a = 0; a < 3; ++a) {
+        first[a] = CellOf(p[a] - reach, a);
+        last[a] = CellOf(p[a] + reach, a);
+    }
+    for (int z = first[2]; z <= last[2]; ++z) {
+        for (int y = first[1]; y <= last[1]; ++y) {
+            for (int x = first[0]; x <= last[0]; ++x) {
+                size_t cell = CellIndex(x, y, z);
+                for (uint32_t k = cellStart_[cell]; k < cellStart_[cell + 1]; ++k) fn(cellObjects_[k]);
+            }
+        }
+    }
+}
+
+int SpatialGrid::Pick(const float origin[3], const float direction[3]) const {
+    if (IsEmpty()) return -1;
+
+    float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (length <= 0.0f) return -1;
+    float dir[3] = { direction[0] / length, direction[1] / length, direction[2] / length };
+
+    // Walk the grid grown by one cell on every side, since a sphere's surface can be
+    // one cell away from the cell of its center
+    float h = cellSize_;
+    float tEnter = 0.0f;
+    float tExit = std::numeric_limits<float>::max();
+    for (int a = 0; a < 3; ++a) {
+        float lo = origin_[a] - h;
+        float hi = origin_[a] + (dims_[a] + 1) * h;
+        if (dir[a] == 0.0f) {
+            if (origin[a] < lo || origin[a] > hi) return -1;
+            continue;
+        }
+        float t0 = (lo - origin[a]) / dir[a];
+        float t1 = (hi - origin[a]) / dir[a];
+        if (t0 > t1) std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+    }
+    if (tEnter > tExit) return -1;
+
+    // Cells from -1 to dims, stepped through in the order the ray crosses them
+    int cell[3], step[3];
+    float tNext[3], tDelta[3];
+    for (int a = 0; a < 3; ++a) {
+        float p = origin[a] + dir[a] * tEnter;
+        cell[a] = std::clamp(static_cast<int>(std::floor((p - origin_[a]) / h)), -1, dims_[a]);
+        if (dir[a] > 0.0f) {
+            step[a] = 1;
+            tNext[a] = (origin_[a] + (cell[a] + 1) * h - origin[a]) / dir[a];
+            tDelta[a] = h / dir[a];
+        } else if (dir[a] < 0.0f) {
+            step[a] = -1;
+            tNext[a] = (origin_[a] + cell[a] * h - origin[a]) / dir[a];
+            tDelta[a] = -h / dir[a];
+        } else {
+            step[a] = 0;
+            tNext[a] = std::numeric_limits<float>::max();
+            tDelta[a] = std::numeric_limits<float>::max();
+        }
+    }
+
+    int best = -1;
+    float bestT = std::numeric_limits<float>::max();
+    float tCell = tEnter;
+    while (tCell <= tExit && tCell <= bestT) {
+        // Spheres centered in this cell or next to it
+        for (int z = std::max(cell[2] - 1, 0); z <= std::min(cell[2] + 1, dims_[2] - 1); ++z) {
+            for (int y = std::max(cell[1] - 1, 0); y <= std::min(cell[1] + 1, dims_[1] - 1); ++y) {
+                for (int x = std::max(cell[0] - 1, 0); x <= std::min(cell[0] + 1, dims_[0] - 1); ++x) {
+                    size_t c = CellIndex(x, y, z);
+                    for (uint32_t k = cellStart_[c]; k < cellStart_[c + 1]; ++k) {
+                        uint32_t j = cellObjects_[k];
+                        float t = RayHit(origin, dir, &xyz_[3 * j], radii_[j]);
+                        if (t >= 0.0f && t < bestT) {
+                            bestT = t;
+                            best = static_cast<int>(j);
+                        }
+                    }
+                }
+            }
+        }
+
+        int a = tNext[0] < tNext[1] ? (tNext[0] < tNext[2] ? 0 : 2) : (tNext[1] < tNext[2] ? 1 : 2);
+        tCell = tNext[a];
+        tNext[a] += tDelta[a];
+        cell[a] += step[a];
+        if (cell[a] < -1 || cell[a] > dims_[a]) break;
+    }
+    return best;
+}
+
+size_t SpatialGrid::CountNeighbours(size_t i, float gap) const {
+    if (i >= radii_.size() || radii_[i] < 0.0f || IsEmpty()) return 0;
+
+    const float* p = &xyz_[3 * i];
+    size_t count = 0;
+    ForEachNear(p, radii_[i] + gap + maxRadius_, [&](uint32_t j) {
+        if (j != i && Distance(p, &xyz_[3 * j]) - radii_[i] - radii_[j] < gap) ++count;
+    });
+    return count;
+}
+
+std::vector<uint32_t> SpatialGrid::ClosePairs(float gap, size_t maxPairs) const {
+    if (IsEmpty()) return {};
+
+    size_t cells = cellStart_.size() - 1;
+    size_t numChunks = (cells + CHUNK_CELLS - 1) / CHUNK_CELLS;
+    std::vector<std::vector<uint32_t>> chunkPairs(numChunks);
+    std::atomic<size_t> found{0};
+
+    RunChunks(numChunks, [&](size_t c) {
+        auto& pairs = chunkPairs[c];
+        size_t end = std::min((c + 1) * CHUNK_CELLS, cells);
+        for (size_t cell = c * CHUNK_CELLS; cell < end && found < maxPairs; ++cell) {
+            for (uint32_t k = cellStart_[cell]; k < cellStart_[cell + 1]; ++k) {
+                uint32_t i = cellObjects_[k];
+                const float* p = &xyz_[3 * i];
+                size_t before = pairs.size();
+                ForEachNear(p, radii_[i] + gap + maxRadius_, [&](uint32_t j) {
+                    if (j > i && Distance(p, &xyz_[3 * j]) - radii_[i] - radii_[j] < gap) {
+                        pairs.push_back(i);
+                        pairs.push_back(j);
+                    }
+                });
+                found += (pairs.size() - before) / 2;
+            }
+        }
+    });
+
+    std::vector<uint32_t> result;
+    for (const auto& pairs : chunkPairs) {
+        result.insert(result.end(), pairs.begin(), pairs.end());
+        if (result.size() >= 2 * maxPairs) break;
+    }
+    result.resize(std::min(result.size(), 2 * maxPairs));
+    return result;
+}
@@ -0,0 +1,54 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Uniform grid over the spheres of one step, stored as a cell list: objects sorted
+// by cell, with each cell's first object in cellStart_. Cells are at least as wide
+// as the largest sphere, so a sphere only reaches into the cells next to its own,
+// and there are about as many cells as spheres, so every query below only looks
+// at a few objects per cell. Built once per step (off the GUI thread) in O(N);
+// the queries are read-only and thread-safe.
+class SpatialGrid {
+public:
+    static constexpr size_t CHUNK_CELLS = 4096;
+
+    // xyz centers and radii of n spheres; a negative radius leaves one out
+    void Build(std::vector<float> xyz, std::vector<float> radii);
+    size_t GetNumObjects() const { return radii_.size(); }
+    bool IsEmpty() const { return cellObjects_.empty(); }
+
+    // Nearest sphere hit by the ray origin + t * direction, t >= 0; -1 when none.
+    // Walks the cells along the ray front to back and stops behind the first hit.
+    int Pick(const float origin[3], const float direction[3]) const;
+
+    // Spheres whose surface is closer than gap to sphere i's, not counting i
+    size_t CountNeighbours(size_t i, float gap) const;
+
+    // Pairs (i, j), i < j, whose surfaces are closer than gap, flattened; gap 0 finds
+    // the overlapping ones. Cells are split across worker threads; at most maxPairs
+    // pairs are returned.
+    std::vector<uint32_t> ClosePairs(float gap, size_t maxPairs) const;
+
+private:
+    // Calls fn(j) for every object whose cell is within reach of point p
+    template<typename Fn>
+    void ForEachNear(const float* p, float reach, Fn fn) const;
+    int CellOf(float v, int axis) const;
+    size_t CellIndex(int x, int y, int z) const {
+        return (static_cast<size_t>(z) * dims_[1] + y) * dims_[0] + x;
+    }
+
+    std::vector<float> xyz_;
+    std::vector<float> radii_;
+    float origin_[3] = { 0.0f, 0.0f, 0.0f };
+    float cellSize_ = 1.0f;
+    int dims_[3] = { 0, 0, 0 };
+    float maxRadius_ = 0.0f;
+    std::vector<uint32_t> cellStart_;       // Cells + 1 entries
+    std::vector<uint32_t> cellObjects_;     // Object indices, cell-major
+};
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,500 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "SphereRenderer.h"
+#include <QOpenGLContext>
+#include <GL/gl.h>
+#include <algorithm>
+#include <cstddef>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// Attribute locations shared by the shader and the buffer setup
+constexpr GLuint ATTR_VERTEX = 0;
+constexpr GLuint ATTR_INSTANCE_CENTER = 1;
+constexpr GLuint ATTR_INSTANCE_RADIUS = 2;
+constexpr GLuint ATTR_INSTANCE_COLOR = 3;
+constexpr GLuint ATTR_INSTANCE_PREV = 4;
+constexpr GLuint ATTR_INSTANCE_NEXT = 5;
+constexpr GLuint ATTR_INSTANCE_NEXT2 = 6;
+// Impostor quad corners take the mesh's place; compatibility contexts only draw
+// when attribute 0 is an enabled array
+constexpr GLuint ATTR_CORNER = 0;
+
+// Scales and moves the unit sphere to each instance; Gouraud lighting from one
+// directional light, as the fixed-function pipeline does it
+const char* VERTEX_SHADER = R"(
+#version 120
+attribute vec3 vertex;          // Unit sphere point, also its normal
+attribute vec3 instancePrev;    // Centers at steps k-1, k, k+1 and k+2, blended by
+attribute vec3 instanceCenter;  // stepWeights; unused ones have zero weight
+attribute vec3 instanceNext;
+attribute vec3 instanceNext2;
+attribute float instanceRadius; // 0 hides the sphere
+attribute vec4 instanceColor;
+uniform vec4 stepWeights;
+uniform mat4 matrix;
+uniform vec3 lightDirection;    // World space, towards the light
+uniform float ambient;
+uniform float diffuse;
+varying vec4 color;
+
+void main() {
+    float light = ambient + diffuse * max(dot(vertex, lightDirection), 0.0);
+    color = vec4(min(instanceColor.rgb * light, vec3(1.0)), instanceColor.a);
+    vec3 position = stepWeights.x * instancePrev + stepWeights.y * instanceCenter +
+                    stepWeights.z * instanceNext + stepWeights.w * instanceNext2;
+    gl_Position = matrix * vec4(position + vertex * instanceRadius, 1.0);
+}
+)";
+
+const char* FRAGMENT_SHADER = R"(
+#version 120
+varying vec4 color;
+
+void main() {
+    gl_FragColor = color;
+}
+)";
+
+// Square perpendicular to the line of sight through the sphere's center, just large
+// enough to hold the cone of rays that touch the sphere, so it covers the silhouette
+// exactly under perspective. Collapses when the eye is inside the sphere.
+const char* IMPOSTOR_VERTEX_SHADER = R"(
+#version 120
+attribute vec2 corner;          // -1/+1 in both directions
+attribute vec3 instancePrev;    // Centers at steps k-1, k, k+1 and k+2, blended by
+attribute vec3 instanceCenter;  // stepWeights; unused ones have zero weight
+attribute vec3 instanceNext;
+attribute vec3 instanceNext2;
+attribute float instanceRadius; // 0 hides the sphere
+attribute vec4 instanceColor;
+uniform vec4 stepWeights;
+uniform mat4 view;
+uniform mat4 projection;
+varying vec3 rayPoint;          // Eye space point on the quad; its ray starts at the eye
+varying vec3 center;            // Eye space
+varying float radius;
+varying vec4 color;
+
+void main() {
+    vec3 position = stepWeights.x * instancePrev + stepWeights.y * instanceCenter +
+                    stepWeights.z * instanceNext + stepWeights.w * instanceNext2;
+    center = (view * vec4(position, 1.0)).xyz;
+    radius = instanceRadius;
+    color = instanceColor;
+
+    float dist = length(center);
+    vec3 axis = center / max(dist, 1e-30);
+    vec3 helper = abs(axis.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 u = normalize(cross(axis, helper));
+    vec3 v = cross(u, axis);
+    float size = dist > radius ? radius * dist / sqrt(dist * dist - radius * radius) : 0.0;
+
+    rayPoint = center + (corner.x * u + corner.y * v) * size;
+    gl_Position = projection * vec4(rayPoint, 1.0);
+}
+)";
+
+// Nearest ray/sphere hit, lit per pixel, with its true depth
+const char* IMPOSTOR_FRAGMENT_SHADER = R"(
+#version 120
+uniform mat4 projection;
+uniform vec3 lightDirection;    // Eye space, towards the light
+uniform float ambient;
+uniform float diffuse;
+varying vec3 rayPoint;
+varying vec3 center;
+varying float radius;
+varying vec4 color;
+
+void main() {
+    vec3 dir = normalize(rayPoint);
+    float along = dot(dir, center);
+    vec3 offset = center - along * dir;     // Center to the ray's closest point; stable far away
+    float disc = radius * radius - dot(offset, offset);
+    if (disc < 0.0) discard;
+
+    vec3 hit = dir * (along - sqrt(disc));
+    vec3 normal = (hit - center) / radius;
+    float light = ambient + diffuse * max(dot(normal, lightDirection), 0.0);
+    gl_FragColor = vec4(min(color.rgb * light, vec3(1.0)), color.a);
+
+    vec4 clip = projection * vec4(hit, 1.0);
+    float ndcDepth = clip.z / clip.w;
+    gl_FragDepth = (gl_DepthRange.diff * ndcDepth + gl_DepthRange.near + gl_DepthRange.far) * 0.5;
+}
+)";
+
+} // namespace
+
+SphereRenderer::SphereRenderer()
+    : initialized_(false)
+    , cornerVbo_(0)
+    , meshVbo_(0)
+    , meshIbo_(0)
+    , numIndices_(0)
+    , instanceVbo_(0)
+    , numInstances_(0)
+    , runVbo_(0)
+    , runStyleVbo_(0)
+    , runObjects_(0)
+    , runSteps_(0)
+    , stepWeights_(0.0f, 1.0f, 0.0f, 0.0f)
+    , lightDirection_(0.0f, 0.0f, 1.0f)
+{
+}
+
+SphereRenderer::~SphereRenderer() {
+    // Buffers must be released by the owner via Cleanup() while its context is current
+}
+
+void SphereRenderer::Initialize(int slices, int stacks) {
+    initializeOpenGLFunctions();
+    Cleanup();
+
+    // Instanced attributes need OpenGL 3.3; older contexts draw the mesh once per sphere
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    bool instancing = context && !context->isOpenGLES() &&
+                      context->format().version() >= qMakePair(3, 3);
+    if (instancing) {
+        program_ = std::make_unique<QOpenGLShaderProgram>();
+        program_->addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+        program_->addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+        program_->bindAttributeLocation("vertex", ATTR_VERTEX);
+        program_->bindAttributeLocation("instanceCenter", ATTR_INSTANCE_CENTER);
+        program_->bindAttributeLocation("instancePrev", ATTR_INSTANCE_PREV);
+        program_->bindAttributeLocation("instanceNext", ATTR_INSTANCE_NEXT);
+        program_->bindAttributeLocation("instanceNext2", ATTR_INSTANCE_NEXT2);
+        program_->bindAttributeLocation("instanceRadius", ATTR_INSTANCE_RADIUS);
+        program_->bindAttributeLocation("instanceColor", ATTR_INSTANCE_COLOR);
+        if (!program_->link()) {
+            program_.reset();
+        }
+    }
+    if (program_) {
+        impostorProgram_ = std::make_unique<QOpenGLShaderProgram>();
+        impostorProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, IMPOSTOR_VERTEX_SHADER);
+        impostorProgram_->addShaderFromSourceCode(QOpenGLShader::Fragment, IMPOSTOR_FRAGMENT_SHADER);
+        impostorProgram_->bindAttributeLocation("instanceCenter", ATTR_INSTANCE_CENTER);
+        impostorProgram_->bindAttributeLocation("instancePrev", ATTR_INSTANCE_PREV);
+        impostorProgram_->bindAttributeLocation("instanceNext", ATTR_INSTANCE_NEXT);
+        impostorProgram_->bindAttributeLocation("instanceNext2", ATTR_INSTANCE_NEXT2);
+        impostorProgram_->bindAttributeLocation("instanceRadius", ATTR_INSTANCE_RADIUS);
+        impostorProgram_->bindAttributeLocation("instanceColor", ATTR_INSTANCE_COLOR);
+        impostorProgram_->bindAttributeLocation("corner", ATTR_CORNER);
+        if (!impostorProgram_->link()) {
+            impostorProgram_.reset();
+        }
+    }
+
+    BuildMesh(slices, stacks);
+    if (program_) {
+        glGenBuffers(1, &instanceVbo_);
+    }
+    if (impostorProgram_) {
+        const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+        glGenBuffers(1, &cornerVbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, cornerVbo_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    initialized_ = true;
+}
+
+void SphereRenderer::Cleanup() {
+    if (cornerVbo_ != 0) {
+        glDeleteBuffers(1, &cornerVbo_);
+        cornerVbo_ = 0;
+    }
+    if (meshVbo_ != 0) {
+        glDeleteBuffers(1, &meshVbo_);
+        meshVbo_ = 0;
+    }
+    if (meshIbo_ != 0) {
+        glDeleteBuffers(1, &meshIbo_);
+        meshIbo_ = 0;
+    }
+    if (instanceVbo_ != 0) {
+        glDeleteBuffers(1, &instanceVbo_);
+        instanceVbo_ = 0;
+    }
+    ReleaseResidentRun();
+    program_.reset();
+    impostorProgram_.reset();
+    instances_.clear();
+    numIndices_ = 0;
+    numInstances_ = 0;
+    initialized_ = false;
+}
+
+void SphereRenderer::BuildMesh(int slices, int stacks) {
+    slices = std::max(3, slices);
+    stacks = std::max(2, stacks);
+
+    // Latitude rings from pole to pole; the seam column is repeated
+    std::vector<float> points;
+    points.reserve(static_cast<size_t>((stacks + 1) * (slices + 1) * 3));
+    for (int i = 0; i <= stacks; ++i) {
+        double lat = M_PI * (-0.5 + static_cast<double>(i) / stacks);
+        double z = std::sin(lat);
+        double zr = std::cos(lat);
+        for (int j = 0; j <= slices; ++j) {
+            double lng = 2.0 * M_PI * static_cast<double>(j) / slices;
+            points.push_back(static_cast<float>(std::cos(lng) * zr));
+            points.push_back(static_cast<float>(std::sin(lng) * zr));
+            points.push_back(static_cast<float>(z));
+        }
+    }
+
+    std::vector<GLushort> indices;
+    indices.reserve(static_cast<size_t>(stacks * slices * 6));
+    for (int i = 0; i < stacks; ++i) {
+        for (int j = 0; j < slices; ++j) {
+            GLushort a = static_cast<GLushort>(i * (slices + 1) + j);
+            GLushort b = static_cast<GLushort>(a + slices + 1);
+            indices.insert(indices.end(), { a, b, static_cast<GLushort>(a + 1),
+                                            static_cast<GLushort>(a + 1), b, static_cast<GLushort>(b + 1) });
+        }
+    }
+    numIndices_ = static_cast<GLsizei>(indices.size());
+
+    glGenBuffers(1, &meshVbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(points.size() * sizeof(float)), points.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenBuffers(1, &meshIbo_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIbo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLushort)),
+                 indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void SphereRenderer::SetMatrices(const QMatrix4x4& projection, const QMatrix4x4& view) {
+    projection_ = projection;
+    view_ = view;
+    matrix_ = projection * view;
+}
+
+void SphereRenderer::SetInstances(const std::vector<Instance>& instances) {
+    if (!initialized_) return;
+    numInstances_ = static_cast<GLsizei>(instances.size());
+
+    if (!program_) {
+        instances_ = instances;
+        return;
+    }
+
+    // Orphan the previous contents so the driver doesn't wait for earlier draws
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instances.size() * INSTANCE_BYTES), nullptr, GL_STREAM_DRAW);
+    if (!instances.empty()) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(instances.size() * INSTANCE_BYTES), instances.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SphereRenderer::Draw(Mode mode) {
+    if (!initialized_ || numInstances_ == 0) return;
+
+    if (!program_) {
+        for (const auto& s : instances_) {
+            glColor4ub(s.r, s.g, s.b, s.a);
+            DrawMeshFixedFunction(s.x, s.y, s.z, s.radius);
+        }
+        return;
+    }
+
+    InstanceLayout layout;
+    layout.centerVbo = instanceVbo_;
+    layout.centerStride = INSTANCE_BYTES;
+    layout.styleVbo = instanceVbo_;
+    layout.radiusOffset = offsetof(Instance, radius);
+    layout.colorOffset = offsetof(Instance, r);
+    layout.styleStride = INSTANCE_BYTES;
+    DrawInstanced(mode, layout, numInstances_);
+}
+
+bool SphereRenderer::CreateResidentRun(size_t numObjects, size_t numSteps) {
+    ReleaseResidentRun();
+    if (!program_ || numObjects == 0 || numSteps == 0) return false;
+
+    // Drain stale errors so an allocation failure can be told apart
+    while (glGetError() != GL_NO_ERROR) {}
+
+    glGenBuffers(1, &runVbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, runVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(numSteps * numObjects * POINT_BYTES), nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &runStyleVbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, runStyleVbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(numObjects * STYLE_BYTES), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        ReleaseResidentRun();
+        return false;
+    }
+    runObjects_ = static_cast<GLsizei>(numObjects);
+    runSteps_ = static_cast<GLsizei>(numSteps);
+    return true;
+}
+
+void SphereRenderer::UploadResidentSteps(size_t firstSlot, const float* xyz, size_t numSteps) {
+    if (runVbo_ == 0 || firstSlot >= static_cast<size_t>(runSteps_)) return;
+    numSteps = std::min(numSteps, static_cast<size_t>(runSteps_) - firstSlot);
+
+    size_t stepBytes = static_cast<size_t>(runObjects_) * POINT_BYTES;
+    glBindBuffer(GL_ARRAY_BUFFER, runVbo_);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(firstSlot * stepBytes),
+                    static_cast<GLsizeiptr>(numSteps * stepBytes), xyz);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SphereRenderer::SetResidentStyles(const std::vector<Style>& styles) {
+    if (runStyleVbo_ == 0) return;
+    size_t count = std::min(styles.size(), static_cast<size_t>(runObjects_));
+
+    glBindBuffer(GL_ARRAY_BUFFER, runStyleVbo_);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(count * STYLE_BYTES), styles.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SphereRenderer::ReleaseResidentRun() {
+    if (runVbo_ != 0) {
+        glDeleteBuffers(1, &runVbo_);
+        runVbo_ = 0;
+    }
+    if (runStyleVbo_ != 0) {
+        glDeleteBuffers(1, &runStyleVbo_);
+        runStyleVbo_ = 0;
+    }
+    runObjects_ = 0;
+    runSteps_ = 0;
+}
+
+void SphereRenderer::DrawResident(size_t slot, Mode mode) {
+    if (!initialized_ || runVbo_ == 0 || slot >= static_cast<size_t>(runSteps_)) return;
+
+    // The step is only where the center attributes start reading; neighbours past
+    // either end of the window repeat the end slot
+    size_t stepBytes = static_cast<size_t>(runObjects_) * POINT_BYTES;
+    size_t lastSlot = static_cast<size_t>(runSteps_) - 1;
+    InstanceLayout layout;
+    layout.centerVbo = runVbo_;
+    layout.centerOffset = static_cast<GLintptr>(slot * stepBytes);
+    layout.centerStride = POINT_BYTES;
+    layout.interpolated = stepWeights_ != QVector4D(0.0f, 1.0f, 0.0f, 0.0f);
+    layout.prevOffset = static_cast<GLintptr>((slot > 0 ? slot - 1 : 0) * stepBytes);
+    layout.nextOffset = static_cast<GLintptr>(std::min(slot + 1, lastSlot) * stepBytes);
+    layout.next2Offset = static_cast<GLintptr>(std::min(slot + 2, lastSlot) * stepBytes);
+    layout.weights = stepWeights_;
+    layout.styleVbo = runStyleVbo_;
+    layout.radiusOffset = offsetof(Style, radius);
+    layout.colorOffset = offsetof(Style, r);
+    layout.styleStride = STYLE_BYTES;
+    DrawInstanced(mode, layout, runObjects_);
+}
+
+void SphereRenderer::DrawInstanced(Mode mode, const InstanceLayout& layout, GLsizei count) {
+    bool impostors = mode == Mode::Impostor && impostorProgram_;
+    QOpenGLShaderProgram* program = impostors ? impostorProgram_.get() : program_.get();
+
+    program->bind();
+    program->setUniformValue("ambient", AMBIENT);
+    program->setUniformValue("diffuse", DIFFUSE);
+    if (impostors) {
+        program->setUniformValue("view", view_);
+        program->setUniformValue("projection", projection_);
+        program->setUniformValue("lightDirection", view_.mapVector(lightDirection_).normalized());
+        glBindBuffer(GL_ARRAY_BUFFER, cornerVbo_);
+        glEnableVertexAttribArray(ATTR_CORNER);
+        glVertexAttribPointer(ATTR_CORNER, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    } else {
+        program->setUniformValue("matrix", matrix_);
+        program->setUniformValue("lightDirection", lightDirection_);
+        glBindBuffer(GL_ARRAY_BUFFER, meshVbo_);
+        glEnableVertexAttribArray(ATTR_VERTEX);
+        glVertexAttribPointer(ATTR_VERTEX, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    }
+
+    // Per-instance center, radius and color, one step per sphere
+    glBindBuffer(GL_ARRAY_BUFFER, layout.centerVbo);
+    glEnableVertexAttribArray(ATTR_INSTANCE_CENTER);
+    glVertexAttribPointer(ATTR_INSTANCE_CENTER, 3, GL_FLOAT, GL_FALSE, layout.centerStride,
+                          reinterpret_cast<const void*>(layout.centerOffset));
+    glVertexAttribDivisor(ATTR_INSTANCE_CENTER, 1);
+    program->setUniformValue("stepWeights", layout.weights);
+    if (layout.interpolated) {
+        const GLuint neighbours[] = { ATTR_INSTANCE_PREV, ATTR_INSTANCE_NEXT, ATTR_INSTANCE_NEXT2 };
+        const GLintptr offsets[] = { layout.prevOffset, layout.nextOffset, layout.next2Offset };
+        for (int i = 0; i < 3; ++i) {
+            glEnableVertexAttribArray(neighbours[i]);
+            glVertexAttribPointer(neighbours[i], 3, GL_FLOAT, GL_FALSE, layout.centerStride,
+                                  reinterpret_cast<const void*>(offsets[i]));
+            glVertexAttribDivisor(neighbours[i], 1);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, layout.styleVbo);
+    glEnableVertexAttribArray(ATTR_INSTANCE_RADIUS);
+    glVertexAttribPointer(ATTR_INSTANCE_RADIUS, 1, GL_FLOAT, GL_FALSE, layout.styleStride,
+                          reinterpret_cast<const void*>(layout.radiusOffset));
+    glVertexAttribDivisor(ATTR_INSTANCE_RADIUS, 1);
+    glEnableVertexAttribArray(ATTR_INSTANCE_COLOR);
+    glVertexAttribPointer(ATTR_INSTANCE_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, layout.styleStride,
+                          reinterpret_cast<const void*>(layout.colorOffset));
+    glVertexAttribDivisor(ATTR_INSTANCE_COLOR, 1);
+
+    if (impostors) {
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+    } else {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIbo_);
+        glDrawElementsInstanced(GL_TRIANGLES, numIndices_, GL_UNSIGNED_SHORT, nullptr, count);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    for (GLuint location : { ATTR_INSTANCE_CENTER, ATTR_INSTANCE_RADIUS, ATTR_INSTANCE_COLOR }) {
+        glVertexAttribDivisor(location, 0);
+        glDisableVertexAttribArray(location);
+    }
+    if (layout.interpolated) {
+        for (GLuint location : { ATTR_INSTANCE_PREV, ATTR_INSTANCE_NEXT, ATTR_INSTANCE_NEXT2 }) {
+            glVertexAttribDivisor(location, 0);
+            glDisableVertexAttribArray(location);
+        }
+    }
+    glDisableVertexAttribArray(impostors ? ATTR_CORNER : ATTR_VERTEX);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    program->release();
+}
+
+void SphereRenderer::DrawSingle(float x, float y, float z, float radius, float r, float g, float b, float a) {
+    if (!initialized_) return;
+    glColor4f(r, g, b, a);
+    DrawMeshFixedFunction(x, y, z, radius);
+}
+
+void SphereRenderer::DrawMeshFixedFunction(float x, float y, float z, float radius) {
+    // Unit sphere points double as normals; GL_NORMALIZE undoes the scaling
+    glPushMatrix();
+    glTranslatef(x, y, z);
+    glScalef(radius, radius, radius);
+
+    glBindBuffer(GL_ARRAY_BUFFER, meshVbo_);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+    glNormalPointer(GL_FLOAT, 0, nullptr);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIbo_);
+    glDrawElements(GL_TRIANGLES, numIndices_, GL_UNSIGNED_SHORT, nullptr);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glPopMatrix();
+}
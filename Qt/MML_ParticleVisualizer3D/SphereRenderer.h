@@ -0,0 +1,133 @@
+#ifndef SPHERE_RENDERER_H
+#define SPHERE_RENDERER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QVector4D>
+#include <memory>
+#include <vector>
+
+// Draws many lit spheres from one unit-sphere mesh built once in a VBO. Every sphere
+// is an instance carrying its center, radius and color, so all of them cost a single
+// glDrawElementsInstanced call; the vertex shader reproduces the fixed-function
+// headlight the rest of the scene uses. The same instances can instead be drawn as
+// impostors: a 4-vertex quad per sphere whose fragment shader intersects the view
+// ray with the sphere for exact silhouette, normal and depth. Without instancing
+// (older than OpenGL 3.3) the mesh is drawn once per sphere with the current
+// fixed-function matrices and lights, which still avoids rebuilding the sphere on
+// the CPU.
+//
+// Instead of instances rebuilt per step, the positions of a whole run (or a window
+// of its steps) can stay in GPU memory, step-major; a step is then drawn by starting
+// the center attribute at that step's row, with no CPU work per frame. Between
+// stored steps the shader blends the centers of steps k-1 .. k+2 of the window.
+class SphereRenderer : protected QOpenGLExtraFunctions {
+public:
+    // One sphere; 20 bytes, uploaded as is
+    struct Instance {
+        float x, y, z;
+        float radius;
+        unsigned char r, g, b, a;
+    };
+    
+    // Radius and color of one sphere of a resident run; 8 bytes
+    struct Style {
+        float radius;               // 0 hides the sphere
+        unsigned char r, g, b, a;
+    };
+    
+    enum class Mode {
+        Mesh,       // Tessellated sphere; faceted when large on screen
+        Impostor    // Ray-cast quad; pixel exact at any size
+    };
+
+    SphereRenderer();
+    ~SphereRenderer();
+
+    // Must be called with the GL context current
+    void Initialize(int slices, int stacks);
+    void Cleanup();
+    bool IsInitialized() const { return initialized_; }
+    bool IsInstanced() const { return program_ != nullptr; }
+    bool HasImpostors() const { return impostorProgram_ != nullptr; }
+    
+    // Triangles per sphere in Mesh mode
+    GLsizei GetMeshTriangles() const { return numIndices_ / 3; }
+
+    // Perspective projection and world to eye transform; world-space direction towards the light
+    void SetMatrices(const QMatrix4x4& projection, const QMatrix4x4& view);
+    void SetLightDirection(const QVector3D& direction) { lightDirection_ = direction.normalized(); }
+
+    // Replaces the spheres drawn by Draw(); only needed when they change
+    void SetInstances(const std::vector<Instance>& instances);
+    // Impostors fall back to the mesh when the context can't draw them
+    void Draw(Mode mode = Mode::Mesh);
+
+    // Resident run: numSteps slots of numObjects centers (xyz floats). Needs instancing;
+    // returns false when it isn't available or the GPU is out of memory.
+    bool CreateResidentRun(size_t numObjects, size_t numSteps);
+    void UploadResidentSteps(size_t firstSlot, const float* xyz, size_t numSteps);
+    void SetResidentStyles(const std::vector<Style>& styles);
+    void ReleaseResidentRun();
+    bool HasResidentRun() const { return runVbo_ != 0; }
+    size_t GetResidentSlots() const { return static_cast<size_t>(runSteps_); }
+    void DrawResident(size_t slot, Mode mode = Mode::Mesh);
+    // Weights of steps slot-1, slot, slot+1 and slot+2 in DrawResident; (0, 1, 0, 0)
+    // draws the stored step
+    void SetStepWeights(const QVector4D& weights) { stepWeights_ = weights; }
+
+    // A single sphere with the fixed-function state (axis tips and the like)
+    void DrawSingle(float x, float y, float z, float radius, float r, float g, float b, float a);
+
+private:
+    void BuildMesh(int slices, int stacks);
+    void DrawMeshFixedFunction(float x, float y, float z, float radius);
+    
+    // Where the per-instance attributes are read from; offsets and strides in bytes
+    struct InstanceLayout {
+        GLuint centerVbo = 0;
+        GLintptr centerOffset = 0;
+        GLsizei centerStride = 0;
+        GLuint styleVbo = 0;
+        GLintptr radiusOffset = 0;
+        GLintptr colorOffset = 0;
+        GLsizei styleStride = 0;
+        bool interpolated = false;  // Neighbouring steps read at these offsets
+        GLintptr prevOffset = 0;
+        GLintptr nextOffset = 0;
+        GLintptr next2Offset = 0;
+        QVector4D weights = QVector4D(0.0f, 1.0f, 0.0f, 0.0f);
+    };
+    void DrawInstanced(Mode mode, const InstanceLayout& layout, GLsizei count);
+
+    // Fixed-function lighting the shader matches: global plus light ambient, and light diffuse
+    static constexpr float AMBIENT = 0.5f;
+    static constexpr float DIFFUSE = 0.8f;
+    static constexpr GLsizei INSTANCE_BYTES = sizeof(Instance);
+    static constexpr GLsizei STYLE_BYTES = sizeof(Style);
+    static constexpr GLsizei POINT_BYTES = 3 * sizeof(float);
+
+    bool initialized_;
+    std::unique_ptr<QOpenGLShaderProgram> program_;
+    std::unique_ptr<QOpenGLShaderProgram> impostorProgram_;
+    GLuint cornerVbo_;              // Impostor quad corners
+    GLuint meshVbo_;                // Unit sphere points, which are also the normals
+    GLuint meshIbo_;                // Triangles, GL_UNSIGNED_SHORT
+    GLsizei numIndices_;
+    GLuint instanceVbo_;
+    GLsizei numInstances_;
+    std::vector<Instance> instances_;   // Kept only for the fixed-function path
+    GLuint runVbo_;                 // Resident centers, runSteps_ rows of runObjects_
+    GLuint runStyleVbo_;
+    GLsizei runObjects_;
+    GLsizei runSteps_;
+    QVector4D stepWeights_;
+    QMatrix4x4 projection_;
+    QMatrix4x4 view_;
+    QMatrix4x4 matrix_;             // projection_ * view_
+    QVector3D lightDirection_;
+};
+
+#endif // SPHERE_RENDERER_H
@@ -0,0 +1,365 @@
+#include "DerivedSeries.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <thread>
+
+DerivedSeriesEngine::DerivedSeriesEngine()
+    : numThreads_(std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+template<typename Fn>
+void DerivedSeriesEngine::ParallelFor(size_t n, Fn fn) const {
+    if (n == 0) return;
+
+    // fn(chunk, begin, end); chunk boundaries depend only on n, so multi-pass
+    // kernels can rely on the same partition in every pass
+    size_t chunks = std::min<size_t>(numThreads_, std::max<size_t>(1, n / MIN_SAMPLES_PER_THREAD));
+    if (chunks == 1) {
+        fn(size_t(0), size_t(0), n);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t c = 1; c < chunks; ++c) {
+        workers.emplace_back(fn, c, n * c / chunks, n * (c + 1) / chunks);
+    }
+    fn(size_t(0), size_t(0), n / chunks);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<const SeriesSamples> DerivedSeriesEngine::Snapshot(const LoadedFunction& func, int subFunction) {
+    auto sourceKey = std::make_pair(&func, subFunction);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sources_.find(sourceKey);
+        if (it != sources_.end()) return it->second;
+    }
+
+    auto samples = std::make_shared<SeriesSamples>();
+    samples->title = func.GetDimension() > 1 ? func.GetFunctionTitle(subFunction) : func.GetTitle();
+
+    size_t n = static_cast<size_t>(std::max(func.GetNumPoints(), 0));
+    samples->x.resize(n);
+    samples->y.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        samples->x[i] = func.GetSampleX(static_cast<int>(i));
+        samples->y[i] = func.GetSampleY(subFunction, static_cast<int>(i));
+    }
+
+    if (auto* spaced = dynamic_cast<const LoadedEquallySpacedFunction*>(&func)) {
+        samples->equallySpaced = true;
+        samples->x0 = spaced->GetX0();
+        samples->dx = spaced->GetDx();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sources_[sourceKey] = samples;
+    return samples;
+}
+
+std::shared_ptr<const SeriesSamples> DerivedSeriesEngine::FindCached(const DerivedSeriesKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_.find(NormalizeKey(key));
+    return it != results_.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<const SeriesSamples> DerivedSeriesEngine::Compute(const DerivedSeriesKey& requestKey,
+                                                                  std::shared_ptr<const SeriesSamples> source) {
+    DerivedSeriesKey key = NormalizeKey(requestKey);
+    if (auto cached = FindCached(key)) return cached;
+    if (!source) return nullptr;
+
+    std::shared_ptr<const SeriesSamples> result = Run(key, *source);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Don't cache results for a source that was invalidated while computing;
+    // its address may already belong to a new function
+    auto sourceIt = sources_.find(std::make_pair(key.source, key.subFunction));
+    if (sourceIt == sources_.end() || sourceIt->second != source) return result;
+
+    auto inserted = results_.emplace(key, result);
+    if (!inserted.second) {
+        // Another worker finished the same request first
+        return inserted.first->second;
+    }
+    resultOrder_.push_back(key);
+    while (resultOrder_.size() > MAX_CACHED_RESULTS) {
+        results_.erase(resultOrder_.front());
+        resultOrder_.pop_front();
+    }
+    PruneSources();
+    return result;
+}
+
+void DerivedSeriesEngine::PruneSources() {
+    for (auto it = sources_.begin(); it != sources_.end();) {
+        // Copies are only handed out under mutex_, so a snapshot held by the
+        // cache alone can't be picked up by a job while this runs
+        bool referenced = it->second.use_count() > 1;
+        for (auto r = results_.begin(); !referenced && r != results_.end(); ++r) {
+            referenced = r->first.source == it->first.first && r->first.subFunction == it->first.second;
+        }
+        it = referenced ? std::next(it) : sources_.erase(it);
+    }
+}
+
+void DerivedSeriesEngine::InvalidateSource(const LoadedFunction* source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = sources_.begin(); it != sources_.end();) {
+        it = (it->first.first == source) ? sources_.erase(it) : std::next(it);
+    }
+    for (auto it = results_.begin(); it != results_.end();) {
+        it = (it->first.source == source) ? results_.erase(it) : std::next(it);
+    }
+    resultOrder_.erase(std::remove_if(resultOrder_.begin(), resultOrder_.end(),
+                                      [source](const DerivedSeriesKey& k) { return k.source == source; }),
+                       resultOrder_.end());
+}
+
+void DerivedSeriesEngine::ClearCache() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sources_.clear();
+    results_.clear();
+    resultOrder_.clear();
+}
+
+DerivedSeriesKey DerivedSeriesEngine::NormalizeKey(DerivedSeriesKey key) {
+    key.window = UsesWindow(key.kind) ? std::max(key.window, 1) : 0;
+    return key;
+}
+
+std::unique_ptr<LoadedFunction> DerivedSeriesEngine::CreateFunction(const SeriesSamples& samples) {
+    if (samples.equallySpaced) {
+        return std::make_unique<LoadedEquallySpacedFunction>(samples.title, samples.x0, samples.dx, samples.y);
+    }
+
+    auto func = std::make_unique<LoadedRealFunction>(samples.title, 0);
+    func->Reserve(samples.x.size());
+    for (size_t i = 0; i < samples.x.size(); ++i) {
+        func->AddPoint(samples.x[i], samples.y[i]);
+    }
+    return func;
+}
+
+const char* DerivedSeriesEngine::GetKindName(DerivedSeriesKind kind) {
+    switch (kind) {
+        case DerivedSeriesKind::Derivative:    return "Derivative";
+        case DerivedSeriesKind::Integral:      return "Integral";
+        case DerivedSeriesKind::MovingAverage: return "Moving Average";
+        case DerivedSeriesKind::MovingRms:     return "Moving RMS";
+        case DerivedSeriesKind::FftMagnitude:  return "FFT Magnitude";
+    }
+    return "";
+}
+
+bool DerivedSeriesEngine::UsesWindow(DerivedSeriesKind kind) {
+    return kind == DerivedSeriesKind::MovingAverage || kind == DerivedSeriesKind::MovingRms;
+}
+
+std::shared_ptr<SeriesSamples> DerivedSeriesEngine::Run(const DerivedSeriesKey& key, const SeriesSamples& source) const {
+    auto result = std::make_shared<SeriesSamples>();
+    size_t n = source.y.size();
+
+    if (key.kind == DerivedSeriesKind::FftMagnitude) {
+        FftMagnitude(source, *result);
+        result->title = "|FFT| " + source.title;
+        return result;
+    }
+
+    // Pointwise operations keep the source x grid
+    result->x = source.x;
+    result->equallySpaced = source.equallySpaced;
+    result->x0 = source.x0;
+    result->dx = source.dx;
+    result->y.resize(n);
+    if (n == 0) return result;
+
+    switch (key.kind) {
+        case DerivedSeriesKind::Derivative:
+            Derivative(source.x.data(), source.y.data(), result->y.data(), n);
+            result->title = "d/dx " + source.title;
+            break;
+        case DerivedSeriesKind::Integral:
+            CumulativeIntegral(source.x.data(), source.y.data(), result->y.data(), n);
+            result->title = "Integral of " + source.title;
+            break;
+        case DerivedSeriesKind::MovingAverage:
+            MovingWindow(source.y.data(), result->y.data(), n, key.window, false);
+            result->title = "Mean[" + std::to_string(key.window) + "] " + source.title;
+            break;
+        case DerivedSeriesKind::MovingRms:
+            MovingWindow(source.y.data(), result->y.data(), n, key.window, true);
+            result->title = "RMS[" + std::to_string(key.window) + "] " + source.title;
+            break;
+        default:
+            break;
+    }
+    return result;
+}
+
+void DerivedSeriesEngine::Derivative(const double* x, const double* y, double* out, size_t n) const {
+    if (n < 2) {
+        out[0] = 0.0;
+        return;
+    }
+
+    // Central differences inside, one-sided at the ends
+    ParallelFor(n, [=](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t lo = i > 0 ? i - 1 : 0;
+            size_t hi = i + 1 < n ? i + 1 : n - 1;
+            double h = x[hi] - x[lo];
+            out[i] = h != 0.0 ? (y[hi] - y[lo]) / h : 0.0;
+        }
+    });
+}
+
+void DerivedSeriesEngine::CumulativeIntegral(const double* x, const double* y, double* out, size_t n) const {
+    // Trapezoid areas of each interval, then a running sum
+    out[0] = 0.0;
+    ParallelFor(n - 1, [=](size_t, size_t begin, size_t end) {
+        for (size_t i = begin + 1; i <= end; ++i) {
+            out[i] = 0.5 * (y[i] + y[i - 1]) * (x[i] - x[i - 1]);
+        }
+    });
+    PrefixSum(out, out, n, false);
+}
+
+void DerivedSeriesEngine::MovingWindow(const double* y, double* out, size_t n, int window, bool rms) const {
+    // Window sums from a prefix sum are O(1) per sample, independent of the window size
+    std::vector<double> prefix(n);
+    PrefixSum(y, prefix.data(), n, rms);
+    const double* p = prefix.data();
+
+    size_t before = static_cast<size_t>(window - 1) / 2;
+    size_t after = static_cast<size_t>(window - 1) - before;
+
+    ParallelFor(n, [=](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t lo = i > before ? i - before : 0;
+            size_t hi = std::min(i + after, n - 1);
+            double sum = p[hi] - (lo > 0 ? p[lo - 1] : 0.0);
+            double mean = sum / static_cast<double>(hi - lo + 1);
+            out[i] = rms ? std::sqrt(std::max(mean, 0.0)) : mean;
+        }
+    });
+}
+
+void DerivedSeriesEngine::PrefixSum(const double* values, double* out, size_t n, bool squared) const {
+    // Pass 1: local prefix sums per chunk; pass 2: add the totals of preceding chunks
+    size_t maxChunks = std::max<unsigned>(numThreads_, 1u);
+    std::vector<double> chunkTotals(maxChunks, 0.0);
+
+    ParallelFor(n, [&](size_t chunk, size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            double v = values[i];
+            sum += squared ? v * v : v;
+            out[i] = sum;
+        }
+        chunkTotals[chunk] = sum;
+    });
+
+    std::vector<double> chunkOffsets(maxChunks, 0.0);
+    for (size_t c = 1; c < maxChunks; ++c) {
+        chunkOffsets[c] = chunkOffsets[c - 1] + chunkTotals[c - 1];
+    }
+
+    ParallelFor(n, [&](size_t chunk, size_t begin, size_t end) {
+        double offset = chunkOffsets[chunk];
+        if (offset == 0.0) return;
+        for (size_t i = begin; i < end; ++i) {
+            out[i] += offset;
+        }
+    });
+}
+
+void DerivedSeriesEngine::FftMagnitude(const SeriesSamples& source, SeriesSamples& result) const {
+    size_t n = source.y.size();
+    result.equallySpaced = true;
+    result.x0 = 0.0;
+    if (n < 2) {
+        result.dx = 1.0;
+        result.x.assign(1, 0.0);
+        result.y.assign(1, n == 1 ? std::abs(source.y[0]) : 0.0);
+        return;
+    }
+
+    double span = source.x[n - 1] - source.x[0];
+    double dx = span > 0.0 ? span / static_cast<double>(n - 1) : 1.0;
+
+    size_t fftSize = 1;
+    while (fftSize < n) fftSize <<= 1;
+
+    // Input on a uniform grid (linear resampling if the source is not), zero-padded
+    std::vector<std::complex<double>> data(fftSize);
+    if (source.equallySpaced || span <= 0.0) {
+        for (size_t i = 0; i < n; ++i) data[i] = source.y[i];
+    } else {
+        const auto& xs = source.x;
+        const auto& ys = source.y;
+        ParallelFor(n, [&](size_t, size_t begin, size_t end) {
+            size_t j = std::upper_bound(xs.begin(), xs.end(), xs[0] + begin * dx) - xs.begin();
+            for (size_t i = begin; i < end; ++i) {
+                double xi = xs[0] + static_cast<double>(i) * dx;
+                while (j < n && xs[j] <= xi) ++j;
+                if (j == 0) { data[i] = ys[0]; continue; }
+                if (j >= n) { data[i] = ys[n - 1]; continue; }
+                double h = xs[j] - xs[j - 1];
+                double t = h > 0.0 ? (xi - xs[j - 1]) / h : 0.0;
+                data[i] = ys[j - 1] + t * (ys[j] - ys[j - 1]);
+            }
+        });
+    }
+
+    // Bit-reversal permutation
+    for (size_t i = 1, j = 0; i < fftSize; ++i) {
+        size_t bit = fftSize >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    // Twiddle factors for the largest stage; smaller stages use a stride into it
+    std::vector<std::complex<double>> twiddle(fftSize / 2);
+    const double pi = std::acos(-1.0);
+    for (size_t k = 0; k < twiddle.size(); ++k) {
+        double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(fftSize);
+        twiddle[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+
+    // Iterative radix-2 butterflies; the fftSize/2 butterflies of a stage are independent
+    std::complex<double>* d = data.data();
+    const std::complex<double>* w = twiddle.data();
+    for (size_t len = 2; len <= fftSize; len <<= 1) {
+        size_t half = len / 2;
+        size_t stride = fftSize / len;
+        ParallelFor(fftSize / 2, [=](size_t, size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                size_t j = b % half;
+                size_t i = (b / half) * len + j;
+                std::complex<double> t = w[j * stride] * d[i + half];
+                d[i + half] = d[i] - t;
+                d[i] += t;
+            }
+        });
+    }
+
+    // One-sided amplitude spectrum, frequency in cycles per x unit
+    size_t bins = fftSize / 2 + 1;
+    result.dx = 1.0 / (static_cast<double>(fftSize) * dx);
+    result.x.resize(bins);
+    result.y.resize(bins);
+    double norm = 1.0 / static_cast<double>(n);
+    for (size_t k = 0; k < bins; ++k) {
+        double scale = (k == 0 || k == fftSize / 2) ? norm : 2.0 * norm;
+        result.x[k] = static_cast<double>(k) * result.dx;
+        result.y[k] = std::abs(data[k]) * scale;
+    }
+}
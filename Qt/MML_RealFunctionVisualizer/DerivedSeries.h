@@ -0,0 +1,106 @@
+#ifndef DERIVED_SERIES_H
+#define DERIVED_SERIES_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <deque>
+#include <tuple>
+#include "MMLData.h"
+
+// Operations available for derived series
+enum class DerivedSeriesKind {
+    Derivative,         // Finite-difference dy/dx
+    Integral,           // Cumulative trapezoid integral
+    MovingAverage,      // Centered windowed mean
+    MovingRms,          // Centered windowed RMS
+    FftMagnitude        // One-sided FFT magnitude spectrum
+};
+
+// Plain sample arrays of one series; x is ascending
+struct SeriesSamples {
+    std::string title;
+    std::vector<double> x;
+    std::vector<double> y;
+    bool equallySpaced = false;
+    double x0 = 0.0;
+    double dx = 0.0;
+};
+
+// Identifies a derived series: source series, operation and parameters
+struct DerivedSeriesKey {
+    const LoadedFunction* source = nullptr;
+    int subFunction = 0;
+    DerivedSeriesKind kind = DerivedSeriesKind::Derivative;
+    int window = 0;     // Samples in the moving window; unused by other operations
+
+    bool operator<(const DerivedSeriesKey& other) const {
+        return std::make_tuple(source, subFunction, static_cast<int>(kind), window) <
+               std::make_tuple(other.source, other.subFunction, static_cast<int>(other.kind), other.window);
+    }
+};
+
+// Computes derived series from loaded functions.
+// Snapshot() copies the source samples on the GUI thread; Compute() is thread-safe
+// and splits every kernel across worker threads. Both source snapshots and results
+// are cached, so repeating a request (e.g. going back to an earlier window size)
+// returns immediately. A snapshot is kept while a cached result or a pending job
+// still uses it.
+class DerivedSeriesEngine {
+public:
+    static constexpr size_t MAX_CACHED_RESULTS = 32;
+    static constexpr size_t MIN_SAMPLES_PER_THREAD = 16384;
+
+    DerivedSeriesEngine();
+
+    // Copy of one (sub-)series of a loaded function, cached per source
+    std::shared_ptr<const SeriesSamples> Snapshot(const LoadedFunction& func, int subFunction);
+
+    // Cached result or nullptr; cheap enough to call on the GUI thread
+    std::shared_ptr<const SeriesSamples> FindCached(const DerivedSeriesKey& key) const;
+
+    // Computes (or fetches) the derived series; safe to call from worker threads
+    std::shared_ptr<const SeriesSamples> Compute(const DerivedSeriesKey& key,
+                                                 std::shared_ptr<const SeriesSamples> source);
+
+    // Drops cached data for a source that was removed or replaced
+    void InvalidateSource(const LoadedFunction* source);
+    void ClearCache();
+
+    // Normalizes parameters that don't affect the result, so they share cache entries
+    static DerivedSeriesKey NormalizeKey(DerivedSeriesKey key);
+
+    static std::unique_ptr<LoadedFunction> CreateFunction(const SeriesSamples& samples);
+    static const char* GetKindName(DerivedSeriesKind kind);
+    static bool UsesWindow(DerivedSeriesKind kind);
+
+private:
+    std::shared_ptr<SeriesSamples> Run(const DerivedSeriesKey& key, const SeriesSamples& source) const;
+
+    // Drops snapshots no cached result refers to and no job holds; mutex_ must be held
+    void PruneSources();
+
+    // Kernels; all arrays have the source length
+    void Derivative(const double* x, const double* y, double* out, size_t n) const;
+    void CumulativeIntegral(const double* x, const double* y, double* out, size_t n) const;
+    void MovingWindow(const double* y, double* out, size_t n, int window, bool rms) const;
+    void FftMagnitude(const SeriesSamples& source, SeriesSamples& result) const;
+
+    // Inclusive prefix sum of values[i] (or values[i]^2), computed in chunks
+    void PrefixSum(const double* values, double* out, size_t n, bool squared) const;
+
+    // Runs fn(begin, end) over [0, n) split across worker threads
+    template<typename Fn>
+    void ParallelFor(size_t n, Fn fn) const;
+
+    unsigned numThreads_;
+
+    mutable std::mutex mutex_;
+    std::map<std::pair<const LoadedFunction*, int>, std::shared_ptr<const SeriesSamples>> sources_;
+    std::map<DerivedSeriesKey, std::shared_ptr<const SeriesSamples>> results_;
+    std::deque<DerivedSeriesKey> resultOrder_;  // Insertion order for eviction
+};
+
+#endif // DERIVED_SERIES_H
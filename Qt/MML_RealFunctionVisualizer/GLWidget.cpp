@@ -2,9 +2,103 @@
 #include <GL/gl.h>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// Collects a line strip over samples [first, last] into out (xyz), collapsing runs
+// that fall into the same pixel column to their first/min/max/last samples. The
+// result is visually identical to the full strip but bounded by ~4 vertices per column.
+template<typename XFn, typename YFn>
+void CollectDecimatedStrip(size_t first, size_t last, XFn xAt, YFn yAt,
+                           double minX, double pixelsPerUnit, std::vector<float>& out) {
+    out.clear();
+    if (first > last) return;
+    
+    auto emit = [&](size_t i) {
+        out.push_back(static_cast<float>(xAt(i)));
+        out.push_back(static_cast<float>(yAt(i)));
+        out.push_back(0.0f);
+    };
+    
+    // Few samples per pixel: nothing to gain from decimation
+    double span = (xAt(last) - xAt(first)) * pixelsPerUnit;
+    if (static_cast<double>(last - first + 1) <= 2.0 * std::abs(span) + 2.0) {
+        for (size_t i = first; i <= last; ++i) {
+            emit(i);
+        }
+        return;
+    }
+    
+    auto columnOf = [&](size_t i) {
+        return static_cast<long long>(std::floor((xAt(i) - minX) * pixelsPerUnit));
+    };
+    
+    auto emitColumn = [&](size_t c0, size_t cMin, size_t cMax, size_t c1) {
+        size_t idx[4] = { c0, cMin, cMax, c1 };
+        std::sort(idx, idx + 4);
+        for (int k = 0; k < 4; ++k) {
+            if (k > 0 && idx[k] == idx[k - 1]) continue;
+            emit(idx[k]);
+        }
+    };
+    
+    long long column = columnOf(first);
+    size_t colFirst = first, colMin = first, colMax = first, colLast = first;
+    for (size_t i = first + 1; i <= last; ++i) {
+        long long c = columnOf(i);
+        if (c != column) {
+            emitColumn(colFirst, colMin, colMax, colLast);
+            column = c;
+            colFirst = colMin = colMax = i;
+        } else {
+            double y = yAt(i);
+            if (y < yAt(colMin)) colMin = i;
+            if (y > yAt(colMax)) colMax = i;
+        }
+        colLast = i;
+    }
+    emitColumn(colFirst, colMin, colMax, colLast);
+}
+
+// Appends the segment (x0, y0)-(x1, y1) to a GL_LINES style xyz list
+void AddSegment(std::vector<float>& out, double x0, double y0, double x1, double y1) {
+    out.insert(out.end(), { static_cast<float>(x0), static_cast<float>(y0), 0.0f,
+                            static_cast<float>(x1), static_cast<float>(y1), 0.0f });
+}
+
+// Index range of sorted x values covering [minX, maxX], extended by one sample
+// on each side so the strip continues to the plot edges. Returns false if empty.
+template<typename XFn>
+bool FindVisibleRange(size_t count, XFn xAt, double minX, double maxX,
+                      size_t& first, size_t& last) {
+    if (count == 0) return false;
+    
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (xAt(mid) < minX) lo = mid + 1; else hi = mid;
+    }
+    first = lo > 0 ? lo - 1 : 0;
+    
+    lo = first; hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (xAt(mid) <= maxX) lo = mid + 1; else hi = mid;
+    }
+    last = std::min(lo, count - 1);
+    return first <= last;
+}
+
+} // namespace
 
 GLWidget::GLWidget(QWidget* parent)
     : QOpenGLWidget(parent)
+    , functions_(std::make_shared<FunctionStore>())
+    , paneFiltered_(false)
+    , labelsDirty_(true)
+    , labelMinX_(0.0), labelMaxX_(0.0)
+    , labelMinY_(0.0), labelMaxY_(0.0)
     , viewMinX_(-10.0)
     , viewMaxX_(10.0)
     , viewMinY_(-10.0)
@@ -21,6 +115,9 @@ GLWidget::GLWidget(QWidget* parent)
     , showLabels_(true)
     , preserveAspectRatio_(false)
     , isPanning_(false)
+    , hoverEnabled_(true)
+    , hoverActive_(false)
+    , hoverX_(0.0)
     , glInitialized_(false)
     , width_(800)
     , height_(600)
@@ -28,14 +125,22 @@ GLWidget::GLWidget(QWidget* parent)
     setFocusPolicy(Qt::StrongFocus);
     setMouseTracking(true);
     
+    // Round joins keep dense, decimated strips smooth
+    curveStyle_.width = CURVE_LINE_WIDTH;
+    curveStyle_.join = LineRenderer::JoinStyle::Round;
+    
     // Initialize tick info for default view
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        viewMinX_, viewMaxX_, viewMinY_, viewMaxY_, 10, 8);
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
 }
 
 GLWidget::~GLWidget() {
+    if (glInitialized_) {
+        makeCurrent();
+        textRenderer_.Cleanup();
+        hoverTextRenderer_.Cleanup();
+        lineRenderer_.Cleanup();
+        doneCurrent();
+    }
 }
 
 void GLWidget::initializeGL() {
@@ -44,11 +149,19 @@ void GLWidget::initializeGL() {
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glEnable(GL_LINE_SMOOTH);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    
+    QFont labelFont = font();
+    labelFont.setPointSize(9);
+    textRenderer_.Initialize(labelFont, devicePixelRatioF());
+    hoverTextRenderer_.Initialize(labelFont, devicePixelRatioF());
+    lineRenderer_.Initialize(devicePixelRatioF());
+    labelsDirty_ = true;
 }
 
 void GLWidget::resizeGL(int w, int h) {
     width_ = w;
     height_ = h;
+    labelsDirty_ = true;
     // Projection will be set up in paintGL
 }
 
@@ -98,6 +211,10 @@ void GLWidget::SetupProjection() {
     
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
+    
+    QMatrix4x4 projection;
+    projection.ortho(displayMinX_, displayMaxX_, displayMinY_, displayMaxY_, -1.0f, 1.0f);
+    lineRenderer_.SetMatrix(projection);
 }
 
 void GLWidget::paintGL() {
@@ -113,13 +230,15 @@ void GLWidget::paintGL() {
     DrawAxes();
     
     // Draw all functions
-    for (const auto& func : functions_) {
+    for (const auto& func : *functions_) {
         if (!func->IsVisible()) continue;
         
         if (func->GetDimension() == 1) {
-            auto* singleFunc = dynamic_cast<LoadedRealFunction*>(func.get());
-            if (singleFunc) {
+            if (!IsSeriesShown(*func, 0)) continue;
+            if (auto* singleFunc = dynamic_cast<LoadedRealFunction*>(func.get())) {
                 DrawSingleFunction(*singleFunc);
+            } else if (auto* spacedFunc = dynamic_cast<LoadedEquallySpacedFunction*>(func.get())) {
+                DrawEquallySpacedFunction(*spacedFunc);
             }
         } else {
             auto* multiFunc = dynamic_cast<MultiLoadedFunction*>(func.get());
@@ -129,40 +248,35 @@ void GLWidget::paintGL() {
         }
     }
     
-    // Draw labels using QPainter overlay
+    // Hover crosshair in world coordinates, before the viewport is changed for text
+    if (hoverEnabled_ && hoverActive_) {
+        UpdateHoverSamples();
+        DrawHoverCrosshair();
+    }
+    
+    // Draw labels from the glyph atlas in a single batch
     if (showLabels_) {
-        QPainter painter(this);
-        painter.setRenderHint(QPainter::Antialiasing);
-        DrawAxisLabels(painter);
-        painter.end();
+        DrawAxisLabels();
+    }
+    
+    if (hoverEnabled_ && hoverActive_) {
+        DrawHoverReadout();
     }
 }
 
 void GLWidget::DrawGrid() {
-    glLineWidth(1.0f);
-    glColor3f(0.9f, 0.9f, 0.9f);
-    
-    // Draw vertical grid lines at X tick positions
-    glBegin(GL_LINES);
+    // Vertical lines at X tick positions, horizontal lines at Y tick positions
+    lineVertices_.clear();
     for (const auto& tick : xTickInfo_.ticks) {
-        glVertex2d(tick.value, displayMinY_);
-        glVertex2d(tick.value, displayMaxY_);
+        AddSegment(lineVertices_, tick.value, displayMinY_, tick.value, displayMaxY_);
     }
-    glEnd();
-    
-    // Draw horizontal grid lines at Y tick positions
-    glBegin(GL_LINES);
     for (const auto& tick : yTickInfo_.ticks) {
-        glVertex2d(displayMinX_, tick.value);
-        glVertex2d(displayMaxX_, tick.value);
+        AddSegment(lineVertices_, displayMinX_, tick.value, displayMaxX_, tick.value);
     }
-    glEnd();
+    lineRenderer_.DrawSegments(lineVertices_, { GRID_LINE_WIDTH }, 0.9f, 0.9f, 0.9f);
 }
 
 void GLWidget::DrawAxes() {
-    glLineWidth(2.0f);
-    glColor3f(0.0f, 0.0f, 0.0f);
-    
     // Determine axis positions (at 0 if in range, otherwise at edge)
     double xAxisY = 0.0;
     if (displayMinY_ > 0) xAxisY = displayMinY_;
@@ -172,44 +286,52 @@ void GLWidget::DrawAxes() {
     if (displayMinX_ > 0) yAxisX = displayMinX_;
     else if (displayMaxX_ < 0) yAxisX = displayMaxX_;
     
-    // X-axis
-    glBegin(GL_LINES);
-    glVertex2d(displayMinX_, xAxisY);
-    glVertex2d(displayMaxX_, xAxisY);
-    glEnd();
-    
-    // Y-axis
-    glBegin(GL_LINES);
-    glVertex2d(yAxisX, displayMinY_);
-    glVertex2d(yAxisX, displayMaxY_);
-    glEnd();
+    // X and Y axes
+    lineVertices_.clear();
+    AddSegment(lineVertices_, displayMinX_, xAxisY, displayMaxX_, xAxisY);
+    AddSegment(lineVertices_, yAxisX, displayMinY_, yAxisX, displayMaxY_);
+    lineRenderer_.DrawSegments(lineVertices_, { AXIS_LINE_WIDTH }, 0.0f, 0.0f, 0.0f);
     
-    // Draw tick marks
+    // Tick marks
     double tickSize = std::min(displayMaxX_ - displayMinX_, displayMaxY_ - displayMinY_) * 0.01;
-    
-    // X-axis ticks
-    glLineWidth(1.0f);
-    glBegin(GL_LINES);
+    lineVertices_.clear();
     for (const auto& tick : xTickInfo_.ticks) {
-        glVertex2d(tick.value, xAxisY - tickSize);
-        glVertex2d(tick.value, xAxisY + tickSize);
+        AddSegment(lineVertices_, tick.value, xAxisY - tickSize, tick.value, xAxisY + tickSize);
     }
-    glEnd();
-    
-    // Y-axis ticks
-    glBegin(GL_LINES);
     for (const auto& tick : yTickInfo_.ticks) {
-        glVertex2d(yAxisX - tickSize, tick.value);
-        glVertex2d(yAxisX + tickSize, tick.value);
+        AddSegment(lineVertices_, yAxisX - tickSize, tick.value, yAxisX + tickSize, tick.value);
     }
-    glEnd();
+    lineRenderer_.DrawSegments(lineVertices_, { TICK_LINE_WIDTH }, 0.0f, 0.0f, 0.0f);
+}
+
+void GLWidget::UpdateAxisTicks(double minX, double maxX, double minY, double maxY) {
+    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(minX, maxX, minY, maxY, 10, 8);
+    xTickInfo_ = std::move(xTicks);
+    yTickInfo_ = std::move(yTicks);
+    labelsDirty_ = true;
+}
+
+void GLWidget::DrawAxisLabels() {
+    // Re-scale the atlas if the widget moved to a screen with different pixel density
+    if (textRenderer_.GetDevicePixelRatio() != devicePixelRatioF()) {
+        QFont labelFont = font();
+        labelFont.setPointSize(9);
+        textRenderer_.Initialize(labelFont, devicePixelRatioF());
+        hoverTextRenderer_.Initialize(labelFont, devicePixelRatioF());
+        labelsDirty_ = true;
+    }
+    
+    if (labelsDirty_ ||
+        labelMinX_ != displayMinX_ || labelMaxX_ != displayMaxX_ ||
+        labelMinY_ != displayMinY_ || labelMaxY_ != displayMaxY_) {
+        RebuildAxisLabels();
+    }
+    
+    textRenderer_.Draw(width_, height_, 0.0f, 0.0f, 0.0f);
 }
 
-void GLWidget::DrawAxisLabels(QPainter& painter) {
-    painter.setPen(Qt::black);
-    QFont font = painter.font();
-    font.setPointSize(9);
-    painter.setFont(font);
+void GLWidget::RebuildAxisLabels() {
+    textRenderer_.ClearBatch();
     
     int drawWidth = width_ - MARGIN_LEFT - MARGIN_RIGHT;
     int drawHeight = height_ - MARGIN_TOP - MARGIN_BOTTOM;
@@ -232,38 +354,204 @@ void GLWidget::DrawAxisLabels(QPainter& painter) {
     if (displayMinX_ > 0) yAxisX = displayMinX_;
     else if (displayMaxX_ < 0) yAxisX = displayMaxX_;
     
-    // X-axis labels
+    // X-axis labels, centered below the axis
     for (const auto& tick : xTickInfo_.ticks) {
-        int screenX = worldToScreenX(tick.value);
-        int screenY = worldToScreenY(xAxisY) + 15;  // Below the axis
-        
-        QRect textRect(screenX - 40, screenY, 80, 20);
-        painter.drawText(textRect, Qt::AlignCenter, QString::fromStdString(tick.label));
+        float screenX = static_cast<float>(worldToScreenX(tick.value));
+        float screenY = static_cast<float>(worldToScreenY(xAxisY) + 25);
+        textRenderer_.AddText(tick.label, screenX, screenY, TextAlign::Center);
     }
     
-    // Y-axis labels
+    // Y-axis labels, right-aligned left of the axis
     for (const auto& tick : yTickInfo_.ticks) {
-        int screenX = worldToScreenX(yAxisX) - 45;  // Left of the axis
-        int screenY = worldToScreenY(tick.value) - 8;
+        float screenX = static_cast<float>(worldToScreenX(yAxisX) - 5);
+        float screenY = static_cast<float>(worldToScreenY(tick.value));
+        textRenderer_.AddText(tick.label, screenX, screenY, TextAlign::Right);
+    }
+    
+    labelMinX_ = displayMinX_;
+    labelMaxX_ = displayMaxX_;
+    labelMinY_ = displayMinY_;
+    labelMaxY_ = displayMaxY_;
+    labelsDirty_ = false;
+}
+
+void GLWidget::UpdateHoverSamples() {
+    hoverSamples_.clear();
+    
+    int drawWidth = width_ - MARGIN_LEFT - MARGIN_RIGHT;
+    if (drawWidth <= 0) return;
+    
+    double mouseX = displayMinX_ + (hoverPos_.x() - MARGIN_LEFT) / static_cast<double>(drawWidth) *
+                    (displayMaxX_ - displayMinX_);
+    
+    // Binary search per function; the crosshair snaps to the closest sample found
+    double bestDist = std::numeric_limits<double>::max();
+    hoverX_ = mouseX;
+    
+    for (const auto& func : *functions_) {
+        if (!func->IsVisible()) continue;
+        
+        int sample = func->FindNearestSample(mouseX);
+        if (sample < 0) continue;
         
-        QRect textRect(screenX, screenY, 40, 16);
-        painter.drawText(textRect, Qt::AlignRight | Qt::AlignVCenter, QString::fromStdString(tick.label));
+        double sampleX = func->GetSampleX(sample);
+        if (std::abs(sampleX - mouseX) < bestDist) {
+            bestDist = std::abs(sampleX - mouseX);
+            hoverX_ = sampleX;
+        }
+        
+        for (int i = 0; i < func->GetDimension(); ++i) {
+            if (!IsSeriesShown(*func, i)) continue;
+            if (static_cast<int>(hoverSamples_.size()) >= MAX_HOVER_LINES) return;
+            
+            hoverSamples_.push_back({ func->GetFunctionTitle(i), func->GetFunctionColor(i),
+                                      sampleX, func->GetSampleY(i, sample) });
+        }
     }
 }
 
+void GLWidget::DrawHoverCrosshair() {
+    // Vertical line through the nearest sample
+    glLineWidth(1.0f);
+    glColor3f(0.4f, 0.4f, 0.4f);
+    glBegin(GL_LINES);
+    glVertex2d(hoverX_, displayMinY_);
+    glVertex2d(hoverX_, displayMaxY_);
+    glEnd();
+    
+    // Marker on each series at its nearest sample
+    glPointSize(7.0f);
+    glBegin(GL_POINTS);
+    for (const auto& sample : hoverSamples_) {
+        glColor3f(sample.color.r, sample.color.g, sample.color.b);
+        glVertex2d(sample.x, sample.y);
+    }
+    glEnd();
+    glPointSize(1.0f);
+}
+
+void GLWidget::DrawHoverReadout() {
+    char buffer[128];
+    std::vector<std::string> lines;
+    
+    std::snprintf(buffer, sizeof(buffer), "x = %.6g", hoverX_);
+    lines.push_back(buffer);
+    for (const auto& sample : hoverSamples_) {
+        std::snprintf(buffer, sizeof(buffer), "%s: %.6g", sample.title.c_str(), sample.y);
+        lines.push_back(buffer);
+    }
+    
+    const float lineHeight = hoverTextRenderer_.GetLineHeight();
+    const float swatchSize = 8.0f;
+    const float padding = 5.0f;
+    const float textOffset = swatchSize + 2.0f * padding;
+    
+    float textWidth = 0.0f;
+    for (const auto& line : lines) {
+        textWidth = std::max(textWidth, hoverTextRenderer_.GetTextWidth(line));
+    }
+    float boxWidth = textOffset + textWidth + padding;
+    float boxHeight = lines.size() * lineHeight + 2.0f * padding;
+    
+    // Place the box next to the cursor, flipping sides near the plot edges
+    float boxX = hoverPos_.x() + 15.0f;
+    float boxY = hoverPos_.y() + 15.0f;
+    if (boxX + boxWidth > width_ - MARGIN_RIGHT) boxX = hoverPos_.x() - 15.0f - boxWidth;
+    if (boxY + boxHeight > height_ - MARGIN_BOTTOM) boxY = hoverPos_.y() - 15.0f - boxHeight;
+    
+    hoverTextRenderer_.ClearBatch();
+    for (size_t i = 0; i < lines.size(); ++i) {
+        float centerY = boxY + padding + (i + 0.5f) * lineHeight;
+        hoverTextRenderer_.AddText(lines[i], boxX + textOffset, centerY, TextAlign::Left);
+    }
+    
+    // Box and color swatches in widget pixel coordinates
+    glViewport(0, 0, static_cast<int>(width_ * devicePixelRatioF()), static_cast<int>(height_ * devicePixelRatioF()));
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, width_, height_, 0.0, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(1.0f, 1.0f, 1.0f, 0.85f);
+    glBegin(GL_QUADS);
+    glVertex2f(boxX, boxY);
+    glVertex2f(boxX + boxWidth, boxY);
+    glVertex2f(boxX + boxWidth, boxY + boxHeight);
+    glVertex2f(boxX, boxY + boxHeight);
+    glEnd();
+    glDisable(GL_BLEND);
+    
+    glLineWidth(1.0f);
+    glColor3f(0.5f, 0.5f, 0.5f);
+    glBegin(GL_LINE_LOOP);
+    glVertex2f(boxX, boxY);
+    glVertex2f(boxX + boxWidth, boxY);
+    glVertex2f(boxX + boxWidth, boxY + boxHeight);
+    glVertex2f(boxX, boxY + boxHeight);
+    glEnd();
+    
+    glBegin(GL_QUADS);
+    for (size_t i = 0; i < hoverSamples_.size(); ++i) {
+        const Color& c = hoverSamples_[i].color;
+        float centerY = boxY + padding + (i + 1.5f) * lineHeight;
+        glColor3f(c.r, c.g, c.b);
+        glVertex2f(boxX + padding, centerY - swatchSize / 2);
+        glVertex2f(boxX + padding + swatchSize, centerY - swatchSize / 2);
+        glVertex2f(boxX + padding + swatchSize, centerY + swatchSize / 2);
+        glVertex2f(boxX + padding, centerY + swatchSize / 2);
+    }
+    glEnd();
+    
+    hoverTextRenderer_.Draw(width_, height_, 0.0f, 0.0f, 0.0f);
+}
+
+double GLWidget::GetPixelsPerUnitX() const {
+    int drawWidth = std::max(width_ - MARGIN_LEFT - MARGIN_RIGHT, 1);
+    double rangeX = displayMaxX_ - displayMinX_;
+    if (rangeX <= 0.0) return 1.0;
+    return drawWidth * devicePixelRatioF() / rangeX;
+}
+
 void GLWidget::DrawSingleFunction(const LoadedRealFunction& func) {
     const auto& points = func.GetPoints();
     if (points.empty()) return;
     
-    const Color& color = func.GetColor();
-    glColor3f(color.r, color.g, color.b);
-    glLineWidth(2.0f);
+    auto xAt = [&points](size_t i) { return points[i].x; };
+    auto yAt = [&points](size_t i) { return points[i].y; };
     
-    glBegin(GL_LINE_STRIP);
-    for (const auto& point : points) {
-        glVertex2d(point.x, point.y);
+    size_t first, last;
+    if (FindVisibleRange(points.size(), xAt, displayMinX_, displayMaxX_, first, last)) {
+        CollectDecimatedStrip(first, last, xAt, yAt, displayMinX_, GetPixelsPerUnitX(), lineVertices_);
+        const Color& color = func.GetColor();
+        lineRenderer_.DrawStrip(lineVertices_, curveStyle_, color.r, color.g, color.b);
     }
-    glEnd();
+}
+
+void GLWidget::DrawEquallySpacedFunction(const LoadedEquallySpacedFunction& func) {
+    const auto& yValues = func.GetYValues();
+    if (yValues.empty()) return;
+    
+    auto xAt = [&func](size_t i) { return func.GetX(i); };
+    auto yAt = [&yValues](size_t i) { return yValues[i]; };
+    
+    // Visible index range follows directly from x0 and dx
+    size_t count = yValues.size();
+    size_t first = 0, last = count - 1;
+    double dx = func.GetDx();
+    if (dx > 0.0) {
+        double i0 = std::floor((displayMinX_ - func.GetX0()) / dx) - 1.0;
+        double i1 = std::ceil((displayMaxX_ - func.GetX0()) / dx) + 1.0;
+        if (i1 < 0.0 || i0 > static_cast<double>(count - 1)) return;
+        first = static_cast<size_t>(std::max(i0, 0.0));
+        last = static_cast<size_t>(std::min(i1, static_cast<double>(count - 1)));
+    }
+    
+    CollectDecimatedStrip(first, last, xAt, yAt, displayMinX_, GetPixelsPerUnitX(), lineVertices_);
+    const Color& color = func.GetColor();
+    lineRenderer_.DrawStrip(lineVertices_, curveStyle_, color.r, color.g, color.b);
 }
 
 void GLWidget::DrawMultiFunction(const MultiLoadedFunction& func) {
@@ -272,30 +560,74 @@ void GLWidget::DrawMultiFunction(const MultiLoadedFunction& func) {
     
     if (xValues.empty()) return;
     
-    for (int i = 0; i < func.GetDimension(); ++i) {
-        if (!func.IsFunctionVisible(i)) continue;
+    auto xAt = [&xValues](size_t i) { return xValues[i]; };
+    
+    size_t first, last;
+    if (!FindVisibleRange(xValues.size(), xAt, displayMinX_, displayMaxX_, first, last)) return;
+    double pixelsPerUnit = GetPixelsPerUnitX();
+    
+    for (int i = 0; i < func.GetDimension() && i < static_cast<int>(yValues.size()); ++i) {
+        if (!IsSeriesShown(func, i)) continue;
         
-        Color color = func.GetFunctionColor(i);
-        glColor3f(color.r, color.g, color.b);
-        glLineWidth(2.0f);
+        const auto& ys = yValues[i];
+        if (ys.empty()) continue;
         
-        glBegin(GL_LINE_STRIP);
-        for (size_t j = 0; j < xValues.size() && j < yValues[i].size(); ++j) {
-            glVertex2d(xValues[j], yValues[i][j]);
-        }
-        glEnd();
+        auto yAt = [&ys](size_t j) { return ys[j]; };
+        CollectDecimatedStrip(first, std::min(last, ys.size() - 1), xAt, yAt, displayMinX_, pixelsPerUnit,
+                              lineVertices_);
+        Color color = func.GetFunctionColor(i);
+        lineRenderer_.DrawStrip(lineVertices_, curveStyle_, color.r, color.g, color.b);
     }
 }
 
 void GLWidget::AddFunction(std::unique_ptr<LoadedFunction> func) {
-    functions_.push_back(std::move(func));
+    functions_->push_back(std::move(func));
     CalculateBounds();
     update();
     emit boundsChanged();
 }
 
+void GLWidget::ReplaceFunction(size_t index, std::unique_ptr<LoadedFunction> func) {
+    if (index >= functions_->size()) return;
+    
+    // Keeps the current view, so tweaking a derived series doesn't reset zoom/pan
+    (*functions_)[index] = std::move(func);
+    update();
+}
+
+void GLWidget::ShareFunctionStore(const GLWidget& owner) {
+    functions_ = owner.functions_;
+    CalculateBounds();
+    update();
+}
+
+void GLWidget::SetPaneSeries(std::vector<SeriesView> series) {
+    paneSeries_ = std::move(series);
+    paneFiltered_ = true;
+    update();
+}
+
+void GLWidget::ClearPaneSeries() {
+    paneSeries_.clear();
+    paneFiltered_ = false;
+    update();
+}
+
+bool GLWidget::IsSeriesShown(const LoadedFunction& func, int subFunction) const {
+    if (!func.IsVisible() || !func.IsFunctionVisible(subFunction)) return false;
+    if (!paneFiltered_) return true;
+    return std::find(paneSeries_.begin(), paneSeries_.end(), SeriesView{ &func, subFunction }) != paneSeries_.end();
+}
+
+void GLWidget::SetXView(double minX, double maxX) {
+    viewMinX_ = minX;
+    viewMaxX_ = maxX;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
+    update();
+}
+
 void GLWidget::ClearFunctions() {
-    functions_.clear();
+    functions_->clear();
     
     // Reset to defaults
     defaultMinX_ = -10.0;
@@ -309,47 +641,48 @@ void GLWidget::ClearFunctions() {
     viewMaxY_ = defaultMaxY_;
     
     // Calculate ticks for default range
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        viewMinX_, viewMaxX_, viewMinY_, viewMaxY_, 10, 8);
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
     
     update();
     emit boundsChanged();
 }
 
 void GLWidget::CalculateBounds() {
-    if (functions_.empty()) {
+    if (functions_->empty()) {
         defaultMinX_ = -10.0;
         defaultMaxX_ = 10.0;
         defaultMinY_ = -10.0;
         defaultMaxY_ = 10.0;
     } else {
-        // Find visible bounds
-        bool firstVisible = true;
-        double minX = 0, maxX = 1, minY = 0, maxY = 1;
+        // X bounds come from all visible functions, so linked panes agree on them;
+        // Y bounds only from the series shown in this pane
+        bool firstX = true, firstY = true;
+        double minX = -10.0, maxX = 10.0, minY = -10.0, maxY = 10.0;
         
-        for (const auto& func : functions_) {
+        for (const auto& func : *functions_) {
             if (!func->IsVisible()) continue;
             
-            if (firstVisible) {
+            if (firstX) {
                 minX = func->GetMinX();
                 maxX = func->GetMaxX();
-                minY = func->GetMinY();
-                maxY = func->GetMaxY();
-                firstVisible = false;
+                firstX = false;
             } else {
                 minX = std::min(minX, func->GetMinX());
                 maxX = std::max(maxX, func->GetMaxX());
-                minY = std::min(minY, func->GetMinY());
-                maxY = std::max(maxY, func->GetMaxY());
             }
-        }
-        
-        if (firstVisible) {
-            // No visible functions
-            minX = -10.0; maxX = 10.0;
-            minY = -10.0; maxY = 10.0;
+            
+            for (int i = 0; i < func->GetDimension(); ++i) {
+                if (!IsSeriesShown(*func, i)) continue;
+                
+                if (firstY) {
+                    minY = func->GetFunctionMinY(i);
+                    maxY = func->GetFunctionMaxY(i);
+                    firstY = false;
+                } else {
+                    minY = std::min(minY, func->GetFunctionMinY(i));
+                    maxY = std::max(maxY, func->GetFunctionMaxY(i));
+                }
+            }
         }
         
         // Handle degenerate ranges
@@ -371,17 +704,13 @@ void GLWidget::CalculateBounds() {
     }
     
     // Calculate nice tick values
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        defaultMinX_, defaultMaxX_, defaultMinY_, defaultMaxY_, 10, 8);
-    
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    UpdateAxisTicks(defaultMinX_, defaultMaxX_, defaultMinY_, defaultMaxY_);
     
     // Use nice bounds for view
-    viewMinX_ = xTicks.min;
-    viewMaxX_ = xTicks.max;
-    viewMinY_ = yTicks.min;
-    viewMaxY_ = yTicks.max;
+    viewMinX_ = xTickInfo_.min;
+    viewMaxX_ = xTickInfo_.max;
+    viewMinY_ = yTickInfo_.min;
+    viewMaxY_ = yTickInfo_.max;
     
     // Projection will be set up in paintGL when update() triggers a repaint
 }
@@ -411,6 +740,11 @@ void GLWidget::SetPreserveAspectRatio(bool preserve) {
     update();  // Projection will be set up in paintGL
 }
 
+void GLWidget::SetHoverReadoutEnabled(bool enabled) {
+    hoverEnabled_ = enabled;
+    update();
+}
+
 void GLWidget::mousePressEvent(QMouseEvent* event) {
     if (event->button() == Qt::LeftButton || event->button() == Qt::RightButton) {
         isPanning_ = true;
@@ -419,6 +753,16 @@ void GLWidget::mousePressEvent(QMouseEvent* event) {
 }
 
 void GLWidget::mouseMoveEvent(QMouseEvent* event) {
+    // Track hover position; the nearest samples are looked up in paintGL
+    QPoint pos = event->pos();
+    bool insidePlot = pos.x() >= MARGIN_LEFT && pos.x() <= width_ - MARGIN_RIGHT &&
+                      pos.y() >= MARGIN_TOP && pos.y() <= height_ - MARGIN_BOTTOM;
+    if (hoverEnabled_ && (insidePlot || hoverActive_)) {
+        hoverActive_ = insidePlot;
+        hoverPos_ = pos;
+        if (!isPanning_) update();
+    }
+    
     if (!isPanning_) return;
     
     QPoint delta = event->pos() - lastMousePos_;
@@ -440,12 +784,10 @@ void GLWidget::mouseMoveEvent(QMouseEvent* event) {
     viewMaxY_ += dy;
     
     // Recalculate ticks for new view
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        viewMinX_, viewMaxX_, viewMinY_, viewMaxY_, 10, 8);
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
     
     update();
+    emit xViewChanged(viewMinX_, viewMaxX_);
 }
 
 void GLWidget::mouseReleaseEvent(QMouseEvent* event) {
@@ -472,10 +814,16 @@ void GLWidget::wheelEvent(QWheelEvent* event) {
     viewMaxY_ = mouseY + (viewMaxY_ - mouseY) * zoomFactor;
     
     // Recalculate ticks for new view
-    auto [xTicks, yTicks] = AxisTickCalculator::CalculateAxisTicks(
-        viewMinX_, viewMaxX_, viewMinY_, viewMaxY_, 10, 8);
-    xTickInfo_ = xTicks;
-    yTickInfo_ = yTicks;
+    UpdateAxisTicks(viewMinX_, viewMaxX_, viewMinY_, viewMaxY_);
     
     update();
+    emit xViewChanged(viewMinX_, viewMaxX_);
+}
+
+void GLWidget::leaveEvent(QEvent* event) {
+    QOpenGLWidget::leaveEvent(event);
+    if (hoverActive_) {
+        hoverActive_ = false;
+        update();
+    }
 }
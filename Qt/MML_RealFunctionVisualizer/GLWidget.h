@@ -6,12 +6,13 @@
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QFont>
-#include <QPainter>
 #include <vector>
 #include <memory>
 #include <functional>
 #include "MMLData.h"
 #include "AxisTickCalculator.h"
+#include "TextRenderer.h"
+#include "LineRenderer.h"
 
 // Callback for when visibility changes
 using VisibilityChangedCallback = std::function<void()>;
@@ -25,11 +26,24 @@ public:
 
     // Function management
     void AddFunction(std::unique_ptr<LoadedFunction> func);
+    void ReplaceFunction(size_t index, std::unique_ptr<LoadedFunction> func);
     void ClearFunctions();
     void ResetView();
     
-    std::vector<std::unique_ptr<LoadedFunction>>& GetFunctions() { return functions_; }
-    const std::vector<std::unique_ptr<LoadedFunction>>& GetFunctions() const { return functions_; }
+    FunctionStore& GetFunctions() { return *functions_; }
+    const FunctionStore& GetFunctions() const { return *functions_; }
+    
+    // Linked panes: share the owner's function store (no data is copied) and
+    // show only the given series; an empty filter shows everything
+    void ShareFunctionStore(const GLWidget& owner);
+    void SetPaneSeries(std::vector<SeriesView> series);
+    void ClearPaneSeries();
+    bool IsSeriesShown(const LoadedFunction& func, int subFunction) const;
+    
+    // Sets the x range without emitting xViewChanged (used to follow a linked pane)
+    void SetXView(double minX, double maxX);
+    double GetViewMinX() const { return viewMinX_; }
+    double GetViewMaxX() const { return viewMaxX_; }
 
     // Display settings
     bool IsGridVisible() const { return showGrid_; }
@@ -41,6 +55,9 @@ public:
     bool IsAspectRatioPreserved() const { return preserveAspectRatio_; }
     void SetPreserveAspectRatio(bool preserve);
     
+    bool IsHoverReadoutEnabled() const { return hoverEnabled_; }
+    void SetHoverReadoutEnabled(bool enabled);
+    
     // Callback
     void SetVisibilityChangedCallback(VisibilityChangedCallback cb) { visibilityCallback_ = cb; }
     
@@ -49,6 +66,7 @@ public:
 
 signals:
     void boundsChanged();
+    void xViewChanged(double minX, double maxX);
 
 protected:
     void initializeGL() override;
@@ -59,22 +77,55 @@ protected:
     void mouseMoveEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
     void wheelEvent(QWheelEvent* event) override;
+    void leaveEvent(QEvent* event) override;
 
 private:
+    // One line of the hover readout (nearest sample of a visible series)
+    struct HoverSample {
+        std::string title;
+        Color color;
+        double x;
+        double y;
+    };
+    
     void DrawAxes();
     void DrawGrid();
-    void DrawAxisLabels(QPainter& painter);
+    void DrawAxisLabels();
+    void RebuildAxisLabels();
+    void UpdateAxisTicks(double minX, double maxX, double minY, double maxY);
+    void UpdateHoverSamples();
+    void DrawHoverCrosshair();
+    void DrawHoverReadout();
     void DrawSingleFunction(const LoadedRealFunction& func);
+    void DrawEquallySpacedFunction(const LoadedEquallySpacedFunction& func);
     void DrawMultiFunction(const MultiLoadedFunction& func);
     void CalculateBounds();
     void SetupProjection();
+    double GetPixelsPerUnitX() const;
+    
+    std::shared_ptr<FunctionStore> functions_;
     
-    std::vector<std::unique_ptr<LoadedFunction>> functions_;
+    // Series shown in this pane (non-owning); used only when paneFiltered_ is set
+    std::vector<SeriesView> paneSeries_;
+    bool paneFiltered_;
     
     // Tick information
     AxisTickInfo xTickInfo_;
     AxisTickInfo yTickInfo_;
     
+    // Axis labels drawn from a glyph atlas; the batch is rebuilt only when
+    // ticks, display bounds or widget size change
+    TextRenderer textRenderer_;
+    bool labelsDirty_;
+    double labelMinX_, labelMaxX_;
+    double labelMinY_, labelMaxY_;
+    
+    // Curves, grid and axes are drawn as instanced wide lines; lineVertices_
+    // is scratch space for the vertices streamed each frame
+    LineRenderer lineRenderer_;
+    LineRenderer::Style curveStyle_;
+    std::vector<float> lineVertices_;
+    
     // View parameters (nice bounds)
     double viewMinX_;
     double viewMaxX_;
@@ -102,6 +153,14 @@ private:
     QPoint lastMousePos_;
     bool isPanning_;
     
+    // Hover crosshair and nearest-sample readout
+    TextRenderer hoverTextRenderer_;
+    bool hoverEnabled_;
+    bool hoverActive_;
+    QPoint hoverPos_;
+    double hoverX_;
+    std::vector<HoverSample> hoverSamples_;
+    
     // OpenGL initialization flag
     bool glInitialized_;
     
@@ -114,6 +173,15 @@ private:
     static constexpr int MARGIN_TOP = 20;
     static constexpr int MARGIN_RIGHT = 20;
     
+    // Line widths in logical pixels
+    static constexpr float CURVE_LINE_WIDTH = 2.0f;
+    static constexpr float AXIS_LINE_WIDTH = 2.0f;
+    static constexpr float TICK_LINE_WIDTH = 1.0f;
+    static constexpr float GRID_LINE_WIDTH = 1.0f;
+    
+    // Maximum number of series listed in the hover readout
+    static constexpr int MAX_HOVER_LINES = 12;
+    
     VisibilityChangedCallback visibilityCallback_;
 };
 
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <iterator>
+#include <cmath>
 
 struct Point2D {
     double x;
@@ -51,7 +53,33 @@ public:
     // Get color for a sub-function (for multi-function)
     virtual Color GetFunctionColor(int index) const = 0;
     
+    // Y range of a single sub-function, regardless of visibility
+    virtual double GetFunctionMinY(int /*index*/) const { return GetMinY(); }
+    virtual double GetFunctionMaxY(int /*index*/) const { return GetMaxY(); }
+    
+    // Sample access for hover readout. Samples are ordered by increasing x,
+    // so the nearest sample is found with a binary search (-1 if empty).
+    virtual int FindNearestSample(double x) const = 0;
+    virtual double GetSampleX(int sampleIndex) const = 0;
+    virtual double GetSampleY(int functionIndex, int sampleIndex) const = 0;
+    
 protected:
+    // Binary search over a sorted range for the element nearest to value
+    template<typename It, typename KeyFn>
+    static int FindNearestSorted(It begin, It end, double value, KeyFn key) {
+        if (begin == end) return -1;
+        
+        It it = std::lower_bound(begin, end, value,
+            [&key](const auto& elem, double v) { return key(elem) < v; });
+        
+        if (it == end) return static_cast<int>(std::distance(begin, end) - 1);
+        if (it != begin) {
+            It prev = std::prev(it);
+            if (value - key(*prev) <= key(*it) - value) it = prev;
+        }
+        return static_cast<int>(std::distance(begin, it));
+    }
+    
     bool visible_ = true;
 };
 
@@ -59,16 +87,24 @@ protected:
 class LoadedRealFunction : public LoadedFunction {
 public:
     LoadedRealFunction(const std::string& title, const Color& color)
-        : title_(title), color_(color), xMin_(0), xMax_(1) {}
+        : title_(title), color_(color), xMin_(0), xMax_(1)
+        , minX_(std::numeric_limits<double>::max()), maxX_(std::numeric_limits<double>::lowest())
+        , minY_(std::numeric_limits<double>::max()), maxY_(std::numeric_limits<double>::lowest()) {}
     
     // Alternative constructor that takes an index (for parser compatibility)
     LoadedRealFunction(const std::string& title, int /*index*/)
-        : title_(title), color_(0.0f, 0.0f, 0.0f), xMin_(0), xMax_(1) {}
+        : LoadedRealFunction(title, Color(0.0f, 0.0f, 0.0f)) {}
     
     void AddPoint(double x, double y) {
         points_.push_back(Point2D(x, y));
+        minX_ = std::min(minX_, x);
+        maxX_ = std::max(maxX_, x);
+        minY_ = std::min(minY_, y);
+        maxY_ = std::max(maxY_, y);
     }
     
+    void Reserve(size_t numPoints) { points_.reserve(numPoints); }
+    
     void SetXRange(double xMin, double xMax) {
         xMin_ = xMin;
         xMax_ = xMax;
@@ -84,72 +120,140 @@ public:
     
     Color GetFunctionColor(int /*index*/) const override { return color_; }
     
-    double GetMinX() const override {
-        if (points_.empty()) return 0.0;
-        double minX = std::numeric_limits<double>::max();
-        for (const auto& p : points_) {
-            minX = std::min(minX, p.x);
-        }
-        return minX;
+    int FindNearestSample(double x) const override {
+        return FindNearestSorted(points_.begin(), points_.end(), x,
+                                 [](const Point2D& p) { return p.x; });
     }
+    double GetSampleX(int sampleIndex) const override { return points_[sampleIndex].x; }
+    double GetSampleY(int /*functionIndex*/, int sampleIndex) const override { return points_[sampleIndex].y; }
+    
+    double GetMinX() const override { return points_.empty() ? 0.0 : minX_; }
+    double GetMaxX() const override { return points_.empty() ? 1.0 : maxX_; }
+    double GetMinY() const override { return points_.empty() ? 0.0 : minY_; }
+    double GetMaxY() const override { return points_.empty() ? 1.0 : maxY_; }
+
+private:
+    std::string title_;
+    Color color_;
+    std::vector<Point2D> points_;
+    double xMin_;
+    double xMax_;
+    // Extents of points_, kept up to date by AddPoint
+    double minX_, maxX_;
+    double minY_, maxY_;
+};
+
+// Equally spaced real function, stored with implicit x: x_i = x0 + i * dx
+class LoadedEquallySpacedFunction : public LoadedFunction {
+public:
+    LoadedEquallySpacedFunction(const std::string& title, double x0, double dx)
+        : title_(title), color_(0.0f, 0.0f, 0.0f), x0_(x0), dx_(dx)
+        , minY_(std::numeric_limits<double>::max())
+        , maxY_(std::numeric_limits<double>::lowest()) {}
     
-    double GetMaxX() const override {
-        if (points_.empty()) return 1.0;
-        double maxX = std::numeric_limits<double>::lowest();
-        for (const auto& p : points_) {
-            maxX = std::max(maxX, p.x);
+    LoadedEquallySpacedFunction(const std::string& title, double x0, double dx, std::vector<double> yValues)
+        : LoadedEquallySpacedFunction(title, x0, dx) {
+        yValues_ = std::move(yValues);
+        for (double y : yValues_) {
+            minY_ = std::min(minY_, y);
+            maxY_ = std::max(maxY_, y);
         }
-        return maxX;
     }
     
-    double GetMinY() const override {
-        if (points_.empty()) return 0.0;
-        double minY = std::numeric_limits<double>::max();
-        for (const auto& p : points_) {
-            minY = std::min(minY, p.y);
-        }
-        return minY;
+    void AddValue(double y) {
+        yValues_.push_back(y);
+        minY_ = std::min(minY_, y);
+        maxY_ = std::max(maxY_, y);
     }
     
-    double GetMaxY() const override {
-        if (points_.empty()) return 1.0;
-        double maxY = std::numeric_limits<double>::lowest();
-        for (const auto& p : points_) {
-            maxY = std::max(maxY, p.y);
-        }
-        return maxY;
+    double GetX0() const { return x0_; }
+    double GetDx() const { return dx_; }
+    double GetX(size_t i) const { return x0_ + static_cast<double>(i) * dx_; }
+    const std::vector<double>& GetYValues() const { return yValues_; }
+    
+    const std::string& GetTitle() const override { return title_; }
+    const Color& GetColor() const { return color_; }
+    void SetColor(const Color& color) { color_ = color; }
+    
+    int GetNumPoints() const override { return static_cast<int>(yValues_.size()); }
+    int GetDimension() const override { return 1; }
+    
+    Color GetFunctionColor(int /*index*/) const override { return color_; }
+    
+    // Spacing is uniform, so the nearest sample is computed directly
+    int FindNearestSample(double x) const override {
+        if (yValues_.empty()) return -1;
+        if (dx_ <= 0.0) return 0;
+        double i = std::round((x - x0_) / dx_);
+        return static_cast<int>(std::clamp(i, 0.0, static_cast<double>(yValues_.size() - 1)));
     }
+    double GetSampleX(int sampleIndex) const override { return GetX(sampleIndex); }
+    double GetSampleY(int /*functionIndex*/, int sampleIndex) const override { return yValues_[sampleIndex]; }
+    
+    double GetMinX() const override { return yValues_.empty() ? 0.0 : x0_; }
+    double GetMaxX() const override { return yValues_.empty() ? 1.0 : GetX(yValues_.size() - 1); }
+    double GetMinY() const override { return yValues_.empty() ? 0.0 : minY_; }
+    double GetMaxY() const override { return yValues_.empty() ? 1.0 : maxY_; }
 
 private:
     std::string title_;
     Color color_;
-    std::vector<Point2D> points_;
-    double xMin_;
-    double xMax_;
+    double x0_;
+    double dx_;
+    std::vector<double> yValues_;
+    double minY_;
+    double maxY_;
 };
 
 // Multiple functions sharing the same x-coordinates
 class MultiLoadedFunction : public LoadedFunction {
 public:
     MultiLoadedFunction(const std::string& title, const std::vector<std::string>& legend)
-        : title_(title), legend_(legend) {
+        : title_(title), legend_(legend)
+        , minX_(std::numeric_limits<double>::max()), maxX_(std::numeric_limits<double>::lowest()) {
         // Initialize visibility for all sub-functions
         functionVisibility_.resize(legend.size(), true);
     }
     
     void AddPoint(double x, const std::vector<double>& yValues) {
         xValues_.push_back(x);
+        minX_ = std::min(minX_, x);
+        maxX_ = std::max(maxX_, x);
         
         // Ensure we have enough vectors
         while (yValues_.size() < yValues.size()) {
             yValues_.push_back(std::vector<double>());
+            functionMinY_.push_back(std::numeric_limits<double>::max());
+            functionMaxY_.push_back(std::numeric_limits<double>::lowest());
         }
         
         for (size_t i = 0; i < yValues.size(); ++i) {
             yValues_[i].push_back(yValues[i]);
+            functionMinY_[i] = std::min(functionMinY_[i], yValues[i]);
+            functionMaxY_[i] = std::max(functionMaxY_[i], yValues[i]);
         }
     }
     
+    // Puts the samples in order of increasing x, as lookups expect; a no-op when
+    // the file listed them in order
+    void SortByX() {
+        if (std::is_sorted(xValues_.begin(), xValues_.end())) return;
+        
+        std::vector<size_t> order(xValues_.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [this](size_t a, size_t b) { return xValues_[a] < xValues_[b]; });
+        
+        auto permute = [&order](std::vector<double>& values) {
+            if (values.size() != order.size()) return;
+            std::vector<double> sorted(order.size());
+            for (size_t i = 0; i < order.size(); ++i) sorted[i] = values[order[i]];
+            values.swap(sorted);
+        };
+        permute(xValues_);
+        for (auto& y : yValues_) permute(y);
+    }
+    
     const std::vector<double>& GetXValues() const { return xValues_; }
     const std::vector<std::vector<double>>& GetYValues() const { return yValues_; }
     const std::vector<std::string>& GetLegend() const { return legend_; }
@@ -192,23 +296,33 @@ public:
         }
     }
     
-    double GetMinX() const override {
-        if (xValues_.empty()) return 0.0;
-        return *std::min_element(xValues_.begin(), xValues_.end());
+    int FindNearestSample(double x) const override {
+        return FindNearestSorted(xValues_.begin(), xValues_.end(), x,
+                                 [](double v) { return v; });
+    }
+    double GetSampleX(int sampleIndex) const override { return xValues_[sampleIndex]; }
+    double GetSampleY(int functionIndex, int sampleIndex) const override {
+        return yValues_[functionIndex][sampleIndex];
+    }
+    
+    double GetFunctionMinY(int index) const override {
+        if (index < 0 || index >= static_cast<int>(yValues_.size()) || yValues_[index].empty()) return 0.0;
+        return functionMinY_[index];
     }
     
-    double GetMaxX() const override {
-        if (xValues_.empty()) return 1.0;
-        return *std::max_element(xValues_.begin(), xValues_.end());
+    double GetFunctionMaxY(int index) const override {
+        if (index < 0 || index >= static_cast<int>(yValues_.size()) || yValues_[index].empty()) return 1.0;
+        return functionMaxY_[index];
     }
     
+    double GetMinX() const override { return xValues_.empty() ? 0.0 : minX_; }
+    double GetMaxX() const override { return xValues_.empty() ? 1.0 : maxX_; }
+    
     double GetMinY() const override {
         double minY = std::numeric_limits<double>::max();
         for (size_t i = 0; i < yValues_.size(); ++i) {
             if (!IsFunctionVisible(static_cast<int>(i))) continue;
-            for (double y : yValues_[i]) {
-                minY = std::min(minY, y);
-            }
+            minY = std::min(minY, functionMinY_[i]);
         }
         return minY == std::numeric_limits<double>::max() ? 0.0 : minY;
     }
@@ -217,9 +331,7 @@ public:
         double maxY = std::numeric_limits<double>::lowest();
         for (size_t i = 0; i < yValues_.size(); ++i) {
             if (!IsFunctionVisible(static_cast<int>(i))) continue;
-            for (double y : yValues_[i]) {
-                maxY = std::max(maxY, y);
-            }
+            maxY = std::max(maxY, functionMaxY_[i]);
         }
         return maxY == std::numeric_limits<double>::lowest() ? 1.0 : maxY;
     }
@@ -229,8 +341,25 @@ private:
     std::vector<std::string> legend_;
     std::vector<double> xValues_;
     std::vector<std::vector<double>> yValues_;
+    // Extents of the samples, kept up to date by AddPoint
+    double minX_, maxX_;
+    std::vector<double> functionMinY_;
+    std::vector<double> functionMaxY_;
     std::vector<Color> colors_;
     std::vector<bool> functionVisibility_;
 };
 
+// Functions shared by all plot panes
+using FunctionStore = std::vector<std::unique_ptr<LoadedFunction>>;
+
+// Non-owning reference to one series (sub-function) of a loaded function
+struct SeriesView {
+    const LoadedFunction* function = nullptr;
+    int subFunction = 0;
+    
+    bool operator==(const SeriesView& other) const {
+        return function == other.function && subFunction == other.subFunction;
+    }
+};
+
 #endif // MML_DATA_H
@@ -1,6 +1,7 @@
 #include "MMLFileParser.h"
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
 
 std::unique_ptr<LoadedFunction> MMLFileParser::ParseFile(const std::string& filename, int index) {
     std::ifstream file(filename);
@@ -19,9 +20,9 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseFile(const std::string& file
     } else if (typeStr == "MULTI_REAL_FUNCTION_VARIABLE_SPACED") {
         return ParseMultiRealFunctionVariableSpaced(file);
     } else if (typeStr == "REAL_FUNCTION_EQUALLY_SPACED") {
-        throw std::runtime_error("REAL_FUNCTION_EQUALLY_SPACED not yet supported");
+        return ParseRealFunctionEquallySpaced(file);
     } else if (typeStr == "REAL_FUNCTION_VARIABLE_SPACED") {
-        throw std::runtime_error("REAL_FUNCTION_VARIABLE_SPACED not yet supported");
+        return ParseRealFunctionVariableSpaced(file, index);
     } else {
         throw std::runtime_error("Unsupported format: " + typeStr);
     }
@@ -58,7 +59,11 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseRealFunction(std::ifstream&
     }
     int numPoints = ParseInt(parts[1]);
     
-    auto func = std::make_unique<LoadedRealFunction>(title, index);
+    std::vector<double> xValues, yValues;
+    if (numPoints > 0) {
+        xValues.reserve(numPoints);
+        yValues.reserve(numPoints);
+    }
     
     // Parse data points
     while (std::getline(file, line)) {
@@ -67,15 +72,178 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseRealFunction(std::ifstream&
         
         parts = Split(line, ' ');
         if (parts.size() >= 2) {
-            double x = ParseDouble(parts[0]);
-            double y = ParseDouble(parts[1]);
-            func->AddPoint(x, y);
+            xValues.push_back(ParseDouble(parts[0]));
+            yValues.push_back(ParseDouble(parts[1]));
+        }
+    }
+    
+    return CreateRealFunction(title, index, xValues, yValues);
+}
+
+std::unique_ptr<LoadedFunction> MMLFileParser::ParseRealFunctionEquallySpaced(std::ifstream& file) {
+    // Format:
+    // Title
+    // x1: <value>
+    // x2: <value>
+    // NumPoints: <value>
+    // Data lines: "x y" or just "y"
+    
+    std::string title;
+    std::getline(file, title);
+    title = Trim(title);
+    
+    double x1 = 0.0, x2 = 0.0;
+    bool hasX1 = false, hasX2 = false;
+    int numPoints = 0;
+    
+    std::vector<double> yValues;
+    double firstX = 0.0, secondX = 0.0;
+    bool hasExplicitX = false;
+    
+    std::string line, key, value;
+    while (std::getline(file, line)) {
+        line = Trim(line);
+        if (line.empty()) continue;
+        
+        // Header lines
+        if (ParseKeyValue(line, key, value)) {
+            if (key == "x1") { x1 = ParseDouble(value); hasX1 = true; }
+            else if (key == "x2") { x2 = ParseDouble(value); hasX2 = true; }
+            else if (key == "NumPoints") {
+                numPoints = ParseInt(value);
+                if (numPoints > 0) yValues.reserve(numPoints);
+            }
+            continue;
+        }
+        
+        // Data lines; x is not stored, only used if the header lacks the range
+        auto parts = Split(line, ' ');
+        if (parts.size() >= 2) {
+            if (yValues.size() == 0) firstX = ParseDouble(parts[0]);
+            else if (yValues.size() == 1) secondX = ParseDouble(parts[0]);
+            hasExplicitX = true;
+            yValues.push_back(ParseDouble(parts[1]));
+        } else if (parts.size() == 1) {
+            yValues.push_back(ParseDouble(parts[0]));
         }
     }
     
+    if (yValues.empty()) {
+        throw std::runtime_error("No data points in equally spaced function: " + title);
+    }
+    
+    double x0 = 0.0, dx = 1.0;
+    if (hasX1 && hasX2) {
+        x0 = x1;
+        dx = yValues.size() > 1 ? (x2 - x1) / static_cast<double>(yValues.size() - 1) : 1.0;
+    } else if (hasExplicitX) {
+        x0 = firstX;
+        dx = yValues.size() > 1 ? secondX - firstX : 1.0;
+    } else {
+        throw std::runtime_error("Missing x1/x2 for equally spaced function: " + title);
+    }
+    
+    // A descending range is stored ascending, so lookups and bounds can rely on dx > 0
+    if (dx < 0.0) {
+        x0 += dx * static_cast<double>(yValues.size() - 1);
+        dx = -dx;
+        std::reverse(yValues.begin(), yValues.end());
+    }
+    if (!(dx > 0.0) || !std::isfinite(dx)) {
+        throw std::runtime_error("Invalid x spacing in equally spaced function: " + title);
+    }
+    
+    auto func = std::make_unique<LoadedEquallySpacedFunction>(title, x0, dx, std::move(yValues));
     return func;
 }
 
+std::unique_ptr<LoadedFunction> MMLFileParser::ParseRealFunctionVariableSpaced(std::ifstream& file, int index) {
+    // Format:
+    // Title
+    // Optional header lines ("NumPoints: <value>", "x1: <value>", ...)
+    // Data lines: x y
+    
+    std::string title;
+    std::getline(file, title);
+    title = Trim(title);
+    
+    std::vector<double> xValues, yValues;
+    
+    std::string line, key, value;
+    while (std::getline(file, line)) {
+        line = Trim(line);
+        if (line.empty()) continue;
+        
+        if (ParseKeyValue(line, key, value)) {
+            if (key == "NumPoints") {
+                int numPoints = ParseInt(value);
+                if (numPoints > 0) {
+                    xValues.reserve(numPoints);
+                    yValues.reserve(numPoints);
+                }
+            }
+            continue;
+        }
+        
+        auto parts = Split(line, ' ');
+        if (parts.size() >= 2) {
+            xValues.push_back(ParseDouble(parts[0]));
+            yValues.push_back(ParseDouble(parts[1]));
+        }
+    }
+    
+    return CreateRealFunction(title, index, xValues, yValues);
+}
+
+std::unique_ptr<LoadedFunction> MMLFileParser::CreateRealFunction(const std::string& title, int index,
+                                                                  std::vector<double>& xValues,
+                                                                  std::vector<double>& yValues) {
+    // Lookups binary-search x, so samples listed out of order are sorted here
+    if (!std::is_sorted(xValues.begin(), xValues.end())) {
+        std::vector<size_t> order(xValues.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [&xValues](size_t a, size_t b) { return xValues[a] < xValues[b]; });
+        std::vector<double> sortedX(order.size()), sortedY(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            sortedX[i] = xValues[order[i]];
+            sortedY[i] = yValues[order[i]];
+        }
+        xValues.swap(sortedX);
+        yValues.swap(sortedY);
+    }
+    
+    // Uniform grids don't need x stored per sample
+    if (IsEquallySpaced(xValues)) {
+        double dx = (xValues.back() - xValues.front()) / static_cast<double>(xValues.size() - 1);
+        return std::make_unique<LoadedEquallySpacedFunction>(title, xValues.front(), dx, std::move(yValues));
+    }
+    
+    auto func = std::make_unique<LoadedRealFunction>(title, index);
+    func->Reserve(xValues.size());
+    for (size_t i = 0; i < xValues.size(); ++i) {
+        func->AddPoint(xValues[i], yValues[i]);
+    }
+    return func;
+}
+
+bool MMLFileParser::IsEquallySpaced(const std::vector<double>& xValues) {
+    if (xValues.size() < 3) return false;
+    
+    double x0 = xValues.front();
+    double range = xValues.back() - x0;
+    if (!(range > 0.0)) return false;
+    
+    double dx = range / static_cast<double>(xValues.size() - 1);
+    double tolerance = 1e-9 * range;
+    for (size_t i = 1; i < xValues.size(); ++i) {
+        if (std::abs(xValues[i] - (x0 + static_cast<double>(i) * dx)) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::unique_ptr<LoadedFunction> MMLFileParser::ParseMultiRealFunction(std::ifstream& file) {
     std::string title;
     std::getline(file, title);
@@ -137,6 +305,7 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseMultiRealFunction(std::ifstr
         }
     }
     
+    func->SortByX();
     return func;
 }
 
@@ -195,9 +364,19 @@ std::unique_ptr<LoadedFunction> MMLFileParser::ParseMultiRealFunctionVariableSpa
         }
     }
     
+    func->SortByX();
     return func;
 }
 
+bool MMLFileParser::ParseKeyValue(const std::string& line, std::string& key, std::string& value) {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) return false;
+    
+    key = Trim(line.substr(0, colon));
+    value = Trim(line.substr(colon + 1));
+    return true;
+}
+
 double MMLFileParser::ParseDouble(const std::string& str) {
     try {
         return std::stod(str);
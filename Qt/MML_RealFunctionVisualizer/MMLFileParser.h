@@ -16,10 +16,19 @@ public:
 private:
     // Format-specific parsers
     static std::unique_ptr<LoadedFunction> ParseRealFunction(std::ifstream& file, int index);
+    static std::unique_ptr<LoadedFunction> ParseRealFunctionEquallySpaced(std::ifstream& file);
+    static std::unique_ptr<LoadedFunction> ParseRealFunctionVariableSpaced(std::ifstream& file, int index);
     static std::unique_ptr<LoadedFunction> ParseMultiRealFunction(std::ifstream& file);
     static std::unique_ptr<LoadedFunction> ParseMultiRealFunctionVariableSpaced(std::ifstream& file);
     
+    // Builds implicit-x storage when samples are equally spaced, explicit points otherwise
+    static std::unique_ptr<LoadedFunction> CreateRealFunction(const std::string& title, int index,
+                                                              std::vector<double>& xValues,
+                                                              std::vector<double>& yValues);
+    static bool IsEquallySpaced(const std::vector<double>& xValues);
+    
     // Utility functions
+    static bool ParseKeyValue(const std::string& line, std::string& key, std::string& value);
     static double ParseDouble(const std::string& str);
     static int ParseInt(const std::string& str);
     static std::vector<std::string> Split(const std::string& str, char delimiter);
@@ -8,6 +8,7 @@
 #include <QFrame>
 #include <QScrollArea>
 #include <QPalette>
+#include <QtConcurrent/QtConcurrentRun>
 
 // Color palette matching WPF version
 const std::vector<Color> MainWindow::colorPalette_ = {
@@ -28,6 +29,12 @@ MainWindow::MainWindow(const std::vector<std::string>& filenames, QWidget *paren
     : QMainWindow(parent)
     , functionCounter_(0)
     , graphTitle_("Real Function Visualizer")
+    , derivedWatcher_(nullptr)
+    , runningJob_{}
+    , queuedJob_{}
+    , hasQueuedJob_(false)
+    , derivedGeneration_(0)
+    , liveDerivedIndex_(-1)
 {
     setWindowTitle("MML Real Function Visualizer (Qt + OpenGL)");
     resize(1200, 850);
@@ -40,14 +47,20 @@ MainWindow::MainWindow(const std::vector<std::string>& filenames, QWidget *paren
     mainLayout->setContentsMargins(5, 5, 5, 5);
     mainLayout->setSpacing(5);
 
-    // Create GL widget (takes most space)
-    glWidget_ = new GLWidget(this);
-    glWidget_->setMinimumSize(600, 400);
-    mainLayout->addWidget(glWidget_, 1);  // Stretch factor 1
+    // Create GL widget (takes most space); further panes are stacked below it
+    paneSplitter_ = new QSplitter(Qt::Vertical, this);
+    paneSplitter_->setMinimumSize(600, 400);
+    mainLayout->addWidget(paneSplitter_, 1);  // Stretch factor 1
+    
+    glWidget_ = CreatePane();
     
     // Connect signals
     connect(glWidget_, &GLWidget::boundsChanged, this, &MainWindow::OnBoundsChanged);
 
+    // Worker for derived series
+    derivedWatcher_ = new QFutureWatcher<std::shared_ptr<const SeriesSamples>>(this);
+    connect(derivedWatcher_, &QFutureWatcherBase::finished, this, &MainWindow::OnDerivedSeriesFinished);
+
     // Create sidebar
     sidebarWidget_ = new QWidget(this);
     sidebarWidget_->setFixedWidth(230);
@@ -66,6 +79,8 @@ MainWindow::MainWindow(const std::vector<std::string>& filenames, QWidget *paren
 }
 
 MainWindow::~MainWindow() {
+    // The worker references derivedEngine_
+    derivedWatcher_->waitForFinished();
 }
 
 void MainWindow::CreateSidebar(QWidget* parent) {
@@ -122,6 +137,56 @@ void MainWindow::CreateSidebar(QWidget* parent) {
     connect(aspectRatioCheckbox_, &QCheckBox::toggled, this, &MainWindow::OnAspectRatioToggled);
     sidebarLayout->addWidget(aspectRatioCheckbox_);
     
+    hoverReadoutCheckbox_ = new QCheckBox("Show Hover Readout", parent);
+    hoverReadoutCheckbox_->setChecked(true);
+    connect(hoverReadoutCheckbox_, &QCheckBox::toggled, this, &MainWindow::OnHoverReadoutToggled);
+    sidebarLayout->addWidget(hoverReadoutCheckbox_);
+    glWidget_->SetHoverReadoutEnabled(hoverReadoutCheckbox_->isChecked());
+    
+    QHBoxLayout* paneLayout = new QHBoxLayout();
+    paneLayout->addWidget(new QLabel("Linked panes:", parent));
+    paneCountSpin_ = new QSpinBox(parent);
+    paneCountSpin_->setRange(1, MAX_PANES);
+    paneCountSpin_->setValue(1);
+    connect(paneCountSpin_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::OnPaneCountChanged);
+    paneLayout->addWidget(paneCountSpin_);
+    paneLayout->addStretch();
+    sidebarLayout->addLayout(paneLayout);
+    
+    // ===== DERIVED SERIES SECTION =====
+    QLabel* derivedLabel = new QLabel("Derived Series:", parent);
+    derivedLabel->setStyleSheet("font-weight: bold;");
+    sidebarLayout->addWidget(derivedLabel);
+    
+    derivedSourceCombo_ = new QComboBox(parent);
+    sidebarLayout->addWidget(derivedSourceCombo_);
+    
+    QHBoxLayout* derivedLayout = new QHBoxLayout();
+    derivedKindCombo_ = new QComboBox(parent);
+    for (DerivedSeriesKind kind : { DerivedSeriesKind::Derivative, DerivedSeriesKind::Integral,
+                                    DerivedSeriesKind::MovingAverage, DerivedSeriesKind::MovingRms,
+                                    DerivedSeriesKind::FftMagnitude }) {
+        derivedKindCombo_->addItem(DerivedSeriesEngine::GetKindName(kind), static_cast<int>(kind));
+    }
+    connect(derivedKindCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::OnDerivedKindChanged);
+    derivedLayout->addWidget(derivedKindCombo_, 1);
+    
+    derivedWindowSpin_ = new QSpinBox(parent);
+    derivedWindowSpin_->setRange(1, 1000000);
+    derivedWindowSpin_->setValue(25);
+    derivedWindowSpin_->setToolTip("Window size in samples");
+    derivedWindowSpin_->setEnabled(false);
+    connect(derivedWindowSpin_, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::OnDerivedWindowChanged);
+    derivedLayout->addWidget(derivedWindowSpin_);
+    sidebarLayout->addLayout(derivedLayout);
+    
+    derivedAddButton_ = new QPushButton("Add Derived Series", parent);
+    derivedAddButton_->setEnabled(false);
+    connect(derivedAddButton_, &QPushButton::clicked, this, &MainWindow::OnAddDerivedSeries);
+    sidebarLayout->addWidget(derivedAddButton_);
+    
     sidebarLayout->addSpacing(10);
     
     // ===== BUTTONS SECTION =====
@@ -176,9 +241,10 @@ void MainWindow::LoadFunctionFile(const QString& filename) {
         if (func) {
             // Assign colors to functions
             if (func->GetDimension() == 1) {
-                auto* singleFunc = dynamic_cast<LoadedRealFunction*>(func.get());
-                if (singleFunc) {
+                if (auto* singleFunc = dynamic_cast<LoadedRealFunction*>(func.get())) {
                     singleFunc->SetColor(GetColorForIndex(functionCounter_));
+                } else if (auto* spacedFunc = dynamic_cast<LoadedEquallySpacedFunction*>(func.get())) {
+                    spacedFunc->SetColor(GetColorForIndex(functionCounter_));
                 }
             } else {
                 auto* multiFunc = dynamic_cast<MultiLoadedFunction*>(func.get());
@@ -201,6 +267,7 @@ void MainWindow::LoadFunctionFile(const QString& filename) {
             functionCounter_++;
             
             UpdateLegend();
+            if (panes_.size() > 1) RecalculatePaneBounds();
             statusBar_->showMessage("Loaded: " + filename, 3000);
         }
     }
@@ -211,7 +278,16 @@ void MainWindow::LoadFunctionFile(const QString& filename) {
 }
 
 void MainWindow::ClearAll() {
-    glWidget_->ClearFunctions();
+    // Results still being computed belong to the old function list
+    derivedGeneration_++;
+    hasQueuedJob_ = false;
+    liveDerivedIndex_ = -1;
+    derivedEngine_.ClearCache();
+    
+    seriesPane_.clear();
+    for (GLWidget* pane : panes_) {
+        pane->ClearFunctions();
+    }
     loadedFilenames_.clear();
     functionCounter_ = 0;
     graphTitle_ = "Real Function Visualizer";
@@ -222,7 +298,9 @@ void MainWindow::ClearAll() {
 }
 
 void MainWindow::ResetView() {
-    glWidget_->ResetView();
+    for (GLWidget* pane : panes_) {
+        pane->ResetView();
+    }
     statusBar_->showMessage("View reset", 2000);
 }
 
@@ -232,15 +310,27 @@ void MainWindow::OnTitleChanged() {
 }
 
 void MainWindow::OnGridToggled(bool checked) {
-    glWidget_->SetGridVisible(checked);
+    for (GLWidget* pane : panes_) {
+        pane->SetGridVisible(checked);
+    }
 }
 
 void MainWindow::OnLabelsToggled(bool checked) {
-    glWidget_->SetLabelsVisible(checked);
+    for (GLWidget* pane : panes_) {
+        pane->SetLabelsVisible(checked);
+    }
 }
 
 void MainWindow::OnAspectRatioToggled(bool checked) {
-    glWidget_->SetPreserveAspectRatio(checked);
+    for (GLWidget* pane : panes_) {
+        pane->SetPreserveAspectRatio(checked);
+    }
+}
+
+void MainWindow::OnHoverReadoutToggled(bool checked) {
+    for (GLWidget* pane : panes_) {
+        pane->SetHoverReadoutEnabled(checked);
+    }
 }
 
 void MainWindow::OnLegendCheckboxToggled(bool checked) {
@@ -263,8 +353,7 @@ void MainWindow::OnLegendCheckboxToggled(bool checked) {
                     func->SetVisible(checked);
                 }
                 
-                glWidget_->RecalculateBounds();
-                glWidget_->update();
+                RecalculatePaneBounds();
             }
             break;
         }
@@ -289,6 +378,7 @@ void MainWindow::UpdateLegend() {
     
     const auto& functions = glWidget_->GetFunctions();
     int colorIndex = 0;
+    int seriesOrdinal = 0;
     
     for (size_t funcIdx = 0; funcIdx < functions.size(); ++funcIdx) {
         const auto& func = functions[funcIdx];
@@ -322,11 +412,15 @@ void MainWindow::UpdateLegend() {
             label->setWordWrap(true);
             entryLayout->addWidget(label, 1);
             
+            QComboBox* paneCombo = CreatePaneCombo(SeriesView{ func.get(), 0 }, seriesOrdinal++);
+            if (paneCombo) entryLayout->addWidget(paneCombo);
+            
             legendLayout_->addWidget(entryWidget);
             
             LegendEntry entry;
             entry.checkbox = checkbox;
             entry.colorBox = colorBox;
+            entry.paneCombo = paneCombo;
             entry.functionIndex = static_cast<int>(funcIdx);
             entry.subFunctionIndex = -1;
             legendEntries_.push_back(entry);
@@ -364,11 +458,15 @@ void MainWindow::UpdateLegend() {
                     label->setWordWrap(true);
                     entryLayout->addWidget(label, 1);
                     
+                    QComboBox* paneCombo = CreatePaneCombo(SeriesView{ func.get(), i }, seriesOrdinal++);
+                    if (paneCombo) entryLayout->addWidget(paneCombo);
+                    
                     legendLayout_->addWidget(entryWidget);
                     
                     LegendEntry entry;
                     entry.checkbox = checkbox;
                     entry.colorBox = colorBox;
+                    entry.paneCombo = paneCombo;
                     entry.functionIndex = static_cast<int>(funcIdx);
                     entry.subFunctionIndex = i;
                     legendEntries_.push_back(entry);
@@ -379,6 +477,259 @@ void MainWindow::UpdateLegend() {
     
     // Add stretch at the end
     legendLayout_->addStretch();
+    
+    UpdatePaneSeries();
+    RefreshDerivedSources();
+}
+
+GLWidget* MainWindow::CreatePane() {
+    GLWidget* pane = new GLWidget(paneSplitter_);
+    pane->setMinimumSize(300, 100);
+    if (!panes_.empty()) {
+        // Secondary panes view the primary's data and follow its settings
+        pane->ShareFunctionStore(*glWidget_);
+        pane->SetGridVisible(gridCheckbox_->isChecked());
+        pane->SetLabelsVisible(labelsCheckbox_->isChecked());
+        pane->SetPreserveAspectRatio(aspectRatioCheckbox_->isChecked());
+        pane->SetHoverReadoutEnabled(hoverReadoutCheckbox_->isChecked());
+    }
+    connect(pane, &GLWidget::xViewChanged, this, &MainWindow::OnPaneXViewChanged);
+    
+    paneSplitter_->addWidget(pane);
+    panes_.push_back(pane);
+    return pane;
+}
+
+QComboBox* MainWindow::CreatePaneCombo(const SeriesView& series, int ordinal) {
+    if (panes_.size() < 2) return nullptr;
+    
+    QComboBox* combo = new QComboBox();
+    for (size_t p = 0; p < panes_.size(); ++p) {
+        combo->addItem(QString("P%1").arg(p + 1));
+    }
+    combo->setCurrentIndex(GetSeriesPane(series, ordinal));
+    combo->setToolTip("Pane showing this series");
+    connect(combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::OnLegendPaneChanged);
+    return combo;
+}
+
+int MainWindow::GetSeriesPane(const SeriesView& series, int ordinal) const {
+    // Series without an explicit choice are spread over the panes in load order
+    auto it = seriesPane_.find(std::make_pair(series.function, series.subFunction));
+    if (it != seriesPane_.end() && it->second < static_cast<int>(panes_.size())) {
+        return it->second;
+    }
+    return ordinal % static_cast<int>(panes_.size());
+}
+
+void MainWindow::UpdatePaneSeries() {
+    if (panes_.size() < 2) {
+        glWidget_->ClearPaneSeries();
+        return;
+    }
+    
+    std::vector<std::vector<SeriesView>> paneSeries(panes_.size());
+    int ordinal = 0;
+    for (const auto& func : glWidget_->GetFunctions()) {
+        for (int i = 0; i < func->GetDimension(); ++i) {
+            SeriesView series{ func.get(), i };
+            paneSeries[GetSeriesPane(series, ordinal++)].push_back(series);
+        }
+    }
+    
+    for (size_t p = 0; p < panes_.size(); ++p) {
+        panes_[p]->SetPaneSeries(std::move(paneSeries[p]));
+    }
+}
+
+void MainWindow::RecalculatePaneBounds() {
+    // All panes derive x bounds from the same store, so they stay aligned
+    for (GLWidget* pane : panes_) {
+        pane->RecalculateBounds();
+    }
+}
+
+void MainWindow::OnPaneCountChanged(int count) {
+    while (static_cast<int>(panes_.size()) < count) {
+        CreatePane();
+    }
+    while (static_cast<int>(panes_.size()) > count && panes_.size() > 1) {
+        delete panes_.back();
+        panes_.pop_back();
+    }
+    
+    UpdateLegend();
+    RecalculatePaneBounds();
+}
+
+void MainWindow::OnLegendPaneChanged(int pane) {
+    QComboBox* combo = qobject_cast<QComboBox*>(sender());
+    if (!combo) return;
+    
+    for (const auto& entry : legendEntries_) {
+        if (entry.paneCombo != combo) continue;
+        
+        const auto& functions = glWidget_->GetFunctions();
+        if (entry.functionIndex < static_cast<int>(functions.size())) {
+            const LoadedFunction* func = functions[entry.functionIndex].get();
+            int subFunction = std::max(entry.subFunctionIndex, 0);
+            seriesPane_[std::make_pair(func, subFunction)] = pane;
+            
+            UpdatePaneSeries();
+            RecalculatePaneBounds();
+        }
+        break;
+    }
+}
+
+void MainWindow::OnPaneXViewChanged(double minX, double maxX) {
+    // Every other pane follows; their repaints land in the same event loop pass
+    GLWidget* source = qobject_cast<GLWidget*>(sender());
+    for (GLWidget* pane : panes_) {
+        if (pane != source) {
+            pane->SetXView(minX, maxX);
+        }
+    }
+}
+
+void MainWindow::RefreshDerivedSources() {
+    // Keep the selection if the same series is still present
+    QVariant current = derivedSourceCombo_->currentData();
+    
+    derivedSourceCombo_->blockSignals(true);
+    derivedSourceCombo_->clear();
+    
+    const auto& functions = glWidget_->GetFunctions();
+    for (size_t funcIdx = 0; funcIdx < functions.size(); ++funcIdx) {
+        const auto& func = functions[funcIdx];
+        int dim = func->GetDimension();
+        for (int i = 0; i < dim; ++i) {
+            std::string title = dim > 1 ? func->GetFunctionTitle(i) : func->GetTitle();
+            derivedSourceCombo_->addItem(QString::fromStdString(title),
+                                         QPoint(static_cast<int>(funcIdx), i));
+        }
+    }
+    
+    int index = derivedSourceCombo_->findData(current);
+    derivedSourceCombo_->setCurrentIndex(index >= 0 ? index : 0);
+    derivedSourceCombo_->blockSignals(false);
+    
+    derivedAddButton_->setEnabled(derivedSourceCombo_->count() > 0);
+}
+
+void MainWindow::OnAddDerivedSeries() {
+    if (derivedSourceCombo_->currentIndex() < 0) return;
+    
+    QPoint source = derivedSourceCombo_->currentData().toPoint();
+    const auto& functions = glWidget_->GetFunctions();
+    if (source.x() < 0 || source.x() >= static_cast<int>(functions.size())) return;
+    
+    DerivedSeriesKey key;
+    key.source = functions[source.x()].get();
+    key.subFunction = source.y();
+    key.kind = static_cast<DerivedSeriesKind>(derivedKindCombo_->currentData().toInt());
+    key.window = derivedWindowSpin_->value();
+    
+    RequestDerivedSeries(key, -1);
+}
+
+void MainWindow::OnDerivedKindChanged(int /*index*/) {
+    auto kind = static_cast<DerivedSeriesKind>(derivedKindCombo_->currentData().toInt());
+    derivedWindowSpin_->setEnabled(DerivedSeriesEngine::UsesWindow(kind));
+}
+
+void MainWindow::OnDerivedWindowChanged(int window) {
+    // Window tweaks update the last added windowed series in place
+    if (liveDerivedIndex_ < 0 || !DerivedSeriesEngine::UsesWindow(liveDerivedKey_.kind)) return;
+    
+    DerivedSeriesKey key = liveDerivedKey_;
+    key.window = window;
+    RequestDerivedSeries(key, liveDerivedIndex_);
+}
+
+void MainWindow::RequestDerivedSeries(const DerivedSeriesKey& key, int replaceIndex) {
+    if (auto cached = derivedEngine_.FindCached(key)) {
+        ApplyDerivedSeries(*cached, key, replaceIndex);
+        return;
+    }
+    
+    DerivedJob job;
+    job.key = key;
+    job.source = derivedEngine_.Snapshot(*key.source, key.subFunction);
+    job.replaceIndex = replaceIndex;
+    job.generation = derivedGeneration_;
+    
+    if (derivedWatcher_->isRunning()) {
+        // Only the latest pending request matters
+        queuedJob_ = job;
+        hasQueuedJob_ = true;
+        return;
+    }
+    StartDerivedJob(job);
+}
+
+void MainWindow::StartDerivedJob(const DerivedJob& job) {
+    runningJob_ = job;
+    statusBar_->showMessage(QString("Computing %1...").arg(DerivedSeriesEngine::GetKindName(job.key.kind)));
+    
+    DerivedSeriesEngine* engine = &derivedEngine_;
+    DerivedSeriesKey key = job.key;
+    std::shared_ptr<const SeriesSamples> source = job.source;
+    derivedWatcher_->setFuture(QtConcurrent::run([engine, key, source]() {
+        return engine->Compute(key, source);
+    }));
+}
+
+void MainWindow::OnDerivedSeriesFinished() {
+    std::shared_ptr<const SeriesSamples> result = derivedWatcher_->result();
+    DerivedJob finished = runningJob_;
+    runningJob_ = DerivedJob{};
+    
+    if (result && finished.generation == derivedGeneration_) {
+        ApplyDerivedSeries(*result, finished.key, finished.replaceIndex);
+    }
+    
+    if (hasQueuedJob_) {
+        hasQueuedJob_ = false;
+        if (queuedJob_.generation == derivedGeneration_) {
+            StartDerivedJob(queuedJob_);
+        }
+    }
+}
+
+void MainWindow::ApplyDerivedSeries(const SeriesSamples& samples, const DerivedSeriesKey& key, int replaceIndex) {
+    auto func = DerivedSeriesEngine::CreateFunction(samples);
+    auto& functions = glWidget_->GetFunctions();
+    bool replace = replaceIndex >= 0 && replaceIndex < static_cast<int>(functions.size());
+    
+    // A replaced series keeps its color and visibility
+    Color color = replace ? functions[replaceIndex]->GetFunctionColor(0) : GetColorForIndex(functionCounter_);
+    if (auto* singleFunc = dynamic_cast<LoadedRealFunction*>(func.get())) {
+        singleFunc->SetColor(color);
+    } else if (auto* spacedFunc = dynamic_cast<LoadedEquallySpacedFunction*>(func.get())) {
+        spacedFunc->SetColor(color);
+    }
+    
+    if (replace) {
+        func->SetVisible(functions[replaceIndex]->IsVisible());
+        auto paneIt = seriesPane_.find(std::make_pair(functions[replaceIndex].get(), 0));
+        if (paneIt != seriesPane_.end()) {
+            seriesPane_[std::make_pair(func.get(), 0)] = paneIt->second;
+            seriesPane_.erase(paneIt);
+        }
+        derivedEngine_.InvalidateSource(functions[replaceIndex].get());
+        glWidget_->ReplaceFunction(static_cast<size_t>(replaceIndex), std::move(func));
+        liveDerivedIndex_ = replaceIndex;
+    } else {
+        glWidget_->AddFunction(std::move(func));
+        functionCounter_++;
+        liveDerivedIndex_ = static_cast<int>(glWidget_->GetFunctions().size()) - 1;
+    }
+    liveDerivedKey_ = key;
+    
+    UpdateLegend();
+    if (!replace && panes_.size() > 1) RecalculatePaneBounds();
+    statusBar_->showMessage(QString("Derived: %1").arg(QString::fromStdString(samples.title)), 3000);
 }
 
 Color MainWindow::GetColorForIndex(int index) {
@@ -9,15 +9,22 @@
 #include <QPushButton>
 #include <QStatusBar>
 #include <QVBoxLayout>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QFutureWatcher>
+#include <QSplitter>
+#include <map>
 #include <vector>
 #include <memory>
 #include "GLWidget.h"
 #include "MMLData.h"
+#include "DerivedSeries.h"
 
 // Structure to hold legend entry widgets
 struct LegendEntry {
     QCheckBox* checkbox;
     QWidget* colorBox;
+    QComboBox* paneCombo;   // Pane selector, nullptr with a single pane
     int functionIndex;      // Index into the function list
     int subFunctionIndex;   // For multi-function: which sub-function (-1 for single)
 };
@@ -37,8 +44,16 @@ private slots:
     void OnGridToggled(bool checked);
     void OnLabelsToggled(bool checked);
     void OnAspectRatioToggled(bool checked);
+    void OnHoverReadoutToggled(bool checked);
     void OnLegendCheckboxToggled(bool checked);
     void OnBoundsChanged();
+    void OnAddDerivedSeries();
+    void OnDerivedKindChanged(int index);
+    void OnDerivedWindowChanged(int window);
+    void OnDerivedSeriesFinished();
+    void OnPaneCountChanged(int count);
+    void OnLegendPaneChanged(int pane);
+    void OnPaneXViewChanged(double minX, double maxX);
 
 private:
     void LoadFunctionFile(const QString& filename);
@@ -46,8 +61,31 @@ private:
     void CreateSidebar(QWidget* parent);
     Color GetColorForIndex(int index);
     
+    // Linked panes: every pane views the primary pane's function store
+    GLWidget* CreatePane();
+    QComboBox* CreatePaneCombo(const SeriesView& series, int ordinal);
+    int GetSeriesPane(const SeriesView& series, int ordinal) const;
+    void UpdatePaneSeries();
+    void RecalculatePaneBounds();
+    
+    // Derived series: requests are served from the engine cache when possible,
+    // otherwise computed on a worker thread (one job at a time, latest request queued)
+    struct DerivedJob {
+        DerivedSeriesKey key;
+        std::shared_ptr<const SeriesSamples> source;
+        int replaceIndex;       // Function to replace, -1 to add a new one
+        int generation;         // Stale if the function list was cleared meanwhile
+    };
+    void RefreshDerivedSources();
+    void RequestDerivedSeries(const DerivedSeriesKey& key, int replaceIndex);
+    void StartDerivedJob(const DerivedJob& job);
+    void ApplyDerivedSeries(const SeriesSamples& samples, const DerivedSeriesKey& key, int replaceIndex);
+    
     // Main widgets
-    GLWidget* glWidget_;
+    GLWidget* glWidget_;                // Primary pane, owns the function store
+    QSplitter* paneSplitter_;
+    std::vector<GLWidget*> panes_;      // All panes, primary first
+    std::map<std::pair<const LoadedFunction*, int>, int> seriesPane_;  // Explicit pane choices
     
     // Sidebar components
     QWidget* sidebarWidget_;
@@ -63,6 +101,14 @@ private:
     QCheckBox* gridCheckbox_;
     QCheckBox* labelsCheckbox_;
     QCheckBox* aspectRatioCheckbox_;
+    QCheckBox* hoverReadoutCheckbox_;
+    QSpinBox* paneCountSpin_;
+    
+    // Derived series panel
+    QComboBox* derivedSourceCombo_;
+    QComboBox* derivedKindCombo_;
+    QSpinBox* derivedWindowSpin_;
+    QPushButton* derivedAddButton_;
     
     // Buttons
     QPushButton* loadButton_;
@@ -77,6 +123,18 @@ private:
     int functionCounter_;
     QString graphTitle_;
     
+    // Derived series state
+    DerivedSeriesEngine derivedEngine_;
+    QFutureWatcher<std::shared_ptr<const SeriesSamples>>* derivedWatcher_;
+    DerivedJob runningJob_;
+    DerivedJob queuedJob_;
+    bool hasQueuedJob_;
+    int derivedGeneration_;
+    int liveDerivedIndex_;          // Last added derived series, updated by window tweaks
+    DerivedSeriesKey liveDerivedKey_;
+    
+    static constexpr int MAX_PANES = 6;
+    
     // Color palette (matching WPF)
     static const std::vector<Color> colorPalette_;
 };